@@ -35,6 +35,19 @@ namespace fmu4cpp {
             return resourceLocation_;
         }
 
+        // Values given by the last setup_experiment call
+        [[nodiscard]] double startTime() const {
+            return startTime_;
+        }
+
+        [[nodiscard]] std::optional<double> stopTime() const {
+            return stopTime_;
+        }
+
+        [[nodiscard]] std::optional<double> tolerance() const {
+            return tolerance_;
+        }
+
         std::optional<IntVariable> get_int_variable(const std::string &name) {
             for (const auto &v: integers_) {
                 if (v.name() == name) return v;
@@ -185,6 +198,10 @@ namespace fmu4cpp {
         std::string instanceName_;
         std::string resourceLocation_;
 
+        double startTime_{};
+        std::optional<double> stopTime_;
+        std::optional<double> tolerance_;
+
         std::vector<IntVariable> integers_;
         std::vector<RealVariable> reals_;
         std::vector<BoolVariable> booleans_;
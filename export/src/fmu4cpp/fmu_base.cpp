@@ -45,6 +45,9 @@ namespace {
 namespace fmu4cpp {
 
     void fmu_base::setup_experiment(double start, std::optional<double> stop, std::optional<double> tolerance) {
+        startTime_ = start;
+        stopTime_ = stop;
+        tolerance_ = tolerance;
     }
 
     void fmu_base::enter_initialisation_mode() {
@@ -0,0 +1,720 @@
+/*
+ * -----------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [BatchKernels.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Span based batch overloads of the atmosphere, gravity and frame routines.
+ *  Inputs are structure-of-arrays; the kernel is chosen at run time from the
+ *  instruction sets supported by the CPU (AVX-512F, AVX2 or SSE2).
+ *
+ *  Accuracy: the SIMD kernels perform the same IEEE operations (+, -, *, /, sqrt)
+ *  in the same order as the scalar routines and are compiled without FMA
+ *  contraction, so results are bit identical to a scalar build without FMA. A
+ *  build with FMA (-mfma, -march=native) contracts the scalar routines but not the
+ *  kernels, and MaxUlpError widens accordingly; it is in units in the last place of
+ *  the magnitude of the result. Pressure and density keep the libm pow/exp calls of
+ *  the scalar code; only the layer search and the temperature are vectorised.
+ *
+ *  The single precision density is a closed form of the same model without libm
+ *  calls (densityFloat); its kernels are bit identical to its scalar routine in the
+ *  same sense, and within MaxFloatRelativeError of the double density.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef BATCH_KERNELS_H
+#define BATCH_KERNELS_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+#include "AtmosphericModels.h"
+#include "EarthCenteredFrames.h"
+#include "GravitationalModels.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_KERNELS_X86 1
+#include <immintrin.h>
+#define BATCH_TARGET_SSE2   __attribute__((target("sse2"), optimize("fp-contract=off")))
+#define BATCH_TARGET_AVX2   __attribute__((target("avx2"), optimize("fp-contract=off")))
+#define BATCH_TARGET_AVX512 __attribute__((target("avx512f"), optimize("fp-contract=off")))
+#endif
+
+namespace Simd {
+
+// Instruction sets with a dedicated kernel, ordered from narrowest to widest
+enum class Isa { Scalar = 0, SSE2 = 1, AVX2 = 2, AVX512 = 3 };
+
+// Documented accuracy bound of the batch kernels with respect to the scalar routines. With
+// FMA the scalar temperature rounds once less than the kernels, and pow(T / T_b, g0 / (R L))
+// multiplies that relative difference by up to g0 / (R |L|) = 34 in pressure and density
+// (20 ULP measured over the test altitudes, 4 ULP for J2).
+#ifdef __FMA__
+constexpr int MaxUlpError = 40;
+#else
+constexpr int MaxUlpError = 2;
+#endif
+
+// Documented relative accuracy of the single precision density with respect to the double one
+constexpr double MaxFloatRelativeError = 1e-6;
+
+// Widest instruction set supported by the running CPU
+inline Isa detectIsa() {
+#ifdef BATCH_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Isa::AVX512;
+    if (__builtin_cpu_supports("avx2"))    return Isa::AVX2;
+    if (__builtin_cpu_supports("sse2"))    return Isa::SSE2;
+#endif
+    return Isa::Scalar;
+}
+
+namespace detail {
+
+inline std::atomic<Isa>& activeIsaStorage() {
+    static std::atomic<Isa> isa{detectIsa()};
+    return isa;
+}
+
+template<typename T>
+void requireSameSize(std::span<const T> reference, std::size_t size) {
+    if (reference.size() != size) {
+        throw std::invalid_argument("Batch kernel spans must have equal sizes");
+    }
+}
+
+} // namespace detail
+
+// Instruction set used by the batch overloads
+inline Isa activeIsa() {
+    return detail::activeIsaStorage().load(std::memory_order_relaxed);
+}
+
+// Restrict dispatch to `isa` or narrower (never wider than the CPU supports).
+// Meant for testing and benchmarking each kernel on the same machine.
+inline void limitIsa(Isa isa) {
+    Isa detected = detectIsa();
+    detail::activeIsaStorage().store(isa < detected ? isa : detected, std::memory_order_relaxed);
+}
+
+namespace detail {
+
+/*********************************J2 gravity***************************************/
+
+inline void j2Scalar(const double* x, const double* y, const double* z,
+                     double* ax, double* ay, double* az, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        auto a = J2::calculateGravitationalAcceleration(x[i], y[i], z[i]);
+        ax[i] = a[0];
+        ay[i] = a[1];
+        az[i] = a[2];
+    }
+}
+
+#ifdef BATCH_KERNELS_X86
+
+BATCH_TARGET_SSE2 inline void j2Sse2(const double* x, const double* y, const double* z,
+                                     double* ax, double* ay, double* az, std::size_t n) {
+    const __m128d gm = _mm_set1_pd(J2::GM);
+    const __m128d kJ2 = _mm_set1_pd(1.5 * J2::J2 * J2::Re * J2::Re);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d three = _mm_set1_pd(3.0);
+    const __m128d five = _mm_set1_pd(5.0);
+    const __m128d sign = _mm_set1_pd(-0.0);
+
+    const std::size_t whole = n - n % 2; // end of the full vectors, so the scalar tail is provably short
+    std::size_t i = 0;
+    for (; i < whole; i += 2) {
+        __m128d vx = _mm_loadu_pd(x + i);
+        __m128d vy = _mm_loadu_pd(y + i);
+        __m128d vz = _mm_loadu_pd(z + i);
+
+        __m128d r2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy)), _mm_mul_pd(vz, vz));
+        __m128d r = _mm_sqrt_pd(r2);
+        __m128d r3 = _mm_mul_pd(r2, r);
+        __m128d factor = _mm_xor_pd(_mm_div_pd(gm, r3), sign);
+        __m128d factorJ2 = _mm_div_pd(kJ2, r2);
+        __m128d zz = _mm_div_pd(_mm_mul_pd(_mm_mul_pd(five, vz), vz), r2);
+
+        __m128d cxy = _mm_sub_pd(one, _mm_mul_pd(factorJ2, _mm_sub_pd(zz, one)));
+        __m128d cz = _mm_sub_pd(one, _mm_mul_pd(factorJ2, _mm_sub_pd(zz, three)));
+
+        _mm_storeu_pd(ax + i, _mm_mul_pd(_mm_mul_pd(factor, vx), cxy));
+        _mm_storeu_pd(ay + i, _mm_mul_pd(_mm_mul_pd(factor, vy), cxy));
+        _mm_storeu_pd(az + i, _mm_mul_pd(_mm_mul_pd(factor, vz), cz));
+    }
+    j2Scalar(x, y, z, ax, ay, az, i, n);
+}
+
+BATCH_TARGET_AVX2 inline void j2Avx2(const double* x, const double* y, const double* z,
+                                     double* ax, double* ay, double* az, std::size_t n) {
+    const __m256d gm = _mm256_set1_pd(J2::GM);
+    const __m256d kJ2 = _mm256_set1_pd(1.5 * J2::J2 * J2::Re * J2::Re);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d three = _mm256_set1_pd(3.0);
+    const __m256d five = _mm256_set1_pd(5.0);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+
+    const std::size_t whole = n - n % 4;
+    std::size_t i = 0;
+    for (; i < whole; i += 4) {
+        __m256d vx = _mm256_loadu_pd(x + i);
+        __m256d vy = _mm256_loadu_pd(y + i);
+        __m256d vz = _mm256_loadu_pd(z + i);
+
+        __m256d r2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy)), _mm256_mul_pd(vz, vz));
+        __m256d r = _mm256_sqrt_pd(r2);
+        __m256d r3 = _mm256_mul_pd(r2, r);
+        __m256d factor = _mm256_xor_pd(_mm256_div_pd(gm, r3), sign);
+        __m256d factorJ2 = _mm256_div_pd(kJ2, r2);
+        __m256d zz = _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(five, vz), vz), r2);
+
+        __m256d cxy = _mm256_sub_pd(one, _mm256_mul_pd(factorJ2, _mm256_sub_pd(zz, one)));
+        __m256d cz = _mm256_sub_pd(one, _mm256_mul_pd(factorJ2, _mm256_sub_pd(zz, three)));
+
+        _mm256_storeu_pd(ax + i, _mm256_mul_pd(_mm256_mul_pd(factor, vx), cxy));
+        _mm256_storeu_pd(ay + i, _mm256_mul_pd(_mm256_mul_pd(factor, vy), cxy));
+        _mm256_storeu_pd(az + i, _mm256_mul_pd(_mm256_mul_pd(factor, vz), cz));
+    }
+    j2Scalar(x, y, z, ax, ay, az, i, n);
+}
+
+// GCC 12 inlines the unmasked AVX-512 intrinsics (sqrt, permutexvar, roundscale, ...) as
+// masked builtins merging into _mm512_undefined_*(), and then reports that pass-through as
+// -Wmaybe-uninitialized; every lane is overwritten, so the warning is silenced locally.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+BATCH_TARGET_AVX512 inline void j2Avx512(const double* x, const double* y, const double* z,
+                                         double* ax, double* ay, double* az, std::size_t n) {
+    const __m512d gm = _mm512_set1_pd(J2::GM);
+    const __m512d kJ2 = _mm512_set1_pd(1.5 * J2::J2 * J2::Re * J2::Re);
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d three = _mm512_set1_pd(3.0);
+    const __m512d five = _mm512_set1_pd(5.0);
+    const __m512d zero = _mm512_setzero_pd();
+
+    const std::size_t whole = n - n % 8;
+    std::size_t i = 0;
+    for (; i < whole; i += 8) {
+        __m512d vx = _mm512_loadu_pd(x + i);
+        __m512d vy = _mm512_loadu_pd(y + i);
+        __m512d vz = _mm512_loadu_pd(z + i);
+
+        __m512d r2 = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(vx, vx), _mm512_mul_pd(vy, vy)), _mm512_mul_pd(vz, vz));
+        __m512d r = _mm512_sqrt_pd(r2);
+        __m512d r3 = _mm512_mul_pd(r2, r);
+        __m512d factor = _mm512_sub_pd(zero, _mm512_div_pd(gm, r3));
+        __m512d factorJ2 = _mm512_div_pd(kJ2, r2);
+        __m512d zz = _mm512_div_pd(_mm512_mul_pd(_mm512_mul_pd(five, vz), vz), r2);
+
+        __m512d cxy = _mm512_sub_pd(one, _mm512_mul_pd(factorJ2, _mm512_sub_pd(zz, one)));
+        __m512d cz = _mm512_sub_pd(one, _mm512_mul_pd(factorJ2, _mm512_sub_pd(zz, three)));
+
+        _mm512_storeu_pd(ax + i, _mm512_mul_pd(_mm512_mul_pd(factor, vx), cxy));
+        _mm512_storeu_pd(ay + i, _mm512_mul_pd(_mm512_mul_pd(factor, vy), cxy));
+        _mm512_storeu_pd(az + i, _mm512_mul_pd(_mm512_mul_pd(factor, vz), cz));
+    }
+    j2Scalar(x, y, z, ax, ay, az, i, n);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // BATCH_KERNELS_X86
+
+/*********************************ECEF to ECI rotation*****************************/
+
+inline void rotateScalar(double c, double s, const double* x, const double* y, const double* z,
+                         double* xo, double* yo, double* zo, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        double xi = x[i];
+        double yi = y[i];
+        xo[i] =  c * xi + s * yi;
+        yo[i] = -s * xi + c * yi;
+        zo[i] = z[i];
+    }
+}
+
+#ifdef BATCH_KERNELS_X86
+
+BATCH_TARGET_SSE2 inline void rotateSse2(double c, double s, const double* x, const double* y, const double* z,
+                                         double* xo, double* yo, double* zo, std::size_t n) {
+    const __m128d vc = _mm_set1_pd(c);
+    const __m128d vs = _mm_set1_pd(s);
+    const __m128d vns = _mm_set1_pd(-s);
+
+    const std::size_t whole = n - n % 2;
+    std::size_t i = 0;
+    for (; i < whole; i += 2) {
+        __m128d vx = _mm_loadu_pd(x + i);
+        __m128d vy = _mm_loadu_pd(y + i);
+        _mm_storeu_pd(xo + i, _mm_add_pd(_mm_mul_pd(vc, vx), _mm_mul_pd(vs, vy)));
+        _mm_storeu_pd(yo + i, _mm_add_pd(_mm_mul_pd(vns, vx), _mm_mul_pd(vc, vy)));
+        _mm_storeu_pd(zo + i, _mm_loadu_pd(z + i));
+    }
+    rotateScalar(c, s, x, y, z, xo, yo, zo, i, n);
+}
+
+BATCH_TARGET_AVX2 inline void rotateAvx2(double c, double s, const double* x, const double* y, const double* z,
+                                         double* xo, double* yo, double* zo, std::size_t n) {
+    const __m256d vc = _mm256_set1_pd(c);
+    const __m256d vs = _mm256_set1_pd(s);
+    const __m256d vns = _mm256_set1_pd(-s);
+
+    const std::size_t whole = n - n % 4;
+    std::size_t i = 0;
+    for (; i < whole; i += 4) {
+        __m256d vx = _mm256_loadu_pd(x + i);
+        __m256d vy = _mm256_loadu_pd(y + i);
+        _mm256_storeu_pd(xo + i, _mm256_add_pd(_mm256_mul_pd(vc, vx), _mm256_mul_pd(vs, vy)));
+        _mm256_storeu_pd(yo + i, _mm256_add_pd(_mm256_mul_pd(vns, vx), _mm256_mul_pd(vc, vy)));
+        _mm256_storeu_pd(zo + i, _mm256_loadu_pd(z + i));
+    }
+    rotateScalar(c, s, x, y, z, xo, yo, zo, i, n);
+}
+
+BATCH_TARGET_AVX512 inline void rotateAvx512(double c, double s, const double* x, const double* y, const double* z,
+                                             double* xo, double* yo, double* zo, std::size_t n) {
+    const __m512d vc = _mm512_set1_pd(c);
+    const __m512d vs = _mm512_set1_pd(s);
+    const __m512d vns = _mm512_set1_pd(-s);
+
+    const std::size_t whole = n - n % 8;
+    std::size_t i = 0;
+    for (; i < whole; i += 8) {
+        __m512d vx = _mm512_loadu_pd(x + i);
+        __m512d vy = _mm512_loadu_pd(y + i);
+        _mm512_storeu_pd(xo + i, _mm512_add_pd(_mm512_mul_pd(vc, vx), _mm512_mul_pd(vs, vy)));
+        _mm512_storeu_pd(yo + i, _mm512_add_pd(_mm512_mul_pd(vns, vx), _mm512_mul_pd(vc, vy)));
+        _mm512_storeu_pd(zo + i, _mm512_loadu_pd(z + i));
+    }
+    rotateScalar(c, s, x, y, z, xo, yo, zo, i, n);
+}
+
+#endif // BATCH_KERNELS_X86
+
+/*********************************US1976 temperature*******************************/
+
+inline void temperatureScalar(const double* h, double* t, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        t[i] = US1976::Temperature(h[i]);
+    }
+}
+
+#ifdef BATCH_KERNELS_X86
+
+BATCH_TARGET_SSE2 inline void temperatureSse2(const double* h, double* t, std::size_t n) {
+    const std::size_t whole = n - n % 2;
+    std::size_t i = 0;
+    for (; i < whole; i += 2) {
+        __m128d vh = _mm_loadu_pd(h + i);
+        __m128d result = _mm_set1_pd(std::numeric_limits<double>::quiet_NaN());
+        __m128d found = _mm_setzero_pd();
+        for (const auto& layer : US1976::layers) {
+            __m128d lo = _mm_set1_pd(layer.altitude_min);
+            __m128d inside = _mm_and_pd(_mm_cmpge_pd(vh, lo), _mm_cmple_pd(vh, _mm_set1_pd(layer.altitude_max)));
+            __m128d take = _mm_andnot_pd(found, inside);
+            __m128d value = _mm_add_pd(_mm_set1_pd(layer.temperature_base),
+                                       _mm_mul_pd(_mm_set1_pd(layer.temperature_gradient), _mm_sub_pd(vh, lo)));
+            result = _mm_or_pd(_mm_and_pd(take, value), _mm_andnot_pd(take, result));
+            found = _mm_or_pd(found, inside);
+        }
+        _mm_storeu_pd(t + i, result);
+    }
+    temperatureScalar(h, t, i, n);
+}
+
+BATCH_TARGET_AVX2 inline void temperatureAvx2(const double* h, double* t, std::size_t n) {
+    const std::size_t whole = n - n % 4;
+    std::size_t i = 0;
+    for (; i < whole; i += 4) {
+        __m256d vh = _mm256_loadu_pd(h + i);
+        __m256d result = _mm256_set1_pd(std::numeric_limits<double>::quiet_NaN());
+        __m256d found = _mm256_setzero_pd();
+        for (const auto& layer : US1976::layers) {
+            __m256d lo = _mm256_set1_pd(layer.altitude_min);
+            __m256d inside = _mm256_and_pd(_mm256_cmp_pd(vh, lo, _CMP_GE_OQ),
+                                           _mm256_cmp_pd(vh, _mm256_set1_pd(layer.altitude_max), _CMP_LE_OQ));
+            __m256d take = _mm256_andnot_pd(found, inside);
+            __m256d value = _mm256_add_pd(_mm256_set1_pd(layer.temperature_base),
+                                          _mm256_mul_pd(_mm256_set1_pd(layer.temperature_gradient), _mm256_sub_pd(vh, lo)));
+            result = _mm256_blendv_pd(result, value, take);
+            found = _mm256_or_pd(found, inside);
+        }
+        _mm256_storeu_pd(t + i, result);
+    }
+    temperatureScalar(h, t, i, n);
+}
+
+BATCH_TARGET_AVX512 inline void temperatureAvx512(const double* h, double* t, std::size_t n) {
+    const std::size_t whole = n - n % 8;
+    std::size_t i = 0;
+    for (; i < whole; i += 8) {
+        __m512d vh = _mm512_loadu_pd(h + i);
+        __m512d result = _mm512_set1_pd(std::numeric_limits<double>::quiet_NaN());
+        __mmask8 found = 0;
+        for (const auto& layer : US1976::layers) {
+            __m512d lo = _mm512_set1_pd(layer.altitude_min);
+            __mmask8 inside = _mm512_cmp_pd_mask(vh, lo, _CMP_GE_OQ) &
+                              _mm512_cmp_pd_mask(vh, _mm512_set1_pd(layer.altitude_max), _CMP_LE_OQ);
+            __m512d value = _mm512_add_pd(_mm512_set1_pd(layer.temperature_base),
+                                          _mm512_mul_pd(_mm512_set1_pd(layer.temperature_gradient), _mm512_sub_pd(vh, lo)));
+            result = _mm512_mask_blend_pd(static_cast<__mmask8>(inside & ~found), result, value);
+            found = static_cast<__mmask8>(found | inside);
+        }
+        _mm512_storeu_pd(t + i, result);
+    }
+    temperatureScalar(h, t, i, n);
+}
+
+#endif // BATCH_KERNELS_X86
+
+inline void temperature(const double* h, double* t, std::size_t n) {
+    switch (activeIsa()) {
+#ifdef BATCH_KERNELS_X86
+        case Isa::AVX512: temperatureAvx512(h, t, n); return;
+        case Isa::AVX2:   temperatureAvx2(h, t, n);   return;
+        case Isa::SSE2:   temperatureSse2(h, t, n);   return;
+#endif
+        default:          temperatureScalar(h, t, 0, n);
+    }
+}
+
+/*********************************US1976 density in single precision**************/
+
+// The density of a layer in closed form, rho = rho_b exp(a ln(T/T_b) + b (h - h_b)), with
+// a = g0/(R L) - 1 for gradient layers and b = -g0/(R T_b) for isothermal ones: the same
+// model as US1976::Density, with the layer picked by index from a table and with series
+// for ln and exp in place of libm, so that the kernels need no calls. In the table
+// ln(T/T_b) = 2 atanh(t), t = L (h - h_b) / (2 T_b + L (h - h_b)), stays below |t| = 0.15,
+// where the series to t^9 is exact in float, and the exponent within [-3, 2].
+// Per layer constants, padded to the sixteen lanes of an AVX-512 permute
+struct DensityTable {
+    std::array<float, 16> altitudeMin{};
+    std::array<float, 16> temperatureBase{};
+    std::array<float, 16> gradient{};
+    std::array<float, 16> densityBase{};
+    std::array<float, 16> logFactor{};
+    std::array<float, 16> linearFactor{};
+};
+
+constexpr DensityTable makeDensityTable() {
+    DensityTable table;
+    for (std::size_t i = 0; i < US1976::layers.size(); ++i) {
+        const auto& layer = US1976::layers[i];
+        const bool isothermal = layer.temperature_gradient == 0.0;
+        table.altitudeMin[i] = static_cast<float>(layer.altitude_min);
+        table.temperatureBase[i] = static_cast<float>(layer.temperature_base);
+        table.gradient[i] = static_cast<float>(layer.temperature_gradient);
+        table.densityBase[i] = static_cast<float>(layer.pressure_base / (US1976::R * layer.temperature_base));
+        table.logFactor[i] = isothermal ? 0.0f : static_cast<float>(2.0 * (US1976::g0 / (US1976::R * layer.temperature_gradient) - 1.0));
+        table.linearFactor[i] = isothermal ? static_cast<float>(-US1976::g0 / (US1976::R * layer.temperature_base)) : 0.0f;
+    }
+    return table;
+}
+
+inline constexpr DensityTable densityTable = makeDensityTable();
+
+// Series coefficients: 1/(2k+1) for atanh, 1/k! for exp, ln 2 split for the reduction
+constexpr float Atanh3 = 1.0f / 3.0f, Atanh5 = 1.0f / 5.0f, Atanh7 = 1.0f / 7.0f, Atanh9 = 1.0f / 9.0f;
+constexpr float Exp2 = 1.0f / 2.0f, Exp3 = 1.0f / 6.0f, Exp4 = 1.0f / 24.0f, Exp5 = 1.0f / 120.0f,
+                Exp6 = 1.0f / 720.0f, Exp7 = 1.0f / 5040.0f;
+constexpr float Log2e = 1.44269504f, Ln2High = 0.693359375f, Ln2Low = -2.12194440e-4f;
+
+inline float densityFloat(float h) {
+    const float top = static_cast<float>(US1976::layers.back().altitude_max);
+    if (!(h >= 0.0f && h <= top)) return std::numeric_limits<float>::quiet_NaN();
+
+    int k = 0;
+    for (std::size_t i = 1; i < US1976::layers.size(); ++i) k += h > densityTable.altitudeMin[i];
+
+    const float d = h - densityTable.altitudeMin[k];
+    const float dT = densityTable.gradient[k] * d;
+    const float t = dT / (densityTable.temperatureBase[k] + densityTable.temperatureBase[k] + dT);
+    const float t2 = t * t;
+    const float series = t * (1.0f + t2 * (Atanh3 + t2 * (Atanh5 + t2 * (Atanh7 + t2 * Atanh9))));
+    const float e = densityTable.logFactor[k] * series + densityTable.linearFactor[k] * d;
+
+    const float n = std::nearbyint(e * Log2e);
+    const float r = (e - n * Ln2High) - n * Ln2Low;
+    const float p = 1.0f + r * (1.0f + r * (Exp2 + r * (Exp3 + r * (Exp4 + r * (Exp5 + r * (Exp6 + r * Exp7))))));
+    const float scale = std::bit_cast<float>((static_cast<std::int32_t>(n) + 127) << 23);
+    return densityTable.densityBase[k] * (p * scale);
+}
+
+inline void densityFloatScalar(const float* h, float* rho, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        rho[i] = densityFloat(h[i]);
+    }
+}
+
+#ifdef BATCH_KERNELS_X86
+
+BATCH_TARGET_AVX2 inline void densityFloatAvx2(const float* h, float* rho, std::size_t n) {
+    const __m256 altitudeMin = _mm256_loadu_ps(densityTable.altitudeMin.data());
+    const __m256 temperatureBase = _mm256_loadu_ps(densityTable.temperatureBase.data());
+    const __m256 gradient = _mm256_loadu_ps(densityTable.gradient.data());
+    const __m256 densityBase = _mm256_loadu_ps(densityTable.densityBase.data());
+    const __m256 logFactor = _mm256_loadu_ps(densityTable.logFactor.data());
+    const __m256 linearFactor = _mm256_loadu_ps(densityTable.linearFactor.data());
+    const __m256 top = _mm256_set1_ps(static_cast<float>(US1976::layers.back().altitude_max));
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 nan = _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN());
+
+    const std::size_t whole = n - n % 8;
+    std::size_t i = 0;
+    for (; i < whole; i += 8) {
+        __m256 vh = _mm256_loadu_ps(h + i);
+        __m256 inside = _mm256_and_ps(_mm256_cmp_ps(vh, _mm256_setzero_ps(), _CMP_GE_OQ), _mm256_cmp_ps(vh, top, _CMP_LE_OQ));
+
+        __m256i k = _mm256_setzero_si256();
+        for (std::size_t j = 1; j < US1976::layers.size(); ++j) {
+            __m256 above = _mm256_cmp_ps(vh, _mm256_set1_ps(densityTable.altitudeMin[j]), _CMP_GT_OQ);
+            k = _mm256_sub_epi32(k, _mm256_castps_si256(above));
+        }
+
+        __m256 tb = _mm256_permutevar8x32_ps(temperatureBase, k);
+        __m256 d = _mm256_sub_ps(vh, _mm256_permutevar8x32_ps(altitudeMin, k));
+        __m256 dT = _mm256_mul_ps(_mm256_permutevar8x32_ps(gradient, k), d);
+        __m256 t = _mm256_div_ps(dT, _mm256_add_ps(_mm256_add_ps(tb, tb), dT));
+        __m256 t2 = _mm256_mul_ps(t, t);
+        __m256 series = _mm256_add_ps(_mm256_set1_ps(Atanh7), _mm256_mul_ps(t2, _mm256_set1_ps(Atanh9)));
+        series = _mm256_add_ps(_mm256_set1_ps(Atanh5), _mm256_mul_ps(t2, series));
+        series = _mm256_add_ps(_mm256_set1_ps(Atanh3), _mm256_mul_ps(t2, series));
+        series = _mm256_mul_ps(t, _mm256_add_ps(one, _mm256_mul_ps(t2, series)));
+        __m256 e = _mm256_add_ps(_mm256_mul_ps(_mm256_permutevar8x32_ps(logFactor, k), series),
+                                 _mm256_mul_ps(_mm256_permutevar8x32_ps(linearFactor, k), d));
+
+        __m256 m = _mm256_round_ps(_mm256_mul_ps(e, _mm256_set1_ps(Log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256 r = _mm256_sub_ps(_mm256_sub_ps(e, _mm256_mul_ps(m, _mm256_set1_ps(Ln2High))), _mm256_mul_ps(m, _mm256_set1_ps(Ln2Low)));
+        __m256 p = _mm256_add_ps(_mm256_set1_ps(Exp6), _mm256_mul_ps(r, _mm256_set1_ps(Exp7)));
+        p = _mm256_add_ps(_mm256_set1_ps(Exp5), _mm256_mul_ps(r, p));
+        p = _mm256_add_ps(_mm256_set1_ps(Exp4), _mm256_mul_ps(r, p));
+        p = _mm256_add_ps(_mm256_set1_ps(Exp3), _mm256_mul_ps(r, p));
+        p = _mm256_add_ps(_mm256_set1_ps(Exp2), _mm256_mul_ps(r, p));
+        p = _mm256_add_ps(one, _mm256_mul_ps(r, p));
+        p = _mm256_add_ps(one, _mm256_mul_ps(r, p));
+        __m256 scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(m), _mm256_set1_epi32(127)), 23));
+
+        __m256 result = _mm256_mul_ps(_mm256_permutevar8x32_ps(densityBase, k), _mm256_mul_ps(p, scale));
+        _mm256_storeu_ps(rho + i, _mm256_blendv_ps(nan, result, inside));
+    }
+    densityFloatScalar(h, rho, i, n);
+}
+
+// See j2Avx512 for the -Wmaybe-uninitialized suppression
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+BATCH_TARGET_AVX512 inline void densityFloatAvx512(const float* h, float* rho, std::size_t n) {
+    const __m512 altitudeMin = _mm512_loadu_ps(densityTable.altitudeMin.data());
+    const __m512 temperatureBase = _mm512_loadu_ps(densityTable.temperatureBase.data());
+    const __m512 gradient = _mm512_loadu_ps(densityTable.gradient.data());
+    const __m512 densityBase = _mm512_loadu_ps(densityTable.densityBase.data());
+    const __m512 logFactor = _mm512_loadu_ps(densityTable.logFactor.data());
+    const __m512 linearFactor = _mm512_loadu_ps(densityTable.linearFactor.data());
+    const __m512 top = _mm512_set1_ps(static_cast<float>(US1976::layers.back().altitude_max));
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 nan = _mm512_set1_ps(std::numeric_limits<float>::quiet_NaN());
+    const __m512i step = _mm512_set1_epi32(1);
+
+    const std::size_t whole = n - n % 16;
+    std::size_t i = 0;
+    for (; i < whole; i += 16) {
+        __m512 vh = _mm512_loadu_ps(h + i);
+        __mmask16 inside = _mm512_cmp_ps_mask(vh, _mm512_setzero_ps(), _CMP_GE_OQ) & _mm512_cmp_ps_mask(vh, top, _CMP_LE_OQ);
+
+        __m512i k = _mm512_setzero_si512();
+        for (std::size_t j = 1; j < US1976::layers.size(); ++j) {
+            __mmask16 above = _mm512_cmp_ps_mask(vh, _mm512_set1_ps(densityTable.altitudeMin[j]), _CMP_GT_OQ);
+            k = _mm512_mask_add_epi32(k, above, k, step);
+        }
+
+        __m512 tb = _mm512_permutexvar_ps(k, temperatureBase);
+        __m512 d = _mm512_sub_ps(vh, _mm512_permutexvar_ps(k, altitudeMin));
+        __m512 dT = _mm512_mul_ps(_mm512_permutexvar_ps(k, gradient), d);
+        __m512 t = _mm512_div_ps(dT, _mm512_add_ps(_mm512_add_ps(tb, tb), dT));
+        __m512 t2 = _mm512_mul_ps(t, t);
+        __m512 series = _mm512_add_ps(_mm512_set1_ps(Atanh7), _mm512_mul_ps(t2, _mm512_set1_ps(Atanh9)));
+        series = _mm512_add_ps(_mm512_set1_ps(Atanh5), _mm512_mul_ps(t2, series));
+        series = _mm512_add_ps(_mm512_set1_ps(Atanh3), _mm512_mul_ps(t2, series));
+        series = _mm512_mul_ps(t, _mm512_add_ps(one, _mm512_mul_ps(t2, series)));
+        __m512 e = _mm512_add_ps(_mm512_mul_ps(_mm512_permutexvar_ps(k, logFactor), series),
+                                 _mm512_mul_ps(_mm512_permutexvar_ps(k, linearFactor), d));
+
+        __m512 m = _mm512_roundscale_ps(_mm512_mul_ps(e, _mm512_set1_ps(Log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m512 r = _mm512_sub_ps(_mm512_sub_ps(e, _mm512_mul_ps(m, _mm512_set1_ps(Ln2High))), _mm512_mul_ps(m, _mm512_set1_ps(Ln2Low)));
+        __m512 p = _mm512_add_ps(_mm512_set1_ps(Exp6), _mm512_mul_ps(r, _mm512_set1_ps(Exp7)));
+        p = _mm512_add_ps(_mm512_set1_ps(Exp5), _mm512_mul_ps(r, p));
+        p = _mm512_add_ps(_mm512_set1_ps(Exp4), _mm512_mul_ps(r, p));
+        p = _mm512_add_ps(_mm512_set1_ps(Exp3), _mm512_mul_ps(r, p));
+        p = _mm512_add_ps(_mm512_set1_ps(Exp2), _mm512_mul_ps(r, p));
+        p = _mm512_add_ps(one, _mm512_mul_ps(r, p));
+        p = _mm512_add_ps(one, _mm512_mul_ps(r, p));
+        __m512 scale = _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(m), _mm512_set1_epi32(127)), 23));
+
+        __m512 result = _mm512_mul_ps(_mm512_permutexvar_ps(k, densityBase), _mm512_mul_ps(p, scale));
+        _mm512_storeu_ps(rho + i, _mm512_mask_blend_ps(inside, nan, result));
+    }
+    densityFloatScalar(h, rho, i, n);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // BATCH_KERNELS_X86
+
+// Pressure from an already evaluated temperature; mirrors US1976::Pressure term by term
+inline double pressureFromTemperature(double altitude, double temperature) {
+    for (const auto& layer : US1976::layers) {
+        if (altitude >= layer.altitude_min && altitude <= layer.altitude_max) {
+            if (layer.temperature_gradient != 0) {
+                return layer.pressure_base * std::pow((temperature / layer.temperature_base),
+                                                      (US1976::g0 / (US1976::R * layer.temperature_gradient)));
+            } else {
+                return layer.pressure_base * std::exp(-US1976::g0 * (altitude - layer.altitude_min) /
+                                                      (US1976::R * layer.temperature_base));
+            }
+        }
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+} // namespace detail
+} // namespace Simd
+
+namespace US1976 {
+
+// Batch temperature [K] for altitudes [m]
+inline void Temperature(std::span<const double> altitude, std::span<double> temperature) {
+    Simd::detail::requireSameSize(altitude, temperature.size());
+    Simd::detail::temperature(altitude.data(), temperature.data(), altitude.size());
+}
+
+// Batch pressure [Pa] for altitudes [m]
+inline void Pressure(std::span<const double> altitude, std::span<double> pressure) {
+    Simd::detail::requireSameSize(altitude, pressure.size());
+    Simd::detail::temperature(altitude.data(), pressure.data(), altitude.size());
+    for (std::size_t i = 0; i < altitude.size(); ++i) {
+        pressure[i] = Simd::detail::pressureFromTemperature(altitude[i], pressure[i]);
+    }
+}
+
+// Batch density [kg/m^3] for altitudes [m]
+inline void Density(std::span<const double> altitude, std::span<double> density) {
+    Simd::detail::requireSameSize(altitude, density.size());
+    Simd::detail::temperature(altitude.data(), density.data(), altitude.size());
+    for (std::size_t i = 0; i < altitude.size(); ++i) {
+        double Te = density[i];
+        double P = Simd::detail::pressureFromTemperature(altitude[i], Te);
+        density[i] = P / (R * Te);
+    }
+}
+
+// Batch density [kg/m^3] in single precision, from the closed form of the layers above;
+// SSE2 has no per lane permute and takes the scalar form
+inline void Density(std::span<const float> altitude, std::span<float> density) {
+    Simd::detail::requireSameSize(altitude, density.size());
+    switch (Simd::activeIsa()) {
+#ifdef BATCH_KERNELS_X86
+        case Simd::Isa::AVX512: Simd::detail::densityFloatAvx512(altitude.data(), density.data(), altitude.size()); return;
+        case Simd::Isa::AVX2:   Simd::detail::densityFloatAvx2(altitude.data(), density.data(), altitude.size());   return;
+#endif
+        default:                Simd::detail::densityFloatScalar(altitude.data(), density.data(), 0, altitude.size());
+    }
+}
+
+} // namespace US1976
+
+namespace J2 {
+
+// Batch J2 gravitational acceleration for structure-of-arrays positions [m]
+inline void calculateGravitationalAcceleration(std::span<const double> x, std::span<const double> y, std::span<const double> z,
+                                               std::span<double> ax, std::span<double> ay, std::span<double> az) {
+    const std::size_t n = x.size();
+    Simd::detail::requireSameSize(y, n);
+    Simd::detail::requireSameSize(z, n);
+    Simd::detail::requireSameSize(x, ax.size());
+    Simd::detail::requireSameSize(x, ay.size());
+    Simd::detail::requireSameSize(x, az.size());
+
+    switch (Simd::activeIsa()) {
+#ifdef BATCH_KERNELS_X86
+        case Simd::Isa::AVX512: Simd::detail::j2Avx512(x.data(), y.data(), z.data(), ax.data(), ay.data(), az.data(), n); return;
+        case Simd::Isa::AVX2:   Simd::detail::j2Avx2(x.data(), y.data(), z.data(), ax.data(), ay.data(), az.data(), n);   return;
+        case Simd::Isa::SSE2:   Simd::detail::j2Sse2(x.data(), y.data(), z.data(), ax.data(), ay.data(), az.data(), n);   return;
+#endif
+        default:                Simd::detail::j2Scalar(x.data(), y.data(), z.data(), ax.data(), ay.data(), az.data(), 0, n);
+    }
+}
+
+} // namespace J2
+
+namespace Coordinate {
+
+// Batch ECEF to ECI rotation of many points at one epoch
+inline void ecefToEci(std::span<const double> x, std::span<const double> y, std::span<const double> z, double time_since_epoch,
+                      std::span<double> x_eci, std::span<double> y_eci, std::span<double> z_eci) {
+    const std::size_t n = x.size();
+    Simd::detail::requireSameSize(y, n);
+    Simd::detail::requireSameSize(z, n);
+    Simd::detail::requireSameSize(x, x_eci.size());
+    Simd::detail::requireSameSize(x, y_eci.size());
+    Simd::detail::requireSameSize(x, z_eci.size());
+
+    // The kernels apply [c s; -s c], so pass -sin(theta) for r_eci = R_z(-theta) r_ecef
+    double theta = EARTH_ROTATION_RATE * time_since_epoch;
+    double c = std::cos(theta);
+    double s = -std::sin(theta);
+
+    switch (Simd::activeIsa()) {
+#ifdef BATCH_KERNELS_X86
+        case Simd::Isa::AVX512: Simd::detail::rotateAvx512(c, s, x.data(), y.data(), z.data(), x_eci.data(), y_eci.data(), z_eci.data(), n); return;
+        case Simd::Isa::AVX2:   Simd::detail::rotateAvx2(c, s, x.data(), y.data(), z.data(), x_eci.data(), y_eci.data(), z_eci.data(), n);   return;
+        case Simd::Isa::SSE2:   Simd::detail::rotateSse2(c, s, x.data(), y.data(), z.data(), x_eci.data(), y_eci.data(), z_eci.data(), n);   return;
+#endif
+        default:                Simd::detail::rotateScalar(c, s, x.data(), y.data(), z.data(), x_eci.data(), y_eci.data(), z_eci.data(), 0, n);
+    }
+}
+
+// Batch ECEF to geodetic latitude/longitude [deg] and altitude [m]. The closed form is
+// branch free, but needs cbrt/atan2 from libm, so the loop is left to the compiler.
+inline void ecefToLatLonAlt(std::span<const double> x, std::span<const double> y, std::span<const double> z,
+                            std::span<double> lat, std::span<double> lon, std::span<double> alt) {
+    const std::size_t n = x.size();
+    Simd::detail::requireSameSize(y, n);
+    Simd::detail::requireSameSize(z, n);
+    Simd::detail::requireSameSize(x, lat.size());
+    Simd::detail::requireSameSize(x, lon.size());
+    Simd::detail::requireSameSize(x, alt.size());
+
+    for (std::size_t i = 0; i < n; ++i) {
+        ecefToLatLonAlt(x[i], y[i], z[i], lat[i], lon[i], alt[i]);
+    }
+}
+
+} // namespace Coordinate
+
+#endif // BATCH_KERNELS_H
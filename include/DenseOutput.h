@@ -0,0 +1,128 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [DenseOutput.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Dense output over one integrator step in the form of Hairer's DOPRI5 CONTD5,
+ *
+ *      y(t0 + s h) = r1 + s (r2 + (1 - s) (r3 + s (r4 + (1 - s) r5))),
+ *
+ *  where r1..r4 give the cubic Hermite polynomial through the states and derivatives
+ *  at both ends of the step. r5 is zero for plain Hermite interpolation, whose O(h^4)
+ *  error no tolerance controls, or the correction of a Runge-Kutta continuous
+ *  extension (FixedDoPri54::dense_correction), which turns it into the integrator's
+ *  own fourth order interpolant. derivative() and thirdDerivative() let callers
+ *  estimate the Hermite error and bound the step behind a plain Hermite interpolant.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef DENSE_OUTPUT_H
+#define DENSE_OUTPUT_H
+
+#include <cstddef>
+#include <vector>
+
+namespace Integration {
+
+class HermiteStep {
+
+    public:
+        HermiteStep() = default;
+        explicit HermiteStep(std::size_t n) { resize(n); }
+
+        // Storage is sized once, before stepping starts
+        void resize(std::size_t n) {
+            m_Y0.assign(n, 0.0);
+            m_R2.assign(n, 0.0);
+            m_R3.assign(n, 0.0);
+            m_R4.assign(n, 0.0);
+            m_R5.assign(n, 0.0);
+        }
+
+        std::size_t size() const { return m_Y0.size(); }
+
+        // A zero length step at t holding y; evaluate then returns y
+        void reset(double t, const double* y) {
+            m_T0 = m_T1 = t;
+            for (std::size_t i = 0; i < m_Y0.size(); ++i) {
+                m_Y0[i] = y[i];
+                m_R2[i] = m_R3[i] = m_R4[i] = m_R5[i] = 0.0;
+            }
+        }
+
+        // Step [t0, t1] with the states and derivatives at both ends, and optionally the
+        // fifth coefficient of a continuous extension over the same step
+        void set(double t0, const double* y0, const double* f0, double t1, const double* y1, const double* f1,
+                 const double* correction = nullptr) {
+            m_T0 = t0;
+            m_T1 = t1;
+            const double h = t1 - t0;
+            for (std::size_t i = 0; i < m_Y0.size(); ++i) {
+                m_Y0[i] = y0[i];
+                m_R2[i] = y1[i] - y0[i];
+                m_R3[i] = h * f0[i] - m_R2[i];
+                m_R4[i] = m_R2[i] - h * f1[i] - m_R3[i];
+                m_R5[i] = correction ? correction[i] : 0.0;
+            }
+        }
+
+        double start() const { return m_T0; }
+        double end() const { return m_T1; }
+        const std::vector<double>& startState() const { return m_Y0; }
+
+        // State at t in [start, end]
+        void evaluate(double t, double* y) const {
+            const double h = m_T1 - m_T0;
+            const double s = h > 0.0 ? (t - m_T0) / h : 1.0;
+            const double s1 = 1.0 - s;
+            for (std::size_t i = 0; i < m_Y0.size(); ++i) {
+                y[i] = m_Y0[i] + s * (m_R2[i] + s1 * (m_R3[i] + s * (m_R4[i] + s1 * m_R5[i])));
+            }
+        }
+
+        // Time derivative of the interpolant at t in [start, end]
+        void derivative(double t, double* f) const {
+            const double h = m_T1 - m_T0;
+            const double s = h > 0.0 ? (t - m_T0) / h : 1.0;
+            const double s1 = 1.0 - s;
+            for (std::size_t i = 0; i < m_Y0.size(); ++i) {
+                const double g = m_R3[i] + s * (m_R4[i] + s1 * m_R5[i]);
+                const double dg = m_R4[i] + (s1 - s) * m_R5[i];
+                f[i] = h > 0.0 ? (m_R2[i] + (s1 - s) * g + s * s1 * dg) / h : 0.0;
+            }
+        }
+
+        // Third time derivative of the cubic Hermite part, constant over the step; the
+        // change between consecutive steps estimates y^(4) for the Hermite error bound
+        // h^4 / 384 |y^(4)| without evaluating the model
+        void thirdDerivative(double* out) const {
+            const double h = m_T1 - m_T0;
+            for (std::size_t i = 0; i < m_Y0.size(); ++i) {
+                out[i] = h > 0.0 ? -6.0 * m_R4[i] / (h * h * h) : 0.0;
+            }
+        }
+
+    private:
+        double m_T0 = 0.0;
+        double m_T1 = 0.0;
+        std::vector<double> m_Y0;
+        std::vector<double> m_R2;
+        std::vector<double> m_R3;
+        std::vector<double> m_R4;
+        std::vector<double> m_R5;
+};
+
+} // namespace Integration
+
+#endif // DENSE_OUTPUT_H
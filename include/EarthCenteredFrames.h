@@ -19,10 +19,14 @@
  */
 
  #ifndef EARTH_CENTERED_FRAMES_H
- #define EARTH_CENTETED_FRAMES_H
+ #define EARTH_CENTERED_FRAMES_H
 
+#include <array>
 #include <cmath>
+#include <cstddef>
 #include <iostream>
+#include <span>
+#include <stdexcept>
 
 namespace Coordinate{
 
@@ -30,9 +34,12 @@ constexpr double PI = 3.141592653589793;
 constexpr double DEG_TO_RAD = PI / 180.0;
 constexpr double EARTH_SEMI_MAJOR_AXIS = 6378137.0; // WGS84 (meters)
 constexpr double EARTH_ECCENTRICITY = 0.081819190842622; // WGS84
+constexpr double EARTH_ROTATION_RATE = 7.2921150e-5; // sidereal rate (radians per second)
+
+using Matrix3 = std::array<std::array<double, 3>, 3>;
 
 // Convert latitude, longitude, and altitude to ECEF coordinates
-void latLonAltToEcef(double lat, double lon, double alt, double& x, double& y, double& z) {
+inline void latLonAltToEcef(double lat, double lon, double alt, double& x, double& y, double& z) {
     double lat_rad = lat * DEG_TO_RAD;
     double lon_rad = lon * DEG_TO_RAD;
 
@@ -43,46 +50,247 @@ void latLonAltToEcef(double lat, double lon, double alt, double& x, double& y, d
     z = ((1 - EARTH_ECCENTRICITY * EARTH_ECCENTRICITY) * N + alt) * std::sin(lat_rad);
 }
 
-// Convert ECEF coordinates to ECI coordinates
-std::array<double, 3> ecefToEci(double x, double y, double z, double time_since_epoch) {
+// Convert ECEF coordinates to geodetic latitude, longitude (degrees) and altitude (meters).
+// Closed form of Vermeille (2002), exact for points outside a small region around the
+// Earth's centre (|r| > ~43 km), without iteration.
+inline void ecefToLatLonAlt(double x, double y, double z, double& lat, double& lon, double& alt) {
+    constexpr double a = EARTH_SEMI_MAJOR_AXIS;
+    constexpr double e2 = EARTH_ECCENTRICITY * EARTH_ECCENTRICITY;
+    constexpr double e4 = e2 * e2;
+
+    double rho2 = x * x + y * y;
+    double rho = std::sqrt(rho2);
+    double p = rho2 / (a * a);
+    double q = (1 - e2) * z * z / (a * a);
+    double r = (p + q - e4) / 6;
+    double s = e4 * p * q / (4 * r * r * r);
+    double t = std::cbrt(1 + s + std::sqrt(s * (2 + s)));
+    double u = r * (1 + t + 1 / t);
+    double v = std::sqrt(u * u + e4 * q);
+    double w = e2 * (u + v - q) / (2 * v);
+    double k = std::sqrt(u + v + w * w) - w;
+    double D = k * rho / (k + e2);
+    double Dz = std::sqrt(D * D + z * z);
+
+    lat = 2 * std::atan2(z, D + Dz) / DEG_TO_RAD;
+    lon = std::atan2(y, x) / DEG_TO_RAD;
+    alt = (k + e2 - 1) / k * Dz;
+}
+
+// Rotation matrices from ECEF to the local level frames at a geodetic latitude/longitude (degrees),
+// v_local = R v_ecef. Rows are the local axes expressed in ECEF.
+inline Matrix3 ecefToNed(double lat, double lon) {
+    double sin_lat = std::sin(lat * DEG_TO_RAD);
+    double cos_lat = std::cos(lat * DEG_TO_RAD);
+    double sin_lon = std::sin(lon * DEG_TO_RAD);
+    double cos_lon = std::cos(lon * DEG_TO_RAD);
+    return {{{-sin_lat * cos_lon, -sin_lat * sin_lon,  cos_lat},
+             {-sin_lon,            cos_lon,            0.0},
+             {-cos_lat * cos_lon, -cos_lat * sin_lon, -sin_lat}}};
+}
+
+inline Matrix3 ecefToEnu(double lat, double lon) {
+    Matrix3 ned = ecefToNed(lat, lon);
+    return {{ned[1], ned[0], {-ned[2][0], -ned[2][1], -ned[2][2]}}};
+}
+
+inline Matrix3 ecefToNeu(double lat, double lon) {
+    Matrix3 ned = ecefToNed(lat, lon);
+    return {{ned[0], ned[1], {-ned[2][0], -ned[2][1], -ned[2][2]}}};
+}
+
+// Position of an ECEF point in the NEU frame of an origin given by latitude/longitude (degrees)
+// and altitude (meters), e.g. the neu_Origin_* parameters of the 3DoF model
+inline std::array<double, 3> ecefToNeuPosition(double x, double y, double z, double origin_lat, double origin_lon, double origin_alt) {
+    double ox, oy, oz;
+    latLonAltToEcef(origin_lat, origin_lon, origin_alt, ox, oy, oz);
+    Matrix3 R = ecefToNeu(origin_lat, origin_lon);
+    double dx = x - ox;
+    double dy = y - oy;
+    double dz = z - oz;
+    return {R[0][0] * dx + R[0][1] * dy + R[0][2] * dz,
+            R[1][0] * dx + R[1][1] * dy + R[1][2] * dz,
+            R[2][0] * dx + R[2][1] * dy + R[2][2] * dz};
+}
+
+// Convert ECEF coordinates to ECI coordinates. A rotation about Z by the Earth rotation angle
+// since the epoch only; see EarthOrientation.h for precession, nutation and polar motion.
+inline std::array<double, 3> ecefToEci(double x, double y, double z, double time_since_epoch) {
     // Calculate the Earth's rotation angle in radians
-    double earth_rotation_rate = 2 * PI / 86400.0; // radians per second
-    double theta = earth_rotation_rate * time_since_epoch;
+    double theta = EARTH_ROTATION_RATE * time_since_epoch;
     
     // Rotation matrix components
     double cos_theta = std::cos(theta);
     double sin_theta = std::sin(theta);
     
-    // Perform the rotation
-    double x_eci =  cos_theta * x + sin_theta * y;
-    double y_eci = -sin_theta * x + cos_theta * y;
+    // Perform the rotation, r_eci = R_z(-theta) r_ecef
+    double x_eci = cos_theta * x - sin_theta * y;
+    double y_eci = sin_theta * x + cos_theta * y;
     double z_eci = z; // Z-coordinate is unchanged
 
     return {x_eci, y_eci, z_eci};
 }
 
-std::array<double, 3> ecefToEciVel(double x, double y, double z, double vx, double vy, double vz, double time_since_epoch) {
-    // Earth's rotation rate in radians per second
-    double earth_rotation_rate = 2 * PI / 86400.0; // 7.2921159e-5 rad/s
-    double theta = earth_rotation_rate * time_since_epoch;
+// Convert an ECEF velocity to ECI, v_eci = R_z(-theta) (v_ecef + w x r_ecef)
+inline std::array<double, 3> ecefToEciVel(double x, double y, [[maybe_unused]] double z, double vx, double vy, double vz, double time_since_epoch) {
+    double theta = EARTH_ROTATION_RATE * time_since_epoch;
 
     // Rotation matrix components
     double cos_theta = std::cos(theta);
     double sin_theta = std::sin(theta);
 
-    // Position rotation (already done in your original function)
-    double x_eci =  cos_theta * x + sin_theta * y;
-    double y_eci = -sin_theta * x + cos_theta * y;
-    double z_eci = z; // Z-coordinate is unchanged
+    // Velocity relative to the inertial frame, still in ECEF axes
+    double vx_inertial = vx - EARTH_ROTATION_RATE * y;
+    double vy_inertial = vy + EARTH_ROTATION_RATE * x;
 
-    // Velocity rotation considering Earth's rotation
-    double vx_eci =  cos_theta * vx + sin_theta * vy + earth_rotation_rate * (-sin_theta * x + cos_theta * y);
-    double vy_eci = -sin_theta * vx + cos_theta * vy + earth_rotation_rate * (-cos_theta * x - sin_theta * y);
+    double vx_eci = cos_theta * vx_inertial - sin_theta * vy_inertial;
+    double vy_eci = sin_theta * vx_inertial + cos_theta * vy_inertial;
     double vz_eci = vz; // Z-component of velocity is unchanged
 
     return {vx_eci, vy_eci, vz_eci};
 }
 
+// ECEF <-> ECI transformation for one epoch: the rotation angle and its sine/cosine are
+// computed once and reused for positions, velocities and accelerations of any number of
+// vectors. Stepping by the fixed dt given at construction rotates (cos, sin) by a
+// precomputed increment instead of calling the trig functions again; the pair is pulled
+// back onto the unit circle every RenormaliseInterval steps.
+class EcefEciTransform {
+
+    public:
+        static constexpr int RenormaliseInterval = 64;
+
+        explicit EcefEciTransform(double time_since_epoch, double dt = 0.0, double rotation_rate = EARTH_ROTATION_RATE)
+            : m_Rate(rotation_rate), m_Dt(dt), m_CosStep(std::cos(rotation_rate * dt)), m_SinStep(std::sin(rotation_rate * dt)) {
+            setTime(time_since_epoch);
+        }
+
+        // Jump to an arbitrary epoch with fresh trig calls
+        void setTime(double time_since_epoch) {
+            m_Start = time_since_epoch;
+            m_Cos = std::cos(m_Rate * time_since_epoch);
+            m_Sin = std::sin(m_Rate * time_since_epoch);
+            m_Steps = 0;
+        }
+
+        // Advance by dt with the rotation recurrence
+        void step() {
+            const double c = m_Cos * m_CosStep - m_Sin * m_SinStep;
+            const double s = m_Sin * m_CosStep + m_Cos * m_SinStep;
+            m_Cos = c;
+            m_Sin = s;
+            if (++m_Steps % RenormaliseInterval == 0) {
+                // First order Newton step towards c^2 + s^2 = 1
+                const double k = 0.5 * (3.0 - (c * c + s * s));
+                m_Cos *= k;
+                m_Sin *= k;
+            }
+        }
+
+        double time() const { return m_Start + static_cast<double>(m_Steps) * m_Dt; }
+        double cosAngle() const { return m_Cos; }
+        double sinAngle() const { return m_Sin; }
+        double rotationRate() const { return m_Rate; }
+
+        // r_eci = R_z(-theta) r_ecef
+        std::array<double, 3> toEci(const std::array<double, 3>& r) const {
+            return {m_Cos * r[0] - m_Sin * r[1], m_Sin * r[0] + m_Cos * r[1], r[2]};
+        }
+
+        std::array<double, 3> toEcef(const std::array<double, 3>& r) const {
+            return {m_Cos * r[0] + m_Sin * r[1], -m_Sin * r[0] + m_Cos * r[1], r[2]};
+        }
+
+        // v_eci = R (v_ecef + w x r_ecef)
+        std::array<double, 3> toEciVelocity(const std::array<double, 3>& r_ecef, const std::array<double, 3>& v_ecef) const {
+            return toEci({v_ecef[0] - m_Rate * r_ecef[1], v_ecef[1] + m_Rate * r_ecef[0], v_ecef[2]});
+        }
+
+        // v_ecef = R^T v_eci - w x r_ecef
+        std::array<double, 3> toEcefVelocity(const std::array<double, 3>& r_eci, const std::array<double, 3>& v_eci) const {
+            const auto r = toEcef(r_eci);
+            const auto v = toEcef(v_eci);
+            return {v[0] + m_Rate * r[1], v[1] - m_Rate * r[0], v[2]};
+        }
+
+        // a_eci = R (a_ecef + 2 w x v_ecef + w x (w x r_ecef)), Coriolis and centripetal terms
+        std::array<double, 3> toEciAcceleration(const std::array<double, 3>& r_ecef, const std::array<double, 3>& v_ecef,
+                                                const std::array<double, 3>& a_ecef) const {
+            const double w2 = m_Rate * m_Rate;
+            return toEci({a_ecef[0] - 2.0 * m_Rate * v_ecef[1] - w2 * r_ecef[0],
+                          a_ecef[1] + 2.0 * m_Rate * v_ecef[0] - w2 * r_ecef[1],
+                          a_ecef[2]});
+        }
+
+        // a_ecef = R^T a_eci - 2 w x v_ecef - w x (w x r_ecef), arguments in ECI
+        std::array<double, 3> toEcefAcceleration(const std::array<double, 3>& r_eci, const std::array<double, 3>& v_eci,
+                                                 const std::array<double, 3>& a_eci) const {
+            const double w2 = m_Rate * m_Rate;
+            const auto r = toEcef(r_eci);
+            const auto v = toEcefVelocity(r_eci, v_eci);
+            const auto a = toEcef(a_eci);
+            return {a[0] + 2.0 * m_Rate * v[1] + w2 * r[0], a[1] - 2.0 * m_Rate * v[0] + w2 * r[1], a[2]};
+        }
+
+        // Array forms; input and output may be the same storage
+        void toEci(std::span<const std::array<double, 3>> r, std::span<std::array<double, 3>> out) const {
+            requireSameSize(r.size(), out.size());
+            for (std::size_t i = 0; i < r.size(); ++i) out[i] = toEci(r[i]);
+        }
+
+        void toEcef(std::span<const std::array<double, 3>> r, std::span<std::array<double, 3>> out) const {
+            requireSameSize(r.size(), out.size());
+            for (std::size_t i = 0; i < r.size(); ++i) out[i] = toEcef(r[i]);
+        }
+
+        void toEciVelocity(std::span<const std::array<double, 3>> r_ecef, std::span<const std::array<double, 3>> v_ecef,
+                           std::span<std::array<double, 3>> out) const {
+            requireSameSize(r_ecef.size(), v_ecef.size());
+            requireSameSize(r_ecef.size(), out.size());
+            for (std::size_t i = 0; i < r_ecef.size(); ++i) out[i] = toEciVelocity(r_ecef[i], v_ecef[i]);
+        }
+
+        void toEcefVelocity(std::span<const std::array<double, 3>> r_eci, std::span<const std::array<double, 3>> v_eci,
+                            std::span<std::array<double, 3>> out) const {
+            requireSameSize(r_eci.size(), v_eci.size());
+            requireSameSize(r_eci.size(), out.size());
+            for (std::size_t i = 0; i < r_eci.size(); ++i) out[i] = toEcefVelocity(r_eci[i], v_eci[i]);
+        }
+
+        void toEciAcceleration(std::span<const std::array<double, 3>> r_ecef, std::span<const std::array<double, 3>> v_ecef,
+                               std::span<const std::array<double, 3>> a_ecef, std::span<std::array<double, 3>> out) const {
+            requireSameSize(r_ecef.size(), v_ecef.size());
+            requireSameSize(r_ecef.size(), a_ecef.size());
+            requireSameSize(r_ecef.size(), out.size());
+            for (std::size_t i = 0; i < r_ecef.size(); ++i) out[i] = toEciAcceleration(r_ecef[i], v_ecef[i], a_ecef[i]);
+        }
+
+        void toEcefAcceleration(std::span<const std::array<double, 3>> r_eci, std::span<const std::array<double, 3>> v_eci,
+                                std::span<const std::array<double, 3>> a_eci, std::span<std::array<double, 3>> out) const {
+            requireSameSize(r_eci.size(), v_eci.size());
+            requireSameSize(r_eci.size(), a_eci.size());
+            requireSameSize(r_eci.size(), out.size());
+            for (std::size_t i = 0; i < r_eci.size(); ++i) out[i] = toEcefAcceleration(r_eci[i], v_eci[i], a_eci[i]);
+        }
+
+    private:
+        static void requireSameSize(std::size_t a, std::size_t b) {
+            if (a != b) {
+                throw std::invalid_argument("Frame transform arrays must have the same length");
+            }
+        }
+
+        double m_Rate;
+        double m_Dt;
+        double m_CosStep;
+        double m_SinStep;
+
+        double m_Start = 0.0;
+        double m_Cos = 1.0;
+        double m_Sin = 0.0;
+        long long m_Steps = 0;
+};
+
 }
 
 #endif 
\ No newline at end of file
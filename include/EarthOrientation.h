@@ -0,0 +1,475 @@
+/*
+ * -----------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [EarthOrientation.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Transformation between the Earth fixed (ITRF) and the inertial (GCRF/J2000)
+ *  frames with the IAU 1976 precession, IAU 1980 nutation, Greenwich apparent
+ *  sidereal time and polar motion (IAU-76/FK5 reduction, Vallado 3.7):
+ *
+ *      r_GCRF = P N R W r_ITRF
+ *
+ *  The nutation series is truncated to its 30 largest terms by default (a few
+ *  milliarcseconds); the full 106 term table can be read from a resources file.
+ *  P N, the equation of the equinoxes, W and UT1-TAI change slowly, so they are
+ *  evaluated on a coarse time grid and interpolated; the frame of the last epoch
+ *  is kept with P N R W multiplied out, so repeated calls at one epoch cost one
+ *  matrix product per position. Earth orientation parameters (polar motion,
+ *  UT1-UTC, LOD and the nutation corrections) are read from a resources file; TT
+ *  is taken from UTC with the leap second table of TimeScale::Epoch.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef EARTH_ORIENTATION_H
+#define EARTH_ORIENTATION_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "EarthCenteredFrames.h"
+#include "Epoch.h"
+
+namespace Coordinate {
+
+constexpr double ARCSEC_TO_RAD = DEG_TO_RAD / 3600.0;
+constexpr double SECONDS_PER_DAY = 86400.0;
+constexpr double DAYS_PER_CENTURY = 36525.0;
+constexpr double MJD_J2000 = 51544.5;     // modified Julian date of the J2000 epoch
+
+inline Matrix3 multiply(const Matrix3& a, const Matrix3& b) {
+    Matrix3 c{};
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            c[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+        }
+    }
+    return c;
+}
+
+inline Matrix3 transpose(const Matrix3& a) {
+    return {{{a[0][0], a[1][0], a[2][0]}, {a[0][1], a[1][1], a[2][1]}, {a[0][2], a[1][2], a[2][2]}}};
+}
+
+inline std::array<double, 3> multiply(const Matrix3& a, const std::array<double, 3>& v) {
+    return {a[0][0] * v[0] + a[0][1] * v[1] + a[0][2] * v[2],
+            a[1][0] * v[0] + a[1][1] * v[1] + a[1][2] * v[2],
+            a[2][0] * v[0] + a[2][1] * v[1] + a[2][2] * v[2]};
+}
+
+// Frame (passive) rotations about the x, y and z axes
+inline Matrix3 rotationX(double angle) {
+    const double c = std::cos(angle);
+    const double s = std::sin(angle);
+    return {{{1.0, 0.0, 0.0}, {0.0, c, s}, {0.0, -s, c}}};
+}
+
+inline Matrix3 rotationY(double angle) {
+    const double c = std::cos(angle);
+    const double s = std::sin(angle);
+    return {{{c, 0.0, -s}, {0.0, 1.0, 0.0}, {s, 0.0, c}}};
+}
+
+inline Matrix3 rotationZ(double angle) {
+    const double c = std::cos(angle);
+    const double s = std::sin(angle);
+    return {{{c, s, 0.0}, {-s, c, 0.0}, {0.0, 0.0, 1.0}}};
+}
+
+// IAU 1976 precession, mean of date to J2000, for Julian centuries of TT since J2000
+inline Matrix3 precessionMatrix(double T) {
+    const double zeta = (2306.2181 * T + 0.30188 * T * T + 0.017998 * T * T * T) * ARCSEC_TO_RAD;
+    const double theta = (2004.3109 * T - 0.42665 * T * T - 0.041833 * T * T * T) * ARCSEC_TO_RAD;
+    const double z = (2306.2181 * T + 1.09468 * T * T + 0.018203 * T * T * T) * ARCSEC_TO_RAD;
+    return multiply(multiply(rotationZ(zeta), rotationY(-theta)), rotationZ(z));
+}
+
+// IAU 1980 mean obliquity of the ecliptic [rad]
+inline double meanObliquity(double T) {
+    return (84381.448 - 46.8150 * T - 0.00059 * T * T + 0.001813 * T * T * T) * ARCSEC_TO_RAD;
+}
+
+// One term of the IAU 1980 nutation series: multipliers of the Delaunay arguments
+// (D, M, M', F, Omega) and the longitude/obliquity amplitudes in 0.0001 arcsec (+ rate per century)
+struct NutationTerm {
+    int D, M, Mp, F, Omega;
+    double psi, psiRate, eps, epsRate;
+};
+
+// The 30 largest terms of the IAU 1980 series
+inline const std::vector<NutationTerm>& defaultNutationTerms() {
+    static const std::vector<NutationTerm> terms = {
+        { 0,  0,  0, 0, 1, -171996.0, -174.2, 92025.0,  8.9},
+        {-2,  0,  0, 2, 2,  -13187.0,   -1.6,  5736.0, -3.1},
+        { 0,  0,  0, 2, 2,   -2274.0,   -0.2,   977.0, -0.5},
+        { 0,  0,  0, 0, 2,    2062.0,    0.2,  -895.0,  0.5},
+        { 0,  1,  0, 0, 0,    1426.0,   -3.4,    54.0, -0.1},
+        { 0,  0,  1, 0, 0,     712.0,    0.1,    -7.0,  0.0},
+        {-2,  1,  0, 2, 2,    -517.0,    1.2,   224.0, -0.6},
+        { 0,  0,  0, 2, 1,    -386.0,   -0.4,   200.0,  0.0},
+        { 0,  0,  1, 2, 2,    -301.0,    0.0,   129.0, -0.1},
+        {-2, -1,  0, 2, 2,     217.0,   -0.5,   -95.0,  0.3},
+        {-2,  0,  1, 0, 0,    -158.0,    0.0,     0.0,  0.0},
+        {-2,  0,  0, 2, 1,     129.0,    0.1,   -70.0,  0.0},
+        { 0,  0, -1, 2, 2,     123.0,    0.0,   -53.0,  0.0},
+        { 2,  0,  0, 0, 0,      63.0,    0.0,     0.0,  0.0},
+        { 0,  0,  1, 0, 1,      63.0,    0.1,   -33.0,  0.0},
+        { 2,  0, -1, 2, 2,     -59.0,    0.0,    26.0,  0.0},
+        { 0,  0, -1, 0, 1,     -58.0,   -0.1,    32.0,  0.0},
+        { 0,  0,  1, 2, 1,     -51.0,    0.0,    27.0,  0.0},
+        {-2,  0,  2, 0, 0,      48.0,    0.0,     0.0,  0.0},
+        { 0,  0, -2, 2, 1,      46.0,    0.0,   -24.0,  0.0},
+        { 2,  0,  0, 2, 2,     -38.0,    0.0,    16.0,  0.0},
+        { 0,  0,  2, 2, 2,     -31.0,    0.0,    13.0,  0.0},
+        { 0,  0,  2, 0, 0,      29.0,    0.0,     0.0,  0.0},
+        {-2,  0,  1, 2, 2,      29.0,    0.0,   -12.0,  0.0},
+        { 0,  0,  0, 2, 0,      26.0,    0.0,     0.0,  0.0},
+        {-2,  0,  0, 2, 0,     -22.0,    0.0,     0.0,  0.0},
+        { 0,  0, -1, 2, 1,      21.0,    0.0,   -10.0,  0.0},
+        { 0,  2,  0, 0, 0,      17.0,   -0.1,     0.0,  0.0},
+        { 2,  0, -1, 0, 1,      16.0,    0.0,    -8.0,  0.0},
+        {-2,  2,  0, 2, 2,     -16.0,    0.1,     7.0,  0.0},
+    };
+    return terms;
+}
+
+// Read a nutation table: one term per line as "D M M' F Omega psi psiRate eps epsRate",
+// amplitudes in 0.0001 arcsec; '#' starts a comment
+inline std::vector<NutationTerm> loadNutationTerms(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open nutation table '" + path + "'");
+    }
+    std::vector<NutationTerm> terms;
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        NutationTerm t{};
+        if (fields >> t.D >> t.M >> t.Mp >> t.F >> t.Omega >> t.psi >> t.psiRate >> t.eps >> t.epsRate) {
+            terms.push_back(t);
+        }
+    }
+    if (terms.empty()) {
+        throw std::runtime_error("Nutation table '" + path + "' has no terms");
+    }
+    return terms;
+}
+
+struct NutationAngles {
+    double dPsi;          // nutation in longitude [rad]
+    double dEps;          // nutation in obliquity [rad]
+    double meanObliquity; // [rad]
+    double omega;         // longitude of the Moon's ascending node [rad]
+};
+
+inline NutationAngles nutationAngles(double T, const std::vector<NutationTerm>& terms) {
+    const double T2 = T * T;
+    const double T3 = T2 * T;
+    const double D = (297.85036 + 445267.111480 * T - 0.0019142 * T2 + T3 / 189474.0) * DEG_TO_RAD;
+    const double M = (357.52772 + 35999.050340 * T - 0.0001603 * T2 - T3 / 300000.0) * DEG_TO_RAD;
+    const double Mp = (134.96298 + 477198.867398 * T + 0.0086972 * T2 + T3 / 56250.0) * DEG_TO_RAD;
+    const double F = (93.27191 + 483202.017538 * T - 0.0036825 * T2 + T3 / 327270.0) * DEG_TO_RAD;
+    const double Omega = (125.04452 - 1934.136261 * T + 0.0020708 * T2 + T3 / 450000.0) * DEG_TO_RAD;
+
+    double dPsi = 0.0;
+    double dEps = 0.0;
+    for (const NutationTerm& t : terms) {
+        const double argument = t.D * D + t.M * M + t.Mp * Mp + t.F * F + t.Omega * Omega;
+        dPsi += (t.psi + t.psiRate * T) * std::sin(argument);
+        dEps += (t.eps + t.epsRate * T) * std::cos(argument);
+    }
+    return {dPsi * 1e-4 * ARCSEC_TO_RAD, dEps * 1e-4 * ARCSEC_TO_RAD, meanObliquity(T), Omega};
+}
+
+// Greenwich mean sidereal time (IAU 1982) [rad] for seconds of UT1 since J2000
+inline double greenwichMeanSiderealTime(double ut1_since_j2000) {
+    const double days = ut1_since_j2000 / SECONDS_PER_DAY;
+    const double T = days / DAYS_PER_CENTURY;
+    // 360.98564736629 deg/day split into whole turns and the remainder to keep precision
+    const double turns = days - std::floor(days);
+    const double degrees = 280.46061837 + 360.0 * turns + 0.98564736629 * days + 0.000387933 * T * T - T * T * T / 38710000.0;
+    return std::fmod(degrees, 360.0) * DEG_TO_RAD;
+}
+
+// TAI-UTC [s] on the UTC day of a modified Julian date
+inline int taiMinusUtcAtMjd(double mjd) {
+    return TimeScale::taiMinusUtc(TimeScale::J2000Day + static_cast<std::int64_t>(std::floor(mjd - MJD_J2000 + 0.5)));
+}
+
+// Earth orientation parameters of one day
+struct EopRecord {
+    double mjd = 0.0;   // UTC modified Julian date
+    double xp = 0.0;    // polar motion [arcsec]
+    double yp = 0.0;    // polar motion [arcsec]
+    double dut1 = 0.0;  // UT1 - UTC [s]
+    double lod = 0.0;   // excess length of day [s]
+    double dPsi = 0.0;  // nutation corrections [arcsec]
+    double dEps = 0.0;
+};
+
+// Daily Earth orientation parameters, linearly interpolated; zero when empty and held
+// constant outside the tabulated range. UT1-UTC steps by a second at leap seconds, so
+// UT1-TAI is interpolated instead and the TAI-UTC of the requested day added back. File format: one day per line as
+// "MJD xp yp UT1-UTC LOD dPsi dEps" (arcsec, s); '#' starts a comment.
+class EopTable {
+
+    public:
+        EopTable() = default;
+
+        explicit EopTable(std::vector<EopRecord> records) : m_Records(std::move(records)) {
+            std::sort(m_Records.begin(), m_Records.end(), [](const EopRecord& a, const EopRecord& b) { return a.mjd < b.mjd; });
+        }
+
+        static EopTable load(const std::string& path) {
+            std::ifstream in(path);
+            if (!in) {
+                throw std::runtime_error("Cannot open Earth orientation file '" + path + "'");
+            }
+            std::vector<EopRecord> records;
+            std::string line;
+            while (std::getline(in, line)) {
+                line = line.substr(0, line.find('#'));
+                std::istringstream fields(line);
+                EopRecord r;
+                if (fields >> r.mjd >> r.xp >> r.yp >> r.dut1 >> r.lod >> r.dPsi >> r.dEps) {
+                    records.push_back(r);
+                }
+            }
+            return EopTable(std::move(records));
+        }
+
+        bool empty() const { return m_Records.empty(); }
+
+        EopRecord at(double mjd) const {
+            if (m_Records.empty()) {
+                EopRecord zero;
+                zero.mjd = mjd;
+                return zero;
+            }
+            if (mjd <= m_Records.front().mjd) return m_Records.front();
+            if (mjd >= m_Records.back().mjd) return m_Records.back();
+
+            auto upper = std::upper_bound(m_Records.begin(), m_Records.end(), mjd, [](double value, const EopRecord& r) { return value < r.mjd; });
+            const EopRecord& b = *upper;
+            const EopRecord& a = *(upper - 1);
+            const double f = (mjd - a.mjd) / (b.mjd - a.mjd);
+            EopRecord r;
+            r.mjd = mjd;
+            r.xp = a.xp + f * (b.xp - a.xp);
+            r.yp = a.yp + f * (b.yp - a.yp);
+            const double ut1MinusTaiA = a.dut1 - taiMinusUtcAtMjd(a.mjd);
+            const double ut1MinusTaiB = b.dut1 - taiMinusUtcAtMjd(b.mjd);
+            r.dut1 = ut1MinusTaiA + f * (ut1MinusTaiB - ut1MinusTaiA) + taiMinusUtcAtMjd(mjd);
+            r.lod = a.lod + f * (b.lod - a.lod);
+            r.dPsi = a.dPsi + f * (b.dPsi - a.dPsi);
+            r.dEps = a.dEps + f * (b.dEps - a.dEps);
+            return r;
+        }
+
+    private:
+        std::vector<EopRecord> m_Records;
+};
+
+// ITRF <-> GCRF transformation for UTC seconds since J2000 (2000-01-01 12:00 UTC).
+// Not thread safe: the interpolation grid is cached in the object.
+class EarthOrientation {
+
+    public:
+        EarthOrientation(EopTable eop = {}, std::vector<NutationTerm> terms = defaultNutationTerms(), double cadence = 3600.0)
+            : m_Eop(std::move(eop)), m_Terms(std::move(terms)), m_Cadence(cadence) {
+            if (!(cadence > 0.0)) {
+                throw std::invalid_argument("Earth orientation cadence must be positive");
+            }
+        }
+
+        // Rotation taking ITRF (ECEF) coordinates to GCRF (ECI)
+        Matrix3 ecefToEciMatrix(double utc_since_j2000) { return frame(utc_since_j2000).PNRW; }
+
+        Matrix3 eciToEcefMatrix(double utc_since_j2000) { return transpose(ecefToEciMatrix(utc_since_j2000)); }
+
+        // Earth angular velocity [rad/s] including the length of day excess
+        double rotationRate(double utc_since_j2000) {
+            return frame(utc_since_j2000).w;
+        }
+
+        std::array<double, 3> ecefToEci(const std::array<double, 3>& r, double utc_since_j2000) {
+            return multiply(frame(utc_since_j2000).PNRW, r);
+        }
+
+        // The transpose is applied in place rather than built
+        std::array<double, 3> eciToEcef(const std::array<double, 3>& r, double utc_since_j2000) {
+            const Matrix3& m = frame(utc_since_j2000).PNRW;
+            return {m[0][0] * r[0] + m[1][0] * r[1] + m[2][0] * r[2], m[0][1] * r[0] + m[1][1] * r[1] + m[2][1] * r[2],
+                    m[0][2] * r[0] + m[1][2] * r[1] + m[2][2] * r[2]};
+        }
+
+        // Velocity: v_eci = P N R (v_pef + w x r_pef), with r_pef = W r_itrf, v_pef = W v_itrf
+        std::array<double, 3> ecefToEciVelocity(const std::array<double, 3>& r, const std::array<double, 3>& v, double utc_since_j2000) {
+            return frame(utc_since_j2000).velocity(r, v);
+        }
+
+        // Acceleration: a_eci = P N R (a_pef + 2 w x v_pef + w x (w x r_pef)), with a_pef = W a_itrf
+        std::array<double, 3> ecefToEciAcceleration(const std::array<double, 3>& r, const std::array<double, 3>& v,
+                                                    const std::array<double, 3>& a, double utc_since_j2000) {
+            return frame(utc_since_j2000).acceleration(r, v, a);
+        }
+
+        // Positions, velocities and accelerations of several vehicles at one epoch; the rotation
+        // is built once. All spans have the same length.
+        void ecefToEci(double utc_since_j2000, std::span<const std::array<double, 3>> r, std::span<const std::array<double, 3>> v,
+                       std::span<const std::array<double, 3>> a, std::span<std::array<double, 3>> r_eci,
+                       std::span<std::array<double, 3>> v_eci, std::span<std::array<double, 3>> a_eci) {
+            if (v.size() != r.size() || a.size() != r.size() || r_eci.size() != r.size() || v_eci.size() != r.size() ||
+                a_eci.size() != r.size()) {
+                throw std::invalid_argument("Frame transform arrays must have the same length");
+            }
+            const Frame& f = frame(utc_since_j2000);
+            for (std::size_t i = 0; i < r.size(); ++i) {
+                r_eci[i] = multiply(f.PNRW, r[i]);
+                v_eci[i] = f.velocity(r[i], v[i]);
+                a_eci[i] = f.acceleration(r[i], v[i], a[i]);
+            }
+        }
+
+        // Precession-nutation matrix (mean J2000 <- true of date) without interpolation
+        Matrix3 precessionNutation(double utc_since_j2000) const { return evaluate(utc_since_j2000).PN; }
+
+    private:
+        // Slowly varying parts of the transformation
+        struct Slow {
+            Matrix3 PN;
+            Matrix3 W;
+            double equationOfEquinoxes;
+            double ut1MinusTai;
+            double lod;
+            int taiMinusUtc;
+        };
+
+        // Full transformation at one epoch: r_eci = PNRW r_itrf, Earth rate w about the PEF z axis
+        struct Frame {
+            Matrix3 PNRW;
+            Matrix3 PNR;
+            Matrix3 W;
+            double w;
+
+            std::array<double, 3> velocity(const std::array<double, 3>& r, const std::array<double, 3>& v) const {
+                const auto rp = multiply(W, r);
+                auto vp = multiply(W, v);
+                vp[0] -= w * rp[1];
+                vp[1] += w * rp[0];
+                return multiply(PNR, vp);
+            }
+
+            std::array<double, 3> acceleration(const std::array<double, 3>& r, const std::array<double, 3>& v,
+                                               const std::array<double, 3>& a) const {
+                const auto rp = multiply(W, r);
+                const auto vp = multiply(W, v);
+                auto ap = multiply(W, a);
+                ap[0] += -2.0 * w * vp[1] - w * w * rp[0];
+                ap[1] += 2.0 * w * vp[0] - w * w * rp[1];
+                return multiply(PNR, ap);
+            }
+        };
+
+        // Frame at utc; the last one is kept, so several calls at one epoch build it once
+        const Frame& frame(double utc) {
+            if (m_FrameValid && utc == m_FrameUtc) {
+                return m_Frame;
+            }
+            const Slow slow = interpolated(utc);
+            // UT1-UTC from the interpolated UT1-TAI and the TAI-UTC of utc, looked up only across a leap second
+            const int leap = slow.taiMinusUtc == m_Upper.taiMinusUtc ? slow.taiMinusUtc : taiMinusUtcAtMjd(MJD_J2000 + utc / SECONDS_PER_DAY);
+            const double theta = greenwichMeanSiderealTime(utc + slow.ut1MinusTai + leap) + slow.equationOfEquinoxes;
+            m_Frame.PNR = multiply(slow.PN, rotationZ(-theta));
+            m_Frame.W = slow.W;
+            m_Frame.PNRW = multiply(m_Frame.PNR, slow.W);
+            m_Frame.w = EARTH_ROTATION_RATE * (1.0 - slow.lod / SECONDS_PER_DAY);
+            m_FrameUtc = utc;
+            m_FrameValid = true;
+            return m_Frame;
+        }
+
+        Slow evaluate(double utc) const {
+            const double mjd = MJD_J2000 + utc / SECONDS_PER_DAY;
+            const EopRecord eop = m_Eop.at(mjd);
+            const double tt = TimeScale::Epoch::fromUtcSinceJ2000(utc).ttSinceJ2000();
+            const double T = tt / (SECONDS_PER_DAY * DAYS_PER_CENTURY);
+
+            NutationAngles n = nutationAngles(T, m_Terms);
+            const double dPsi = n.dPsi + eop.dPsi * ARCSEC_TO_RAD;
+            const double dEps = n.dEps + eop.dEps * ARCSEC_TO_RAD;
+            const double trueObliquity = n.meanObliquity + dEps;
+
+            Slow s;
+            const Matrix3 N = multiply(multiply(rotationX(-n.meanObliquity), rotationZ(dPsi)), rotationX(trueObliquity));
+            s.PN = multiply(precessionMatrix(T), N);
+            s.W = multiply(rotationX(eop.yp * ARCSEC_TO_RAD), rotationY(eop.xp * ARCSEC_TO_RAD));
+            // Equation of the equinoxes with the 1997 terms in the Moon's node
+            s.equationOfEquinoxes = dPsi * std::cos(n.meanObliquity) +
+                                    (0.00264 * std::sin(n.omega) + 0.000063 * std::sin(2.0 * n.omega)) * ARCSEC_TO_RAD;
+            s.taiMinusUtc = taiMinusUtcAtMjd(mjd);
+            s.ut1MinusTai = eop.dut1 - s.taiMinusUtc;
+            s.lod = eop.lod;
+            return s;
+        }
+
+        // Linear interpolation between the two grid points around utc
+        Slow interpolated(double utc) {
+            const double k = std::floor(utc / m_Cadence);
+            if (!m_Valid || k != m_Knot) {
+                m_Knot = k;
+                m_Lower = evaluate(k * m_Cadence);
+                m_Upper = evaluate((k + 1.0) * m_Cadence);
+                m_Valid = true;
+            }
+            const double f = utc / m_Cadence - k;
+            Slow s;
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    s.PN[i][j] = m_Lower.PN[i][j] + f * (m_Upper.PN[i][j] - m_Lower.PN[i][j]);
+                    s.W[i][j] = m_Lower.W[i][j] + f * (m_Upper.W[i][j] - m_Lower.W[i][j]);
+                }
+            }
+            s.equationOfEquinoxes = m_Lower.equationOfEquinoxes + f * (m_Upper.equationOfEquinoxes - m_Lower.equationOfEquinoxes);
+            s.lod = m_Lower.lod + f * (m_Upper.lod - m_Lower.lod);
+            // UT1-TAI is continuous across leap seconds, unlike UT1-UTC
+            s.ut1MinusTai = m_Lower.ut1MinusTai + f * (m_Upper.ut1MinusTai - m_Lower.ut1MinusTai);
+            s.taiMinusUtc = m_Lower.taiMinusUtc;
+            return s;
+        }
+
+        EopTable m_Eop;
+        std::vector<NutationTerm> m_Terms;
+        double m_Cadence;
+
+        bool m_Valid = false;
+        double m_Knot = 0.0;
+        Slow m_Lower{};
+        Slow m_Upper{};
+
+        bool m_FrameValid = false;
+        double m_FrameUtc = 0.0;
+        Frame m_Frame{};
+};
+
+} // namespace Coordinate
+
+#endif // EARTH_ORIENTATION_H
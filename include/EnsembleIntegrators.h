@@ -0,0 +1,349 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [EnsembleIntegrators.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Integrators that advance many trajectories of one model at once, for
+ *  dispersions. The state is stored array-of-structures-of-arrays: trajectories
+ *  are grouped in tiles of Lanes, and a tile holds each state component for all
+ *  of its lanes contiguously, Block[i][lane]. Every stage loop runs over lanes,
+ *  and the model evaluates one tile per call, so the SIMD width is used across
+ *  trajectories rather than across the few states of one. Lanes is a multiple of
+ *  every SIMD width (8 doubles for AVX-512) and small enough for a tile and its
+ *  stages to stay in L1.
+ *      EnsembleRK4<N, Lanes>      classical Runge-Kutta, one step for all lanes
+ *      EnsembleDoPri54<N, Lanes>  Dormand-Prince 5(4) with a step size and time per
+ *                                 lane; lanes that reject, or have arrived, are
+ *                                 masked out of the update while the others go on
+ *  Models derive from them directly (these keep a virtual ode_fun, called once per
+ *  tile of Lanes trajectories rather than per state), with
+ *      void ode_fun(std::size_t tile, const Block& x, Block& f)
+ *  and take their per trajectory parameters from arrays indexed the same way.
+ *  The error norm and step size control are those of FixedDoPri54, per lane.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef ENSEMBLE_INTEGRATORS_H
+#define ENSEMBLE_INTEGRATORS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Integration {
+
+// Trajectories, tiles and per lane times shared by the ensemble integrators
+template<int N, int Lanes>
+class EnsembleIntegrator {
+
+    public:
+        static_assert(Lanes % 8 == 0, "Lanes must be a multiple of the widest SIMD width");
+
+        static constexpr int LaneCount = Lanes;
+
+        // One tile: component i of lane l at [i][l]
+        using Lane = std::array<double, Lanes>;
+        struct alignas(64) Block {
+            std::array<Lane, N> x;
+            Lane& operator[](int i) { return x[i]; }
+            const Lane& operator[](int i) const { return x[i]; }
+        };
+
+        explicit EnsembleIntegrator(std::size_t count)
+            : m_Count(count), m_Sol((count + Lanes - 1) / Lanes), m_T(m_Sol.size()) {
+            if (count == 0) throw std::invalid_argument("Ensemble needs at least one trajectory");
+            for (auto& t : m_T) t.fill(0.0);
+        }
+
+        EnsembleIntegrator(const EnsembleIntegrator&) = delete;
+        EnsembleIntegrator& operator=(const EnsembleIntegrator&) = delete;
+
+        virtual ~EnsembleIntegrator() = default;
+
+        virtual void ode_fun(std::size_t tile, const Block& x, Block& f) = 0;
+
+        std::size_t size() const { return m_Count; }
+        std::size_t tiles() const { return m_Sol.size(); }
+
+        void set_sol(std::size_t trajectory, int i, double x) { m_Sol[trajectory / Lanes][i][trajectory % Lanes] = x; }
+        double get_sol(std::size_t trajectory, int i) const { return m_Sol[trajectory / Lanes][i][trajectory % Lanes]; }
+
+        double get_t(std::size_t trajectory) const { return m_T[trajectory / Lanes][trajectory % Lanes]; }
+        void set_t(double t) {
+            for (auto& lanes : m_T) lanes.fill(t);
+        }
+
+        // Counted per trajectory, as for a loop over scalar integrators
+        long get_nstep() const { return m_Nstep; }
+        long get_nrej() const { return m_Nrej; }
+        long get_nfev() const { return m_Nfev; }
+
+        void set_reltol(double tol) { m_RelTol = tol; }
+        void set_abstol(double tol) { m_AbsTol = tol; }
+
+    protected:
+        // Lanes of `tile` holding a trajectory; the rest pad the last tile
+        int activeLanes(std::size_t tile) const {
+            return static_cast<int>(std::min<std::size_t>(Lanes, m_Count - tile * Lanes));
+        }
+
+        // Padding lanes follow the first lane of their tile, so that they never feed
+        // the model a state it cannot evaluate
+        void fillPadding(std::size_t tile) {
+            for (int l = activeLanes(tile); l < Lanes; ++l) {
+                for (int i = 0; i < N; ++i) m_Sol[tile][i][l] = m_Sol[tile][i][0];
+                m_T[tile][l] = m_T[tile][0];
+            }
+        }
+
+        // Model derivative of a tile, counted per trajectory
+        void evaluate(std::size_t tile, const Block& x, Block& f) {
+            ode_fun(tile, x, f);
+            m_Nfev += activeLanes(tile);
+        }
+
+        // Root mean square of the error of each lane weighted by the tolerances
+        void errorNorm(std::size_t tile, const Block& error, Lane& norm) const {
+            const Block& sol = m_Sol[tile];
+            norm.fill(0.0);
+            for (int i = 0; i < N; ++i) {
+                for (int l = 0; l < Lanes; ++l) {
+                    const double scale = m_AbsTol + m_RelTol * std::max(std::abs(sol[i][l]), std::abs(m_Next[i][l]));
+                    const double e = error[i][l] / scale;
+                    norm[l] += e * e;
+                }
+            }
+            for (int l = 0; l < Lanes; ++l) norm[l] = std::sqrt(norm[l] / N);
+        }
+
+        std::size_t m_Count;
+        std::vector<Block> m_Sol;
+        std::vector<Lane> m_T;
+        Block m_Next{};
+
+        double m_RelTol = 1e-6;
+        double m_AbsTol = 1e-6;
+
+        long m_Nstep = 0;
+        long m_Nrej = 0;
+        long m_Nfev = 0;
+};
+
+template<int N, int Lanes = 64>
+class EnsembleRK4 : public EnsembleIntegrator<N, Lanes> {
+
+        using Base = EnsembleIntegrator<N, Lanes>;
+
+    public:
+        using typename Base::Block;
+        using typename Base::Lane;
+
+        explicit EnsembleRK4(std::size_t count) : Base(count) {}
+
+        // tint in equal steps of about dt shared by all lanes, the last one shortened
+        // to land on t + tint; lanes are assumed to start at the same time
+        void solve_fixed(double tint, double dt) {
+            Lane h;
+            for (std::size_t tile = 0; tile < this->tiles(); ++tile) {
+                this->fillPadding(tile);
+                const double start = this->m_T[tile][0];
+                const double end = start + tint;
+                double t = start;
+                while (t < end) {
+                    h.fill(std::min(dt, end - t));
+                    attempt(tile, h);
+                    this->m_Sol[tile] = this->m_Next;
+                    t += h[0];
+                    this->m_Nstep += this->activeLanes(tile);
+                    if (end - t < 1e-12 * std::max(1.0, std::abs(end))) t = end;
+                }
+                this->m_T[tile].fill(t);
+            }
+        }
+
+    private:
+        void attempt(std::size_t tile, const Lane& h) {
+            const Block& sol = this->m_Sol[tile];
+            Block& next = this->m_Next;
+            this->evaluate(tile, sol, m_K1);
+            for (int i = 0; i < N; ++i) {
+                for (int l = 0; l < Lanes; ++l) m_Y[i][l] = sol[i][l] + 0.5 * h[l] * m_K1[i][l];
+            }
+            this->evaluate(tile, m_Y, m_K2);
+            for (int i = 0; i < N; ++i) {
+                for (int l = 0; l < Lanes; ++l) m_Y[i][l] = sol[i][l] + 0.5 * h[l] * m_K2[i][l];
+            }
+            this->evaluate(tile, m_Y, m_K3);
+            for (int i = 0; i < N; ++i) {
+                for (int l = 0; l < Lanes; ++l) m_Y[i][l] = sol[i][l] + h[l] * m_K3[i][l];
+            }
+            this->evaluate(tile, m_Y, m_K4);
+            for (int i = 0; i < N; ++i) {
+                for (int l = 0; l < Lanes; ++l) {
+                    next[i][l] = sol[i][l] + h[l] / 6.0 * (m_K1[i][l] + 2.0 * (m_K2[i][l] + m_K3[i][l]) + m_K4[i][l]);
+                }
+            }
+        }
+
+        Block m_Y{};
+        Block m_K1{};
+        Block m_K2{};
+        Block m_K3{};
+        Block m_K4{};
+};
+
+template<int N, int Lanes = 64>
+class EnsembleDoPri54 : public EnsembleIntegrator<N, Lanes> {
+
+        using Base = EnsembleIntegrator<N, Lanes>;
+
+    public:
+        using typename Base::Block;
+        using typename Base::Lane;
+
+        explicit EnsembleDoPri54(std::size_t count) : Base(count) {}
+
+        // tint from each lane's own time with error control, starting from dt0. A tile
+        // runs until all of its lanes have arrived; every attempt advances the lanes
+        // that accept and retries the others with a smaller step
+        void solve_adaptive(double tint, double dt0, bool = true) {
+            for (std::size_t tile = 0; tile < this->tiles(); ++tile) solveTile(tile, tint, dt0);
+        }
+
+    private:
+        void solveTile(std::size_t tile, double tint, double dt0) {
+            this->fillPadding(tile);
+            Block& sol = this->m_Sol[tile];
+            Lane& t = this->m_T[tile];
+            const int active = this->activeLanes(tile);
+
+            Lane end;
+            Lane h;
+            Lane taken;
+            Lane error;
+            std::array<bool, Lanes> done;
+            for (int l = 0; l < Lanes; ++l) {
+                end[l] = t[l] + tint;
+                h[l] = dt0;
+                done[l] = l >= active;
+            }
+            int remaining = active;
+
+            this->evaluate(tile, sol, m_K1);
+            while (remaining > 0) {
+                // Arrived lanes take zero steps, which leave them where they are
+                for (int l = 0; l < Lanes; ++l) taken[l] = done[l] ? 0.0 : std::min(h[l], end[l] - t[l]);
+                attempt(tile, taken, error);
+
+                for (int l = 0; l < active; ++l) {
+                    if (done[l]) continue;
+                    const bool last = t[l] + h[l] >= end[l];
+                    const double factor = error[l] > 0.0 ? std::clamp(0.9 * std::pow(error[l], -0.2), 0.2, 5.0) : 5.0;
+                    if (error[l] <= 1.0) {
+                        for (int i = 0; i < N; ++i) {
+                            sol[i][l] = this->m_Next[i][l];
+                            m_K1[i][l] = m_K[6][i][l];
+                        }
+                        t[l] += taken[l];
+                        ++this->m_Nstep;
+                        if (last) {
+                            t[l] = end[l];
+                            done[l] = true;
+                            --remaining;
+                        } else {
+                            h[l] = taken[l] * factor;
+                        }
+                    } else {
+                        ++this->m_Nrej;
+                        h[l] = taken[l] * std::min(factor, 0.9);
+                        if (h[l] < 1e-14 * std::max(1.0, std::abs(t[l]))) {
+                            throw std::runtime_error("Step size underflow in trajectory " +
+                                                     std::to_string(tile * Lanes + l) + " at t = " + std::to_string(t[l]));
+                        }
+                    }
+                }
+            }
+        }
+
+        // Candidate solution of every lane for its own step h into m_Next, with the
+        // scaled error of each; m_K1 holds the derivative at the current solution
+        void attempt(std::size_t tile, const Lane& h, Lane& error) {
+            const Block& sol = this->m_Sol[tile];
+            Block& next = this->m_Next;
+            const Block& k1 = m_K1;
+            for (int i = 0; i < N; ++i) {
+                for (int l = 0; l < Lanes; ++l) m_Y[i][l] = sol[i][l] + h[l] * (1.0 / 5.0) * k1[i][l];
+            }
+            this->evaluate(tile, m_Y, m_K[1]);
+            for (int i = 0; i < N; ++i) {
+                for (int l = 0; l < Lanes; ++l) {
+                    m_Y[i][l] = sol[i][l] + h[l] * (3.0 / 40.0 * k1[i][l] + 9.0 / 40.0 * m_K[1][i][l]);
+                }
+            }
+            this->evaluate(tile, m_Y, m_K[2]);
+            for (int i = 0; i < N; ++i) {
+                for (int l = 0; l < Lanes; ++l) {
+                    m_Y[i][l] = sol[i][l] + h[l] * (44.0 / 45.0 * k1[i][l] - 56.0 / 15.0 * m_K[1][i][l] +
+                                                    32.0 / 9.0 * m_K[2][i][l]);
+                }
+            }
+            this->evaluate(tile, m_Y, m_K[3]);
+            for (int i = 0; i < N; ++i) {
+                for (int l = 0; l < Lanes; ++l) {
+                    m_Y[i][l] = sol[i][l] + h[l] * (19372.0 / 6561.0 * k1[i][l] - 25360.0 / 2187.0 * m_K[1][i][l] +
+                                                    64448.0 / 6561.0 * m_K[2][i][l] - 212.0 / 729.0 * m_K[3][i][l]);
+                }
+            }
+            this->evaluate(tile, m_Y, m_K[4]);
+            for (int i = 0; i < N; ++i) {
+                for (int l = 0; l < Lanes; ++l) {
+                    m_Y[i][l] = sol[i][l] + h[l] * (9017.0 / 3168.0 * k1[i][l] - 355.0 / 33.0 * m_K[1][i][l] +
+                                                    46732.0 / 5247.0 * m_K[2][i][l] + 49.0 / 176.0 * m_K[3][i][l] -
+                                                    5103.0 / 18656.0 * m_K[4][i][l]);
+                }
+            }
+            this->evaluate(tile, m_Y, m_K[5]);
+            for (int i = 0; i < N; ++i) {
+                for (int l = 0; l < Lanes; ++l) {
+                    next[i][l] = sol[i][l] + h[l] * (35.0 / 384.0 * k1[i][l] + 500.0 / 1113.0 * m_K[2][i][l] +
+                                                     125.0 / 192.0 * m_K[3][i][l] - 2187.0 / 6784.0 * m_K[4][i][l] +
+                                                     11.0 / 84.0 * m_K[5][i][l]);
+                }
+            }
+            this->evaluate(tile, next, m_K[6]);
+
+            // Fifth minus fourth order solution
+            for (int i = 0; i < N; ++i) {
+                for (int l = 0; l < Lanes; ++l) {
+                    m_Error[i][l] = h[l] * (71.0 / 57600.0 * k1[i][l] - 71.0 / 16695.0 * m_K[2][i][l] +
+                                            71.0 / 1920.0 * m_K[3][i][l] - 17253.0 / 339200.0 * m_K[4][i][l] +
+                                            22.0 / 525.0 * m_K[5][i][l] - 1.0 / 40.0 * m_K[6][i][l]);
+                }
+            }
+            this->errorNorm(tile, m_Error, error);
+        }
+
+        Block m_K1{};
+        Block m_Y{};
+        Block m_Error{};
+        std::array<Block, 7> m_K{};
+};
+
+} // namespace Integration
+
+#endif // ENSEMBLE_INTEGRATORS_H
@@ -0,0 +1,247 @@
+/*
+ * ----------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [Epoch.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Epoch held as integer nanoseconds of Terrestrial Time since J2000.0
+ *  (2000-01-01 12:00:00 TT), which resolves 1 ns over +-292 years and makes
+ *  advancing by a step an exact integer add. Conversions to UTC use the
+ *  leap second table (TAI-UTC, 1972-2017), TT = TAI + 32.184 s and UT1 = UTC +
+ *  (UT1-UTC) from the Earth orientation parameters. Calendar conversions are
+ *  constexpr (days_from_civil / civil_from_days, proleptic Gregorian).]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------------
+ */
+
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace TimeScale {
+
+constexpr std::int64_t NanosecondsPerSecond = 1000000000;
+constexpr std::int64_t SecondsPerDay = 86400;
+constexpr std::int64_t TtMinusTaiNanoseconds = 32184000000; // 32.184 s
+constexpr double J2000JulianDate = 2451545.0;
+
+// Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant's days_from_civil)
+constexpr std::int64_t daysFromCivil(std::int64_t year, int month, int day) {
+    year -= month <= 2;
+    const std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const std::int64_t yoe = year - era * 400;
+    const std::int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const std::int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+struct CivilDate {
+    std::int64_t year;
+    int month;
+    int day;
+};
+
+// Inverse of daysFromCivil
+constexpr CivilDate civilFromDays(std::int64_t days) {
+    days += 719468;
+    const std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const std::int64_t doe = days - era * 146097;
+    const std::int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const std::int64_t mp = (5 * doy + 2) / 153;
+    const int day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    const int month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    return {yoe + era * 400 + (month <= 2), month, day};
+}
+
+// Days since 1970-01-01 of 2000-01-01
+constexpr std::int64_t J2000Day = daysFromCivil(2000, 1, 1);
+
+struct LeapSecond {
+    std::int64_t utcDay;   // first UTC day (since 1970-01-01) with this offset
+    int taiMinusUtc;       // [s]
+};
+
+// TAI-UTC since the start of the leap second era
+constexpr std::array<LeapSecond, 28> LeapSeconds = {{
+    {daysFromCivil(1972, 1, 1), 10}, {daysFromCivil(1972, 7, 1), 11}, {daysFromCivil(1973, 1, 1), 12},
+    {daysFromCivil(1974, 1, 1), 13}, {daysFromCivil(1975, 1, 1), 14}, {daysFromCivil(1976, 1, 1), 15},
+    {daysFromCivil(1977, 1, 1), 16}, {daysFromCivil(1978, 1, 1), 17}, {daysFromCivil(1979, 1, 1), 18},
+    {daysFromCivil(1980, 1, 1), 19}, {daysFromCivil(1981, 7, 1), 20}, {daysFromCivil(1982, 7, 1), 21},
+    {daysFromCivil(1983, 7, 1), 22}, {daysFromCivil(1985, 7, 1), 23}, {daysFromCivil(1988, 1, 1), 24},
+    {daysFromCivil(1990, 1, 1), 25}, {daysFromCivil(1991, 1, 1), 26}, {daysFromCivil(1992, 7, 1), 27},
+    {daysFromCivil(1993, 7, 1), 28}, {daysFromCivil(1994, 7, 1), 29}, {daysFromCivil(1996, 1, 1), 30},
+    {daysFromCivil(1997, 7, 1), 31}, {daysFromCivil(1999, 1, 1), 32}, {daysFromCivil(2006, 1, 1), 33},
+    {daysFromCivil(2009, 1, 1), 34}, {daysFromCivil(2012, 7, 1), 35}, {daysFromCivil(2015, 7, 1), 36},
+    {daysFromCivil(2017, 1, 1), 37},
+}};
+
+// TAI-UTC [s] on a UTC day; 10 s is used before 1972 (the rubber second era is not modelled)
+constexpr int taiMinusUtc(std::int64_t utcDay) {
+    int offset = LeapSeconds[0].taiMinusUtc;
+    for (const LeapSecond& leap : LeapSeconds) {
+        if (utcDay >= leap.utcDay) offset = leap.taiMinusUtc;
+    }
+    return offset;
+}
+
+struct CalendarTime {
+    std::int64_t year;
+    int month;
+    int day;
+    int hour;
+    int minute;
+    int second;
+    std::int64_t nanosecond;
+};
+
+class Epoch {
+
+    public:
+        constexpr Epoch() = default;
+
+        // Nanoseconds of TT since J2000.0
+        static constexpr Epoch fromTtNanoseconds(std::int64_t nanoseconds) { return Epoch(nanoseconds); }
+
+        static constexpr Epoch fromTt(std::int64_t year, int month, int day, int hour, int minute, int second, std::int64_t nanosecond = 0) {
+            return Epoch(clockNanoseconds(year, month, day, hour, minute, second, nanosecond));
+        }
+
+        static constexpr Epoch fromTai(std::int64_t year, int month, int day, int hour, int minute, int second, std::int64_t nanosecond = 0) {
+            return Epoch(clockNanoseconds(year, month, day, hour, minute, second, nanosecond) + TtMinusTaiNanoseconds);
+        }
+
+        // UTC clock reading in seconds since 2000-01-01 12:00:00 UTC, the inverse of utcSinceJ2000()
+        static Epoch fromUtcSinceJ2000(double seconds) {
+            const std::int64_t clock = nanoseconds(seconds);
+            const std::int64_t leap = TimeScale::taiMinusUtc(utcDay(clock));
+            return Epoch(clock + leap * NanosecondsPerSecond + TtMinusTaiNanoseconds);
+        }
+
+        // second may be 60 during a leap second
+        static constexpr Epoch fromUtc(std::int64_t year, int month, int day, int hour, int minute, int second, std::int64_t nanosecond = 0) {
+            const std::int64_t leap = TimeScale::taiMinusUtc(daysFromCivil(year, month, day));
+            return Epoch(clockNanoseconds(year, month, day, hour, minute, second, nanosecond) + leap * NanosecondsPerSecond +
+                         TtMinusTaiNanoseconds);
+        }
+
+        constexpr std::int64_t ttNanoseconds() const { return m_Nanoseconds; }
+
+        // Exact O(1) stepping
+        constexpr Epoch& operator+=(std::int64_t nanoseconds) {
+            m_Nanoseconds += nanoseconds;
+            return *this;
+        }
+
+        constexpr Epoch operator+(std::int64_t nanoseconds) const { return Epoch(m_Nanoseconds + nanoseconds); }
+
+        constexpr std::int64_t operator-(const Epoch& other) const { return m_Nanoseconds - other.m_Nanoseconds; }
+
+        constexpr bool operator==(const Epoch& other) const = default;
+        constexpr auto operator<=>(const Epoch& other) const = default;
+
+        // Seconds to nanoseconds, rounded to the nearest nanosecond
+        static std::int64_t nanoseconds(double seconds) { return std::llround(seconds * 1e9); }
+
+        Epoch plusSeconds(double seconds) const { return Epoch(m_Nanoseconds + nanoseconds(seconds)); }
+
+        // TT seconds since J2000.0, as used by the ephemerides and precession-nutation
+        double ttSinceJ2000() const { return toSeconds(m_Nanoseconds); }
+
+        double taiSinceJ2000() const { return toSeconds(m_Nanoseconds - TtMinusTaiNanoseconds); }
+
+        // UTC clock reading in seconds since 2000-01-01 12:00:00 UTC, i.e. the time scale of
+        // timeSinceJ2000() in J2000.h and of Coordinate::EarthOrientation
+        double utcSinceJ2000() const { return toSeconds(utcClockNanoseconds()); }
+
+        // UT1 seconds since 2000-01-01 12:00:00 UT1 for a given UT1-UTC [s]
+        double ut1SinceJ2000(double ut1_minus_utc) const { return utcSinceJ2000() + ut1_minus_utc; }
+
+        // TAI-UTC in effect at this epoch [s]
+        constexpr int taiMinusUtc() const { return TimeScale::taiMinusUtc(utcDay(utcClockNanoseconds())); }
+
+        // Two part TT Julian date (whole day count, fraction of day) without loss of resolution
+        std::pair<double, double> julianDateTT() const {
+            const std::int64_t perDay = SecondsPerDay * NanosecondsPerSecond;
+            std::int64_t days = m_Nanoseconds / perDay;
+            std::int64_t rest = m_Nanoseconds % perDay;
+            if (rest < 0) {
+                rest += perDay;
+                days -= 1;
+            }
+            return {J2000JulianDate + static_cast<double>(days), static_cast<double>(rest) / static_cast<double>(perDay)};
+        }
+
+        constexpr CalendarTime utc() const { return calendar(utcClockNanoseconds()); }
+        constexpr CalendarTime tt() const { return calendar(m_Nanoseconds); }
+
+    private:
+        constexpr explicit Epoch(std::int64_t nanoseconds) : m_Nanoseconds(nanoseconds) {}
+
+        static double toSeconds(std::int64_t nanoseconds) {
+            // Split so that the whole seconds convert exactly
+            const std::int64_t seconds = nanoseconds / NanosecondsPerSecond;
+            return static_cast<double>(seconds) + static_cast<double>(nanoseconds - seconds * NanosecondsPerSecond) * 1e-9;
+        }
+
+        // Clock reading of a calendar time, in nanoseconds since 2000-01-01 12:00:00 of that scale
+        static constexpr std::int64_t clockNanoseconds(std::int64_t year, int month, int day, int hour, int minute, int second,
+                                                       std::int64_t nanosecond) {
+            const std::int64_t days = daysFromCivil(year, month, day) - J2000Day;
+            const std::int64_t seconds = days * SecondsPerDay + hour * 3600 + minute * 60 + second - SecondsPerDay / 2;
+            return seconds * NanosecondsPerSecond + nanosecond;
+        }
+
+        static constexpr std::int64_t utcDay(std::int64_t utcClock) {
+            const std::int64_t perDay = SecondsPerDay * NanosecondsPerSecond;
+            const std::int64_t shifted = utcClock + perDay / 2;
+            return J2000Day + (shifted >= 0 ? shifted / perDay : (shifted - perDay + 1) / perDay);
+        }
+
+        // UTC reading: TT - 32.184 s - (TAI-UTC). The offset is looked up with a first guess
+        // taken at the TAI reading, which differs from UTC by less than a minute.
+        constexpr std::int64_t utcClockNanoseconds() const {
+            const std::int64_t tai = m_Nanoseconds - TtMinusTaiNanoseconds;
+            std::int64_t utc = tai - TimeScale::taiMinusUtc(utcDay(tai)) * NanosecondsPerSecond;
+            return tai - TimeScale::taiMinusUtc(utcDay(utc)) * NanosecondsPerSecond;
+        }
+
+        static constexpr CalendarTime calendar(std::int64_t clock) {
+            const std::int64_t perDay = SecondsPerDay * NanosecondsPerSecond;
+            const std::int64_t shifted = clock + perDay / 2;
+            std::int64_t days = shifted / perDay;
+            std::int64_t rest = shifted % perDay;
+            if (rest < 0) {
+                rest += perDay;
+                days -= 1;
+            }
+            const CivilDate date = civilFromDays(J2000Day + days);
+            const std::int64_t seconds = rest / NanosecondsPerSecond;
+            return {date.year,
+                    date.month,
+                    date.day,
+                    static_cast<int>(seconds / 3600),
+                    static_cast<int>(seconds / 60 % 60),
+                    static_cast<int>(seconds % 60),
+                    rest % NanosecondsPerSecond};
+        }
+
+        std::int64_t m_Nanoseconds = 0;
+};
+
+} // namespace TimeScale
+
+#endif // EPOCH_H
@@ -0,0 +1,784 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [FixedSizeIntegrators.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Integrators with the state dimension N as a template parameter, drop-in bases for
+ *  DynamicModel<Integrator> next to the libode ones: same constructor, ode_fun,
+ *  ode_jac (double** rows), after_step and solve_fixed/solve_adaptive interface.
+ *  Solution, stages and the row-major Jacobian are std::arrays inside the object,
+ *  so nothing is allocated after construction and a 13-state model stays within a
+ *  few kilobytes of contiguous memory. The model is a template parameter as well
+ *  (CRTP): a model derives from Bind<Integrator, itself>, and the stages call its
+ *  ode_fun, ode_jac and after_step directly, without virtual dispatch, so the right
+ *  hand side can be inlined into them. Bind leaves the libode integrators and
+ *  integrators already bound to a derived model (Variational.h) unchanged.
+ *      FixedRK4<N>       classical Runge-Kutta, fixed step
+ *      FixedDoPri54<N>   Dormand-Prince 5(4), FSAL, adaptive, with the fourth order
+ *                        continuous extension of Hairer's DOPRI5 (dense_correction)
+ *      FixedROS34PW2<N>  Rosenbrock-W 3(2) of Rang & Angermann (2005), adaptive,
+ *                        one Jacobian and LU factorisation per step
+ *      FixedROS34PW2<N, true>  the same W-method keeping its Jacobian for several
+ *                        steps and its factorisation while the step is unchanged
+ *      FixedAutoSwitch<N> DoPri54 or ROS34PW2 (W mode), switched on a stiffness
+ *                        estimate with hysteresis]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef FIXED_SIZE_INTEGRATORS_H
+#define FIXED_SIZE_INTEGRATORS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace Integration {
+
+template<class Integrator, class Model>
+struct BindModel {
+    using type = Integrator;
+};
+
+template<class Integrator, class Model>
+    requires requires { typename Integrator::template Bind<Model>; }
+struct BindModel<Integrator, Model> {
+    using type = typename Integrator::template Bind<Model>;
+};
+
+// Base class of a model on Integrator: a fixed size integrator bound to Model, unless it
+// is bound to a model already; any other integrator as it is
+template<class Integrator, class Model>
+using Bind = typename BindModel<Integrator, Model>::type;
+
+// Model of an integrator: the one it is bound to, else the given one
+template<class Bound, class Model>
+using ModelOf = std::conditional_t<std::is_void_v<Bound>, Model, Bound>;
+
+// In place LU factorisation with partial pivoting of a row-major N x N matrix
+template<int N>
+class LuFactor {
+
+    public:
+        // False if the matrix is numerically singular
+        bool factor(std::array<double, N * N>& A) {
+            for (int k = 0; k < N; ++k) {
+                int pivot = k;
+                for (int i = k + 1; i < N; ++i) {
+                    if (std::abs(A[i * N + k]) > std::abs(A[pivot * N + k])) pivot = i;
+                }
+                m_Pivot[k] = pivot;
+                if (A[pivot * N + k] == 0.0) return false;
+                if (pivot != k) {
+                    for (int j = 0; j < N; ++j) std::swap(A[k * N + j], A[pivot * N + j]);
+                }
+                const double inverse = 1.0 / A[k * N + k];
+                for (int i = k + 1; i < N; ++i) {
+                    const double l = A[i * N + k] * inverse;
+                    A[i * N + k] = l;
+                    for (int j = k + 1; j < N; ++j) A[i * N + j] -= l * A[k * N + j];
+                }
+            }
+            return true;
+        }
+
+        // Overwrite b with the solution of A x = b for the factored A
+        void solve(const std::array<double, N * N>& LU, double* b) const {
+            for (int k = 0; k < N; ++k) std::swap(b[k], b[m_Pivot[k]]);
+            for (int k = 0; k < N; ++k) {
+                for (int i = k + 1; i < N; ++i) b[i] -= LU[i * N + k] * b[k];
+            }
+            for (int i = N - 1; i >= 0; --i) {
+                double s = b[i];
+                for (int j = i + 1; j < N; ++j) s -= LU[i * N + j] * b[j];
+                b[i] = s / LU[i * N + i];
+            }
+        }
+
+    private:
+        std::array<int, N> m_Pivot{};
+};
+
+// State, counters and the step loops. Stepper supplies attempt(h), which leaves the
+// candidate solution in m_Next and returns its scaled error (<= 1 accepts), and
+// accepted(h, f), which may hand over the derivative at the new solution. Model derives
+// from Stepper and supplies ode_fun, optionally ode_jac and after_step.
+// The stage kernels below work on this class and are its friends.
+template<int N, class Stepper, class Model>
+class FixedSizeIntegrator {
+
+    public:
+        using State = std::array<double, N>;
+
+        explicit FixedSizeIntegrator(int neq) {
+            if (neq != N) {
+                throw std::invalid_argument("Integrator built for " + std::to_string(N) + " states, model has " +
+                                            std::to_string(neq));
+            }
+        }
+
+        FixedSizeIntegrator(const FixedSizeIntegrator&) = delete;
+        FixedSizeIntegrator& operator=(const FixedSizeIntegrator&) = delete;
+
+        // Forward differences; models with an analytic Jacobian hide this with their own
+        void ode_jac(double* solin, double** Jout) {
+            State f0;
+            State f1;
+            State x;
+            for (int i = 0; i < N; ++i) x[i] = solin[i];
+            model().ode_fun(x.data(), f0.data());
+            for (int j = 0; j < N; ++j) {
+                const double xj = x[j];
+                const double h = std::sqrt(2.2e-16) * std::max(1.0, std::abs(xj));
+                x[j] = xj + h;
+                model().ode_fun(x.data(), f1.data());
+                x[j] = xj;
+                for (int i = 0; i < N; ++i) Jout[i][j] = (f1[i] - f0[i]) / h;
+            }
+            m_Nfev += N + 1;
+        }
+
+        void after_step(double /*t*/) {}
+
+        void set_sol(int i, double x) {
+            m_Sol[i] = x;
+            m_DerivativeValid = false;
+        }
+        double get_sol(int i) const { return m_Sol[i]; }
+
+        double get_t() const { return m_T; }
+        void set_t(double t) { m_T = t; }
+
+        long get_nstep() const { return m_Nstep; }
+        long get_nrej() const { return m_Nrej; }
+        long get_nfev() const { return m_Nfev; }
+        long get_njac() const { return m_Njac; }
+        long get_nlu() const { return m_Nlu; }
+
+        void set_reltol(double tol) { m_RelTol = tol; }
+        void set_abstol(double tol) { m_AbsTol = tol; }
+
+        // Only the first n states enter the error norm; the others follow the steps
+        // these take (variational equations, Variational.h)
+        void set_error_count(int n) { m_ErrorCount = std::clamp(n, 1, N); }
+
+        // One accepted step of at most hmax with error control, starting from the step the
+        // controller proposed after the previous call (dt0 the first time); returns its
+        // length. Unlike solve_adaptive nothing forces the step to end at a given time.
+        double step_adaptive(double hmax, double dt0) {
+            double h = std::min(m_Proposed > 0.0 ? m_Proposed : dt0, hmax);
+            double next = h;
+            while (!controlledStep(h, next)) {
+                h = next;
+            }
+            m_Proposed = next;
+            return h;
+        }
+
+        // tint in equal steps of about dt, the last one shortened to land on t + tint
+        void solve_fixed(double tint, double dt) {
+            const double end = m_T + tint;
+            while (m_T < end) {
+                const double h = std::min(dt, end - m_T);
+                stepper().attempt(h);
+                accept(h);
+                if (end - m_T < 1e-12 * std::max(1.0, std::abs(end))) m_T = end;
+            }
+        }
+
+    protected:
+        template<int> friend class DoPri54Stages;
+        template<int, bool> friend class ROS34PW2Stages;
+
+        Stepper& stepper() { return static_cast<Stepper&>(*this); }
+
+        // Deduced so that an unbound integrator (Model void) stays a complete type
+        auto& model() { return static_cast<Model&>(*this); }
+
+        // Step after an accepted one; steppers that reuse factorisations may keep h
+        double nextStep(double /*h*/, double proposed) const { return proposed; }
+
+        // Derivative at m_Sol, reused while the solution has not been touched (FSAL)
+        const State& derivative() {
+            if (!m_DerivativeValid) {
+                model().ode_fun(m_Sol.data(), m_F.data());
+                ++m_Nfev;
+                m_DerivativeValid = true;
+            }
+            return m_F;
+        }
+
+        // Accepted steps move the candidate into the solution
+        void accept(double h) {
+            m_Sol = m_Next;
+            m_T += h;
+            ++m_Nstep;
+            m_DerivativeValid = stepper().accepted(h, m_F);
+            model().after_step(m_T);
+        }
+
+        // Root mean square of the error weighted by the tolerances
+        double errorNorm(const State& error) const {
+            double sum = 0.0;
+            for (int i = 0; i < m_ErrorCount; ++i) {
+                const double scale = m_AbsTol + m_RelTol * std::max(std::abs(m_Sol[i]), std::abs(m_Next[i]));
+                const double e = error[i] / scale;
+                sum += e * e;
+            }
+            return std::sqrt(sum / m_ErrorCount);
+        }
+
+        // One attempt of length h, accepted when its scaled error is at most 1; next is the
+        // step to try after it. The step size exponent 1 / (q + 1) for an embedded order q
+        // comes from the stepper.
+        bool controlledStep(double h, double& next) {
+            const double exponent = stepper().errorExponent();
+            const double error = stepper().attempt(h);
+            const double factor = error > 0.0 ? std::clamp(0.9 * std::pow(error, -exponent), 0.2, 5.0) : 5.0;
+            if (error <= 1.0) {
+                accept(h);
+                next = stepper().nextStep(h, h * factor);
+                return true;
+            }
+            ++m_Nrej;
+            next = h * std::min(factor, 0.9);
+            if (next < 1e-14 * std::max(1.0, std::abs(m_T))) {
+                throw std::runtime_error("Step size underflow at t = " + std::to_string(m_T));
+            }
+            return false;
+        }
+
+        // tint with error control, starting from dt0; the step never passes t + tint
+        void solveAdaptive(double tint, double dt0) {
+            const double end = m_T + tint;
+            double h = dt0;
+            while (m_T < end) {
+                const bool last = m_T + h >= end;
+                const double taken = last ? end - m_T : h;
+                if (controlledStep(taken, h) && last) m_T = end;
+            }
+        }
+
+        State m_Sol{};
+        State m_Next{};
+        State m_F{};
+        double m_T = 0.0;
+
+        double m_RelTol = 1e-6;
+        double m_AbsTol = 1e-6;
+        int m_ErrorCount = N;
+
+        long m_Nstep = 0;
+        long m_Nrej = 0;
+        long m_Nfev = 0;
+        long m_Njac = 0;
+        long m_Nlu = 0;
+
+    private:
+        bool m_DerivativeValid = false;
+        double m_Proposed = 0.0; // next step of step_adaptive, 0 before the first
+};
+
+template<int N, class Model = void>
+class FixedRK4 : public FixedSizeIntegrator<N, FixedRK4<N, Model>, Model> {
+
+        using Base = FixedSizeIntegrator<N, FixedRK4<N, Model>, Model>;
+        friend Base;
+
+    public:
+        template<class Derived>
+        using Bind = FixedRK4<N, ModelOf<Model, Derived>>;
+
+        explicit FixedRK4(int neq) : Base(neq) {}
+
+    private:
+        double attempt(double h) {
+            const auto& k1 = this->derivative();
+            for (int i = 0; i < N; ++i) m_Y[i] = this->m_Sol[i] + 0.5 * h * k1[i];
+            this->model().ode_fun(m_Y.data(), m_K2.data());
+            for (int i = 0; i < N; ++i) m_Y[i] = this->m_Sol[i] + 0.5 * h * m_K2[i];
+            this->model().ode_fun(m_Y.data(), m_K3.data());
+            for (int i = 0; i < N; ++i) m_Y[i] = this->m_Sol[i] + h * m_K3[i];
+            this->model().ode_fun(m_Y.data(), m_K4.data());
+            this->m_Nfev += 3;
+            for (int i = 0; i < N; ++i) {
+                this->m_Next[i] = this->m_Sol[i] + h / 6.0 * (k1[i] + 2.0 * (m_K2[i] + m_K3[i]) + m_K4[i]);
+            }
+            return 0.0;
+        }
+
+        bool accepted(double, typename Base::State&) { return false; }
+
+        typename Base::State m_Y{};
+        typename Base::State m_K2{};
+        typename Base::State m_K3{};
+        typename Base::State m_K4{};
+};
+
+// Stages of Dormand-Prince 5(4) on a FixedSizeIntegrator
+template<int N>
+class DoPri54Stages {
+
+    public:
+        using State = std::array<double, N>;
+
+        static constexpr double ErrorExponent = 0.2;
+
+        template<class Integrator>
+        double attempt(Integrator& integrator, double h) {
+            const State& sol = integrator.m_Sol;
+            State& next = integrator.m_Next;
+            // Kept for the continuous extension; the integrator's copy becomes k7 (FSAL)
+            m_K[0] = integrator.derivative();
+            m_H = h;
+            const State& k1 = m_K[0];
+            for (int i = 0; i < N; ++i) m_Y[i] = sol[i] + h * (1.0 / 5.0) * k1[i];
+            integrator.model().ode_fun(m_Y.data(), m_K[1].data());
+            for (int i = 0; i < N; ++i) m_Y[i] = sol[i] + h * (3.0 / 40.0 * k1[i] + 9.0 / 40.0 * m_K[1][i]);
+            integrator.model().ode_fun(m_Y.data(), m_K[2].data());
+            for (int i = 0; i < N; ++i) {
+                m_Y[i] = sol[i] + h * (44.0 / 45.0 * k1[i] - 56.0 / 15.0 * m_K[1][i] + 32.0 / 9.0 * m_K[2][i]);
+            }
+            integrator.model().ode_fun(m_Y.data(), m_K[3].data());
+            for (int i = 0; i < N; ++i) {
+                m_Y[i] = sol[i] + h * (19372.0 / 6561.0 * k1[i] - 25360.0 / 2187.0 * m_K[1][i] +
+                                       64448.0 / 6561.0 * m_K[2][i] - 212.0 / 729.0 * m_K[3][i]);
+            }
+            integrator.model().ode_fun(m_Y.data(), m_K[4].data());
+            for (int i = 0; i < N; ++i) {
+                m_Y[i] = sol[i] + h * (9017.0 / 3168.0 * k1[i] - 355.0 / 33.0 * m_K[1][i] + 46732.0 / 5247.0 * m_K[2][i] +
+                                       49.0 / 176.0 * m_K[3][i] - 5103.0 / 18656.0 * m_K[4][i]);
+            }
+            integrator.model().ode_fun(m_Y.data(), m_K[5].data());
+            for (int i = 0; i < N; ++i) {
+                next[i] = sol[i] + h * (35.0 / 384.0 * k1[i] + 500.0 / 1113.0 * m_K[2][i] + 125.0 / 192.0 * m_K[3][i] -
+                                        2187.0 / 6784.0 * m_K[4][i] + 11.0 / 84.0 * m_K[5][i]);
+            }
+            integrator.model().ode_fun(next.data(), m_K[6].data());
+            integrator.m_Nfev += 6;
+
+            // Fifth minus fourth order solution
+            for (int i = 0; i < N; ++i) {
+                m_Error[i] = h * (71.0 / 57600.0 * k1[i] - 71.0 / 16695.0 * m_K[2][i] + 71.0 / 1920.0 * m_K[3][i] -
+                                  17253.0 / 339200.0 * m_K[4][i] + 22.0 / 525.0 * m_K[5][i] - 1.0 / 40.0 * m_K[6][i]);
+            }
+            return integrator.errorNorm(m_Error);
+        }
+
+        // Derivative at the new solution: the last stage
+        const State& lastStage() const { return m_K[6]; }
+
+        // Fifth coefficient of the continuous extension of the last attempted step (Hairer,
+        // Norsett & Wanner, DOPRI5 CONTD5). With y0, y1 and the end derivatives k1, k7 it
+        // gives the fourth order interpolant that DenseOutput.h evaluates.
+        void denseCorrection(double* out) const {
+            constexpr double d1 = -12715105075.0 / 11282082432.0;
+            constexpr double d3 = 87487479700.0 / 32700410799.0;
+            constexpr double d4 = -10690763975.0 / 1880347072.0;
+            constexpr double d5 = 701980252875.0 / 199316789632.0;
+            constexpr double d6 = -1453857185.0 / 822651844.0;
+            constexpr double d7 = 69997945.0 / 29380423.0;
+            for (int i = 0; i < N; ++i) {
+                out[i] = m_H * (d1 * m_K[0][i] + d3 * m_K[2][i] + d4 * m_K[3][i] + d5 * m_K[4][i] + d6 * m_K[5][i] +
+                                d7 * m_K[6][i]);
+            }
+        }
+
+        // h |lambda| of the dominant eigenvalue from the last two stages, both taken at
+        // the step end (Hairer & Wanner II.10); the method is stable up to about 3.3
+        double stiffness(const State& next, double h) const {
+            double numerator = 0.0;
+            double denominator = 0.0;
+            for (int i = 0; i < N; ++i) {
+                numerator += (m_K[6][i] - m_K[5][i]) * (m_K[6][i] - m_K[5][i]);
+                denominator += (next[i] - m_Y[i]) * (next[i] - m_Y[i]);
+            }
+            return denominator > 0.0 ? h * std::sqrt(numerator / denominator) : 0.0;
+        }
+
+    private:
+        State m_Y{};
+        State m_Error{};
+        std::array<State, 7> m_K{};
+        double m_H = 0.0;
+};
+
+template<int N, class Model = void>
+class FixedDoPri54 : public FixedSizeIntegrator<N, FixedDoPri54<N, Model>, Model> {
+
+        using Base = FixedSizeIntegrator<N, FixedDoPri54<N, Model>, Model>;
+        friend Base;
+
+    public:
+        template<class Derived>
+        using Bind = FixedDoPri54<N, ModelOf<Model, Derived>>;
+
+        explicit FixedDoPri54(int neq) : Base(neq) {}
+
+        void solve_adaptive(double tint, double dt0, bool = true) { this->solveAdaptive(tint, dt0); }
+
+        // Continuous extension of the last accepted step; always available
+        bool dense_correction(double* out) const {
+            m_Stages.denseCorrection(out);
+            return true;
+        }
+
+    private:
+        double errorExponent() const { return DoPri54Stages<N>::ErrorExponent; }
+        double attempt(double h) { return m_Stages.attempt(*this, h); }
+
+        bool accepted(double, typename Base::State& f) {
+            f = m_Stages.lastStage();
+            return true;
+        }
+
+        DoPri54Stages<N> m_Stages;
+};
+
+// Coefficients of ROS34PW2 in the transformed form (Hairer & Wanner IV.7) that needs
+// no Jacobian-vector products: (I / (h gamma) - W) U_i = f(y + sum a_ij U_j) + sum c_ij / h U_j
+struct ROS34PW2Coefficients {
+    static constexpr int Stages = 4;
+    static constexpr double Gamma = 4.3586652150845900e-01;
+
+    std::array<std::array<double, Stages>, Stages> a{};
+    std::array<std::array<double, Stages>, Stages> c{};
+    std::array<double, Stages> m{};
+    std::array<double, Stages> e{};  // m minus the embedded solution
+
+    constexpr ROS34PW2Coefficients() {
+        const double alpha[Stages][Stages] = {{0.0, 0.0, 0.0, 0.0},
+                                              {8.7173304301691801e-01, 0.0, 0.0, 0.0},
+                                              {8.4457060015369423e-01, -1.1299064236484185e-01, 0.0, 0.0},
+                                              {0.0, 0.0, 1.0, 0.0}};
+        const double gamma[Stages][Stages] = {{Gamma, 0.0, 0.0, 0.0},
+                                              {-8.7173304301691801e-01, Gamma, 0.0, 0.0},
+                                              {-9.0338057013044082e-01, 5.4180672388095326e-02, Gamma, 0.0},
+                                              {2.4212380706095346e-01, -1.2232505839045147e+00, 5.4526025533510214e-01, Gamma}};
+        const double b[Stages] = {2.4212380706095346e-01, -1.2232505839045147e+00, 1.5452602553351020e+00, Gamma};
+        const double bHat[Stages] = {3.7810903145819369e-01, -9.6042292212423178e-02, 0.5, 2.1793326075422950e-01};
+
+        // Inverse of the lower triangular gamma by forward substitution
+        double inverse[Stages][Stages] = {};
+        for (int j = 0; j < Stages; ++j) {
+            for (int i = j; i < Stages; ++i) {
+                double s = i == j ? 1.0 : 0.0;
+                for (int k = j; k < i; ++k) s -= gamma[i][k] * inverse[k][j];
+                inverse[i][j] = s / gamma[i][i];
+            }
+        }
+        for (int i = 0; i < Stages; ++i) {
+            for (int j = 0; j < Stages; ++j) {
+                for (int k = 0; k < Stages; ++k) a[i][j] += alpha[i][k] * inverse[k][j];
+                c[i][j] = i == j ? 0.0 : -inverse[i][j];
+                m[j] += b[i] * inverse[i][j];
+                e[j] += (b[i] - bHat[i]) * inverse[i][j];
+            }
+        }
+    }
+};
+
+// Stages of ROS34PW2 on a FixedSizeIntegrator, with the Jacobian and the factored
+// iteration matrix I / (h gamma) - J. ReuseJacobian selects the W mode: the Jacobian
+// is refreshed only after a rejected step or MaxJacobianAge accepted ones, and the
+// factorisation only when h changes, with h held while the controller would grow
+// it by less than 20 %. The method keeps its order for any Jacobian approximation,
+// so a stale one costs step size, not accuracy.
+template<int N, bool ReuseJacobian>
+class ROS34PW2Stages {
+
+    public:
+        using State = std::array<double, N>;
+
+        static constexpr double ErrorExponent = 1.0 / 3.0;
+
+        ROS34PW2Stages() {
+            for (int i = 0; i < N; ++i) m_JacobianRows[i] = m_Jacobian.data() + i * N;
+        }
+
+        // The Jacobian rows point into this object
+        ROS34PW2Stages(const ROS34PW2Stages&) = delete;
+        ROS34PW2Stages& operator=(const ROS34PW2Stages&) = delete;
+
+        void setMaxJacobianAge(int steps) { m_MaxJacobianAge = steps; }
+        void refreshJacobian() { m_JacobianAge = -1; }
+
+        double nextStep(double h, double proposed) const {
+            if (ReuseJacobian && proposed >= h && proposed <= 1.2 * h) {
+                return h;
+            }
+            return proposed;
+        }
+
+        template<class Integrator>
+        double attempt(Integrator& integrator, double h) {
+            const State& sol = integrator.m_Sol;
+            prepare(integrator, h);
+            for (int s = 0; s < Stages; ++s) {
+                if (s == 0) {
+                    m_U[0] = integrator.derivative();
+                } else {
+                    for (int i = 0; i < N; ++i) {
+                        double y = sol[i];
+                        for (int j = 0; j < s; ++j) y += Coefficients.a[s][j] * m_U[j][i];
+                        m_Y[i] = y;
+                    }
+                    integrator.model().ode_fun(m_Y.data(), m_U[s].data());
+                    ++integrator.m_Nfev;
+                    for (int i = 0; i < N; ++i) {
+                        double sum = 0.0;
+                        for (int j = 0; j < s; ++j) sum += Coefficients.c[s][j] * m_U[j][i];
+                        m_U[s][i] += sum / h;
+                    }
+                }
+                m_Lu.solve(m_Matrix, m_U[s].data());
+            }
+            for (int i = 0; i < N; ++i) {
+                double y = sol[i];
+                double error = 0.0;
+                for (int s = 0; s < Stages; ++s) {
+                    y += Coefficients.m[s] * m_U[s][i];
+                    error += Coefficients.e[s] * m_U[s][i];
+                }
+                integrator.m_Next[i] = y;
+                m_Error[i] = error;
+            }
+            const double norm = integrator.errorNorm(m_Error);
+            if (norm > 1.0) {
+                // A rejection with a Jacobian from an earlier step asks for a fresh one
+                if (m_JacobianAge > 0) m_JacobianAge = -1;
+            } else {
+                ++m_JacobianAge;
+            }
+            return norm;
+        }
+
+        // Spectral radius of the current Jacobian by power iteration. The geometric mean
+        // of two successive growth ratios also converges for a +-lambda pair, which is
+        // what the [0 I; G 0] Jacobian of the translational dynamics has.
+        double spectralRadius() const {
+            State v;
+            for (int i = 0; i < N; ++i) v[i] = 1.0 + 0.1 * i;
+            double previous = 0.0;
+            double ratio = 0.0;
+            for (int iteration = 0; iteration < 10; ++iteration) {
+                State w{};
+                for (int i = 0; i < N; ++i) {
+                    for (int j = 0; j < N; ++j) w[i] += m_Jacobian[i * N + j] * v[j];
+                }
+                double norm = 0.0;
+                double length = 0.0;
+                for (int i = 0; i < N; ++i) {
+                    norm += w[i] * w[i];
+                    length += v[i] * v[i];
+                }
+                if (norm == 0.0) return 0.0;
+                previous = ratio;
+                ratio = std::sqrt(norm / length);
+                for (int i = 0; i < N; ++i) v[i] = w[i] / std::sqrt(norm);
+            }
+            return std::sqrt(previous * ratio);
+        }
+
+    private:
+        static constexpr ROS34PW2Coefficients Coefficients{};
+        static constexpr int Stages = ROS34PW2Coefficients::Stages;
+
+        template<class Integrator>
+        void prepare(Integrator& integrator, double h) {
+            if (!ReuseJacobian || m_JacobianAge < 0 || m_JacobianAge >= m_MaxJacobianAge) {
+                integrator.model().ode_jac(integrator.m_Sol.data(), m_JacobianRows.data());
+                ++integrator.m_Njac;
+                m_JacobianAge = 0;
+                m_FactoredStep = 0.0;
+            }
+            if (h != m_FactoredStep) {
+                const double diagonal = 1.0 / (h * ROS34PW2Coefficients::Gamma);
+                for (int i = 0; i < N * N; ++i) m_Matrix[i] = -m_Jacobian[i];
+                for (int i = 0; i < N; ++i) m_Matrix[i * N + i] += diagonal;
+                if (!m_Lu.factor(m_Matrix)) {
+                    throw std::runtime_error("Singular iteration matrix at t = " + std::to_string(integrator.m_T));
+                }
+                ++integrator.m_Nlu;
+                m_FactoredStep = h;
+            }
+        }
+
+        State m_Y{};
+        State m_Error{};
+        std::array<State, Stages> m_U{};
+        std::array<double, N * N> m_Jacobian{};
+        std::array<double*, N> m_JacobianRows{};
+        std::array<double, N * N> m_Matrix{};
+        LuFactor<N> m_Lu;
+        double m_FactoredStep = 0.0;
+        int m_JacobianAge = -1;  // accepted steps since the Jacobian, -1 for none
+        int m_MaxJacobianAge = 20;
+};
+
+template<int N, bool ReuseJacobian = false, class Model = void>
+class FixedROS34PW2 : public FixedSizeIntegrator<N, FixedROS34PW2<N, ReuseJacobian, Model>, Model> {
+
+        using Base = FixedSizeIntegrator<N, FixedROS34PW2<N, ReuseJacobian, Model>, Model>;
+        friend Base;
+
+    public:
+        template<class Derived>
+        using Bind = FixedROS34PW2<N, ReuseJacobian, ModelOf<Model, Derived>>;
+
+        explicit FixedROS34PW2(int neq) : Base(neq) {}
+
+        void solve_adaptive(double tint, double dt0, bool = true) { this->solveAdaptive(tint, dt0); }
+
+        // Accepted steps a Jacobian is used for in the W mode
+        void set_max_jacobian_age(int steps) { m_Stages.setMaxJacobianAge(steps); }
+
+        // Force a fresh Jacobian on the next step, e.g. after the inputs change
+        void refresh_jacobian() { m_Stages.refreshJacobian(); }
+
+    private:
+        double errorExponent() const { return ROS34PW2Stages<N, ReuseJacobian>::ErrorExponent; }
+        double attempt(double h) { return m_Stages.attempt(*this, h); }
+        double nextStep(double h, double proposed) const { return m_Stages.nextStep(h, proposed); }
+        bool accepted(double, typename Base::State&) { return false; }
+
+        ROS34PW2Stages<N, ReuseJacobian> m_Stages;
+};
+
+// DoPri54 while the problem is non-stiff, ROS34PW2 in the W mode while it is stiff.
+// Explicit steps estimate h |lambda| from their last two stages; SwitchSteps
+// accepted steps above StiffLimit (step size bound by stability, not accuracy; the
+// controller settles near h |lambda| = 3.1 there) switch to the Rosenbrock method. Implicit steps take the spectral radius of their
+// Jacobian; SwitchSteps steps with h rho below NonStiffLimit, well inside the
+// explicit stability region, switch back. The gap between the two limits and the
+// step count are the hysteresis.
+template<int N, class Model = void>
+class FixedAutoSwitch : public FixedSizeIntegrator<N, FixedAutoSwitch<N, Model>, Model> {
+
+        using Base = FixedSizeIntegrator<N, FixedAutoSwitch<N, Model>, Model>;
+        friend Base;
+
+    public:
+        template<class Derived>
+        using Bind = FixedAutoSwitch<N, ModelOf<Model, Derived>>;
+
+        struct SwitchEvent {
+            double time;
+            bool toStiff;
+        };
+
+        static constexpr int EventCapacity = 64;
+
+        explicit FixedAutoSwitch(int neq) : Base(neq) {}
+
+        void solve_adaptive(double tint, double dt0, bool = true) { this->solveAdaptive(tint, dt0); }
+
+        void set_switch_limits(double stiffLimit, double nonStiffLimit, int switchSteps) {
+            m_StiffLimit = stiffLimit;
+            m_NonStiffLimit = nonStiffLimit;
+            m_SwitchSteps = switchSteps;
+        }
+
+        void refresh_jacobian() { m_Implicit.refreshJacobian(); }
+
+        // Continuous extension of the last accepted step, only when it was explicit
+        bool dense_correction(double* out) const {
+            if (!m_LastExplicit) return false;
+            m_Explicit.denseCorrection(out);
+            return true;
+        }
+
+        bool is_stiff() const { return m_Stiff; }
+        long get_nswitch() const { return m_Switches; }
+        double get_explicit_time() const { return m_ExplicitTime; }
+        double get_implicit_time() const { return m_ImplicitTime; }
+
+        // The latest switches, oldest first, at most EventCapacity of them
+        int get_nevent() const { return static_cast<int>(std::min<long>(m_Switches, EventCapacity)); }
+        SwitchEvent get_event(int i) const {
+            const long first = std::max<long>(0, m_Switches - EventCapacity);
+            return m_Events[(first + i) % EventCapacity];
+        }
+
+    private:
+        double errorExponent() const {
+            return m_Stiff ? ROS34PW2Stages<N, true>::ErrorExponent : DoPri54Stages<N>::ErrorExponent;
+        }
+
+        double attempt(double h) {
+            return m_Stiff ? m_Implicit.attempt(*this, h) : m_Explicit.attempt(*this, h);
+        }
+
+        double nextStep(double h, double proposed) const {
+            return m_Stiff ? m_Implicit.nextStep(h, proposed) : proposed;
+        }
+
+        bool accepted(double h, typename Base::State& f) {
+            m_LastExplicit = !m_Stiff;
+            if (m_Stiff) {
+                m_ImplicitTime += h;
+                count(h * m_Implicit.spectralRadius() < m_NonStiffLimit);
+                return false;
+            }
+            m_ExplicitTime += h;
+            count(m_Explicit.stiffness(this->m_Sol, h) > m_StiffLimit);
+            f = m_Explicit.lastStage();
+            return true;
+        }
+
+        // As in Hairer's DOPRI5, the count restarts only after ResetSteps contrary steps
+        // in a row: at the stability limit the controller alternates around the bound
+        void count(bool other) {
+            if (other) {
+                m_Contrary = 0;
+                if (++m_Count >= m_SwitchSteps) toggle();
+            } else if (++m_Contrary >= ResetSteps) {
+                m_Count = 0;
+                m_Contrary = 0;
+            }
+        }
+
+        void toggle() {
+            m_Stiff = !m_Stiff;
+            m_Count = 0;
+            m_Contrary = 0;
+            if (m_Stiff) m_Implicit.refreshJacobian();
+            m_Events[m_Switches % EventCapacity] = {this->m_T, m_Stiff};
+            ++m_Switches;
+        }
+
+        static constexpr int ResetSteps = 6;
+
+        DoPri54Stages<N> m_Explicit;
+        ROS34PW2Stages<N, true> m_Implicit;
+
+        bool m_Stiff = false;
+        bool m_LastExplicit = false; // method of the last accepted step
+        int m_Count = 0;     // steps pointing at the other method
+        int m_Contrary = 0;  // consecutive steps since the last of them
+        double m_StiffLimit = 2.5;
+        double m_NonStiffLimit = 1.0;
+        int m_SwitchSteps = 15;
+
+        long m_Switches = 0;
+        double m_ExplicitTime = 0.0;
+        double m_ImplicitTime = 0.0;
+        std::array<SwitchEvent, EventCapacity> m_Events{};
+};
+
+} // namespace Integration
+
+#endif // FIXED_SIZE_INTEGRATORS_H
@@ -46,8 +46,8 @@ constexpr std::array<T, 3> calculateGravitationalAcceleration(T x, T y, T z) {
     // Gravitational acceleration factor
     T factor = GM / (r2 * r);
 
-    // J2 correction factor
-    T factorJ2 = 1.5 * J2 * GM * Re * Re / (r2 * r * r);
+    // J2 correction factor, 1.5 * J2 * (Re / r)^2
+    T factorJ2 = 1.5 * J2 * Re * Re / r2;
 
     // Gravitational acceleration in x, y, and z directions
     T ax = -factor * x * (1 - factorJ2 * (5 * z * z / r2 - 1));
@@ -57,6 +57,142 @@ constexpr std::array<T, 3> calculateGravitationalAcceleration(T x, T y, T z) {
     return {ax, ay, az};
 }
 
+// The J2 term of calculateGravitationalAcceleration alone, without the central term;
+// for formulations that carry the central attraction separately (Encke)
+template<ValidPosition T>
+constexpr std::array<T, 3> calculateJ2Perturbation(T x, T y, T z) {
+    T r2 = x * x + y * y + z * z;
+    T r = std::sqrt(r2);
+    T factor = GM / (r2 * r) * 1.5 * J2 * Re * Re / r2;
+    T u2 = 5 * z * z / r2;
+
+    return {factor * x * (u2 - 1), factor * y * (u2 - 1), factor * z * (u2 - 3)};
+}
+
+// Unnormalised zonal harmonics J2..J6 (EGM96), indexed by degree
+constexpr std::array<double, 7> Jn = {0.0, 0.0, J2, -2.53265648533e-6, -1.61962159137e-6, -2.27296082869e-7, 5.40681239107e-7};
+
+// Acceleration together with the gravity-gradient tensor d(a_i)/d(x_j), which is symmetric
+template<ValidPosition T>
+struct AccelerationAndGradient {
+    std::array<T, 3> acceleration;
+    std::array<std::array<T, 3>, 3> gradient;
+};
+
+namespace detail {
+
+// One step of the Legendre recursion, unrolled at compile time up to degree N.
+// On entry P = P_n(u), Pm1 = P_{n-1}(u), dP = P'_n(u), dPm1 = P'_{n-1}(u), rhoN = (Re/r)^n.
+// Accumulates A += Jn rho^n P'_{n+1}(u) and B += Jn rho^n P'_n(u).
+template<int n, int N, ValidPosition T>
+constexpr void zonalTerms(T u, T rho, T rhoN, T P, T Pm1, T dP, T dPm1, T& A, T& B) {
+    T dPp1 = dPm1 + T(2 * n + 1) * P;
+    A += T(Jn[n]) * rhoN * dPp1;
+    B += T(Jn[n]) * rhoN * dP;
+    if constexpr (n < N) {
+        constexpr T inverse = T(1) / T(n + 1);
+        T Pp1 = (T(2 * n + 1) * u * P - T(n) * Pm1) * inverse;
+        zonalTerms<n + 1, N>(u, rho, rhoN * rho, Pp1, P, dPp1, dP, A, B);
+    }
+}
+
+// Same recursion carrying P''_n as well, for the gravity gradient. Accumulates the sums
+// S[0] = sum Jn rho^n P'_{n+1}, S[1] = sum Jn rho^n P'_n, S[2] = sum Jn rho^n P''_{n+1},
+// S[3] = sum Jn rho^n P''_n, S[4] = sum n Jn rho^n P'_{n+1}, S[5] = sum n Jn rho^n P'_n.
+template<int n, int N, ValidPosition T>
+constexpr void zonalGradientTerms(T u, T rho, T rhoN, T P, T Pm1, T dP, T dPm1, T d2P, T d2Pm1, std::array<T, 6>& S) {
+    T dPp1 = dPm1 + T(2 * n + 1) * P;
+    T d2Pp1 = d2Pm1 + T(2 * n + 1) * dP;
+    T w = T(Jn[n]) * rhoN;
+    S[0] += w * dPp1;
+    S[1] += w * dP;
+    S[2] += w * d2Pp1;
+    S[3] += w * d2P;
+    S[4] += T(n) * w * dPp1;
+    S[5] += T(n) * w * dP;
+    if constexpr (n < N) {
+        constexpr T inverse = T(1) / T(n + 1);
+        T Pp1 = (T(2 * n + 1) * u * P - T(n) * Pm1) * inverse;
+        zonalGradientTerms<n + 1, N>(u, rho, rhoN * rho, Pp1, P, dPp1, dP, d2Pp1, d2P, S);
+    }
+}
+
+} // namespace detail
+
+// Zonal gravity field J2..JN with the Legendre recursion unrolled for a fixed N:
+// a = -GM/r^2 * [ r_hat * (1 - sum Jn rho^n P'_{n+1}(u)) + z_hat * sum Jn rho^n P'_n(u) ],
+// with u = z/r and rho = Re/r. Zonal<2> is the J2 model above.
+template<int N>
+struct Zonal {
+    static_assert(N >= 2 && N < static_cast<int>(Jn.size()), "Zonal harmonics are available for J2..J6");
+
+    template<ValidPosition T>
+    static constexpr std::array<T, 3> calculateGravitationalAcceleration(T x, T y, T z) {
+        T r2 = x * x + y * y + z * z;
+        T r = std::sqrt(r2);
+        T u = z / r;
+        T rho = T(Re) / r;
+
+        T A = 0;
+        T B = 0;
+        detail::zonalTerms<2, N>(u, rho, rho * rho, (T(3) * u * u - T(1)) * T(0.5), u, T(3) * u, T(1), A, B);
+
+        T factor = T(GM) / (r2 * r);
+        T radial = T(1) - A;
+
+        return {-factor * x * radial, -factor * y * radial, -factor * (z * radial + r * B)};
+    }
+
+    // Acceleration and gravity gradient from one pass of the recursion. With
+    // a = -GM * [ r_vec * A / r^3 + z_hat * B / r^2 ], A = 1 - sum Jn rho^n P'_{n+1}:
+    // G_ij = -GM/r^3 * [ A (d_ij - 3 e_i e_j) + e_i (A_u (d_jz - u e_j) - A_rho e_j)
+    //                    + d_iz (B_u (d_jz - u e_j) - (B_rho + 2 B) e_j) ]
+    // where e = r_hat and X_u, X_rho = rho * dX/drho are partial derivatives.
+    template<ValidPosition T>
+    static constexpr AccelerationAndGradient<T> calculateGravityGradient(T x, T y, T z) {
+        T r2 = x * x + y * y + z * z;
+        T r = std::sqrt(r2);
+        T u = z / r;
+        T rho = T(Re) / r;
+
+        std::array<T, 6> S{};
+        detail::zonalGradientTerms<2, N>(u, rho, rho * rho, (T(3) * u * u - T(1)) * T(0.5), u, T(3) * u, T(1), T(3), T(0), S);
+
+        T A = T(1) - S[0];
+        T B = S[1];
+        T Au = -S[2];
+        T Bu = S[3];
+        T Arho = -S[4];
+        T Brho = S[5];
+
+        T factor = T(GM) / (r2 * r);
+        const std::array<T, 3> e = {x / r, y / r, u};
+
+        AccelerationAndGradient<T> result{};
+        result.acceleration = {-factor * x * A, -factor * y * A, -factor * (z * A + r * B)};
+
+        for (int i = 0; i < 3; ++i) {
+            for (int j = i; j < 3; ++j) {
+                T dij = (i == j) ? T(1) : T(0);
+                T djz = (j == 2) ? T(1) : T(0);
+                T g = A * (dij - T(3) * e[i] * e[j]) + e[i] * (Au * (djz - u * e[j]) - Arho * e[j]);
+                if (i == 2) {
+                    g += Bu * (djz - u * e[j]) - (Brho + T(2) * B) * e[j];
+                }
+                result.gradient[i][j] = -factor * g;
+                result.gradient[j][i] = -factor * g;
+            }
+        }
+        return result;
+    }
+};
+
+// Closed form J2 acceleration and gravity gradient (3x3 symmetric tensor) sharing one set of terms
+template<ValidPosition T>
+constexpr AccelerationAndGradient<T> calculateGravityGradient(T x, T y, T z) {
+    return Zonal<2>::calculateGravityGradient(x, y, z);
+}
+
 } // namespace J2
 
 #endif // GRAVITATIONAL_MODELS_H
\ No newline at end of file
@@ -0,0 +1,414 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [GravityFieldCache.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Interpolating cache in front of an expensive gravity model.
+ *  Space is covered by an unbounded octree of cubic cells; a cell holds the
+ *  acceleration and gravity gradient of the model at 4x4x4 equispaced nodes and
+ *  is interpolated with tricubic Lagrange polynomials. The point mass term is
+ *  subtracted before interpolation and added back analytically, so only the
+ *  smooth disturbing field is tabulated. Cells are built on demand: a new cell is
+ *  checked against the model at nine points and split into its children when the
+ *  acceleration or gradient error exceeds its tolerance. Leaf cells are evicted
+ *  least recently used once the capacity is reached; the markers of split cells
+ *  hold no table and are kept, so an evicted region is rebuilt at its final level
+ *  without repeating the refinement. One cache can be shared by several model
+ *  instances (and threads) of the same process.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef GRAVITY_FIELD_CACHE_H
+#define GRAVITY_FIELD_CACHE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "SphericalHarmonicGravity.h"
+
+namespace SphericalHarmonics {
+
+struct CacheSettings {
+    double tolerance = 1e-8;       // acceleration error accepted from interpolation [m/s^2]
+    double gradientTolerance = 1e-11; // gravity gradient error accepted from interpolation [1/s^2]
+    double rootCellSize = 1.0e6;   // edge of the level 0 cells [m]
+    int maxLevel = 10;             // cells are not split beyond rootCellSize / 2^maxLevel
+    std::size_t capacity = 65536;  // leaf cells kept before least recently used ones are evicted
+};
+
+struct CacheStatistics {
+    std::uint64_t hits = 0;        // evaluations served by an existing cell
+    std::uint64_t misses = 0;      // cells built
+    std::uint64_t refinements = 0; // cells rejected by the error check and split
+    std::uint64_t evictions = 0;
+    std::size_t cells = 0;         // leaf cells currently held
+    std::size_t refinedCells = 0;  // markers of split cells currently held
+};
+
+class GravityFieldCache {
+
+    public:
+        // The model returns acceleration and gradient at an Earth fixed position; it is only
+        // called while building cells, one call at a time, so it need not be thread safe.
+        using Model = std::function<AccelerationAndGradient(double, double, double)>;
+
+        GravityFieldCache(Model model, double GM, const CacheSettings& settings = {})
+            : m_Model(std::move(model)), m_GM(GM), m_Settings(settings) {
+            if (!(settings.tolerance > 0.0) || !(settings.gradientTolerance > 0.0) || !(settings.rootCellSize > 0.0) || settings.maxLevel < 0 || settings.maxLevel > 40 ||
+                settings.capacity == 0) {
+                throw std::invalid_argument("Invalid gravity field cache settings");
+            }
+        }
+
+        // Cache shared by everyone asking for the same key while at least one user holds it.
+        // The factory is only called when no live cache exists for the key.
+        static std::shared_ptr<GravityFieldCache> shared(const std::string& key, const std::function<std::shared_ptr<GravityFieldCache>()>& factory) {
+            static std::mutex mutex;
+            static std::map<std::string, std::weak_ptr<GravityFieldCache>> registry;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (auto existing = registry[key].lock()) {
+                return existing;
+            }
+            auto cache = factory();
+            registry[key] = cache;
+            return cache;
+        }
+
+        // Registry key of a cache for the given model description and settings. The doubles are
+        // written with 17 significant digits so that distinct error targets never share a cache.
+        static std::string sharedKey(const std::string& model, const CacheSettings& settings) {
+            char buffer[128];
+            std::snprintf(buffer, sizeof(buffer), "|%.17g|%.17g|%.17g|%d|%zu", settings.tolerance, settings.gradientTolerance,
+                          settings.rootCellSize, settings.maxLevel, settings.capacity);
+            return model + buffer;
+        }
+
+        std::array<double, 3> acceleration(double x, double y, double z) {
+            return accelerationAndGradient(x, y, z).acceleration;
+        }
+
+        AccelerationAndGradient accelerationAndGradient(double x, double y, double z) {
+            AccelerationAndGradient result = pointMass(x, y, z);
+            std::array<double, Components> disturbance;
+
+            for (int level = 0; level <= m_Settings.maxLevel; ++level) {
+                const Key key = keyOf(x, y, z, level);
+                {
+                    std::shared_lock<std::shared_mutex> lock(m_Mutex);
+                    auto it = m_Cells.find(key);
+                    if (it != m_Cells.end()) {
+                        Cell& cell = *it->second;
+                        if (cell.refined) {
+                            continue;
+                        }
+                        touch(cell);
+                        interpolate(cell, key, x, y, z, disturbance);
+                        m_Hits[stripe()].count.fetch_add(1, std::memory_order_relaxed);
+                        return add(result, disturbance);
+                    }
+                }
+
+                // Build outside the lock; if another thread got there first its cell is kept
+                auto built = build(key);
+                m_Misses.fetch_add(1, std::memory_order_relaxed);
+                if (built->refined) {
+                    m_Refinements.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                std::unique_lock<std::shared_mutex> lock(m_Mutex);
+                if (!built->refined && m_Leaves >= m_Settings.capacity) {
+                    evict();
+                }
+                auto [inserted, added] = m_Cells.emplace(key, std::move(built));
+                Cell& cell = *inserted->second;
+                if (added && !cell.refined) {
+                    ++m_Leaves;
+                    m_Epoch.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (cell.refined) {
+                    continue;
+                }
+                touch(cell);
+                interpolate(cell, key, x, y, z, disturbance);
+                return add(result, disturbance);
+            }
+            // Unreachable: cells at maxLevel are never refined
+            throw std::logic_error("Gravity field cache failed to resolve a cell");
+        }
+
+        CacheStatistics statistics() const {
+            CacheStatistics s;
+            for (const auto& stripe : m_Hits) {
+                s.hits += stripe.count.load(std::memory_order_relaxed);
+            }
+            s.misses = m_Misses.load(std::memory_order_relaxed);
+            s.refinements = m_Refinements.load(std::memory_order_relaxed);
+            s.evictions = m_Evictions.load(std::memory_order_relaxed);
+            std::shared_lock<std::shared_mutex> lock(m_Mutex);
+            s.cells = m_Leaves;
+            s.refinedCells = m_Cells.size() - m_Leaves;
+            return s;
+        }
+
+        // Drop every cell, e.g. after the model changed; statistics are kept
+        void clear() {
+            std::unique_lock<std::shared_mutex> lock(m_Mutex);
+            m_Cells.clear();
+            m_Leaves = 0;
+        }
+
+        const CacheSettings& settings() const { return m_Settings; }
+
+    private:
+        // Acceleration (3) and the upper triangle of the gradient (6) at each node
+        static constexpr int Components = 9;
+        static constexpr int Nodes = 4;
+
+        struct Key {
+            int level;
+            std::int64_t i;
+            std::int64_t j;
+            std::int64_t k;
+            bool operator==(const Key& other) const { return level == other.level && i == other.i && j == other.j && k == other.k; }
+        };
+
+        struct KeyHash {
+            std::size_t operator()(const Key& key) const {
+                std::uint64_t h = static_cast<std::uint64_t>(key.level) * 0x9E3779B97F4A7C15ull;
+                for (std::int64_t v : {key.i, key.j, key.k}) {
+                    h ^= static_cast<std::uint64_t>(v) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+                }
+                return static_cast<std::size_t>(h);
+            }
+        };
+
+        struct Cell {
+            bool refined = false;  // too coarse; look in the children
+            std::atomic<std::uint64_t> lastUse{0}; // epoch of the last interpolation, leaves only
+            std::vector<double> values; // Nodes^3 * Components, x fastest
+        };
+
+        // The age of a leaf is the number of leaves built since its last use: hits only read the
+        // epoch and write a cell at most once per epoch, so hot cells stay shared between threads.
+        void touch(Cell& cell) const {
+            const std::uint64_t epoch = m_Epoch.load(std::memory_order_relaxed);
+            if (cell.lastUse.load(std::memory_order_relaxed) != epoch) {
+                cell.lastUse.store(epoch, std::memory_order_relaxed);
+            }
+        }
+
+        // Hits are counted on one of several cache lines picked by thread, not on one shared line
+        static constexpr std::size_t HitStripes = 16;
+
+        struct alignas(64) HitCounter {
+            std::atomic<std::uint64_t> count{0};
+        };
+
+        static std::size_t stripe() {
+            return std::hash<std::thread::id>{}(std::this_thread::get_id()) % HitStripes;
+        }
+
+        double cellSize(int level) const { return std::ldexp(m_Settings.rootCellSize, -level); }
+
+        Key keyOf(double x, double y, double z, int level) const {
+            const double h = cellSize(level);
+            return {level, static_cast<std::int64_t>(std::floor(x / h)), static_cast<std::int64_t>(std::floor(y / h)),
+                    static_cast<std::int64_t>(std::floor(z / h))};
+        }
+
+        AccelerationAndGradient pointMass(double x, double y, double z) const {
+            const double r2 = x * x + y * y + z * z;
+            const double r = std::sqrt(r2);
+            const double factor = m_GM / (r2 * r);
+            const std::array<double, 3> p = {x, y, z};
+
+            AccelerationAndGradient result{};
+            for (int i = 0; i < 3; ++i) {
+                result.acceleration[i] = -factor * p[i];
+                for (int j = i; j < 3; ++j) {
+                    result.gradient[i][j] = factor * (3.0 * p[i] * p[j] / r2 - (i == j ? 1.0 : 0.0));
+                    result.gradient[j][i] = result.gradient[i][j];
+                }
+            }
+            return result;
+        }
+
+        // Model minus point mass, packed as acceleration and gradient upper triangle
+        std::array<double, Components> disturbingField(double x, double y, double z) {
+            AccelerationAndGradient full;
+            {
+                std::lock_guard<std::mutex> lock(m_ModelMutex);
+                full = m_Model(x, y, z);
+            }
+            const AccelerationAndGradient central = pointMass(x, y, z);
+            return {full.acceleration[0] - central.acceleration[0], full.acceleration[1] - central.acceleration[1],
+                    full.acceleration[2] - central.acceleration[2], full.gradient[0][0] - central.gradient[0][0],
+                    full.gradient[0][1] - central.gradient[0][1], full.gradient[0][2] - central.gradient[0][2],
+                    full.gradient[1][1] - central.gradient[1][1], full.gradient[1][2] - central.gradient[1][2],
+                    full.gradient[2][2] - central.gradient[2][2]};
+        }
+
+        // Cubic Lagrange weights on the nodes 0, 1/3, 2/3, 1 of the unit interval
+        static std::array<double, Nodes> weights(double t) {
+            const double s = 3.0 * t;
+            return {-(s - 1.0) * (s - 2.0) * (s - 3.0) / 6.0, s * (s - 2.0) * (s - 3.0) / 2.0, -s * (s - 1.0) * (s - 3.0) / 2.0,
+                    s * (s - 1.0) * (s - 2.0) / 6.0};
+        }
+
+        void interpolate(const Cell& cell, const Key& key, double x, double y, double z, std::array<double, Components>& out) const {
+            const double h = cellSize(key.level);
+            const auto wx = weights(x / h - static_cast<double>(key.i));
+            const auto wy = weights(y / h - static_cast<double>(key.j));
+            const auto wz = weights(z / h - static_cast<double>(key.k));
+
+            out.fill(0.0);
+            const double* v = cell.values.data();
+            for (int k = 0; k < Nodes; ++k) {
+                for (int j = 0; j < Nodes; ++j) {
+                    const double wjk = wy[j] * wz[k];
+                    for (int i = 0; i < Nodes; ++i, v += Components) {
+                        const double w = wx[i] * wjk;
+                        for (int c = 0; c < Components; ++c) {
+                            out[c] += w * v[c];
+                        }
+                    }
+                }
+            }
+        }
+
+        std::unique_ptr<Cell> build(const Key& key) {
+            auto cell = std::make_unique<Cell>();
+            const double h = cellSize(key.level);
+            const double x0 = static_cast<double>(key.i) * h;
+            const double y0 = static_cast<double>(key.j) * h;
+            const double z0 = static_cast<double>(key.k) * h;
+
+            cell->values.resize(Nodes * Nodes * Nodes * Components);
+            double* v = cell->values.data();
+            for (int k = 0; k < Nodes; ++k) {
+                for (int j = 0; j < Nodes; ++j) {
+                    for (int i = 0; i < Nodes; ++i, v += Components) {
+                        const auto node = disturbingField(x0 + h * i / 3.0, y0 + h * j / 3.0, z0 + h * k / 3.0);
+                        std::copy(node.begin(), node.end(), v);
+                    }
+                }
+            }
+            if (key.level == m_Settings.maxLevel) {
+                return cell;
+            }
+
+            // Error check at the centre and at the centres of the eight octants
+            std::array<double, Components> interpolated;
+            for (int c = 0; c < 9; ++c) {
+                const double fx = (c == 8) ? 0.5 : 0.25 + 0.5 * (c & 1);
+                const double fy = (c == 8) ? 0.5 : 0.25 + 0.5 * ((c >> 1) & 1);
+                const double fz = (c == 8) ? 0.5 : 0.25 + 0.5 * ((c >> 2) & 1);
+                const double x = x0 + fx * h;
+                const double y = y0 + fy * h;
+                const double z = z0 + fz * h;
+                const auto exact = disturbingField(x, y, z);
+                interpolate(*cell, key, x, y, z, interpolated);
+                double accelerationError = 0.0;
+                for (int n = 0; n < 3; ++n) {
+                    accelerationError += (interpolated[n] - exact[n]) * (interpolated[n] - exact[n]);
+                }
+                // Frobenius norm of the symmetric tensor; off-diagonal entries count twice
+                double gradientError = 0.0;
+                for (int n = 3; n < Components; ++n) {
+                    const double e = interpolated[n] - exact[n];
+                    gradientError += (n == 3 || n == 6 || n == 8 ? 1.0 : 2.0) * e * e;
+                }
+                if (std::sqrt(accelerationError) > m_Settings.tolerance || std::sqrt(gradientError) > m_Settings.gradientTolerance) {
+                    cell->refined = true;
+                    cell->values.clear();
+                    cell->values.shrink_to_fit();
+                    break;
+                }
+            }
+            return cell;
+        }
+
+        // Drop the least recently used eighth of the leaf cells; called with the unique lock held.
+        // Refined markers stay: they are small and spare the refinement when the region is revisited.
+        void evict() {
+            std::vector<std::pair<std::uint64_t, Key>> ages;
+            ages.reserve(m_Leaves);
+            for (const auto& [key, cell] : m_Cells) {
+                if (!cell->refined) {
+                    ages.emplace_back(cell->lastUse.load(std::memory_order_relaxed), key);
+                }
+            }
+            if (ages.empty()) {
+                return;
+            }
+            const std::size_t count = std::max<std::size_t>(1, ages.size() / 8);
+            std::nth_element(ages.begin(), ages.begin() + (count - 1), ages.end(),
+                             [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (std::size_t n = 0; n < count; ++n) {
+                m_Cells.erase(ages[n].second);
+            }
+            m_Leaves -= count;
+            m_Evictions.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        static AccelerationAndGradient add(AccelerationAndGradient result, const std::array<double, Components>& d) {
+            result.acceleration[0] += d[0];
+            result.acceleration[1] += d[1];
+            result.acceleration[2] += d[2];
+            const int row[6] = {0, 0, 0, 1, 1, 2};
+            const int col[6] = {0, 1, 2, 1, 2, 2};
+            for (int c = 0; c < 6; ++c) {
+                result.gradient[row[c]][col[c]] += d[3 + c];
+                if (row[c] != col[c]) {
+                    result.gradient[col[c]][row[c]] += d[3 + c];
+                }
+            }
+            return result;
+        }
+
+        Model m_Model;
+        std::mutex m_ModelMutex;
+        double m_GM;
+        CacheSettings m_Settings;
+
+        mutable std::shared_mutex m_Mutex;
+        std::unordered_map<Key, std::unique_ptr<Cell>, KeyHash> m_Cells;
+        std::size_t m_Leaves = 0; // cells of m_Cells holding a table
+
+        std::atomic<std::uint64_t> m_Epoch{0}; // leaves built so far, the clock of the eviction order
+        std::array<HitCounter, HitStripes> m_Hits;
+        std::atomic<std::uint64_t> m_Misses{0};
+        std::atomic<std::uint64_t> m_Refinements{0};
+        std::atomic<std::uint64_t> m_Evictions{0};
+};
+
+} // namespace SphericalHarmonics
+
+#endif // GRAVITY_FIELD_CACHE_H
@@ -0,0 +1,337 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [IntegratorSelection.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Run time choice of the libode integrator behind a DynamicModel<Integrator>.
+ *  Every supported specialisation is an alternative of one std::variant; select()
+ *  constructs the chosen one in place at initialisation and each communication
+ *  step is a single std::visit, inside which the model type is static. Needs the
+ *  libode headers on the include path.
+ *  In the stepping mode (start/advanceTo) the integrator runs in segments of its own
+ *  length, carried from one call to the next, and states at communication points
+ *  come from the dense output of the current segment (DenseOutput.h). Integrators
+ *  with step_adaptive (FixedSizeIntegrators.h) take one natural step per segment,
+ *  never forced onto a segment end; FixedDoPri54 interpolates with its own
+ *  continuous extension. Otherwise the segment is interpolated by a cubic Hermite,
+ *  and for the adaptive methods a segment whose Hermite error estimate exceeds the
+ *  tolerances is taken again, shorter, so outputs between steps keep the accuracy
+ *  the tolerance parameters ask for.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef INTEGRATOR_SELECTION_H
+#define INTEGRATOR_SELECTION_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "DenseOutput.h"
+#include "FixedSizeIntegrators.h"
+
+#include "ode_rk_4.h"
+#include "ode_dopri_54.h"
+#include "ode_dopri_87.h"
+#include "ode_grk4a.h"
+#include "ode_row6a.h"
+#include "ode_radau_iia.h"
+
+namespace Integration {
+
+// Values of the FMU "integrator" parameter
+enum class Method : int {
+    RK4 = 0,       // explicit, fixed step
+    DoPri54 = 1,   // explicit, adaptive
+    DoPri87 = 2,   // explicit, adaptive, high order
+    GRK4A = 3,     // Rosenbrock, adaptive
+    ROW6A = 4,     // Rosenbrock, adaptive
+    RadauIIA = 5,  // fully implicit, adaptive
+    FixedDoPri54 = 6,   // FixedSizeIntegrators.h, explicit, adaptive
+    FixedROS34PW2 = 7,  // FixedSizeIntegrators.h, Rosenbrock-W, adaptive
+    FixedROS34PW2Reuse = 8,  // the same, reusing its Jacobian and factorisation
+    FixedAutoSwitch = 9,     // FixedDoPri54 or FixedROS34PW2Reuse by stiffness
+};
+
+// Whether a value of the "integrator" parameter names a method
+constexpr bool isMethod(int value) {
+    return value >= static_cast<int>(Method::RK4) && value <= static_cast<int>(Method::FixedAutoSwitch);
+}
+
+struct StepSettings {
+    double relativeTolerance = 1e-10;
+    double absoluteTolerance = 1e-6;
+    double fixedStep = 1.0;   // substep of the fixed step methods [s]
+    double maxStep = 60.0;    // longest segment between dense output updates [s]
+};
+
+template<class Integrator>
+concept Adaptive = requires(Integrator& integrator, double t) { integrator.solve_adaptive(t, t); };
+
+// Integrators that can take a single step of their own length
+template<class Integrator>
+concept NaturalSteps = requires(Integrator& integrator, double t) { integrator.step_adaptive(t, t); };
+
+template<template<class> class Model>
+class IntegratorSelection {
+
+        static constexpr int StateCount = Model<OdeRK4>::StateCount;
+
+        // States in the error norms; variational equations (Variational.h) follow the nominal ones
+        static constexpr int ErrorCount = [] {
+            if constexpr (requires { Model<OdeRK4>::NominalCount; }) {
+                return Model<OdeRK4>::NominalCount;
+            } else {
+                return StateCount;
+            }
+        }();
+
+    public:
+        using Variant = std::variant<Model<OdeRK4>, Model<OdeDoPri54>, Model<OdeDoPri87>, Model<OdeGRK4A>, Model<OdeROW6A>,
+                                     Model<OdeRadauIIA>, Model<FixedDoPri54<StateCount>>, Model<FixedROS34PW2<StateCount>>,
+                                     Model<FixedROS34PW2<StateCount, true>>, Model<FixedAutoSwitch<StateCount>>>;
+
+        // Construct the model for a method in place, discarding the current one and its state
+        void select(Method method) {
+            switch (method) {
+                case Method::RK4: m_Model.template emplace<0>(); break;
+                case Method::DoPri54: m_Model.template emplace<1>(); break;
+                case Method::DoPri87: m_Model.template emplace<2>(); break;
+                case Method::GRK4A: m_Model.template emplace<3>(); break;
+                case Method::ROW6A: m_Model.template emplace<4>(); break;
+                case Method::RadauIIA: m_Model.template emplace<5>(); break;
+                case Method::FixedDoPri54: m_Model.template emplace<6>(); break;
+                case Method::FixedROS34PW2: m_Model.template emplace<7>(); break;
+                case Method::FixedROS34PW2Reuse: m_Model.template emplace<8>(); break;
+                case Method::FixedAutoSwitch: m_Model.template emplace<9>(); break;
+                default: throw std::invalid_argument("Unknown integrator " + std::to_string(static_cast<int>(method)));
+            }
+        }
+
+        void select(int method) { select(static_cast<Method>(method)); }
+
+        Method method() const { return static_cast<Method>(m_Model.index()); }
+
+        // Run a generic callable on the active model, e.g. [&](auto& model) { model.Force = f; }
+        template<class Visitor>
+        decltype(auto) visit(Visitor&& visitor) {
+            return std::visit(std::forward<Visitor>(visitor), m_Model);
+        }
+
+        // Integrate over tint: adaptive methods start from dt0, fixed step methods take
+        // the fewest equal steps not longer than fixed_step
+        void advance(double tint, double dt0, double fixed_step) {
+            visit([&](auto& model) { advance(model, tint, dt0, fixed_step); });
+        }
+
+        template<class M>
+        static void advance(M& model, double tint, double dt0, double fixed_step) {
+            if constexpr (Adaptive<M>) {
+                model.solve_adaptive(tint, dt0);
+            } else {
+                const double steps = std::max(1.0, std::ceil(tint / fixed_step - 1e-9));
+                model.solve_fixed(tint, tint / steps);
+            }
+        }
+
+        // Begin stepping at time from the state currently held by the model
+        void start(double time, const StepSettings& settings) {
+            m_Settings = settings;
+            m_Time = time;
+            m_Step = std::min(settings.fixedStep, settings.maxStep);
+            visit([&](auto& model) {
+                if constexpr (Adaptive<std::decay_t<decltype(model)>>) {
+                    model.set_reltol(settings.relativeTolerance);
+                    model.set_abstol(settings.absoluteTolerance);
+                }
+                for (int i = 0; i < StateCount; ++i) m_Y[i] = model.get_sol(i);
+            });
+            m_Dense.reset(time, m_Y.data());
+            m_Output = m_Y;
+            m_HermiteLimit = std::numeric_limits<double>::infinity();
+            m_ThirdSpan = 0.0;
+        }
+
+        // State at time >= the previous request. Segments end wherever the integrator
+        // takes them; the next segment is sized from the substeps the last one needed.
+        const std::vector<double>& advanceTo(double time) {
+            const double eps = 1e-12 * std::max(1.0, std::abs(time));
+            while (m_Time < time - eps) {
+                visit([&](auto& model) { segment(model); });
+            }
+            m_Dense.evaluate(time, m_Output.data());
+            return m_Output;
+        }
+
+        // The inputs are about to change at time: bring the integrator back from the end
+        // of the segment to time by integrating the segment start, with the old inputs.
+        // Methods that keep a Jacobian take a fresh one on the next step.
+        void restart(double time) {
+            if (time < m_Time) {
+                const double t0 = m_Dense.start();
+                visit([&](auto& model) {
+                    rewind(model, m_Dense.startState().data(), m_Time - t0);
+                    if (time > t0) {
+                        advance(model, time - t0, std::min(m_Step, time - t0), m_Settings.fixedStep);
+                    }
+                    for (int i = 0; i < StateCount; ++i) m_Y[i] = model.get_sol(i);
+                });
+                m_Time = std::max(time, t0);
+                m_Dense.reset(m_Time, m_Y.data());
+            }
+            // The new inputs change the derivatives; do not difference across them
+            m_ThirdSpan = 0.0;
+            visit([](auto& model) {
+                if constexpr (requires { model.refresh_jacobian(); }) {
+                    model.refresh_jacobian();
+                }
+            });
+        }
+
+        // Integrator time, at or ahead of the last requested output time
+        double time() const { return m_Time; }
+
+        // Length of the next segment [s]
+        double stepSize() const { return m_Step; }
+
+    private:
+        template<class M>
+        static void setState(M& model, const double* y) {
+            for (int i = 0; i < StateCount; ++i) model.set_sol(i, y[i]);
+        }
+
+        // Hermite error h^4 / 384 |y^(4)| of the segment in m_Dense, scaled by the tolerances
+        // as an integrator error norm. y^(4) is the change of the constant third derivative
+        // from the last accepted Hermite segment over the distance of their midpoints. With
+        // no such segment (start, restart, continuous extension before) the error is h / 3
+        // times the defect rhs(y) - y' of the interpolant at a quarter point, where the
+        // error's slope is y^(4) h^3 / 128; this costs a model evaluation and, being
+        // multiplied by the Jacobian, overestimates on stiff problems, so it is only the
+        // fallback.
+        template<class M>
+        double hermiteError(M& model, double h) {
+            if (m_ThirdSpan > 0.0) {
+                m_Dense.thirdDerivative(m_Work.data());
+                const double scale = h * h * h * h / 384.0 / (0.5 * (h + m_ThirdSpan));
+                for (int i = 0; i < StateCount; ++i) m_Work[i] = scale * (m_Work[i] - m_Third[i]);
+            } else {
+                const double t = m_Dense.start() + 0.25 * h;
+                m_Dense.evaluate(t, m_Output.data());
+                model.ode_fun(m_Output.data(), m_Work.data());
+                m_Dense.derivative(t, m_Output.data());
+                for (int i = 0; i < StateCount; ++i) m_Work[i] = h / 3.0 * (m_Work[i] - m_Output[i]);
+            }
+            double sum = 0.0;
+            for (int i = 0; i < ErrorCount; ++i) {
+                const double e = m_Work[i] / (m_Settings.absoluteTolerance +
+                                              m_Settings.relativeTolerance * std::max(std::abs(m_Y[i]), std::abs(m_Y1[i])));
+                sum += e * e;
+            }
+            return std::sqrt(sum / ErrorCount);
+        }
+
+        // Put the model back to the state y it held dt earlier
+        template<class M>
+        static void rewind(M& model, const double* y, double dt) {
+            setState(model, y);
+            if constexpr (requires { model.set_t(model.get_t()); }) {
+                model.set_t(model.get_t() - dt);
+            }
+        }
+
+        template<class M>
+        void segment(M& model) {
+            // Formulations with a reference solution move it only between segments
+            if constexpr (requires { model.Rectify(); }) {
+                model.Rectify();
+            }
+            for (int i = 0; i < StateCount; ++i) m_Y[i] = model.get_sol(i);
+            model.ode_fun(m_Y.data(), m_F.data());
+
+            for (;;) {
+                double h = m_Step;
+                long taken = 1;
+                if constexpr (NaturalSteps<M>) {
+                    h = model.step_adaptive(std::min(m_Settings.maxStep, m_HermiteLimit), m_Step);
+                } else {
+                    const auto steps = model.get_nstep();
+                    advance(model, h, h, m_Settings.fixedStep);
+                    taken = model.get_nstep() - steps;
+                }
+
+                for (int i = 0; i < StateCount; ++i) m_Y1[i] = model.get_sol(i);
+                model.ode_fun(m_Y1.data(), m_F1.data());
+
+                if constexpr (requires { model.dense_correction(m_Correction.data()); }) {
+                    if (model.dense_correction(m_Correction.data())) {
+                        m_Dense.set(m_Time, m_Y.data(), m_F.data(), m_Time + h, m_Y1.data(), m_F1.data(), m_Correction.data());
+                        m_ThirdSpan = 0.0;
+                        m_Time += h;
+                        return;
+                    }
+                }
+                m_Dense.set(m_Time, m_Y.data(), m_F.data(), m_Time + h, m_Y1.data(), m_F1.data());
+
+                // Fixed step methods have no tolerance to hold the interpolant to
+                if constexpr (Adaptive<M>) {
+                    const double error = hermiteError(model, h);
+                    // Fourth order in h, with the limits of the integrators' step controllers
+                    const double factor = error > 0.0 ? std::clamp(0.9 * std::pow(error, -0.25), 0.2, 2.0) : 2.0;
+                    if (error > 1.0) {
+                        rewind(model, m_Y.data(), h);
+                        m_HermiteLimit = h * std::min(factor, 0.9);
+                        m_Step = std::min(m_Step, m_HermiteLimit);
+                        continue;
+                    }
+                    m_HermiteLimit = h * factor;
+                    m_Dense.thirdDerivative(m_Third.data());
+                    m_ThirdSpan = h;
+                    if constexpr (!NaturalSteps<M>) {
+                        // Aim for one integrator step per segment so the interpolant spans a natural step
+                        const double natural = taken <= 1 ? 2.0 * h : h / static_cast<double>(taken);
+                        m_Step = std::min({natural, m_HermiteLimit, m_Settings.maxStep});
+                    }
+                }
+                m_Time += h;
+                return;
+            }
+        }
+
+        Variant m_Model;
+
+        StepSettings m_Settings;
+        double m_Time = 0.0;
+        double m_Step = 1.0;
+        HermiteStep m_Dense{StateCount};
+        std::vector<double> m_Output = std::vector<double>(StateCount);
+        std::vector<double> m_Y = std::vector<double>(StateCount);
+        std::vector<double> m_F = std::vector<double>(StateCount);
+        std::vector<double> m_Y1 = std::vector<double>(StateCount);
+        std::vector<double> m_F1 = std::vector<double>(StateCount);
+        std::vector<double> m_Correction = std::vector<double>(StateCount);
+        std::vector<double> m_Work = std::vector<double>(StateCount);
+        std::vector<double> m_Third = std::vector<double>(StateCount); // of the last accepted Hermite segment
+        double m_ThirdSpan = 0.0;  // its length, 0 for none
+        double m_HermiteLimit = std::numeric_limits<double>::infinity(); // longest segment the Hermite error allows [s]
+};
+
+} // namespace Integration
+
+#endif // INTEGRATOR_SELECTION_H
@@ -32,7 +32,7 @@
 constexpr double J2000_JULIAN_DATE = 2451545.0;
 
 // Function to calculate Julian Date from a given date
-double dateToJulianDate(int year, int month, int day, int hour, int minute, int second) {
+inline double dateToJulianDate(int year, int month, int day, int hour, int minute, int second) {
 
     // Adjust months and year for Gregorian calendar
     if (month <= 2) {
@@ -52,7 +52,8 @@ double dateToJulianDate(int year, int month, int day, int hour, int minute, int
 }
 
 // Function to calculate time since J2000 epoch in seconds
-double timeSinceJ2000(int year, int month, int day, int hour, int minute, int second) {
+// (the Julian date double resolves ~40 us; see TimeScale::Epoch in Epoch.h for time scales and stepping)
+inline double timeSinceJ2000(int year, int month, int day, int hour, int minute, int second) {
 
     double julianDate = dateToJulianDate(year, month, day, hour, minute, second);
     double timeSinceEpoch = (julianDate - J2000_JULIAN_DATE) * 86400.0; // Convert days to seconds
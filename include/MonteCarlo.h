@@ -0,0 +1,301 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [MonteCarlo.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Building blocks of the Monte Carlo dispersion runner:
+ *      Dispersion        a variable with the distribution it is drawn from, read
+ *                        from a text file, one per line
+ *      WorkStealingPool  runs indices 0..count-1 on a fixed set of threads. Each
+ *                        thread starts on a contiguous block of its own and, once
+ *                        that is drained, steals half of the largest remaining block
+ *                        of another thread, so slow runs do not hold the rest up
+ *      SummaryWriter     appends finished runs to a stream from any thread
+ *  The only shared state while running are one lock per thread, taken once per
+ *  run by its owner and rarely by a thief, and the writer's lock.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Philox.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace MonteCarlo {
+
+/*********************************Dispersions**************************************/
+
+struct Distribution {
+    enum class Kind { Constant, Uniform, Normal };
+
+    Kind kind = Kind::Constant;
+    double a = 0.0; // value, lower bound or mean
+    double b = 0.0; // upper bound or standard deviation
+
+    double sample(Random::Philox& random) const {
+        switch (kind) {
+            case Kind::Uniform: return random.uniform(a, b);
+            case Kind::Normal:  return random.normal(a, b);
+            default:            return a;
+        }
+    }
+};
+
+struct Dispersion {
+    std::string variable;
+    Distribution distribution;
+};
+
+// Reads lines of
+//     <variable> constant <value>
+//     <variable> uniform  <lower> <upper>
+//     <variable> normal   <mean> <standard deviation>
+// Blank lines and everything after '#' are ignored
+inline std::vector<Dispersion> parseDispersions(std::istream& input) {
+    std::vector<Dispersion> dispersions;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+
+        Dispersion dispersion;
+        std::string kind;
+        if (!(fields >> dispersion.variable)) continue;
+
+        const auto fail = [&](const std::string& reason) {
+            return std::invalid_argument("Dispersion line " + std::to_string(lineNumber) + ": " + reason);
+        };
+
+        fields >> kind;
+        Distribution& distribution = dispersion.distribution;
+        if (kind == "constant") {
+            distribution.kind = Distribution::Kind::Constant;
+            if (!(fields >> distribution.a)) throw fail("constant needs a value");
+        } else if (kind == "uniform") {
+            distribution.kind = Distribution::Kind::Uniform;
+            if (!(fields >> distribution.a >> distribution.b)) throw fail("uniform needs lower and upper bounds");
+            if (!(distribution.a < distribution.b)) throw fail("uniform bounds must be increasing");
+        } else if (kind == "normal") {
+            distribution.kind = Distribution::Kind::Normal;
+            if (!(fields >> distribution.a >> distribution.b)) throw fail("normal needs a mean and a standard deviation");
+            if (!(distribution.b > 0.0)) throw fail("standard deviation must be positive");
+        } else {
+            throw fail("unknown distribution '" + kind + "'");
+        }
+
+        std::string extra;
+        if (fields >> extra) throw fail("unexpected '" + extra + "'");
+        dispersions.push_back(dispersion);
+    }
+    return dispersions;
+}
+
+// Values of the dispersed variables in run `run`. Dispersion i draws from the
+// Philox stream (seed, run, i), so the values of a run do not depend on the thread
+// it lands on, the order runs are executed in or the distributions of the others
+inline void sampleRun(const std::vector<Dispersion>& dispersions, std::uint64_t seed, std::uint64_t run,
+                      std::vector<double>& values) {
+    values.resize(dispersions.size());
+    for (std::size_t i = 0; i < dispersions.size(); ++i) {
+        Random::Philox random(seed, run, static_cast<std::uint32_t>(i));
+        values[i] = dispersions[i].distribution.sample(random);
+    }
+}
+
+/*********************************Scheduling***************************************/
+
+// Binds the calling thread to one core; false where unsupported
+inline bool pinToCore(unsigned core) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % CPU_SETSIZE, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)core;
+    return false;
+#endif
+}
+
+class WorkStealingPool {
+
+    public:
+        // threads == 0 takes one thread per hardware thread
+        explicit WorkStealingPool(unsigned threads = 0, bool pinThreads = false)
+            : m_ThreadCount(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+              m_PinThreads(pinThreads) {}
+
+        unsigned threadCount() const { return m_ThreadCount; }
+
+        // Calls task(thread, index) once for every index in [0, count), thread being
+        // the worker number in [0, threadCount()). The calling thread only waits, so it
+        // is never pinned. Returns once all calls have; the first exception a task
+        // throws stops the workers and is rethrown here
+        template<class Task>
+        void run(std::size_t count, Task&& task) {
+            std::vector<Range> ranges(m_ThreadCount);
+            for (unsigned t = 0; t < m_ThreadCount; ++t) {
+                ranges[t].begin = count * t / m_ThreadCount;
+                ranges[t].end = count * (t + 1) / m_ThreadCount;
+            }
+
+            std::mutex errorMutex;
+            std::exception_ptr error;
+            std::atomic<bool> stop{false};
+
+            const auto work = [&](unsigned thread) {
+                if (m_PinThreads) {
+                    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+                    pinToCore(thread % cores);
+                }
+                std::size_t index;
+                while (!stop.load(std::memory_order_relaxed) && next(ranges, thread, index)) {
+                    try {
+                        task(thread, index);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(errorMutex);
+                        if (!error) error = std::current_exception();
+                        stop.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            workers.reserve(m_ThreadCount);
+            for (unsigned t = 0; t < m_ThreadCount; ++t) workers.emplace_back(work, t);
+            for (auto& worker : workers) worker.join();
+
+            if (error) std::rethrow_exception(error);
+        }
+
+    private:
+        // Indices [begin, end) still to run on one thread, on a cache line of its own
+        struct alignas(64) Range {
+            std::mutex mutex;
+            std::size_t begin = 0;
+            std::size_t end = 0;
+        };
+
+        // Next index of `thread`: the front of its own range, otherwise the back half
+        // of the largest range left, which becomes its own
+        static bool next(std::vector<Range>& ranges, unsigned thread, std::size_t& index) {
+            Range& own = ranges[thread];
+            {
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (own.begin < own.end) {
+                    index = own.begin++;
+                    return true;
+                }
+            }
+
+            for (;;) {
+                // The sizes only pick the victim; its range may have shrunk by the time it is locked again
+                std::size_t largest = 0;
+                unsigned victim = thread;
+                for (unsigned t = 0; t < ranges.size(); ++t) {
+                    if (t == thread) continue;
+                    std::lock_guard<std::mutex> lock(ranges[t].mutex);
+                    const std::size_t size = ranges[t].end - ranges[t].begin;
+                    if (size > largest) {
+                        largest = size;
+                        victim = t;
+                    }
+                }
+                if (victim == thread) return false;
+
+                std::size_t begin;
+                std::size_t end;
+                {
+                    std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+                    const std::size_t size = ranges[victim].end - ranges[victim].begin;
+                    if (size == 0) continue;
+                    end = ranges[victim].end;
+                    begin = end - (size + 1) / 2;
+                    ranges[victim].end = begin;
+                }
+
+                std::lock_guard<std::mutex> lock(own.mutex);
+                own.begin = begin + 1;
+                own.end = end;
+                index = begin;
+                return true;
+            }
+        }
+
+        unsigned m_ThreadCount;
+        bool m_PinThreads;
+};
+
+/*********************************Output*******************************************/
+
+// Serialises whole lines from many threads onto one stream, flushing every
+// `flushEvery` lines so that finished runs reach the disk while the rest go on
+class SummaryWriter {
+
+    public:
+        explicit SummaryWriter(std::ostream& output, std::size_t flushEvery = 64)
+            : m_Output(output), m_FlushEvery(std::max<std::size_t>(1, flushEvery)) {}
+
+        ~SummaryWriter() { m_Output.flush(); }
+
+        // `line` without its end of line
+        void write(const std::string& line) {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Output << line << '\n';
+            if (++m_Pending == m_FlushEvery) {
+                m_Output.flush();
+                m_Pending = 0;
+            }
+            ++m_Lines;
+        }
+
+        std::size_t lines() const {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            return m_Lines;
+        }
+
+    private:
+        std::ostream& m_Output;
+        std::size_t m_FlushEvery;
+        std::size_t m_Pending = 0;
+        std::size_t m_Lines = 0;
+        mutable std::mutex m_Mutex;
+};
+
+} // namespace MonteCarlo
+
+#endif // MONTE_CARLO_H
@@ -0,0 +1,265 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [Philox.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Philox4x32-10 counter based random numbers (Salmon et al., Parallel Random
+ *  Numbers: As Easy as 1, 2, 3, SC11). A block of four 32 bit words is a pure
+ *  function of a 128 bit counter and a 64 bit key, so any draw of any stream can be
+ *  computed directly, without state shared between threads:
+ *      key     = seed
+ *      counter = {block, stream, run (low), run (high)}
+ *  Each (seed, run, stream) owns 2^32 blocks. Bulk generation evaluates eight
+ *  blocks at once with AVX2 where the CPU has it (Simd::activeIsa()); the words
+ *  are the same with every kernel.
+ *  Uniform doubles take 52 bits from two words and lie in the open interval (0, 1);
+ *  normal doubles come in Box-Muller pairs from one block.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "BatchKernels.h"
+
+namespace Random {
+
+using Counter = std::array<std::uint32_t, 4>;
+using Key = std::array<std::uint32_t, 2>;
+
+namespace detail {
+
+constexpr std::uint32_t PhiloxM0 = 0xD2511F53;
+constexpr std::uint32_t PhiloxM1 = 0xCD9E8D57;
+constexpr std::uint32_t PhiloxW0 = 0x9E3779B9; // golden ratio
+constexpr std::uint32_t PhiloxW1 = 0xBB67AE85; // sqrt(3) - 1
+constexpr int PhiloxRounds = 10;
+
+// 2^-52, the spacing of the uniform doubles
+constexpr double UniformScale = 1.0 / 4503599627370496.0;
+
+} // namespace detail
+
+// One Philox4x32-10 block
+constexpr Counter philox(Counter counter, Key key) {
+    for (int round = 0; round < detail::PhiloxRounds; ++round) {
+        const std::uint64_t product0 = std::uint64_t(detail::PhiloxM0) * counter[0];
+        const std::uint64_t product1 = std::uint64_t(detail::PhiloxM1) * counter[2];
+        counter = {std::uint32_t(product1 >> 32) ^ counter[1] ^ key[0], std::uint32_t(product1),
+                   std::uint32_t(product0 >> 32) ^ counter[3] ^ key[1], std::uint32_t(product0)};
+        key[0] += detail::PhiloxW0;
+        key[1] += detail::PhiloxW1;
+    }
+    return counter;
+}
+
+// Uniform double in (0, 1) from two words
+constexpr double toUniform(std::uint32_t high, std::uint32_t low) {
+    // 52 bits keep bits + 0.5 exact, so the top word maps strictly below 1
+    const std::uint64_t bits = ((std::uint64_t(high) << 32) | low) >> 12;
+    return (double(bits) + 0.5) * detail::UniformScale;
+}
+
+// Box-Muller: two independent standard normals from two uniforms in (0, 1)
+inline void boxMuller(double u1, double u2, double& z1, double& z2) {
+    const double radius = std::sqrt(-2.0 * std::log(u1));
+    const double angle = 2.0 * M_PI * u2;
+    z1 = radius * std::cos(angle);
+    z2 = radius * std::sin(angle);
+}
+
+namespace detail {
+
+// Words of blocks [first, first + count) of one stream, block after block
+inline void blocksScalar(Counter counter, Key key, std::uint32_t first, std::size_t count, std::uint32_t* words) {
+    for (std::size_t b = 0; b < count; ++b) {
+        counter[0] = first + std::uint32_t(b);
+        const Counter block = philox(counter, key);
+        for (int w = 0; w < 4; ++w) words[4 * b + w] = block[w];
+    }
+}
+
+#ifdef BATCH_KERNELS_X86
+
+// High and low 32 bits of the products of eight lanes with m
+BATCH_TARGET_AVX2 inline void mulhiloAvx2(__m256i a, __m256i m, __m256i& high, __m256i& low) {
+    const __m256i even = _mm256_mul_epu32(a, m);
+    const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+BATCH_TARGET_AVX2 inline void blocksAvx2(Counter counter, Key key, std::uint32_t first, std::size_t count,
+                                         std::uint32_t* words) {
+    const __m256i m0 = _mm256_set1_epi32(int(PhiloxM0));
+    const __m256i m1 = _mm256_set1_epi32(int(PhiloxM1));
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    std::size_t b = 0;
+    for (; b + 8 <= count; b += 8) {
+        __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32(int(first + std::uint32_t(b))), lanes);
+        __m256i c1 = _mm256_set1_epi32(int(counter[1]));
+        __m256i c2 = _mm256_set1_epi32(int(counter[2]));
+        __m256i c3 = _mm256_set1_epi32(int(counter[3]));
+        std::uint32_t k0 = key[0];
+        std::uint32_t k1 = key[1];
+        for (int round = 0; round < PhiloxRounds; ++round) {
+            __m256i high0, low0, high1, low1;
+            mulhiloAvx2(c0, m0, high0, low0);
+            mulhiloAvx2(c2, m1, high1, low1);
+            c0 = _mm256_xor_si256(_mm256_xor_si256(high1, c1), _mm256_set1_epi32(int(k0)));
+            c1 = low1;
+            c2 = _mm256_xor_si256(_mm256_xor_si256(high0, c3), _mm256_set1_epi32(int(k1)));
+            c3 = low0;
+            k0 += PhiloxW0;
+            k1 += PhiloxW1;
+        }
+
+        // Lanes are blocks; interleave back to block order
+        alignas(32) std::uint32_t lane[4][8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lane[0]), c0);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lane[1]), c1);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lane[2]), c2);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lane[3]), c3);
+        for (int l = 0; l < 8; ++l) {
+            for (int w = 0; w < 4; ++w) words[4 * (b + l) + w] = lane[w][l];
+        }
+    }
+    blocksScalar(counter, key, first + std::uint32_t(b), count - b, words + 4 * b);
+}
+
+#endif // BATCH_KERNELS_X86
+
+inline void blocks(Counter counter, Key key, std::uint32_t first, std::size_t count, std::uint32_t* words) {
+#ifdef BATCH_KERNELS_X86
+    if (Simd::activeIsa() >= Simd::Isa::AVX2) {
+        blocksAvx2(counter, key, first, count, words);
+        return;
+    }
+#endif
+    blocksScalar(counter, key, first, count, words);
+}
+
+} // namespace detail
+
+// Draws of one (seed, run, stream). Scalar and bulk calls consume the same words
+// in the same order: uniform() two, a pair of normal() one block of four, so
+// fillUniform(n) equals n calls of uniform() and fillNormal(2n) 2n calls of
+// normal() from the same position.
+class Philox {
+
+    public:
+        Philox(std::uint64_t seed, std::uint64_t run, std::uint32_t stream = 0)
+            : m_Counter{0, stream, std::uint32_t(run), std::uint32_t(run >> 32)},
+              m_Key{std::uint32_t(seed), std::uint32_t(seed >> 32)} {}
+
+        // Next word
+        std::uint32_t bits() {
+            if (m_Word == 4) {
+                m_Block = philox(m_Counter, m_Key);
+                ++m_Counter[0];
+                m_Word = 0;
+            }
+            return m_Block[m_Word++];
+        }
+
+        // Uniform in (0, 1)
+        double uniform() {
+            const std::uint32_t high = bits();
+            return toUniform(high, bits());
+        }
+
+        double uniform(double lower, double upper) { return lower + (upper - lower) * uniform(); }
+
+        // Standard normal; the second of each pair is kept for the next call
+        double normal() {
+            if (m_HasSpare) {
+                m_HasSpare = false;
+                return m_Spare;
+            }
+            const double u1 = uniform();
+            const double u2 = uniform();
+            double z1;
+            boxMuller(u1, u2, z1, m_Spare);
+            m_HasSpare = true;
+            return z1;
+        }
+
+        double normal(double mean, double sigma) { return mean + sigma * normal(); }
+
+        // Next words in bulk
+        void fillBits(std::span<std::uint32_t> out) {
+            std::size_t i = 0;
+            while (i < out.size() && m_Word < 4) out[i++] = m_Block[m_Word++];
+            const std::size_t whole = (out.size() - i) / 4;
+            detail::blocks(m_Counter, m_Key, m_Counter[0], whole, out.data() + i);
+            m_Counter[0] += std::uint32_t(whole);
+            i += 4 * whole;
+            while (i < out.size()) out[i++] = bits();
+        }
+
+        void fillUniform(std::span<double> out, double lower = 0.0, double upper = 1.0) {
+            for (std::size_t begin = 0; begin < out.size(); begin += BatchSize / 2) {
+                const std::size_t n = std::min(BatchSize / 2, out.size() - begin);
+                fillBits(std::span<std::uint32_t>(m_Buffer.data(), 2 * n));
+                for (std::size_t i = 0; i < n; ++i) {
+                    out[begin + i] = lower + (upper - lower) * toUniform(m_Buffer[2 * i], m_Buffer[2 * i + 1]);
+                }
+            }
+        }
+
+        void fillNormal(std::span<double> out, double mean = 0.0, double sigma = 1.0) {
+            std::size_t i = 0;
+            if (m_HasSpare && i < out.size()) out[i++] = mean + sigma * normal();
+            while (i < out.size()) {
+                const std::size_t pairs = std::min(BatchSize / 4, (out.size() - i + 1) / 2);
+                fillBits(std::span<std::uint32_t>(m_Buffer.data(), 4 * pairs));
+                for (std::size_t p = 0; p < pairs; ++p) {
+                    const std::uint32_t* w = m_Buffer.data() + 4 * p;
+                    double z1;
+                    double z2;
+                    boxMuller(toUniform(w[0], w[1]), toUniform(w[2], w[3]), z1, z2);
+                    out[i++] = mean + sigma * z1;
+                    if (i < out.size()) {
+                        out[i++] = mean + sigma * z2;
+                    } else {
+                        m_Spare = z2;
+                        m_HasSpare = true;
+                    }
+                }
+            }
+        }
+
+    private:
+        static constexpr std::size_t BatchSize = 256; // words per bulk call of the kernel
+
+        Counter m_Counter;
+        Key m_Key;
+        Counter m_Block{};
+        int m_Word = 4; // next word of m_Block; 4 when used up
+        double m_Spare = 0.0;
+        bool m_HasSpare = false;
+        std::array<std::uint32_t, BatchSize> m_Buffer;
+};
+
+} // namespace Random
+
+#endif // PHILOX_H
@@ -0,0 +1,113 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [SecularJ2.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Analytic mean element propagation under the secular effect of J2 (Vallado,
+ *  Fundamentals of Astrodynamics and Applications, 9.6):
+ *      raan' = -3/2 n J2 (Re/p)^2 cos i
+ *      argp' =  3/4 n J2 (Re/p)^2 (5 cos^2 i - 1)
+ *      M'    =  n [ 1 + 3/4 J2 (Re/p)^2 sqrt(1 - e^2) (3 cos^2 i - 1) ]
+ *  a, e and i are constant, so the state at any epoch costs one Kepler solve no
+ *  matter how far it is from the initial one. Short periodic terms are not modelled;
+ *  against a numerically integrated J2 orbit in LEO the position is off by 10 to
+ *  30 km, growing only slowly over days, which is enough for coverage and
+ *  visibility studies.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef SECULAR_J2_H
+#define SECULAR_J2_H
+
+#include <cmath>
+
+#include "GravitationalModels.h"
+#include "TwoBody.h"
+
+namespace J2 {
+
+// Mean elements of an osculating state. Only the semi-major axis is corrected, by the
+// first order short periodic term of Brouwer's theory
+//     a_osc - a = J2/2 Re^2/a { (3 cos^2 i - 1) [ (a/r)^3 - (1 - e^2)^(-3/2) ] + 3 sin^2 i (a/r)^3 cos 2u },
+// because it sets the mean motion: left in, it would drift the along-track position
+// by up to tens of kilometres per orbit. The short periodic terms of the other elements
+// only offset the position and are kept.
+inline TwoBody::Elements meanElements(const TwoBody::Vector& r, const TwoBody::Vector& v) {
+    TwoBody::Elements elements = TwoBody::toElements(r, v, GM);
+
+    const double eta2 = 1.0 - elements.e * elements.e;
+    const double nu = TwoBody::trueAnomaly(elements.M, elements.e);
+    const double aOverR = (1.0 + elements.e * std::cos(nu)) / eta2;
+    const double aOverR3 = aOverR * aOverR * aOverR;
+    const double c2 = std::cos(elements.i) * std::cos(elements.i);
+
+    elements.a -= 0.5 * J2 * Re * Re / elements.a *
+                  ((3.0 * c2 - 1.0) * (aOverR3 - 1.0 / (eta2 * std::sqrt(eta2))) +
+                   3.0 * (1.0 - c2) * aOverR3 * std::cos(2.0 * (elements.argp + nu)));
+    return elements;
+}
+
+// Mean elements at epoch with their secular J2 rates; elements() and propagate() jump
+// straight to any time from epoch, forwards or backwards.
+class SecularPropagator {
+
+    public:
+        SecularPropagator() = default;
+
+        explicit SecularPropagator(const TwoBody::Elements& mean) { set(mean); }
+
+        // Start from mean elements at epoch
+        void set(const TwoBody::Elements& mean) {
+            m_Elements = mean;
+
+            const double n = std::sqrt(GM / (mean.a * mean.a * mean.a));
+            const double p = mean.a * (1.0 - mean.e * mean.e);
+            const double k = J2 * Re * Re / (p * p);
+            const double c = std::cos(mean.i);
+            m_RaanRate = -1.5 * n * k * c;
+            m_ArgpRate = 0.75 * n * k * (5.0 * c * c - 1.0);
+            m_MeanAnomalyRate = n * (1.0 + 0.75 * k * std::sqrt(1.0 - mean.e * mean.e) * (3.0 * c * c - 1.0));
+        }
+
+        // Start from an osculating ECI state at epoch
+        void set(const TwoBody::Vector& r, const TwoBody::Vector& v) { set(meanElements(r, v)); }
+
+        // Mean elements dt seconds after epoch
+        TwoBody::Elements elements(double dt) const {
+            TwoBody::Elements elements = m_Elements;
+            elements.raan = TwoBody::wrapAngle(m_Elements.raan + m_RaanRate * dt);
+            elements.argp = TwoBody::wrapAngle(m_Elements.argp + m_ArgpRate * dt);
+            elements.M = TwoBody::wrapAngle(m_Elements.M + m_MeanAnomalyRate * dt);
+            return elements;
+        }
+
+        // ECI position and velocity dt seconds after epoch
+        void propagate(double dt, TwoBody::Vector& r, TwoBody::Vector& v) const {
+            TwoBody::toCartesian(elements(dt), GM, r, v);
+        }
+
+        double raanRate() const { return m_RaanRate; }               // [rad/s]
+        double argpRate() const { return m_ArgpRate; }               // [rad/s]
+        double meanAnomalyRate() const { return m_MeanAnomalyRate; } // [rad/s]
+
+    private:
+        TwoBody::Elements m_Elements;
+        double m_RaanRate = 0.0;
+        double m_ArgpRate = 0.0;
+        double m_MeanAnomalyRate = 0.0;
+};
+
+} // namespace J2
+
+#endif // SECULAR_J2_H
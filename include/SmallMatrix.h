@@ -0,0 +1,165 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [SmallMatrix.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Fixed size 3-vector, 3x3 matrix and quaternion kernels on std::array, for
+ *  right-hand sides that run millions of times: everything lives on the stack and
+ *  is constexpr, so no allocation happens in the integrator loop.
+ *  Quaternions are scalar first, q = (q0, q1, q2, q3), and rotate body vectors into
+ *  the reference frame: v_ref = q (x) v_body (x) q*.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef SMALL_MATRIX_H
+#define SMALL_MATRIX_H
+
+#include <array>
+#include <cmath>
+
+namespace SmallMatrix {
+
+using Vector3 = std::array<double, 3>;
+using Vector4 = std::array<double, 4>;
+using Quaternion = std::array<double, 4>;
+using Matrix3 = std::array<std::array<double, 3>, 3>;
+using Matrix4 = std::array<std::array<double, 4>, 4>;
+using Matrix43 = std::array<std::array<double, 3>, 4>;
+
+constexpr Vector3 add(const Vector3& a, const Vector3& b) { return {a[0] + b[0], a[1] + b[1], a[2] + b[2]}; }
+
+constexpr Vector3 subtract(const Vector3& a, const Vector3& b) { return {a[0] - b[0], a[1] - b[1], a[2] - b[2]}; }
+
+constexpr Vector3 scale(const Vector3& a, double s) { return {a[0] * s, a[1] * s, a[2] * s}; }
+
+constexpr double dot(const Vector3& a, const Vector3& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+constexpr Vector3 cross(const Vector3& a, const Vector3& b) {
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+constexpr Vector3 multiply(const Matrix3& A, const Vector3& x) {
+    return {A[0][0] * x[0] + A[0][1] * x[1] + A[0][2] * x[2],
+            A[1][0] * x[0] + A[1][1] * x[1] + A[1][2] * x[2],
+            A[2][0] * x[0] + A[2][1] * x[1] + A[2][2] * x[2]};
+}
+
+constexpr Matrix3 multiply(const Matrix3& A, const Matrix3& B) {
+    Matrix3 C{};
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            C[i][j] = A[i][0] * B[0][j] + A[i][1] * B[1][j] + A[i][2] * B[2][j];
+        }
+    }
+    return C;
+}
+
+constexpr Matrix3 add(const Matrix3& A, const Matrix3& B) {
+    Matrix3 C{};
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            C[i][j] = A[i][j] + B[i][j];
+        }
+    }
+    return C;
+}
+
+constexpr Matrix3 transpose(const Matrix3& A) {
+    return {{{A[0][0], A[1][0], A[2][0]}, {A[0][1], A[1][1], A[2][1]}, {A[0][2], A[1][2], A[2][2]}}};
+}
+
+// Cross product matrix: skew(a) b = a x b
+constexpr Matrix3 skew(const Vector3& a) { return {{{0.0, -a[2], a[1]}, {a[2], 0.0, -a[0]}, {-a[1], a[0], 0.0}}}; }
+
+constexpr double determinant(const Matrix3& A) {
+    return A[0][0] * (A[1][1] * A[2][2] - A[1][2] * A[2][1]) - A[0][1] * (A[1][0] * A[2][2] - A[1][2] * A[2][0]) +
+           A[0][2] * (A[1][0] * A[2][1] - A[1][1] * A[2][0]);
+}
+
+// Sylvester's criterion: a symmetric A is positive definite iff its leading principal minors are positive
+constexpr bool positiveDefinite(const Matrix3& A) {
+    const bool symmetric = A[0][1] == A[1][0] && A[0][2] == A[2][0] && A[1][2] == A[2][1];
+    return symmetric && A[0][0] > 0.0 && A[0][0] * A[1][1] - A[0][1] * A[1][0] > 0.0 && determinant(A) > 0.0;
+}
+
+// Inverse by cofactors; the caller checks the determinant
+constexpr Matrix3 inverse(const Matrix3& A) {
+    const double d = 1.0 / determinant(A);
+    return {{{(A[1][1] * A[2][2] - A[1][2] * A[2][1]) * d, (A[0][2] * A[2][1] - A[0][1] * A[2][2]) * d, (A[0][1] * A[1][2] - A[0][2] * A[1][1]) * d},
+             {(A[1][2] * A[2][0] - A[1][0] * A[2][2]) * d, (A[0][0] * A[2][2] - A[0][2] * A[2][0]) * d, (A[0][2] * A[1][0] - A[0][0] * A[1][2]) * d},
+             {(A[1][0] * A[2][1] - A[1][1] * A[2][0]) * d, (A[0][1] * A[2][0] - A[0][0] * A[2][1]) * d, (A[0][0] * A[1][1] - A[0][1] * A[1][0]) * d}}};
+}
+
+// Hamilton product p (x) q
+constexpr Quaternion multiply(const Quaternion& p, const Quaternion& q) {
+    return {p[0] * q[0] - p[1] * q[1] - p[2] * q[2] - p[3] * q[3],
+            p[0] * q[1] + p[1] * q[0] + p[2] * q[3] - p[3] * q[2],
+            p[0] * q[2] - p[1] * q[3] + p[2] * q[0] + p[3] * q[1],
+            p[0] * q[3] + p[1] * q[2] - p[2] * q[1] + p[3] * q[0]};
+}
+
+constexpr Quaternion conjugate(const Quaternion& q) { return {q[0], -q[1], -q[2], -q[3]}; }
+
+inline Quaternion normalise(const Quaternion& q) {
+    const double n = 1.0 / std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    return {q[0] * n, q[1] * n, q[2] * n, q[3] * n};
+}
+
+// Rotation matrix of q (body to reference); quadratic in q, exact for |q| = 1
+constexpr Matrix3 rotationMatrix(const Quaternion& q) {
+    const double q00 = q[0] * q[0], q11 = q[1] * q[1], q22 = q[2] * q[2], q33 = q[3] * q[3];
+    const double q01 = q[0] * q[1], q02 = q[0] * q[2], q03 = q[0] * q[3];
+    const double q12 = q[1] * q[2], q13 = q[1] * q[3], q23 = q[2] * q[3];
+    return {{{q00 + q11 - q22 - q33, 2.0 * (q12 - q03), 2.0 * (q13 + q02)},
+             {2.0 * (q12 + q03), q00 - q11 + q22 - q33, 2.0 * (q23 - q01)},
+             {2.0 * (q13 - q02), 2.0 * (q23 + q01), q00 - q11 - q22 + q33}}};
+}
+
+// Derivative of rotationMatrix(q) v with respect to q: column k is d(R v)/dq_k
+constexpr std::array<Vector3, 4> rotationDerivative(const Quaternion& q, const Vector3& v) {
+    const Vector3 qv = {q[1], q[2], q[3]};
+    const Vector3 c = cross(qv, v);
+    const double d = dot(qv, v);
+    std::array<Vector3, 4> D{};
+    D[0] = {2.0 * (q[0] * v[0] + c[0]), 2.0 * (q[0] * v[1] + c[1]), 2.0 * (q[0] * v[2] + c[2])};
+    for (int k = 0; k < 3; ++k) {
+        Vector3 e{};
+        e[k] = 1.0;
+        const Vector3 ev = cross(e, v);
+        for (int i = 0; i < 3; ++i) {
+            D[k + 1][i] = 2.0 * (-qv[k] * v[i] + v[k] * qv[i] + d * e[i] + q[0] * ev[i]);
+        }
+    }
+    return D;
+}
+
+// Kinematics q' = 1/2 Omega(w) q = 1/2 q (x) (0, w) for body rates w
+constexpr Matrix4 omegaMatrix(const Vector3& w) {
+    return {{{0.0, -w[0], -w[1], -w[2]},
+             {w[0], 0.0, w[2], -w[1]},
+             {w[1], -w[2], 0.0, w[0]},
+             {w[2], w[1], -w[0], 0.0}}};
+}
+
+// The same product written as Xi(q) w
+constexpr Matrix43 xiMatrix(const Quaternion& q) {
+    return {{{-q[1], -q[2], -q[3]},
+             {q[0], -q[3], q[2]},
+             {q[3], q[0], -q[1]},
+             {-q[2], q[1], q[0]}}};
+}
+
+} // namespace SmallMatrix
+
+#endif // SMALL_MATRIX_H
@@ -0,0 +1,562 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [SphericalHarmonicGravity.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [High degree spherical harmonic gravity field (EGM96, EGM2008, ...).
+ *  The acceleration is evaluated with the Cunningham V/W recursion written for
+ *  fully normalised coefficients, which is free of the polar singularity and
+ *  stable well beyond degree 360. The recursion runs order by order and keeps
+ *  only a few columns of V/W alive, so the working set stays in cache.
+ *  Coefficients are memory mapped from a binary resources file in which C and S
+ *  are stored as flat, order-major triangular arrays.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef SPHERICAL_HARMONIC_GRAVITY_H
+#define SPHERICAL_HARMONIC_GRAVITY_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SphericalHarmonics {
+
+// Number of coefficients of a triangular array complete to degree `degree`
+constexpr std::size_t triangularSize(int degree) {
+    return static_cast<std::size_t>(degree + 1) * static_cast<std::size_t>(degree + 2) / 2;
+}
+
+// Position of (n, m) in an order-major triangular array complete to degree `degree`.
+// All degrees of one order are contiguous, which is the access pattern of the recursion.
+constexpr std::size_t triangularIndex(int n, int m, int degree) {
+    return static_cast<std::size_t>(m) * static_cast<std::size_t>(degree + 1)
+         - static_cast<std::size_t>(m) * static_cast<std::size_t>(m - 1) / 2
+         + static_cast<std::size_t>(n - m);
+}
+
+// Binary coefficient file layout: header, then C and S as order-major triangles of doubles
+struct FileHeader {
+    char magic[8];        // "EBEKSH1"
+    std::uint32_t degree; // maximum degree stored in the file
+    std::uint32_t reserved;
+    double GM;            // [m^3/s^2]
+    double Re;            // reference radius [m]
+};
+
+constexpr char FileMagic[8] = {'E', 'B', 'E', 'K', 'S', 'H', '1', '\0'};
+
+// Read-only memory mapping of a binary coefficient file
+class CoefficientFile {
+
+    public:
+        explicit CoefficientFile(const std::string& path) {
+#if defined(_WIN32)
+            m_File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (m_File == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error("Unable to open gravity coefficient file '" + path + "'");
+            }
+            LARGE_INTEGER size;
+            GetFileSizeEx(m_File, &size);
+            m_Size = static_cast<std::size_t>(size.QuadPart);
+            m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            m_Data = m_Mapping ? MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (!m_Data) {
+                release();
+                throw std::runtime_error("Unable to map gravity coefficient file '" + path + "'");
+            }
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("Unable to open gravity coefficient file '" + path + "'");
+            }
+            struct stat info {};
+            if (::fstat(fd, &info) != 0) {
+                ::close(fd);
+                throw std::runtime_error("Unable to stat gravity coefficient file '" + path + "'");
+            }
+            m_Size = static_cast<std::size_t>(info.st_size);
+            void* data = m_Size ? ::mmap(nullptr, m_Size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+            ::close(fd);
+            if (data == MAP_FAILED) {
+                throw std::runtime_error("Unable to map gravity coefficient file '" + path + "'");
+            }
+            m_Data = data;
+#endif
+            validate(path);
+        }
+
+        CoefficientFile(const CoefficientFile&) = delete;
+        CoefficientFile& operator=(const CoefficientFile&) = delete;
+
+        ~CoefficientFile() { release(); }
+
+        const FileHeader& header() const { return *static_cast<const FileHeader*>(m_Data); }
+
+        int degree() const { return static_cast<int>(header().degree); }
+
+        const double* C() const {
+            return reinterpret_cast<const double*>(static_cast<const char*>(m_Data) + sizeof(FileHeader));
+        }
+
+        const double* S() const { return C() + triangularSize(degree()); }
+
+    private:
+        void validate(const std::string& path) {
+            if (m_Size < sizeof(FileHeader) || std::memcmp(header().magic, FileMagic, sizeof(FileMagic)) != 0) {
+                release();
+                throw std::runtime_error("'" + path + "' is not a gravity coefficient file");
+            }
+            if (m_Size < sizeof(FileHeader) + 2 * triangularSize(degree()) * sizeof(double)) {
+                release();
+                throw std::runtime_error("Gravity coefficient file '" + path + "' is truncated");
+            }
+        }
+
+        void release() {
+#if defined(_WIN32)
+            if (m_Data) UnmapViewOfFile(m_Data);
+            if (m_Mapping) CloseHandle(m_Mapping);
+            if (m_File != INVALID_HANDLE_VALUE) CloseHandle(m_File);
+            m_Mapping = nullptr;
+            m_File = INVALID_HANDLE_VALUE;
+#else
+            if (m_Data) ::munmap(m_Data, m_Size);
+#endif
+            m_Data = nullptr;
+        }
+
+#if defined(_WIN32)
+        HANDLE m_File = INVALID_HANDLE_VALUE;
+        HANDLE m_Mapping = nullptr;
+#endif
+        void* m_Data = nullptr;
+        std::size_t m_Size = 0;
+};
+
+// Write a binary coefficient file; C and S are order-major triangles complete to `degree`
+inline void writeCoefficientFile(const std::string& path, int degree, double GM, double Re,
+                                 const std::vector<double>& C, const std::vector<double>& S) {
+    if (C.size() != triangularSize(degree) || S.size() != triangularSize(degree)) {
+        throw std::invalid_argument("Coefficient arrays do not match the requested degree");
+    }
+    FileHeader header{};
+    std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.degree = static_cast<std::uint32_t>(degree);
+    header.GM = GM;
+    header.Re = Re;
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Unable to create gravity coefficient file '" + path + "'");
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(C.data()), static_cast<std::streamsize>(C.size() * sizeof(double)));
+    out.write(reinterpret_cast<const char*>(S.data()), static_cast<std::streamsize>(S.size() * sizeof(double)));
+}
+
+// Convert an ICGEM .gfc model (as distributed for EGM96 and EGM2008) up to `maxDegree`
+// into the binary format above
+inline void convertIcgemFile(const std::string& icgemPath, const std::string& binaryPath, int maxDegree) {
+    std::ifstream in(icgemPath);
+    if (!in) {
+        throw std::runtime_error("Unable to open ICGEM file '" + icgemPath + "'");
+    }
+
+    double GM = 0.0;
+    double Re = 0.0;
+    std::vector<double> C(triangularSize(maxDegree), 0.0);
+    std::vector<double> S(triangularSize(maxDegree), 0.0);
+    C[triangularIndex(0, 0, maxDegree)] = 1.0;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        for (auto& c : line) {
+            if (c == 'D' || c == 'd') c = 'e'; // Fortran exponents
+        }
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key == "earth_gravity_constant") {
+            fields >> GM;
+        } else if (key == "radius") {
+            fields >> Re;
+        } else if (key == "gfc") {
+            int n = 0;
+            int m = 0;
+            double c = 0.0;
+            double s = 0.0;
+            fields >> n >> m >> c >> s;
+            if (n <= maxDegree && m <= n) {
+                C[triangularIndex(n, m, maxDegree)] = c;
+                S[triangularIndex(n, m, maxDegree)] = s;
+            }
+        }
+    }
+    if (GM == 0.0 || Re == 0.0) {
+        throw std::runtime_error("ICGEM file '" + icgemPath + "' lacks earth_gravity_constant or radius");
+    }
+    writeCoefficientFile(binaryPath, maxDegree, GM, Re, C, S);
+}
+
+// Acceleration [m/s^2] with the symmetric gravity-gradient tensor d(a_i)/d(x_j) [1/s^2]
+struct AccelerationAndGradient {
+    std::array<double, 3> acceleration;
+    std::array<std::array<double, 3>, 3> gradient;
+};
+
+// Gravity field of degree/order selectable at run time up to the degree of the coefficients.
+// The coefficient storage is not owned and must outlive the field.
+class GravityField {
+
+    public:
+        GravityField(const double* C, const double* S, int coefficientDegree, double GM, double Re)
+            : m_C(C), m_S(S), m_CoefficientDegree(coefficientDegree), m_GM(GM), m_Re(Re) {
+            setDegreeOrder(coefficientDegree, coefficientDegree);
+        }
+
+        explicit GravityField(const CoefficientFile& file)
+            : GravityField(file.C(), file.S(), file.degree(), file.header().GM, file.header().Re) {}
+
+        // Truncate the expansion; allocates the work arrays, so call it outside the hot loop
+        void setDegreeOrder(int degree, int order) {
+            if (degree < 0 || degree > m_CoefficientDegree || order < 0 || order > degree) {
+                throw std::invalid_argument("Requested degree/order exceeds the gravity coefficients");
+            }
+            m_Degree = degree;
+            m_Order = order;
+
+            // V/W are needed two degrees and orders beyond the expansion for second derivatives
+            const int top = degree + 2;
+            m_Stride = static_cast<std::size_t>(top + 1);
+            m_V.assign(ColumnCount * m_Stride, 0.0);
+            m_W.assign(ColumnCount * m_Stride, 0.0);
+
+            m_Alpha.assign(triangularSize(top), 0.0);
+            m_Beta.assign(triangularSize(top), 0.0);
+            m_Diagonal.assign(static_cast<std::size_t>(top + 1), 0.0);
+            for (int m = 0; m <= top; ++m) {
+                if (m > 0) {
+                    m_Diagonal[m] = (m == 1) ? std::sqrt(3.0) : std::sqrt((2.0 * m + 1.0) / (2.0 * m));
+                }
+                for (int n = m + 1; n <= top; ++n) {
+                    const double nn = n;
+                    const double mm = m;
+                    m_Alpha[triangularIndex(n, m, top)] = std::sqrt((2 * nn - 1) * (2 * nn + 1) / ((nn - mm) * (nn + mm)));
+                    if (n >= m + 2) {
+                        m_Beta[triangularIndex(n, m, top)] = std::sqrt((2 * nn + 1) * (nn + mm - 1) * (nn - mm - 1) /
+                                                                      ((2 * nn - 3) * (nn + mm) * (nn - mm)));
+                    }
+                }
+            }
+
+            m_DerivedC.clear();
+            m_DerivedS.clear();
+
+            // Derivative factors one degree beyond the expansion, so they can be applied twice
+            const int derivativeTop = degree + 1;
+            m_F1.assign(triangularSize(derivativeTop), 0.0);
+            m_F2.assign(triangularSize(derivativeTop), 0.0);
+            m_F3.assign(triangularSize(derivativeTop), 0.0);
+            for (int m = 0; m <= derivativeTop; ++m) {
+                for (int n = m; n <= derivativeTop; ++n) {
+                    const double nn = n;
+                    const double mm = m;
+                    const std::size_t k = triangularIndex(n, m, derivativeTop);
+                    const double d0 = (m == 0) ? 1.0 : 2.0;
+                    m_F1[k] = std::sqrt(d0 / 2.0 * (2 * nn + 1) / (2 * nn + 3) * (nn + mm + 1) * (nn + mm + 2));
+                    if (m > 0) {
+                        const double d1 = (m == 1) ? 1.0 : 2.0;
+                        m_F2[k] = std::sqrt(d0 * (2 * nn + 1) * (nn - mm + 1) * (nn - mm + 2) / (d1 * (2 * nn + 3)));
+                    }
+                    m_F3[k] = std::sqrt((2 * nn + 1) * (nn + mm + 1) * (nn - mm + 1) / (2 * nn + 3));
+                }
+            }
+        }
+
+        int degree() const { return m_Degree; }
+        int order() const { return m_Order; }
+        double GM() const { return m_GM; }
+        double Re() const { return m_Re; }
+
+        // Gravitational acceleration [m/s^2] at an Earth fixed position [m]
+        std::array<double, 3> acceleration(double x, double y, double z) {
+            begin(x, y, z, m_Degree + 1);
+
+            double a[3] = {0.0, 0.0, 0.0};
+
+            column(0);
+            column(1);
+            for (int m = 0; m <= m_Order; ++m) {
+                if (m + 1 > 1) column(m + 1);
+                const std::size_t base = triangularIndex(m, m, m_CoefficientDegree);
+                accumulate(m_C + base, m_S + base, m, m_Degree, a);
+            }
+
+            const double scale = m_GM / (m_Re * m_Re);
+            return {scale * a[0], scale * a[1], scale * a[2]};
+        }
+
+        // Gravitational acceleration [m/s^2] and gravity gradient [1/s^2] at an Earth fixed position [m].
+        // The first derivatives of the expansion are themselves expansions one degree higher whose
+        // coefficients do not depend on position, so the gradient is the acceleration kernel run on
+        // those three coefficient sets, sharing the V/W columns with the acceleration itself.
+        AccelerationAndGradient accelerationAndGradient(double x, double y, double z) {
+            if (m_DerivedC.empty()) {
+                deriveCoefficients();
+            }
+            begin(x, y, z, m_Degree + 2);
+
+            double a[3] = {0.0, 0.0, 0.0};
+            double G[3][3] = {};
+
+            const int derivedDegree = m_Degree + 1;
+            const std::size_t derivedSize = triangularSize(derivedDegree);
+
+            column(0);
+            column(1);
+            for (int m = 0; m <= m_Order + 1; ++m) {
+                if (m + 1 > 1) column(m + 1);
+                if (m <= m_Order) {
+                    const std::size_t base = triangularIndex(m, m, m_CoefficientDegree);
+                    accumulate(m_C + base, m_S + base, m, m_Degree, a);
+                }
+                const std::size_t base = triangularIndex(m, m, derivedDegree);
+                for (int j = 0; j < 3; ++j) {
+                    double column[3] = {0.0, 0.0, 0.0};
+                    accumulate(m_DerivedC.data() + j * derivedSize + base, m_DerivedS.data() + j * derivedSize + base, m, derivedDegree, column);
+                    for (int i = 0; i < 3; ++i) {
+                        G[i][j] += column[i];
+                    }
+                }
+            }
+
+            const double scale = m_GM / (m_Re * m_Re);
+            const double scaleGradient = m_GM / (m_Re * m_Re * m_Re);
+            AccelerationAndGradient result{};
+            result.acceleration = {scale * a[0], scale * a[1], scale * a[2]};
+            for (int i = 0; i < 3; ++i) {
+                for (int j = i; j < 3; ++j) {
+                    const double g = 0.5 * scaleGradient * (G[i][j] + G[j][i]);
+                    result.gradient[i][j] = g;
+                    result.gradient[j][i] = g;
+                }
+            }
+            return result;
+        }
+
+        // Gravitational potential [m^2/s^2] at an Earth fixed position [m]
+        double potential(double x, double y, double z) {
+            begin(x, y, z, m_Degree);
+
+            double u = 0.0;
+            column(0);
+            for (int m = 0; m <= m_Order; ++m) {
+                if (m > 0) column(m);
+                const double* Vm = columnV(m);
+                const double* Wm = columnW(m);
+                const std::size_t base = triangularIndex(m, m, m_CoefficientDegree);
+                for (int n = m; n <= m_Degree; ++n) {
+                    u += m_C[base + (n - m)] * Vm[n] + m_S[base + (n - m)] * Wm[n];
+                }
+            }
+            return m_GM / m_Re * u;
+        }
+
+    private:
+        static constexpr int ColumnCount = 5;
+
+        // Add the acceleration terms of order m, degrees m..last, to a (in units of GM/Re^2).
+        // C and S point at the (m, m) coefficient; V/W columns m-1..m+1 must be filled to last+1.
+        void accumulate(const double* C, const double* S, int m, int last, double* a) {
+            const double* Vm = columnV(m);
+            const double* Wm = columnW(m);
+            const double* Vp = columnV(m + 1);
+            const double* Wp = columnW(m + 1);
+            const double* Vl = (m > 0) ? columnV(m - 1) : nullptr;
+            const double* Wl = (m > 0) ? columnW(m - 1) : nullptr;
+            const std::size_t fbase = triangularIndex(m, m, m_Degree + 1);
+
+            double ax = 0.0;
+            double ay = 0.0;
+            double az = 0.0;
+            for (int n = m; n <= last; ++n) {
+                const double c = C[n - m];
+                const double s = S[n - m];
+                const double f1 = m_F1[fbase + (n - m)];
+                const double f3 = m_F3[fbase + (n - m)];
+                if (m == 0) {
+                    ax -= c * f1 * Vp[n + 1];
+                    ay -= c * f1 * Wp[n + 1];
+                } else {
+                    const double f2 = m_F2[fbase + (n - m)];
+                    ax += 0.5 * (f1 * (-c * Vp[n + 1] - s * Wp[n + 1]) + f2 * (c * Vl[n + 1] + s * Wl[n + 1]));
+                    ay += 0.5 * (f1 * (-c * Wp[n + 1] + s * Vp[n + 1]) + f2 * (-c * Wl[n + 1] + s * Vl[n + 1]));
+                }
+                az += f3 * (-c * Vm[n + 1] - s * Wm[n + 1]);
+            }
+            a[0] += ax;
+            a[1] += ay;
+            a[2] += az;
+        }
+
+        // Coefficients of d/dx, d/dy, d/dz of the truncated expansion (units of 1/Re), as three
+        // degree+1 triangles. Same differentiation rules as accumulate(), applied per coefficient.
+        void deriveCoefficients() {
+            const int top = m_Degree + 1;
+            const std::size_t size = triangularSize(top);
+            m_DerivedC.assign(3 * size, 0.0);
+            m_DerivedS.assign(3 * size, 0.0);
+            double* Cx = m_DerivedC.data();
+            double* Sx = m_DerivedS.data();
+            double* Cy = Cx + size;
+            double* Sy = Sx + size;
+            double* Cz = Cy + size;
+            double* Sz = Sy + size;
+
+            for (int m = 0; m <= m_Order; ++m) {
+                for (int n = m; n <= m_Degree; ++n) {
+                    const double C = m_C[triangularIndex(n, m, m_CoefficientDegree)];
+                    const double S = m_S[triangularIndex(n, m, m_CoefficientDegree)];
+                    const std::size_t k = triangularIndex(n, m, top);
+                    const double f1 = m_F1[k];
+                    const double f2 = m_F2[k];
+                    const double f3 = m_F3[k];
+
+                    const std::size_t up = triangularIndex(n + 1, m + 1, top);
+                    Cz[triangularIndex(n + 1, m, top)] -= f3 * C;
+                    Sz[triangularIndex(n + 1, m, top)] -= f3 * S;
+                    if (m == 0) {
+                        Cx[up] -= f1 * C;
+                        Sy[up] -= f1 * C;
+                        continue;
+                    }
+                    const std::size_t down = triangularIndex(n + 1, m - 1, top);
+                    Cx[up] -= 0.5 * f1 * C;
+                    Cx[down] += 0.5 * f2 * C;
+                    Sx[up] -= 0.5 * f1 * S;
+                    Sy[up] -= 0.5 * f1 * C;
+                    Cy[up] += 0.5 * f1 * S;
+                    Cy[down] += 0.5 * f2 * S;
+                    if (m > 1) {
+                        Sx[down] += 0.5 * f2 * S;
+                        Sy[down] -= 0.5 * f2 * C;
+                    }
+                }
+            }
+        }
+
+        double* columnV(int m) { return m_V.data() + static_cast<std::size_t>(m % ColumnCount) * m_Stride; }
+        double* columnW(int m) { return m_W.data() + static_cast<std::size_t>(m % ColumnCount) * m_Stride; }
+
+        void begin(double x, double y, double z, int top) {
+            const double r2 = x * x + y * y + z * z;
+            m_X = x * m_Re / r2;
+            m_Y = y * m_Re / r2;
+            m_Z = z * m_Re / r2;
+            m_Rho2 = m_Re * m_Re / r2;
+            m_V00 = m_Re / std::sqrt(r2);
+            m_Top = top;
+        }
+
+        // Fill column m of V/W for degrees m..top from the diagonal of column m-1
+        void column(int m) {
+            double* V = columnV(m);
+            double* W = columnW(m);
+            if (m > m_Top) {
+                return;
+            }
+            if (m == 0) {
+                V[0] = m_V00;
+                W[0] = 0.0;
+            } else {
+                const double* Vl = columnV(m - 1);
+                const double* Wl = columnW(m - 1);
+                const double d = m_Diagonal[m];
+                V[m] = d * (m_X * Vl[m - 1] - m_Y * Wl[m - 1]);
+                W[m] = d * (m_X * Wl[m - 1] + m_Y * Vl[m - 1]);
+            }
+
+            const int top = m_Degree + 2;
+            const std::size_t base = triangularIndex(m, m, top);
+            if (m + 1 <= m_Top) {
+                const double a = m_Alpha[base + 1];
+                V[m + 1] = a * m_Z * V[m];
+                W[m + 1] = a * m_Z * W[m];
+            }
+            for (int n = m + 2; n <= m_Top; ++n) {
+                const double a = m_Alpha[base + (n - m)];
+                const double b = m_Beta[base + (n - m)];
+                V[n] = a * m_Z * V[n - 1] - b * m_Rho2 * V[n - 2];
+                W[n] = a * m_Z * W[n - 1] - b * m_Rho2 * W[n - 2];
+            }
+        }
+
+        const double* m_C;
+        const double* m_S;
+        int m_CoefficientDegree;
+        double m_GM;
+        double m_Re;
+
+        int m_Degree = 0;
+        int m_Order = 0;
+
+        // Recursion and derivative factors, order-major triangles
+        std::vector<double> m_Alpha;
+        std::vector<double> m_Beta;
+        std::vector<double> m_Diagonal;
+        std::vector<double> m_F1;
+        std::vector<double> m_F2;
+        std::vector<double> m_F3;
+
+        // First derivative coefficient triangles (x, y, z), built on the first gradient request
+        std::vector<double> m_DerivedC;
+        std::vector<double> m_DerivedS;
+
+        // Ring of V/W columns
+        std::size_t m_Stride = 0;
+        std::vector<double> m_V;
+        std::vector<double> m_W;
+
+        // Per evaluation terms
+        double m_X = 0.0;
+        double m_Y = 0.0;
+        double m_Z = 0.0;
+        double m_Rho2 = 0.0;
+        double m_V00 = 0.0;
+        int m_Top = 0;
+};
+
+} // namespace SphericalHarmonics
+
+#endif // SPHERICAL_HARMONIC_GRAVITY_H
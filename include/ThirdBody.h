@@ -0,0 +1,230 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [ThirdBody.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Sun and Moon third body accelerations.
+ *  Positions come from the low precision analytic series of Montenbruck & Gill,
+ *  Satellite Orbits, 3.3.2 (Sun ~0.1-1%, Moon a few arcminutes), referred to the
+ *  mean equator and equinox of J2000. Times are TT seconds since J2000.0
+ *  (TimeScale::Epoch::ttSinceJ2000 in Epoch.h).
+ *  Since the bodies move slowly the series is fitted once by Chebyshev segments
+ *  on a fixed time grid, shared by every model in the process, and a position
+ *  costs one Clenshaw evaluation.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef THIRD_BODY_H
+#define THIRD_BODY_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+#include "TwoBody.h"
+
+namespace ThirdBody {
+
+constexpr double GM_Sun = 1.32712440018e20;  // [m^3/s^2]
+constexpr double GM_Moon = 4.902800066e12;   // [m^3/s^2]
+
+namespace detail {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double Degree = PI / 180.0;
+constexpr double ArcSecond = Degree / 3600.0;
+constexpr double SecondsPerCentury = 36525.0 * 86400.0;
+constexpr double ObliquityJ2000 = 23.43929111 * Degree;
+
+// Ecliptic (longitude, latitude, distance) to the equatorial J2000 frame
+inline std::array<double, 3> eclipticToEquatorial(double lambda, double beta, double r) {
+    const double x = r * std::cos(lambda) * std::cos(beta);
+    const double y = r * std::sin(lambda) * std::cos(beta);
+    const double z = r * std::sin(beta);
+    const double c = std::cos(ObliquityJ2000);
+    const double s = std::sin(ObliquityJ2000);
+    return {x, c * y - s * z, s * y + c * z};
+}
+
+} // namespace detail
+
+// Geocentric position of the Sun [m] from the analytic series
+inline std::array<double, 3> sunPosition(double time_since_j2000) {
+    using namespace detail;
+    const double T = time_since_j2000 / SecondsPerCentury;
+    const double M = (357.5256 + 35999.049 * T) * Degree;
+    const double lambda = 282.94 * Degree + M + 6892.0 * ArcSecond * std::sin(M) + 72.0 * ArcSecond * std::sin(2.0 * M);
+    const double r = (149.619 - 2.499 * std::cos(M) - 0.021 * std::cos(2.0 * M)) * 1.0e9;
+    return eclipticToEquatorial(lambda, 0.0, r);
+}
+
+// Geocentric position of the Moon [m] from the analytic series
+inline std::array<double, 3> moonPosition(double time_since_j2000) {
+    using namespace detail;
+    const double T = time_since_j2000 / SecondsPerCentury;
+    const double L0 = (218.31617 + 481267.88088 * T - 1.3972 * T) * Degree;
+    const double l = (134.96292 + 477198.86753 * T) * Degree;
+    const double lp = (357.52543 + 35999.04944 * T) * Degree;
+    const double F = (93.27283 + 483202.01873 * T) * Degree;
+    const double D = (297.85027 + 445267.11135 * T) * Degree;
+
+    const double lambda = L0 + ArcSecond * (22640.0 * std::sin(l) + 769.0 * std::sin(2.0 * l) - 4586.0 * std::sin(l - 2.0 * D) +
+                                            2370.0 * std::sin(2.0 * D) - 668.0 * std::sin(lp) - 412.0 * std::sin(2.0 * F) -
+                                            212.0 * std::sin(2.0 * l - 2.0 * D) - 206.0 * std::sin(l + lp - 2.0 * D) +
+                                            192.0 * std::sin(l + 2.0 * D) - 165.0 * std::sin(lp - 2.0 * D) + 148.0 * std::sin(l - lp) -
+                                            125.0 * std::sin(D) - 110.0 * std::sin(l + lp) - 55.0 * std::sin(2.0 * F - 2.0 * D));
+
+    const double beta = ArcSecond * (18520.0 * std::sin(F + lambda - L0 + ArcSecond * (412.0 * std::sin(2.0 * F) + 541.0 * std::sin(lp))) -
+                                     526.0 * std::sin(F - 2.0 * D) + 44.0 * std::sin(l + F - 2.0 * D) - 31.0 * std::sin(-l + F - 2.0 * D) -
+                                     25.0 * std::sin(-2.0 * l + F) - 23.0 * std::sin(lp + F - 2.0 * D) + 21.0 * std::sin(-l + F) +
+                                     11.0 * std::sin(-lp + F - 2.0 * D));
+
+    const double r = (385000.0 - 20905.0 * std::cos(l) - 3699.0 * std::cos(2.0 * D - l) - 2956.0 * std::cos(2.0 * D) -
+                      570.0 * std::cos(2.0 * l) + 246.0 * std::cos(2.0 * l - 2.0 * D) - 205.0 * std::cos(lp - 2.0 * D) -
+                      171.0 * std::cos(l + 2.0 * D) - 152.0 * std::cos(l + lp - 2.0 * D)) * 1.0e3;
+
+    return detail::eclipticToEquatorial(lambda, beta, r);
+}
+
+using TwoBody::battinF;
+
+// Acceleration [m/s^2] of a satellite at r relative to the Earth due to a body of
+// gravitational parameter GM at s: GM [ (s - r)/|s - r|^3 - s/|s|^3 ], written as
+// -GM/|r - s|^3 [ r + f(q) s ] with q = r.(r - 2s)/|s|^2 to avoid the cancellation
+// between the direct and indirect terms
+inline std::array<double, 3> acceleration(const std::array<double, 3>& r, const std::array<double, 3>& s, double GM) {
+    const double s2 = s[0] * s[0] + s[1] * s[1] + s[2] * s[2];
+    const double q = (r[0] * (r[0] - 2.0 * s[0]) + r[1] * (r[1] - 2.0 * s[1]) + r[2] * (r[2] - 2.0 * s[2])) / s2;
+    const double d2 = s2 * (1.0 + q);
+    const double factor = -GM / (d2 * std::sqrt(d2));
+    const double f = battinF(q);
+    return {factor * (r[0] + f * s[0]), factor * (r[1] + f * s[1]), factor * (r[2] + f * s[2])};
+}
+
+// Chebyshev approximation of the Sun and Moon series on a fixed grid of segments
+// counted from J2000. Segments are fitted on first use (or by prepare) and kept.
+class Ephemeris {
+
+    public:
+        static constexpr int ChebyshevDegree = 12;
+        static constexpr double SunSegment = 16.0 * 86400.0;  // [s]
+        static constexpr double MoonSegment = 2.0 * 86400.0;  // [s]
+
+        // Ephemeris shared by all models in the process
+        static Ephemeris& shared() {
+            static Ephemeris ephemeris;
+            return ephemeris;
+        }
+
+        // Fit every segment covering [start, stop] ahead of the run
+        void prepare(double start, double stop) {
+            for (double t = start; t < stop + SunSegment; t += SunSegment) segment(m_Sun, t, SunSegment, &sunPosition);
+            for (double t = start; t < stop + MoonSegment; t += MoonSegment) segment(m_Moon, t, MoonSegment, &moonPosition);
+        }
+
+        std::array<double, 3> sun(double time_since_j2000) { return evaluate(m_Sun, time_since_j2000, SunSegment, &sunPosition); }
+        std::array<double, 3> moon(double time_since_j2000) { return evaluate(m_Moon, time_since_j2000, MoonSegment, &moonPosition); }
+
+        std::size_t segmentCount() const {
+            std::shared_lock<std::shared_mutex> lock(m_Mutex);
+            return m_Sun.size() + m_Moon.size();
+        }
+
+    private:
+        using Series = std::array<double, 3> (*)(double);
+
+        struct Segment {
+            std::array<std::array<double, ChebyshevDegree + 1>, 3> coefficients;
+        };
+
+        using Segments = std::map<std::int64_t, Segment>;
+
+        static std::int64_t indexOf(double t, double length) { return static_cast<std::int64_t>(std::floor(t / length)); }
+
+        // Interpolate the series at the Chebyshev nodes of the segment
+        static Segment fit(std::int64_t index, double length, Series series) {
+            constexpr int N = ChebyshevDegree + 1;
+            const double start = static_cast<double>(index) * length;
+            std::array<std::array<double, 3>, N> samples;
+            for (int k = 0; k < N; ++k) {
+                const double x = std::cos(detail::PI * (k + 0.5) / N);
+                samples[k] = series(start + 0.5 * length * (x + 1.0));
+            }
+            Segment segment;
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < N; ++j) {
+                    double sum = 0.0;
+                    for (int k = 0; k < N; ++k) {
+                        sum += samples[k][i] * std::cos(detail::PI * j * (k + 0.5) / N);
+                    }
+                    segment.coefficients[i][j] = (j == 0 ? 1.0 : 2.0) * sum / N;
+                }
+            }
+            return segment;
+        }
+
+        const Segment& segment(Segments& segments, double t, double length, Series series) {
+            const std::int64_t index = indexOf(t, length);
+            {
+                std::shared_lock<std::shared_mutex> lock(m_Mutex);
+                auto it = segments.find(index);
+                if (it != segments.end()) {
+                    return it->second;
+                }
+            }
+            Segment fitted = fit(index, length, series);
+            std::unique_lock<std::shared_mutex> lock(m_Mutex);
+            return segments.emplace(index, fitted).first->second;
+        }
+
+        std::array<double, 3> evaluate(Segments& segments, double t, double length, Series series) {
+            const Segment& s = segment(segments, t, length, series);
+            const double x = 2.0 * (t / length - std::floor(t / length)) - 1.0;
+
+            // Clenshaw recurrence; std::map nodes stay put, so no lock is needed to read
+            std::array<double, 3> result;
+            for (int i = 0; i < 3; ++i) {
+                const auto& c = s.coefficients[i];
+                double b1 = 0.0;
+                double b2 = 0.0;
+                for (int j = ChebyshevDegree; j >= 1; --j) {
+                    const double b0 = 2.0 * x * b1 - b2 + c[j];
+                    b2 = b1;
+                    b1 = b0;
+                }
+                result[i] = x * b1 - b2 + c[0];
+            }
+            return result;
+        }
+
+        mutable std::shared_mutex m_Mutex;
+        Segments m_Sun;
+        Segments m_Moon;
+};
+
+// Sun plus Moon acceleration [m/s^2] at an inertial (J2000) position [m]
+inline std::array<double, 3> sunMoonAcceleration(const std::array<double, 3>& r, double time_since_j2000) {
+    Ephemeris& ephemeris = Ephemeris::shared();
+    const auto sun = acceleration(r, ephemeris.sun(time_since_j2000), GM_Sun);
+    const auto moon = acceleration(r, ephemeris.moon(time_since_j2000), GM_Moon);
+    return {sun[0] + moon[0], sun[1] + moon[1], sun[2] + moon[2]};
+}
+
+} // namespace ThirdBody
+
+#endif // THIRD_BODY_H
@@ -0,0 +1,269 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [TwoBody.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Two-body (Kepler) propagation in universal variables (Curtis, Orbital Mechanics
+ *  for Engineering Students, 3.7; Vallado, Algorithm 8), valid for elliptic,
+ *  parabolic and hyperbolic orbits, conversions between Cartesian states and
+ *  classical elements of elliptic orbits, and the Encke deviation acceleration
+ *  about such a reference orbit.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef TWO_BODY_H
+#define TWO_BODY_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace TwoBody {
+
+using Vector = std::array<double, 3>;
+
+// Battin's f(q) = (1 + q)^(3/2) - 1 without cancellation for small q; shared by the
+// Encke deviation below and the third-body accelerations (ThirdBody.h)
+inline double battinF(double q) {
+    return q * (3.0 + 3.0 * q + q * q) / (1.0 + std::pow(1.0 + q, 1.5));
+}
+
+// Stumpff functions C(z) and S(z), by series near z = 0 where the closed forms cancel
+inline double stumpffC(double z) {
+    if (std::abs(z) < 1e-2) {
+        return 0.5 - z * (1.0 / 24.0 - z * (1.0 / 720.0 - z / 40320.0));
+    }
+    if (z > 0.0) {
+        return (1.0 - std::cos(std::sqrt(z))) / z;
+    }
+    return (std::cosh(std::sqrt(-z)) - 1.0) / -z;
+}
+
+inline double stumpffS(double z) {
+    if (std::abs(z) < 1e-2) {
+        return 1.0 / 6.0 - z * (1.0 / 120.0 - z * (1.0 / 5040.0 - z / 362880.0));
+    }
+    if (z > 0.0) {
+        const double s = std::sqrt(z);
+        return (s - std::sin(s)) / (s * s * s);
+    }
+    const double s = std::sqrt(-z);
+    return (std::sinh(s) - s) / (s * s * s);
+}
+
+// Conic through (r0, v0) at epoch. propagate() starts Newton's iteration on the
+// universal anomaly from the previous solution, so calls at nearby times, as an
+// integrator makes, converge in one or two iterations.
+class KeplerOrbit {
+
+    public:
+        KeplerOrbit() = default;
+
+        KeplerOrbit(const Vector& r0, const Vector& v0, double GM) { set(r0, v0, GM); }
+
+        void set(const Vector& r0, const Vector& v0, double GM) {
+            m_R0 = r0;
+            m_V0 = v0;
+            m_GM = GM;
+            m_SqrtGM = std::sqrt(GM);
+            m_R0Norm = std::sqrt(r0[0] * r0[0] + r0[1] * r0[1] + r0[2] * r0[2]);
+            m_Vr0 = (r0[0] * v0[0] + r0[1] * v0[1] + r0[2] * v0[2]) / m_R0Norm;
+            const double v2 = v0[0] * v0[0] + v0[1] * v0[1] + v0[2] * v0[2];
+            m_Alpha = 2.0 / m_R0Norm - v2 / GM;
+            m_LastDt = 0.0;
+            m_LastChi = 0.0;
+            m_LastR = m_R0Norm;
+        }
+
+        const Vector& position0() const { return m_R0; }
+        const Vector& velocity0() const { return m_V0; }
+
+        // Position and velocity dt seconds after epoch
+        void propagate(double dt, Vector& r, Vector& v) {
+            const double chi = universalAnomaly(dt);
+            const double z = m_Alpha * chi * chi;
+            const double C = stumpffC(z);
+            const double S = stumpffS(z);
+            const double chi2 = chi * chi;
+
+            const double f = 1.0 - chi2 / m_R0Norm * C;
+            const double g = dt - chi2 * chi * S / m_SqrtGM;
+            for (int i = 0; i < 3; ++i) r[i] = f * m_R0[i] + g * m_V0[i];
+
+            const double rNorm = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+            const double fDot = m_SqrtGM / (rNorm * m_R0Norm) * (z * S - 1.0) * chi;
+            const double gDot = 1.0 - chi2 / rNorm * C;
+            for (int i = 0; i < 3; ++i) v[i] = fDot * m_R0[i] + gDot * m_V0[i];
+        }
+
+    private:
+        // Newton's method on the universal Kepler equation; its derivative is |r|
+        double universalAnomaly(double dt) {
+            double chi = m_LastChi + m_SqrtGM * (dt - m_LastDt) / m_LastR;
+            const double a = m_R0Norm * m_Vr0 / m_SqrtGM;
+            const double b = 1.0 - m_Alpha * m_R0Norm;
+            for (int iteration = 0; iteration < 50; ++iteration) {
+                const double chi2 = chi * chi;
+                const double z = m_Alpha * chi2;
+                const double C = stumpffC(z);
+                const double S = stumpffS(z);
+                const double F = a * chi2 * C + b * chi2 * chi * S + m_R0Norm * chi - m_SqrtGM * dt;
+                const double dF = a * chi * (1.0 - z * S) + b * chi2 * C + m_R0Norm;
+                const double step = F / dF;
+                chi -= step;
+                if (std::abs(step) <= 1e-13 * std::max(1.0, std::abs(chi))) {
+                    m_LastDt = dt;
+                    m_LastChi = chi;
+                    m_LastR = dF;
+                    return chi;
+                }
+            }
+            throw std::runtime_error("Universal Kepler equation did not converge");
+        }
+
+        Vector m_R0{};
+        Vector m_V0{};
+        double m_GM = 0.0;
+        double m_SqrtGM = 0.0;
+        double m_R0Norm = 1.0;
+        double m_Vr0 = 0.0;
+        double m_Alpha = 0.0;  // 1 / semi-major axis [1/m]
+
+        double m_LastDt = 0.0;
+        double m_LastChi = 0.0;
+        double m_LastR = 1.0;
+};
+
+// Classical elements of an elliptic orbit, angles in [rad]. For circular orbits the
+// argument of perigee is zero and the anomaly is measured from the node; for equatorial
+// orbits the node is zero and perigee is measured from the x axis.
+struct Elements {
+    double a = 0.0;     // semi-major axis [m]
+    double e = 0.0;     // eccentricity
+    double i = 0.0;     // inclination
+    double raan = 0.0;  // right ascension of the ascending node
+    double argp = 0.0;  // argument of perigee
+    double M = 0.0;     // mean anomaly
+};
+
+// Angle wrapped into [0, 2 pi)
+inline double wrapAngle(double angle) {
+    angle = std::fmod(angle, 2.0 * M_PI);
+    return angle < 0.0 ? angle + 2.0 * M_PI : angle;
+}
+
+// Eccentric anomaly from Kepler's equation M = E - e sin E by Newton's method
+inline double eccentricAnomaly(double M, double e) {
+    M = wrapAngle(M);
+    double E = e < 0.8 ? M + e * std::sin(M) : M_PI;
+    for (int iteration = 0; iteration < 50; ++iteration) {
+        const double step = (E - e * std::sin(E) - M) / (1.0 - e * std::cos(E));
+        E -= step;
+        if (std::abs(step) <= 1e-14) {
+            return E;
+        }
+    }
+    throw std::runtime_error("Kepler's equation did not converge");
+}
+
+inline double trueAnomaly(double M, double e) {
+    const double E = eccentricAnomaly(M, e);
+    return std::atan2(std::sqrt(1.0 - e * e) * std::sin(E), std::cos(E) - e);
+}
+
+// Elements of the osculating orbit through (r, v); throws for parabolic and hyperbolic states
+inline Elements toElements(const Vector& r, const Vector& v, double GM) {
+    constexpr double tolerance = 1e-11;
+
+    const Vector h = {r[1] * v[2] - r[2] * v[1], r[2] * v[0] - r[0] * v[2], r[0] * v[1] - r[1] * v[0]};
+    const double hNorm = std::sqrt(h[0] * h[0] + h[1] * h[1] + h[2] * h[2]);
+    const double rNorm = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+    const double v2 = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+    const double rv = r[0] * v[0] + r[1] * v[1] + r[2] * v[2];
+
+    Elements elements;
+    elements.a = 1.0 / (2.0 / rNorm - v2 / GM);
+    if (!(elements.a > 0.0) || hNorm == 0.0) {
+        throw std::domain_error("Orbital elements are defined for elliptic orbits only");
+    }
+
+    Vector e;
+    for (int k = 0; k < 3; ++k) e[k] = ((v2 - GM / rNorm) * r[k] - rv * v[k]) / GM;
+    elements.e = std::sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+    elements.i = std::acos(std::clamp(h[2] / hNorm, -1.0, 1.0));
+
+    // In-plane axes: p along the node line (the x axis for equatorial orbits), q = h x p
+    const double nodeNorm = std::hypot(h[0], h[1]);
+    Vector p = {1.0, 0.0, 0.0};
+    if (nodeNorm > tolerance * hNorm) {
+        p = {-h[1] / nodeNorm, h[0] / nodeNorm, 0.0};
+        elements.raan = wrapAngle(std::atan2(h[0], -h[1]));
+    }
+    const Vector q = {(h[1] * p[2] - h[2] * p[1]) / hNorm, (h[2] * p[0] - h[0] * p[2]) / hNorm,
+                      (h[0] * p[1] - h[1] * p[0]) / hNorm};
+
+    if (elements.e > tolerance) {
+        elements.argp = wrapAngle(std::atan2(e[0] * q[0] + e[1] * q[1] + e[2] * q[2], e[0] * p[0] + e[1] * p[1] + e[2] * p[2]));
+    }
+    const double u = std::atan2(r[0] * q[0] + r[1] * q[1] + r[2] * q[2], r[0] * p[0] + r[1] * p[1] + r[2] * p[2]);
+    const double nu = u - elements.argp;
+    const double E = std::atan2(std::sqrt(1.0 - elements.e * elements.e) * std::sin(nu), elements.e + std::cos(nu));
+    elements.M = wrapAngle(E - elements.e * std::sin(E));
+    return elements;
+}
+
+// Position and velocity on the orbit described by elements
+inline void toCartesian(const Elements& elements, double GM, Vector& r, Vector& v) {
+    const double E = eccentricAnomaly(elements.M, elements.e);
+    const double cosE = std::cos(E);
+    const double sinE = std::sin(E);
+    const double eta = std::sqrt(1.0 - elements.e * elements.e);
+    const double rNorm = elements.a * (1.0 - elements.e * cosE);
+
+    // Perifocal position and velocity
+    const double x = elements.a * (cosE - elements.e);
+    const double y = elements.a * eta * sinE;
+    const double vFactor = std::sqrt(GM * elements.a) / rNorm;
+    const double vx = -vFactor * sinE;
+    const double vy = vFactor * eta * cosE;
+
+    const double cO = std::cos(elements.raan), sO = std::sin(elements.raan);
+    const double cw = std::cos(elements.argp), sw = std::sin(elements.argp);
+    const double ci = std::cos(elements.i), si = std::sin(elements.i);
+    const Vector P = {cO * cw - sO * sw * ci, sO * cw + cO * sw * ci, sw * si};
+    const Vector Q = {-cO * sw - sO * cw * ci, -sO * sw + cO * cw * ci, cw * si};
+    for (int k = 0; k < 3; ++k) {
+        r[k] = x * P[k] + y * Q[k];
+        v[k] = vx * P[k] + vy * Q[k];
+    }
+}
+
+// Central body part of the Encke deviation acceleration, d'' = -GM/rho^3 [ d + f(q) r ]
+// for the deviation d = r - rho from the reference position rho, with Battin's f(q)
+// and q = d.(d - 2r)/|r|^2, which avoids subtracting the two nearly equal central
+// accelerations
+inline Vector enckeAcceleration(const Vector& rho, const Vector& d, double GM) {
+    const Vector r = {rho[0] + d[0], rho[1] + d[1], rho[2] + d[2]};
+    const double r2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+    const double q = (d[0] * (d[0] - 2.0 * r[0]) + d[1] * (d[1] - 2.0 * r[1]) + d[2] * (d[2] - 2.0 * r[2])) / r2;
+    const double rho2 = rho[0] * rho[0] + rho[1] * rho[1] + rho[2] * rho[2];
+    const double factor = -GM / (rho2 * std::sqrt(rho2));
+    const double f = battinF(q);
+    return {factor * (d[0] + f * r[0]), factor * (d[1] + f * r[1]), factor * (d[2] + f * r[2])};
+}
+
+} // namespace TwoBody
+
+#endif // TWO_BODY_H
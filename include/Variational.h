@@ -0,0 +1,174 @@
+/*
+ * ---------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [Variational.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronuatics and Astronautics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Variational equations of a DynamicModel<Integrator>, integrated with the state
+ *  as one system so that they share its steps:
+ *      x'   = f(x, p)
+ *      Phi' = df/dx Phi,            Phi(t0) = I    (state transition matrix)
+ *      S'   = df/dx S + df/dp,      S(t0)   = 0    (parameter sensitivities)
+ *  df/dx is the model's analytic ode_jac and df/dp its ode_param, over the
+ *  ParameterCount parameters the model lists. The augmented state is x followed by
+ *  [Phi S] row by row, N + P entries a row, so one pass over a row of df/dx
+ *  updates both: Phi_ij = y[N + (N + P) i + j], S_ik = y[N + (N + P) i + N + k].
+ *  The fixed size integrators control the error of x only; libode's control the
+ *  whole augmented state. A projection the model applies after each step is applied
+ *  to [Phi S] through its Jacobian (after_step_jac).]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef VARIATIONAL_H
+#define VARIATIONAL_H
+
+#include <array>
+#include <utility>
+
+#include "FixedSizeIntegrators.h"
+
+namespace Integration {
+
+template<template<class> class Model>
+struct Variational {
+
+    template<class Integrator>
+    class System : public Model<Bind<Integrator, System<Integrator>>> {
+
+            // The fixed size integrators call this system's ode_fun, not the model's
+            using Base = Model<Bind<Integrator, System>>;
+
+        public:
+            static constexpr int NominalCount = Base::StateCount;
+            static constexpr int ParameterCount = Base::ParameterCount;
+            static constexpr int Width = NominalCount + ParameterCount;  // row of [Phi S]
+            static constexpr int StateCount = NominalCount * (1 + Width);
+
+            System () : Base (StateCount) {
+                for (int i = 0; i < NominalCount; ++i) {
+                    m_JacobianRows[i] = m_Jacobian[i].data();
+                    m_ParameterRows[i] = m_Parameter[i].data();
+                }
+                // The state alone sets the steps where the integrator allows it; the
+                // variations are then the derivatives of the discrete solution itself
+                if constexpr (requires(Integrator& integrator) { integrator.set_error_count(NominalCount); }) {
+                    this->set_error_count(NominalCount);
+                }
+                ResetVariations();
+            }
+
+            //system of equations: the model, then [Phi S]. Rows of df/dx are sparse for
+            //the models here, so zero entries are skipped
+            void ode_fun (double* solin, double* fout) {
+                Base::ode_fun(solin, fout);
+                Base::ode_jac(solin, m_JacobianRows.data());
+                Base::ode_param(solin, m_ParameterRows.data());
+
+                const double* V = solin + NominalCount;
+                double* VDot = fout + NominalCount;
+                for (int i = 0; i < NominalCount; ++i) {
+                    double* row = VDot + Width * i;
+                    for (int j = 0; j < NominalCount; ++j) row[j] = 0.0;
+                    for (int k = 0; k < ParameterCount; ++k) row[NominalCount + k] = m_Parameter[i][k];
+                    for (int l = 0; l < NominalCount; ++l) {
+                        const double a = m_Jacobian[i][l];
+                        if (a == 0.0) continue;
+                        const double* source = V + Width * l;
+                        for (int j = 0; j < Width; ++j) row[j] += a * source[j];
+                    }
+                }
+            }
+
+            //jacobian: block lower triangular with df/dx on every diagonal block. The
+            //blocks below, second derivatives of f times Phi and S, are left out; implicit
+            //methods then see an approximate Jacobian for the variations only
+            void ode_jac (double* solin, double** Jout) {
+                for (int i = 0; i < StateCount; ++i) {
+                    for (int j = 0; j < StateCount; ++j) Jout[i][j] = 0.0;
+                }
+                Base::ode_jac(solin, Jout);
+
+                for (int i = 0; i < NominalCount; ++i) {
+                    for (int l = 0; l < NominalCount; ++l) {
+                        const double a = Jout[i][l];
+                        if (a == 0.0) continue;
+                        for (int j = 0; j < Width; ++j) {
+                            Jout[NominalCount + Width * i + j][NominalCount + Width * l + j] = a;
+                        }
+                    }
+                }
+            }
+
+            // A model whose after_step changes the state (the 6 DoF quaternion normalisation)
+            // gives the Jacobian of that map at the state before it as after_step_jac; Phi and
+            // S are multiplied by it in the same step so that they stay the derivatives of
+            // the discrete solution
+            void after_step (double t) {
+                if constexpr (requires(Base& model, double* x, double** J) { model.after_step_jac(x, J); }) {
+                    for (int i = 0; i < NominalCount; ++i) m_Before[i] = this->get_sol(i);
+                    Base::after_step(t);
+                    Base::after_step_jac(m_Before.data(), m_JacobianRows.data());
+
+                    for (int i = 0; i < NominalCount * Width; ++i) m_Variations[i] = this->get_sol(NominalCount + i);
+                    for (int i = 0; i < NominalCount; ++i) {
+                        for (int j = 0; j < Width; ++j) {
+                            double sum = 0.0;
+                            for (int l = 0; l < NominalCount; ++l) {
+                                const double a = m_Jacobian[i][l];
+                                if (a != 0.0) sum += a * m_Variations[Width * l + j];
+                            }
+                            this->set_sol(NominalCount + Width * i + j, sum);
+                        }
+                    }
+                } else {
+                    Base::after_step(t);
+                }
+            }
+
+            // Model state, with the variations restarted from it. The arguments are
+            // forwarded, so they are named vectors rather than braced lists
+            template<class... Args>
+            void SetState(Args&&... args) {
+                Base::SetState(std::forward<Args>(args)...);
+                ResetVariations();
+            }
+
+            // Phi = I, S = 0 at the current state
+            void ResetVariations() {
+                for (int i = NominalCount; i < StateCount; ++i) this->set_sol(i, 0.0);
+                for (int i = 0; i < NominalCount; ++i) this->set_sol(TransitionIndex(i, i), 1.0);
+            }
+
+            // Positions of Phi_ij and S_ik in the augmented state
+            static constexpr int TransitionIndex(int i, int j) { return NominalCount + Width * i + j; }
+            static constexpr int SensitivityIndex(int i, int k) { return NominalCount + Width * i + NominalCount + k; }
+
+            // d x_i(t) / d x_j(t0)
+            double GetTransition(int i, int j) { return this->get_sol(TransitionIndex(i, j)); }
+
+            // d x_i(t) / d p_k
+            double GetSensitivity(int i, int k) { return this->get_sol(SensitivityIndex(i, k)); }
+
+        private:
+            std::array<std::array<double, NominalCount>, NominalCount> m_Jacobian{};
+            std::array<double*, NominalCount> m_JacobianRows{};
+            std::array<std::array<double, ParameterCount>, NominalCount> m_Parameter{};
+            std::array<double*, NominalCount> m_ParameterRows{};
+            std::array<double, NominalCount> m_Before{};
+            std::array<double, NominalCount * Width> m_Variations{};
+    };
+};
+
+} // namespace Integration
+
+#endif // VARIATIONAL_H
@@ -6,11 +6,18 @@
  * Email:       onur.tuncer@itu.edu.tr
  * Institution: Istanbul Technical University
  *              Faculty of Aeronautics and Astronuatics
- * 
+ *
  * Date:        2024
  *
  * Description:
- * [US1976 Atmospheric Model]
+ * [3DoF fixed mass point over a rotating WGS-84 Earth with J2 gravity.
+ *  The state is integrated in ECI across each communication interval by the method
+ *  chosen with the "integrator" parameter (OdeROW6A by default), either directly
+ *  (Cowell, DynamicModel.h) or as the deviation from a rectified Kepler orbit (Encke,
+ *  EnckeModel.h) as chosen by "formulation"; ECEF, geodetic and NEU outputs follow
+ *  from the state. With "variational_equations" the Cowell form carries the state
+ *  transition matrix and the sensitivities to mass and force (Variational.h) in the
+ *  same integration.]
  *
  * License:
  * [See License.txt in the top level directory for licence and copyright information]
@@ -21,10 +28,27 @@
 #include <fmu4cpp/fmu_base.hpp>
 #include "EarthCenteredFrames.h"
 #include "DynamicModel.h"
-#include "ode_row6a.h"
+#include "EnckeModel.h"
+#include "IntegratorSelection.h"
+#include "Variational.h"
+
+#include <stdexcept>
+#include <string>
 
 using namespace fmu4cpp;
 
+using CowellSystem = Integration::IntegratorSelection<DynamicModel>;
+using EnckeSystem = Integration::IntegratorSelection<EnckeModel>;
+using VariationalSystem = Integration::IntegratorSelection<Integration::Variational<DynamicModel>::System>;
+
+constexpr int StateCount = 6;
+constexpr int ParameterCount = 4;
+
+// Values of the "formulation" parameter
+enum class Formulation : int { Cowell = 0, Encke = 1 };
+
+constexpr double DefaultRelativeTolerance = 1e-10;
+
 class Model : public fmu_base {
 
 public:
@@ -37,240 +61,390 @@ public:
                         .setCausality(causality_t::PARAMETER)
                         .setVariability(variability_t::FIXED));
 
+        // Integration method, see Integration::Method: 0 RK4, 1 DoPri54, 2 DoPri87, 3 GRK4A, 4 ROW6A, 5 RadauIIA,
+        // 6 FixedDoPri54, 7 FixedROS34PW2 (fixed size, allocation free), 8 FixedROS34PW2Reuse,
+        // 9 FixedAutoSwitch (explicit or Rosenbrock by stiffness)
         register_variable(
-                real(
-                        "neu_Origin_Latitude", [this] { return m_NeuOriginLatitude; }, [this](double value) { m_NeuOriginLatitude = value; })
+                integer(
+                        "integrator", [this] { return m_Integrator; }, [this](int value) { m_Integrator = value; })
                         .setCausality(causality_t::PARAMETER)
                         .setVariability(variability_t::FIXED));
 
+        // 0 Cowell (full ECI state), 1 Encke (deviation from a two-body reference orbit)
         register_variable(
-                real(
-                        "neu_Origin_Longitude", [this] { return m_NeuOriginLongitude; }, [this](double value) { m_NeuOriginLongitude = value; })
+                integer(
+                        "formulation", [this] { return m_Formulation; }, [this](int value) { m_Formulation = value; })
                         .setCausality(causality_t::PARAMETER)
                         .setVariability(variability_t::FIXED));
 
+        // Cowell only: integrate the variational equations with the state
         register_variable(
-                real(
-                        "neu_Origin_Altitude", [this] { return m_NeuOriginAltitude; }, [this](double value) { m_NeuOriginAltitude = value; })
+                boolean(
+                        "variational_equations", [this] { return m_VariationalEquations; },
+                        [this](bool value) { m_VariationalEquations = value; })
                         .setCausality(causality_t::PARAMETER)
                         .setVariability(variability_t::FIXED));
 
+        // Encke only: |dr| / |r| at which the reference orbit restarts from the current state
         register_variable(
                 real(
-                        "eci_Rx", [this] { return m_EciRx; }, [this](double value) { m_EciRx = value; })
-                        .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("mass")->index(),
-                                          get_real_variable("neu_Origin_Latitude")->index(),
-                                          get_real_variable("neu_Origin_Longitute")->index(),
-                                          get_real_variable("neu_Origin_Altitude")->index(),
-                                          get_real_variable("eci_Vx")->index(),
-                                          get_real_variable("ecef_Rx")->index(),
-                                          get_real_variable("ecef_Ry")->index(),
-                                          get_real_variable("ecef_Rz")->index()}));
+                        "rectification_threshold", [this] { return m_RectificationThreshold; },
+                        [this](double value) { m_RectificationThreshold = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
 
+        // Substep of the fixed step methods [s]
         register_variable(
                 real(
-                        "eci_Ry", [this] { return m_EciRy; }, [this](double value) { m_EciRy = value; })
-                        .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("mass")->index(),
-                                          get_real_variable("neu_Origin_Latitude")->index(),
-                                          get_real_variable("neu_Origin_Longitute")->index(),
-                                          get_real_variable("neu_Origin_Altitude")->index(),
-                                          get_real_variable("eci_Vy")->index(),
-                                          get_real_variable("ecef_Rx")->index(),
-                                          get_real_variable("ecef_Ry")->index(),
-                                          get_real_variable("ecef_Rz")->index()}));
-  
+                        "fixed_step", [this] { return m_FixedStep; }, [this](double value) { m_FixedStep = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        // Relative tolerance of the adaptive methods; 0 takes the tolerance of the experiment
         register_variable(
                 real(
-                        "eci_Rz", [this] { return m_EciRz; }, [this](double value) { m_EciRz = value; })
-                        .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("mass")->index(),
-                                          get_real_variable("neu_Origin_Latitude")->index(),
-                                          get_real_variable("neu_Origin_Longitute")->index(),
-                                          get_real_variable("neu_Origin_Altitude")->index(),
-                                          get_real_variable("eci_Vz")->index(),
-                                          get_real_variable("ecef_Rx")->index(),
-                                          get_real_variable("ecef_Ry")->index(),
-                                          get_real_variable("ecef_Rz")->index()}));
-
-        
+                        "relative_tolerance", [this] { return m_RelativeTolerance; }, [this](double value) { m_RelativeTolerance = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
         register_variable(
                 real(
-                        "eci_Vx", [this] { return m_EciRx; }, [this](double value) { m_EciVx = value; })
-                        .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("mass")->index(),
-                                          get_real_variable("neu_Origin_Latitude")->index(),
-                                          get_real_variable("neu_Origin_Longitute")->index(),
-                                          get_real_variable("neu_Origin_Altitude")->index(),
-                                          get_real_variable("ecef_Vx")->index(),
-                                          get_real_variable("ecef_Vy")->index(),
-                                          get_real_variable("ecef_Vz")->index()}));
+                        "absolute_tolerance", [this] { return m_AbsoluteTolerance; }, [this](double value) { m_AbsoluteTolerance = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
 
+        // Longest integrator segment; communication points inside a segment are interpolated [s]
         register_variable(
                 real(
-                        "eci_Vy", [this] { return m_EciRy; }, [this](double value) { m_EciVy = value; })
-                        .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("mass")->index(),
-                                          get_real_variable("neu_Origin_Latitude")->index(),
-                                          get_real_variable("neu_Origin_Longitute")->index(),
-                                          get_real_variable("neu_Origin_Altitude")->index(),
-                                          get_real_variable("ecef_Vx")->index(),
-                                          get_real_variable("ecef_Vy")->index(),
-                                          get_real_variable("ecef_Vz")->index()}));
-  
+                        "max_step", [this] { return m_MaxStep; }, [this](double value) { m_MaxStep = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        // Time since the ECEF and ECI axes coincided, at simulation time zero
         register_variable(
                 real(
-                        "eci_Vz", [this] { return m_EciRz; }, [this](double value) { m_EciVz = value; })
-                        .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("mass")->index(),
-                                          get_real_variable("neu_Origin_Latitude")->index(),
-                                          get_real_variable("neu_Origin_Longitute")->index(),
-                                          get_real_variable("neu_Origin_Altitude")->index(),
-                                          get_real_variable("ecef_Vx")->index(),
-                                          get_real_variable("ecef_Vy")->index(),
-                                          get_real_variable("ecef_Vz")->index()}));
-        
+                        "time_since_epoch", [this] { return m_TimeSinceEpoch; }, [this](double value) { m_TimeSinceEpoch = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
         register_variable(
                 real(
-                        "ecef_Rx", [this] { return m_EciRx; }, [this](double value) { m_EcefRx = value; })
-                        .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("mass")->index(),
-                                          get_real_variable("neu_Origin_Latitude")->index(),
-                                          get_real_variable("neu_Origin_Longitute")->index(),
-                                          get_real_variable("neu_Origin_Altitude")->index(),
-                                          get_real_variable("ecif_Rx")->index(),
-                                          get_real_variable("ecif_Ry")->index(),
-                                          get_real_variable("ecif_Rz")->index()}));
+                        "neu_Origin_Latitude", [this] { return m_NeuOriginLatitude; }, [this](double value) { m_NeuOriginLatitude = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
 
         register_variable(
                 real(
-                        "ecef_Ry", [this] { return m_EciRy; }, [this](double value) { m_EcefRy = value; })
-                        .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("mass")->index(),
-                                          get_real_variable("neu_Origin_Latitude")->index(),
-                                          get_real_variable("neu_Origin_Longitute")->index(),
-                                          get_real_variable("neu_Origin_Altitude")->index(),
-                                          get_real_variable("eci_Rx")->index(),
-                                          get_real_variable("eci_Ry")->index(),
-                                          get_real_variable("eci_Rz")->index()}));
-  
+                        "neu_Origin_Longitude", [this] { return m_NeuOriginLongitude; }, [this](double value) { m_NeuOriginLongitude = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
         register_variable(
                 real(
-                        "ecef_Rz", [this] { return m_EciRz; }, [this](double value) { m_EcefRz = value; })
-                        .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("mass")->index(),
-                                          get_real_variable("neu_Origin_Latitude")->index(),
-                                          get_real_variable("neu_Origin_Longitute")->index(),
-                                          get_real_variable("neu_Origin_Altitude")->index(),
-                                          get_real_variable("eci_Rx")->index(),
-                                          get_real_variable("eci_Ry")->index(),
-                                          get_real_variable("eci_Rz")->index()}));
-     
+                        "neu_Origin_Altitude", [this] { return m_NeuOriginAltitude; }, [this](double value) { m_NeuOriginAltitude = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        const char *axes[3] = {"x", "y", "z"};
+
+        // Initial ECI state
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("initial_eci_r") + axes[i], [this, i] { return m_InitialEciR[i]; },
+                            [this, i](double value) { m_InitialEciR[i] = value; })
+                            .setCausality(causality_t::PARAMETER)
+                            .setVariability(variability_t::FIXED));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("initial_eci_v") + axes[i], [this, i] { return m_InitialEciV[i]; },
+                            [this, i](double value) { m_InitialEciV[i] = value; })
+                            .setCausality(causality_t::PARAMETER)
+                            .setVariability(variability_t::FIXED));
+        }
+
+        // Applied force in ECI axes, held constant over a communication step
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("eci_f") + axes[i], [this, i] { return m_EciF[i]; },
+                            [this, i](double value) { m_EciF[i] = value; })
+                            .setCausality(causality_t::INPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        // Outputs are states or functions of them, so none depends directly on the inputs
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("eci_r") + axes[i], [this, i] { return m_EciR[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("eci_v") + axes[i], [this, i] { return m_EciV[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("ecef_r") + axes[i], [this, i] { return m_EcefR[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("ecef_v") + axes[i], [this, i] { return m_EcefV[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("neu_r") + axes[i], [this, i] { return m_NeuR[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
         register_variable(
                 real(
-                        "ecef_Vx", [this] { return m_EciRx; }, [this](double value) { m_EcefVx = value; })
+                        "latitude", [this] { return m_Latitude; })
                         .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("mass")->index(),
-                                          get_real_variable("neu_Origin_Latitude")->index(),
-                                          get_real_variable("neu_Origin_Longitute")->index(),
-                                          get_real_variable("neu_Origin_Altitude")->index(),
-                                          get_real_variable("eci_Vx")->index(),
-                                          get_real_variable("eci_Vy")->index(),
-                                          get_real_variable("eci_Vz")->index()}));
+                        .setVariability(variability_t::CONTINUOUS));
 
         register_variable(
                 real(
-                        "ecef_Vy", [this] { return m_EciRy; }, [this](double value) { m_EcefVy = value; })
+                        "longitude", [this] { return m_Longitude; })
                         .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("mass")->index(),
-                                          get_real_variable("neu_Origin_Latitude")->index(),
-                                          get_real_variable("neu_Origin_Longitute")->index(),
-                                          get_real_variable("neu_Origin_Altitude")->index(),
-                                          get_real_variable("eci_Vx")->index(),
-                                          get_real_variable("eci_Vy")->index(),
-                                          get_real_variable("eci_Vz")->index()}));
-  
+                        .setVariability(variability_t::CONTINUOUS));
+
         register_variable(
                 real(
-                        "ecef_Vz", [this] { return m_EciRz; }, [this](double value) { m_EcefVz = value; })
+                        "altitude", [this] { return m_Altitude; })
                         .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("mass")->index(),
-                                          get_real_variable("neu_Origin_Latitude")->index(),
-                                          get_real_variable("neu_Origin_Longitute")->index(),
-                                          get_real_variable("neu_Origin_Altitude")->index(),
-                                          get_real_variable("eci_Vx")->index(),
-                                          get_real_variable("eci_Vy")->index(),
-                                          get_real_variable("eci_Vz")->index()}));
-            
+                        .setVariability(variability_t::CONTINUOUS));
+
+        // With variational_equations: d x(t) / d x(t0) for the ECI state x = (r, v), and
+        // d x(t) / d p for p = (mass, constant bias on eci_fx, eci_fy, eci_fz)
+        for (int i = 0; i < StateCount; ++i) {
+            for (int j = 0; j < StateCount; ++j) {
+                register_variable(
+                        real(
+                                "stm[" + std::to_string(i + 1) + "," + std::to_string(j + 1) + "]",
+                                [this, i, j] { return m_Transition[i][j]; })
+                                .setCausality(causality_t::OUTPUT)
+                                .setVariability(variability_t::CONTINUOUS));
+            }
+        }
+
+        for (int i = 0; i < StateCount; ++i) {
+            for (int k = 0; k < ParameterCount; ++k) {
+                register_variable(
+                        real(
+                                "sensitivity[" + std::to_string(i + 1) + "," + std::to_string(k + 1) + "]",
+                                [this, i, k] { return m_Sensitivity[i][k]; })
+                                .setCausality(causality_t::OUTPUT)
+                                .setVariability(variability_t::CONTINUOUS));
+            }
+        }
+
         Model::reset();
     }
 
+    void exit_initialisation_mode() override {
+        if (m_Formulation != static_cast<int>(Formulation::Cowell) && m_Formulation != static_cast<int>(Formulation::Encke)) {
+            fail("formulation must be 0 (Cowell) or 1 (Encke)");
+        }
+        if (m_VariationalEquations && m_Formulation != static_cast<int>(Formulation::Cowell)) {
+            fail("variational_equations is available for the Cowell formulation (0) only");
+        }
+        if (!Integration::isMethod(m_Integrator)) {
+            fail("integrator must be between 0 and " + std::to_string(static_cast<int>(Integration::Method::FixedAutoSwitch)) +
+                 ", got " + std::to_string(m_Integrator));
+        }
+        // The integrator is fixed from here on; every step dispatches once into the chosen model type
+        initialise(startTime());
+        updateOutputs(startTime());
+    }
+
     bool do_step(double currentTime, double dt) override {
 
         try{
-            
+            // The integrator may already be past currentTime on the old input
+            if (m_EciF != m_AppliedF) {
+                withSystem([&](auto &system) {
+                    system.restart(currentTime);
+                    system.visit([this](auto &model) { model.Force = m_EciF; });
+                });
+                m_AppliedF = m_EciF;
+            }
+            updateOutputs(currentTime + dt);
             return true;
         }catch(...){
             return false;
-        } 
+        }
     }
 
     void reset() override {
        m_Mass = 1.0; //kg
+       m_TimeSinceEpoch = 0.0;
 
-       // Set the location on the surface of earth 
+       // Set the location on the surface of earth
        // where the prime meridian intersects the equator
        m_NeuOriginLatitude = 0.0;
        m_NeuOriginLongitude = 0.0;
        m_NeuOriginAltitude = 0.0;
 
+       // Circular equatorial orbit at 400 km altitude
+       m_InitialEciR = {6778137.0, 0.0, 0.0};
+       m_InitialEciV = {0.0, 7668.56, 0.0};
 
-    
+       m_EciF = {0.0, 0.0, 0.0};
+
+       m_Formulation = static_cast<int>(Formulation::Cowell);
+       m_VariationalEquations = false;
+       m_RectificationThreshold = 1e-3;
+       m_Integrator = static_cast<int>(Integration::Method::ROW6A);
+       m_FixedStep = 1.0;
+       m_RelativeTolerance = 0.0;
+       m_AbsoluteTolerance = 1e-6;
+       m_MaxStep = 60.0;
+
+       initialise(0.0);
+       updateOutputs(0.0);
     }
 
 private:
-    DynamicModel<OdeROW6A> m_DynamicSystem;
-    // /********Inertial properties**********************************/
-    // double m_Mass;
-    // /*************************************************************/
+    // The FMI wrapper drops exception messages, so log them before failing
+    [[noreturn]] void fail(const std::string &message) {
+        log(fmi2Error, message);
+        throw std::runtime_error(message);
+    }
+
+    // Run f on the integrator of the chosen formulation
+    template<class F>
+    void withSystem(F &&f) {
+        if (m_VariationalEquations) {
+            f(m_VariationalSystem);
+        } else if (m_Formulation == static_cast<int>(Formulation::Encke)) {
+            f(m_EnckeSystem);
+        } else {
+            f(m_CowellSystem);
+        }
+    }
+
+    void initialise(double time) {
+        for (int i = 0; i < StateCount; ++i) {
+            for (int j = 0; j < StateCount; ++j) m_Transition[i][j] = (i == j) ? 1.0 : 0.0;
+            m_Sensitivity[i].fill(0.0);
+        }
+        withSystem([&](auto &system) {
+            system.select(m_Integrator);
+            system.visit([this](auto &model) {
+                model.Mass = m_Mass;
+                model.Force = m_EciF;
+                if constexpr (requires { model.RectificationThreshold; }) {
+                    model.RectificationThreshold = m_RectificationThreshold;
+                }
+                model.SetState(m_InitialEciR, m_InitialEciV);
+            });
+            system.start(time, stepSettings());
+        });
+        m_AppliedF = m_EciF;
+    }
+
+    Integration::StepSettings stepSettings() const {
+        Integration::StepSettings settings;
+        settings.relativeTolerance = m_RelativeTolerance > 0.0 ? m_RelativeTolerance : tolerance().value_or(DefaultRelativeTolerance);
+        settings.absoluteTolerance = m_AbsoluteTolerance;
+        settings.fixedStep = m_FixedStep;
+        settings.maxStep = m_MaxStep;
+        return settings;
+    }
+
+    // Outputs at time from the dense output of the integrator
+    void updateOutputs(double time) {
+        withSystem([&](auto &system) {
+            const std::vector<double> &y = system.advanceTo(time);
+            system.visit([&](auto &model) {
+                model.ToEci(y.data(), m_EciR, m_EciV);
+                if constexpr (requires { model.GetTransition(0, 0); }) {
+                    using System = std::decay_t<decltype(model)>;
+                    for (int i = 0; i < StateCount; ++i) {
+                        for (int j = 0; j < StateCount; ++j) m_Transition[i][j] = y[System::TransitionIndex(i, j)];
+                        for (int k = 0; k < ParameterCount; ++k) m_Sensitivity[i][k] = y[System::SensitivityIndex(i, k)];
+                    }
+                }
+            });
+        });
+
+        // One rotation for position and velocity
+        Coordinate::EcefEciTransform transform(m_TimeSinceEpoch + time);
+        m_EcefR = transform.toEcef(m_EciR);
+        m_EcefV = transform.toEcefVelocity(m_EciR, m_EciV);
+
+        Coordinate::ecefToLatLonAlt(m_EcefR[0], m_EcefR[1], m_EcefR[2], m_Latitude, m_Longitude, m_Altitude);
+        m_NeuR = Coordinate::ecefToNeuPosition(m_EcefR[0], m_EcefR[1], m_EcefR[2],
+                                               m_NeuOriginLatitude, m_NeuOriginLongitude, m_NeuOriginAltitude);
+    }
+
+    CowellSystem m_CowellSystem;
+    EnckeSystem m_EnckeSystem;
+    VariationalSystem m_VariationalSystem;
+    int m_Formulation;
+    bool m_VariationalEquations;
+    double m_RectificationThreshold;
+    int m_Integrator;
+    double m_FixedStep;
+    double m_RelativeTolerance;
+    double m_AbsoluteTolerance;
+    double m_MaxStep;
+
+    /********Inertial properties**********************************/
+    double m_Mass;
+    /*************************************************************/
+
+    double m_TimeSinceEpoch;
 
     double m_NeuOriginLatitude;   // in WGS-84 geodetic coordinates
     double m_NeuOriginLongitude;
-    double m_NeuOriginAltitude;    
+    double m_NeuOriginAltitude;
 
-    /*****State variables to be integrated by the dynamic model*/
-    double m_EciRx;
-    double m_EciRy;
-    double m_EciRz;
+    std::array<double, 3> m_InitialEciR;
+    std::array<double, 3> m_InitialEciV;
+    std::array<double, 3> m_EciF;
+    std::array<double, 3> m_AppliedF; // input the integrator currently holds
 
-    double m_EciVx;
-    double m_EciVy;
-    double m_EciVz;
+    /*****State variables integrated by the dynamic model*********/
+    std::array<double, 3> m_EciR;
+    std::array<double, 3> m_EciV;
     /************************************************************/
 
-    /********Helper coordinate frames****************************/
-    double m_EcefRx;
-    double m_EcefRy;
-    double m_EcefRz;
+    /*****Variations, identity and zero without the variational equations*/
+    std::array<std::array<double, StateCount>, StateCount> m_Transition;
+    std::array<std::array<double, ParameterCount>, StateCount> m_Sensitivity;
+    /************************************************************/
 
-    double m_EcefVx;
-    double m_EcefVy;
-    double m_EcefVz;
+    /********Helper coordinate frames****************************/
+    std::array<double, 3> m_EcefR;
+    std::array<double, 3> m_EcefV;
+    std::array<double, 3> m_NeuR;
+    double m_Latitude;
+    double m_Longitude;
+    double m_Altitude;
     /**************************************************************/
- 
+
 };
 
 model_info fmu4cpp::get_model_info() {
@@ -283,4 +457,4 @@ model_info fmu4cpp::get_model_info() {
 
 std::unique_ptr<fmu_base> fmu4cpp::createInstance(const std::string &instanceName, const std::string &fmuResourceLocation) {
     return std::make_unique<Model>(instanceName, fmuResourceLocation);
-}
\ No newline at end of file
+}
@@ -1,47 +1,120 @@
+/*
+ * -----------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [DynamicModel.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Translational dynamics of a point mass in the ECI frame:
+ *  states (rx, ry, rz, vx, vy, vz), J2 gravity plus an applied force.
+ *  The J2 field is symmetric about the rotation axis, so gravity can be evaluated
+ *  directly in ECI axes; Earth rotation enters through the ECEF outputs of the FMU.
+ *  The Jacobian is analytic, [0 I; G 0] with G the gravity-gradient tensor, so
+ *  implicit integrators never fall back to finite differences. ode_param gives the
+ *  derivatives with respect to the mass and the force for the variational
+ *  equations (Variational.h).]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef DYNAMIC_MODEL_3DOF_H
+#define DYNAMIC_MODEL_3DOF_H
+
+#include <array>
+
+#include "FixedSizeIntegrators.h"
+#include "GravitationalModels.h"
 
 template<class Integrator>
-class DynamicModel : public Integrator {
+class DynamicModel : public Integration::Bind<Integrator, DynamicModel<Integrator>> {
+
+        using Solver = Integration::Bind<Integrator, DynamicModel>;
 
     public:
+        static constexpr int StateCount = 6;
+        static constexpr int ParameterCount = 4;  // Mass, Force (ode_param)
+
         //parameters
-        double CutOffFrequency;
-      
-        //constructor
-        DynamicModel () : Integrator (6) {/*empty*/}
+        double Mass = 1.0;                             // [kg]
+        std::array<double, 3> Force = {0.0, 0.0, 0.0}; // applied force in ECI axes [N], held over a step
+
+        //constructor; systems built on this one (Variational.h) pass their own size
+        DynamicModel (int neq = StateCount) : Solver (neq) {/*empty*/}
 
         //system of equations
         void ode_fun (double* solin, double* fout) {
             //alias
-            double eci_rx   = solin[0];
-            double eci_ry   = solin[1];
-            double eci_rz   = solin[2];
+            const double eci_rx = solin[0];
+            const double eci_ry = solin[1];
+            const double eci_rz = solin[2];
+
+            const auto g = J2::calculateGravitationalAcceleration(eci_rx, eci_ry, eci_rz);
 
             //evaluate derivatives
-            fout[0] = -1.0/TimeConstant() * Output + 1.0/TimeConstant() * Input;
-            fout[1] = 0.0;    
+            fout[0] = solin[3];
+            fout[1] = solin[4];
+            fout[2] = solin[5];
+            fout[3] = g[0] + Force[0] / Mass;
+            fout[4] = g[1] + Force[1] / Mass;
+            fout[5] = g[2] + Force[2] / Mass;
         }
+
         //jacobian
         void ode_jac (double* solin, double** Jout) {
-            //alias
-         
-            Jout[0][0] = -1.0/TimeConstant();   Jout[0][1] = 1.0/TimeConstant();
-            Jout[1][0] =  0.0;                  Jout[1][1] = 0.0;
+            const auto G = J2::calculateGravityGradient(solin[0], solin[1], solin[2]).gradient;
+
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    Jout[i][j] = 0.0;
+                    Jout[i][j + 3] = (i == j) ? 1.0 : 0.0;
+                    Jout[i + 3][j] = G[i][j];
+                    Jout[i + 3][j + 3] = 0.0;
+                }
+            }
         }
 
-        void SetInput(double value){
-            this->set_sol(1, value);
+        //derivatives with respect to Mass and the three Force components
+        void ode_param (double* /*solin*/, double** Pout) {
+            for (int i = 0; i < StateCount; ++i) {
+                for (int k = 0; k < ParameterCount; ++k) Pout[i][k] = 0.0;
+            }
+            for (int i = 0; i < 3; ++i) {
+                Pout[3 + i][0] = -Force[i] / (Mass * Mass);
+                Pout[3 + i][1 + i] = 1.0 / Mass;
+            }
         }
 
-         double GetInput(){
-           return this->get_sol(1);
+        void SetState(const std::array<double, 3>& r, const std::array<double, 3>& v) {
+            for (int i = 0; i < 3; ++i) {
+                this->set_sol(i, r[i]);
+                this->set_sol(i + 3, v[i]);
+            }
         }
 
-        void SetOutput(double value){
-            this->set_sol(0, value);
+        // ECI position and velocity of a state vector; the states are these already
+        void ToEci(const double* state, std::array<double, 3>& r, std::array<double, 3>& v) {
+            for (int i = 0; i < 3; ++i) {
+                r[i] = state[i];
+                v[i] = state[3 + i];
+            }
         }
 
-        double GetOutput(){
-            return this->get_sol(0);
+        std::array<double, 3> GetPosition() {
+            return {this->get_sol(0), this->get_sol(1), this->get_sol(2)};
         }
 
-};
\ No newline at end of file
+        std::array<double, 3> GetVelocity() {
+            return {this->get_sol(3), this->get_sol(4), this->get_sol(5)};
+        }
+
+};
+
+#endif // DYNAMIC_MODEL_3DOF_H
@@ -0,0 +1,159 @@
+/*
+ * -----------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [EnckeModel.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Encke formulation of the 3DoF dynamics of DynamicModel.h: the states are the
+ *  deviation (dr, dv) from a two-body reference orbit and the time tau since the
+ *  reference epoch,
+ *      dr' = dv
+ *      dv' = -GM/rho^3 [ dr + f(q) r ] + a_J2(r) + F / m
+ *      tau' = 1
+ *  with rho(tau) from universal-variable Kepler propagation and r = rho + dr. The
+ *  deviation grows slowly, so an error controlled integrator takes far longer steps
+ *  than on the full state. Rectify() restarts the reference from the current state
+ *  once |dr| exceeds RectificationThreshold |rho|; IntegratorSelection calls it at
+ *  the start of each segment so the dense output never spans a rectification.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef ENCKE_MODEL_3DOF_H
+#define ENCKE_MODEL_3DOF_H
+
+#include <array>
+
+#include "FixedSizeIntegrators.h"
+#include "GravitationalModels.h"
+#include "TwoBody.h"
+
+template<class Integrator>
+class EnckeModel : public Integration::Bind<Integrator, EnckeModel<Integrator>> {
+
+        using Solver = Integration::Bind<Integrator, EnckeModel>;
+
+    public:
+        static constexpr int StateCount = 7;
+
+        //parameters
+        double Mass = 1.0;                             // [kg]
+        std::array<double, 3> Force = {0.0, 0.0, 0.0}; // applied force in ECI axes [N], held over a step
+        double RectificationThreshold = 1e-3;          // |dr| / |rho| that restarts the reference
+
+        //constructor
+        EnckeModel () : Solver (StateCount) {/*empty*/}
+
+        //system of equations
+        void ode_fun (double* solin, double* fout) {
+            TwoBody::Vector rho;
+            TwoBody::Vector rhoDot;
+            m_Reference.propagate(solin[6], rho, rhoDot);
+
+            const TwoBody::Vector d = {solin[0], solin[1], solin[2]};
+            const auto central = TwoBody::enckeAcceleration(rho, d, J2::GM);
+            const auto perturbation = J2::calculateJ2Perturbation(rho[0] + d[0], rho[1] + d[1], rho[2] + d[2]);
+
+            //evaluate derivatives
+            for (int i = 0; i < 3; ++i) {
+                fout[i] = solin[3 + i];
+                fout[3 + i] = central[i] + perturbation[i] + Force[i] / Mass;
+            }
+            fout[6] = 1.0;
+        }
+
+        //jacobian: the deviation sees the full gravity gradient at r, the clock the
+        //difference between the gradients at r and on the reference orbit
+        void ode_jac (double* solin, double** Jout) {
+            TwoBody::Vector rho;
+            TwoBody::Vector rhoDot;
+            m_Reference.propagate(solin[6], rho, rhoDot);
+
+            const auto G = J2::calculateGravityGradient(rho[0] + solin[0], rho[1] + solin[1], rho[2] + solin[2]).gradient;
+            const double rho2 = rho[0] * rho[0] + rho[1] * rho[1] + rho[2] * rho[2];
+            const double factor = J2::GM / (rho2 * std::sqrt(rho2));
+
+            for (int i = 0; i < StateCount; ++i) {
+                for (int j = 0; j < StateCount; ++j) Jout[i][j] = 0.0;
+            }
+            for (int i = 0; i < 3; ++i) {
+                Jout[i][i + 3] = 1.0;
+                double column = 0.0;
+                for (int j = 0; j < 3; ++j) {
+                    Jout[i + 3][j] = G[i][j];
+                    // Two-body gradient -GM/rho^3 (I - 3 e e^T) on the reference
+                    const double central = -factor * ((i == j ? 1.0 : 0.0) - 3.0 * rho[i] * rho[j] / rho2);
+                    column += (G[i][j] - central) * rhoDot[j];
+                }
+                Jout[i + 3][6] = column;
+            }
+        }
+
+        // New reference orbit through (r, v), zero deviation
+        void SetState(const std::array<double, 3>& r, const std::array<double, 3>& v) {
+            m_Reference.set(r, v, J2::GM);
+            for (int i = 0; i < StateCount; ++i) {
+                this->set_sol(i, 0.0);
+            }
+        }
+
+        // Restart the reference at the current state if the deviation has grown past the
+        // threshold; true if it did
+        bool Rectify() {
+            std::array<double, 3> r;
+            std::array<double, 3> v;
+            const double state[StateCount] = {this->get_sol(0), this->get_sol(1), this->get_sol(2), this->get_sol(3),
+                                              this->get_sol(4), this->get_sol(5), this->get_sol(6)};
+            ToEci(state, r, v);
+            const double d2 = state[0] * state[0] + state[1] * state[1] + state[2] * state[2];
+            const double r2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+            if (d2 <= RectificationThreshold * RectificationThreshold * r2) {
+                return false;
+            }
+            SetState(r, v);
+            return true;
+        }
+
+        // ECI position and velocity of a state vector
+        void ToEci(const double* state, std::array<double, 3>& r, std::array<double, 3>& v) {
+            TwoBody::Vector rho;
+            TwoBody::Vector rhoDot;
+            m_Reference.propagate(state[6], rho, rhoDot);
+            for (int i = 0; i < 3; ++i) {
+                r[i] = rho[i] + state[i];
+                v[i] = rhoDot[i] + state[3 + i];
+            }
+        }
+
+        std::array<double, 3> GetPosition() {
+            const double state[StateCount] = {this->get_sol(0), this->get_sol(1), this->get_sol(2), this->get_sol(3),
+                                              this->get_sol(4), this->get_sol(5), this->get_sol(6)};
+            std::array<double, 3> r;
+            std::array<double, 3> v;
+            ToEci(state, r, v);
+            return r;
+        }
+
+        std::array<double, 3> GetVelocity() {
+            const double state[StateCount] = {this->get_sol(0), this->get_sol(1), this->get_sol(2), this->get_sol(3),
+                                              this->get_sol(4), this->get_sol(5), this->get_sol(6)};
+            std::array<double, 3> r;
+            std::array<double, 3> v;
+            ToEci(state, r, v);
+            return v;
+        }
+
+    private:
+        TwoBody::KeplerOrbit m_Reference;
+};
+
+#endif // ENCKE_MODEL_3DOF_H
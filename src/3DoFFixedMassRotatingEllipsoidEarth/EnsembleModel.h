@@ -0,0 +1,179 @@
+/*
+ * -----------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [EnsembleModel.h]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [The 3DoF dynamics of DynamicModel.h for an ensemble of point masses, on the
+ *  tiles of an ensemble integrator (EnsembleIntegrators.h): states (rx, ry, rz,
+ *  vx, vy, vz) in ECI, J2 gravity, an applied force and drag in a US1976
+ *  atmosphere rotating with the Earth,
+ *      a = g_J2(r) + F/m - 1/2 rho(h) (Cd A/m) |v_rel| v_rel,  v_rel = v - w x r
+ *  with mass, force and Cd A per trajectory. Gravity goes through the batch J2
+ *  kernel of BatchKernels.h, so the whole tile is one SIMD sweep. The altitude is
+ *  taken above the ellipsoid at the geocentric latitude, a(1 - f sin^2), within
+ *  tens of metres of the geodetic one, and the atmosphere is only evaluated for
+ *  tiles with a lane below its top; above it the drag is zero. Without drag the
+ *  dynamics are those of DynamicModel.
+ *
+ *  With Environment = float the model runs in mixed precision for low fidelity
+ *  dispersion sweeps: the state, its integration, gravity and the applied force stay
+ *  in double, and the atmosphere and drag are evaluated in float, with the closed
+ *  form density of BatchKernels.h at twice the SIMD width. Float only sees
+ *  quantities taken relative to a local origin in double first: the altitude above
+ *  the ellipsoid under the lane, rather than r - a of single precision radii, which
+ *  would cancel seven of their digits, and the wind relative to the rotating air.
+ *  Gravity stays in double: its cost is the square root and division of the central
+ *  term, which double precision needs, while the J2 term is a few products more.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#ifndef ENSEMBLE_MODEL_3DOF_H
+#define ENSEMBLE_MODEL_3DOF_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "AtmosphericModels.h"
+#include "BatchKernels.h"
+#include "EarthCenteredFrames.h"
+#include "EnsembleIntegrators.h"
+
+template<class Integrator, class Environment = double>
+class EnsembleModel : public Integrator {
+
+    static_assert(std::is_same_v<Environment, double> || std::is_same_v<Environment, float>,
+                  "the environment is evaluated in double or in float");
+
+    public:
+        static constexpr int StateCount = 6;
+        static constexpr int Lanes = Integrator::LaneCount;
+        using typename Integrator::Block;
+        using typename Integrator::Lane;
+
+        //constructor: count trajectories of unit mass, no force and no drag
+        explicit EnsembleModel (std::size_t count) : Integrator (count), m_Parameters(this->tiles()) {
+            for (auto& p : m_Parameters) {
+                p.mass.fill(1.0);
+                for (auto& f : p.force) f.fill(0.0);
+                p.dragArea.fill(0.0);
+            }
+        }
+
+        //system of equations for one tile
+        void ode_fun (std::size_t tile, const Block& x, Block& f) {
+            const Parameters& p = m_Parameters[tile];
+
+            J2::calculateGravitationalAcceleration(std::span<const double>(x[0]), std::span<const double>(x[1]),
+                                                   std::span<const double>(x[2]), std::span<double>(f[3]),
+                                                   std::span<double>(f[4]), std::span<double>(f[5]));
+
+            for (int l = 0; l < Lanes; ++l) {
+                f[0][l] = x[3][l];
+                f[1][l] = x[4][l];
+                f[2][l] = x[5][l];
+                f[3][l] += p.force[0][l] / p.mass[l];
+                f[4][l] += p.force[1][l] / p.mass[l];
+                f[5][l] += p.force[2][l] / p.mass[l];
+            }
+
+            // Lanes below the top of the atmosphere at the equator, the highest it can be
+            long inAtmosphere = 0;
+            for (int l = 0; l < Lanes; ++l) {
+                const double r2 = x[0][l] * x[0][l] + x[1][l] * x[1][l] + x[2][l] * x[2][l];
+                inAtmosphere += (r2 < AtmosphereRadius2) & (p.dragArea[l] > 0.0);
+            }
+            if (inAtmosphere > 0) addDrag(tile, x, f);
+        }
+
+        void SetState(std::size_t trajectory, const std::array<double, 3>& r, const std::array<double, 3>& v) {
+            for (int i = 0; i < 3; ++i) {
+                this->set_sol(trajectory, i, r[i]);
+                this->set_sol(trajectory, i + 3, v[i]);
+            }
+        }
+
+        void SetMass(std::size_t trajectory, double mass) { m_Parameters[trajectory / Lanes].mass[trajectory % Lanes] = mass; }
+
+        // Applied force in ECI axes [N], held over the solve
+        void SetForce(std::size_t trajectory, const std::array<double, 3>& force) {
+            Parameters& p = m_Parameters[trajectory / Lanes];
+            for (int i = 0; i < 3; ++i) p.force[i][trajectory % Lanes] = force[i];
+        }
+
+        // Drag coefficient times reference area [m^2]
+        void SetDragArea(std::size_t trajectory, double dragArea) {
+            m_Parameters[trajectory / Lanes].dragArea[trajectory % Lanes] = dragArea;
+        }
+
+        std::array<double, 3> GetPosition(std::size_t trajectory) const {
+            return {this->get_sol(trajectory, 0), this->get_sol(trajectory, 1), this->get_sol(trajectory, 2)};
+        }
+
+        std::array<double, 3> GetVelocity(std::size_t trajectory) const {
+            return {this->get_sol(trajectory, 3), this->get_sol(trajectory, 4), this->get_sol(trajectory, 5)};
+        }
+
+    private:
+        using EnvironmentLane = std::array<Environment, Lanes>;
+
+        struct alignas(64) Parameters {
+            Lane mass;
+            std::array<Lane, 3> force;
+            Lane dragArea;
+        };
+
+        static constexpr double Flattening = 1.0 / 298.257223563; // WGS84
+        static constexpr double AtmosphereRadius2 =
+                (Coordinate::EARTH_SEMI_MAJOR_AXIS + US1976::layers.back().altitude_max) *
+                (Coordinate::EARTH_SEMI_MAJOR_AXIS + US1976::layers.back().altitude_max);
+
+        void addDrag(std::size_t tile, const Block& x, Block& f) {
+            const Parameters& p = m_Parameters[tile];
+            constexpr double w = Coordinate::EARTH_ROTATION_RATE;
+            constexpr double top = US1976::layers.back().altitude_max;
+
+            for (int l = 0; l < Lanes; ++l) {
+                const double r2 = x[0][l] * x[0][l] + x[1][l] * x[1][l] + x[2][l] * x[2][l];
+                const double r = std::sqrt(r2);
+                const double h = r - Coordinate::EARTH_SEMI_MAJOR_AXIS * (1.0 - Flattening * x[2][l] * x[2][l] / r2);
+                // Out of the table the density is dropped; the top is clamped only to keep it defined
+                m_Altitude[l] = static_cast<Environment>(std::clamp(h, 0.0, top));
+                m_Outside[l] = (h < 0.0) | (h > top);
+            }
+            US1976::Density(std::span<const Environment>(m_Altitude), std::span<Environment>(m_Density));
+
+            for (int l = 0; l < Lanes; ++l) {
+                const Environment rho = m_Outside[l] ? Environment(0) : m_Density[l];
+                const Environment vx = static_cast<Environment>(x[3][l] + w * x[1][l]);
+                const Environment vy = static_cast<Environment>(x[4][l] - w * x[0][l]);
+                const Environment vz = static_cast<Environment>(x[5][l]);
+                const Environment k = Environment(-0.5) * rho * static_cast<Environment>(p.dragArea[l]) /
+                                      static_cast<Environment>(p.mass[l]) * std::sqrt(vx * vx + vy * vy + vz * vz);
+                f[3][l] += k * vx;
+                f[4][l] += k * vy;
+                f[5][l] += k * vz;
+            }
+        }
+
+        std::vector<Parameters> m_Parameters;
+        EnvironmentLane m_Altitude{};
+        EnvironmentLane m_Density{};
+        std::array<bool, Lanes> m_Outside{};
+};
+
+#endif // ENSEMBLE_MODEL_3DOF_H
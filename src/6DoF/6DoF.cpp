@@ -1,16 +1,21 @@
 /*
  * -----------------------------------------------------------------------------------
  * Project:     [EBEK]
- * File:        [testJ2000Timing.cpp]
+ * File:        [6DoF.cpp]
  * Author:      Prof.Dr. Onur Tuncer
  * Email:       onur.tuncer@itu.edu.tr
  * Institution: Istanbul Technical University
  *              Faculty of Aeronautics and Astronuatics
- * 
+ *
  * Date:        2024
  *
  * Description:
- * [6 DoF Fixed mass FMU]
+ * [6 DoF Fixed mass FMU.
+ *  Rigid body in ECI with J2 gravity, body axis force and moment inputs and a
+ *  constant inertia tensor; integrated by the method chosen by the "integrator"
+ *  parameter, OdeROW6A by default. With "variational_equations" the state
+ *  transition matrix and the sensitivities to mass, force and moment
+ *  (Variational.h) are integrated with the state.]
  *
  * License:
  * [See License.txt in the top level directory for licence and copyright information]
@@ -18,3 +23,431 @@
  * -----------------------------------------------------------------------------------
  */
 
+#include <fmu4cpp/fmu_base.hpp>
+#include "EarthCenteredFrames.h"
+#include "DynamicModel.h"
+#include "IntegratorSelection.h"
+#include "Variational.h"
+
+#include <stdexcept>
+#include <string>
+
+using namespace fmu4cpp;
+
+using DynamicSystem = Integration::IntegratorSelection<DynamicModel>;
+using VariationalSystem = Integration::IntegratorSelection<Integration::Variational<DynamicModel>::System>;
+
+constexpr int StateCount = 13;
+constexpr int ParameterCount = 7;
+
+constexpr double DefaultRelativeTolerance = 1e-10;
+
+class Model : public fmu_base {
+
+public:
+    Model(const std::string &instanceName, const std::string &resources)
+        : fmu_base(instanceName, resources) {
+
+        register_variable(
+                real(
+                        "mass", [this] { return m_Mass; }, [this](double value) { m_Mass = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        // Inertia tensor about the centre of mass in body axes, symmetric
+        const char *inertia[6] = {"Ixx", "Iyy", "Izz", "Ixy", "Ixz", "Iyz"};
+        const int rows[6] = {0, 1, 2, 0, 0, 1};
+        const int columns[6] = {0, 1, 2, 1, 2, 2};
+        for (int k = 0; k < 6; ++k) {
+            const int i = rows[k];
+            const int j = columns[k];
+            register_variable(
+                    real(
+                            inertia[k], [this, i, j] { return m_Inertia[i][j]; },
+                            [this, i, j](double value) { m_Inertia[i][j] = value; m_Inertia[j][i] = value; })
+                            .setCausality(causality_t::PARAMETER)
+                            .setVariability(variability_t::FIXED));
+        }
+
+        // Integration method, see Integration::Method: 0 RK4, 1 DoPri54, 2 DoPri87, 3 GRK4A, 4 ROW6A, 5 RadauIIA,
+        // 6 FixedDoPri54, 7 FixedROS34PW2 (fixed size, allocation free), 8 FixedROS34PW2Reuse,
+        // 9 FixedAutoSwitch (explicit or Rosenbrock by stiffness)
+        register_variable(
+                integer(
+                        "integrator", [this] { return m_Integrator; }, [this](int value) { m_Integrator = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        // Integrate the variational equations with the state
+        register_variable(
+                boolean(
+                        "variational_equations", [this] { return m_VariationalEquations; },
+                        [this](bool value) { m_VariationalEquations = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        // Substep of the fixed step methods [s]
+        register_variable(
+                real(
+                        "fixed_step", [this] { return m_FixedStep; }, [this](double value) { m_FixedStep = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        // Relative tolerance of the adaptive methods; 0 takes the tolerance of the experiment
+        register_variable(
+                real(
+                        "relative_tolerance", [this] { return m_RelativeTolerance; }, [this](double value) { m_RelativeTolerance = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                real(
+                        "absolute_tolerance", [this] { return m_AbsoluteTolerance; }, [this](double value) { m_AbsoluteTolerance = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        // Longest integrator segment; communication points inside a segment are interpolated [s]
+        register_variable(
+                real(
+                        "max_step", [this] { return m_MaxStep; }, [this](double value) { m_MaxStep = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        // Time since the ECEF and ECI axes coincided, at simulation time zero
+        register_variable(
+                real(
+                        "time_since_epoch", [this] { return m_TimeSinceEpoch; }, [this](double value) { m_TimeSinceEpoch = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        const char *axes[3] = {"x", "y", "z"};
+
+        // Initial state
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("initial_eci_r") + axes[i], [this, i] { return m_InitialEciR[i]; },
+                            [this, i](double value) { m_InitialEciR[i] = value; })
+                            .setCausality(causality_t::PARAMETER)
+                            .setVariability(variability_t::FIXED));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("initial_eci_v") + axes[i], [this, i] { return m_InitialEciV[i]; },
+                            [this, i](double value) { m_InitialEciV[i] = value; })
+                            .setCausality(causality_t::PARAMETER)
+                            .setVariability(variability_t::FIXED));
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            register_variable(
+                    real(
+                            "initial_q" + std::to_string(i), [this, i] { return m_InitialQ[i]; },
+                            [this, i](double value) { m_InitialQ[i] = value; })
+                            .setCausality(causality_t::PARAMETER)
+                            .setVariability(variability_t::FIXED));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("initial_body_w") + axes[i], [this, i] { return m_InitialW[i]; },
+                            [this, i](double value) { m_InitialW[i] = value; })
+                            .setCausality(causality_t::PARAMETER)
+                            .setVariability(variability_t::FIXED));
+        }
+
+        // Force and moment in body axes, held constant over a communication step
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("body_f") + axes[i], [this, i] { return m_BodyF[i]; },
+                            [this, i](double value) { m_BodyF[i] = value; })
+                            .setCausality(causality_t::INPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("body_m") + axes[i], [this, i] { return m_BodyM[i]; },
+                            [this, i](double value) { m_BodyM[i] = value; })
+                            .setCausality(causality_t::INPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        // Outputs are states or functions of them, so none depends directly on the inputs
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("eci_r") + axes[i], [this, i] { return m_EciR[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("eci_v") + axes[i], [this, i] { return m_EciV[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            register_variable(
+                    real(
+                            "q" + std::to_string(i), [this, i] { return m_Q[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("body_w") + axes[i], [this, i] { return m_W[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("ecef_r") + axes[i], [this, i] { return m_EcefR[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        register_variable(
+                real(
+                        "latitude", [this] { return m_Latitude; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "longitude", [this] { return m_Longitude; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "altitude", [this] { return m_Altitude; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        // With variational_equations: d x(t) / d x(t0) for the state x = (r, v, q, w), and
+        // d x(t) / d p for p = (mass, constant bias on body_fx..fz, body_mx..mz)
+        for (int i = 0; i < StateCount; ++i) {
+            for (int j = 0; j < StateCount; ++j) {
+                register_variable(
+                        real(
+                                "stm[" + std::to_string(i + 1) + "," + std::to_string(j + 1) + "]",
+                                [this, i, j] { return m_Transition[i][j]; })
+                                .setCausality(causality_t::OUTPUT)
+                                .setVariability(variability_t::CONTINUOUS));
+            }
+        }
+
+        for (int i = 0; i < StateCount; ++i) {
+            for (int k = 0; k < ParameterCount; ++k) {
+                register_variable(
+                        real(
+                                "sensitivity[" + std::to_string(i + 1) + "," + std::to_string(k + 1) + "]",
+                                [this, i, k] { return m_Sensitivity[i][k]; })
+                                .setCausality(causality_t::OUTPUT)
+                                .setVariability(variability_t::CONTINUOUS));
+            }
+        }
+
+        Model::reset();
+    }
+
+    void exit_initialisation_mode() override {
+        if (!SmallMatrix::positiveDefinite(m_Inertia)) {
+            fail("The inertia tensor (Ixx, Iyy, Izz, Ixy, Ixz, Iyz) must be positive definite");
+        }
+        if (!Integration::isMethod(m_Integrator)) {
+            fail("integrator must be between 0 and " + std::to_string(static_cast<int>(Integration::Method::FixedAutoSwitch)) +
+                 ", got " + std::to_string(m_Integrator));
+        }
+        // The integrator is fixed from here on; every step dispatches once into the chosen model type
+        initialise(startTime());
+        updateOutputs(startTime());
+    }
+
+    bool do_step(double currentTime, double dt) override {
+
+        try{
+            // The integrator may already be past currentTime on the old inputs
+            if (m_BodyF != m_AppliedF || m_BodyM != m_AppliedM) {
+                withSystem([&](auto &system) {
+                    system.restart(currentTime);
+                    system.visit([this](auto &model) {
+                        model.Force = m_BodyF;
+                        model.Moment = m_BodyM;
+                    });
+                });
+                m_AppliedF = m_BodyF;
+                m_AppliedM = m_BodyM;
+            }
+            updateOutputs(currentTime + dt);
+            return true;
+        }catch(...){
+            return false;
+        }
+    }
+
+    void reset() override {
+       m_Mass = 1.0; //kg
+       m_Inertia = {{{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}}}; //kg m^2
+       m_TimeSinceEpoch = 0.0;
+
+       // Circular equatorial orbit at 400 km altitude, body axes aligned with ECI, at rest
+       m_InitialEciR = {6778137.0, 0.0, 0.0};
+       m_InitialEciV = {0.0, 7668.56, 0.0};
+       m_InitialQ = {1.0, 0.0, 0.0, 0.0};
+       m_InitialW = {0.0, 0.0, 0.0};
+
+       m_BodyF = {0.0, 0.0, 0.0};
+       m_BodyM = {0.0, 0.0, 0.0};
+
+       m_Integrator = static_cast<int>(Integration::Method::ROW6A);
+       m_FixedStep = 0.1;
+       m_RelativeTolerance = 0.0;
+       m_AbsoluteTolerance = 1e-9;
+       m_MaxStep = 10.0;
+       m_VariationalEquations = false;
+
+       initialise(0.0);
+       updateOutputs(0.0);
+    }
+
+private:
+    // The FMI wrapper drops exception messages, so log them before failing
+    [[noreturn]] void fail(const std::string &message) {
+        log(fmi2Error, message);
+        throw std::runtime_error(message);
+    }
+
+    // Run f on the integrator with or without the variational equations
+    template<class F>
+    void withSystem(F &&f) {
+        if (m_VariationalEquations) {
+            f(m_VariationalSystem);
+        } else {
+            f(m_DynamicSystem);
+        }
+    }
+
+    void initialise(double time) {
+        for (int i = 0; i < StateCount; ++i) {
+            for (int j = 0; j < StateCount; ++j) m_Transition[i][j] = (i == j) ? 1.0 : 0.0;
+            m_Sensitivity[i].fill(0.0);
+        }
+        withSystem([&](auto &system) {
+            system.select(m_Integrator);
+            system.visit([this](auto &model) {
+                model.Mass = m_Mass;
+                model.SetInertia(m_Inertia);
+                model.Force = m_BodyF;
+                model.Moment = m_BodyM;
+                model.SetState(m_InitialEciR, m_InitialEciV, m_InitialQ, m_InitialW);
+            });
+            system.start(time, stepSettings());
+        });
+        m_AppliedF = m_BodyF;
+        m_AppliedM = m_BodyM;
+    }
+
+    Integration::StepSettings stepSettings() const {
+        Integration::StepSettings settings;
+        settings.relativeTolerance = m_RelativeTolerance > 0.0 ? m_RelativeTolerance : tolerance().value_or(DefaultRelativeTolerance);
+        settings.absoluteTolerance = m_AbsoluteTolerance;
+        settings.fixedStep = m_FixedStep;
+        settings.maxStep = m_MaxStep;
+        return settings;
+    }
+
+    // Outputs at time from the dense output of the integrator
+    void updateOutputs(double time) {
+        withSystem([&](auto &system) {
+            const std::vector<double> &y = system.advanceTo(time);
+            m_EciR = {y[0], y[1], y[2]};
+            m_EciV = {y[3], y[4], y[5]};
+            m_Q = SmallMatrix::normalise({y[6], y[7], y[8], y[9]});
+            m_W = {y[10], y[11], y[12]};
+            system.visit([&](auto &model) {
+                if constexpr (requires { model.GetTransition(0, 0); }) {
+                    using System = std::decay_t<decltype(model)>;
+                    for (int i = 0; i < StateCount; ++i) {
+                        for (int j = 0; j < StateCount; ++j) m_Transition[i][j] = y[System::TransitionIndex(i, j)];
+                        for (int k = 0; k < ParameterCount; ++k) m_Sensitivity[i][k] = y[System::SensitivityIndex(i, k)];
+                    }
+                }
+            });
+        });
+
+        m_EcefR = Coordinate::EcefEciTransform(m_TimeSinceEpoch + time).toEcef(m_EciR);
+        Coordinate::ecefToLatLonAlt(m_EcefR[0], m_EcefR[1], m_EcefR[2], m_Latitude, m_Longitude, m_Altitude);
+    }
+
+    DynamicSystem m_DynamicSystem;
+    VariationalSystem m_VariationalSystem;
+    bool m_VariationalEquations;
+    int m_Integrator;
+    double m_FixedStep;
+    double m_RelativeTolerance;
+    double m_AbsoluteTolerance;
+    double m_MaxStep;
+
+    /********Inertial properties**********************************/
+    double m_Mass;
+    SmallMatrix::Matrix3 m_Inertia;
+    /*************************************************************/
+
+    double m_TimeSinceEpoch;
+
+    SmallMatrix::Vector3 m_InitialEciR;
+    SmallMatrix::Vector3 m_InitialEciV;
+    SmallMatrix::Quaternion m_InitialQ;
+    SmallMatrix::Vector3 m_InitialW;
+
+    SmallMatrix::Vector3 m_BodyF;
+    SmallMatrix::Vector3 m_BodyM;
+    SmallMatrix::Vector3 m_AppliedF; // inputs the integrator currently holds
+    SmallMatrix::Vector3 m_AppliedM;
+
+    /*****State variables integrated by the dynamic model*********/
+    SmallMatrix::Vector3 m_EciR;
+    SmallMatrix::Vector3 m_EciV;
+    SmallMatrix::Quaternion m_Q;
+    SmallMatrix::Vector3 m_W;
+    /************************************************************/
+
+    /*****Variations, identity and zero without the variational equations*/
+    std::array<std::array<double, StateCount>, StateCount> m_Transition;
+    std::array<std::array<double, ParameterCount>, StateCount> m_Sensitivity;
+    /************************************************************/
+
+    /********Helper coordinate frames****************************/
+    SmallMatrix::Vector3 m_EcefR;
+    double m_Latitude;
+    double m_Longitude;
+    double m_Altitude;
+    /**************************************************************/
+
+};
+
+model_info fmu4cpp::get_model_info() {
+    model_info info;
+    info.modelName = "6DoF";
+    info.description = "6DoF Fixed Mass rigid body with quaternion attitude";
+    info.modelIdentifier = FMU4CPP_MODEL_IDENTIFIER;
+    return info;
+}
+
+std::unique_ptr<fmu_base> fmu4cpp::createInstance(const std::string &instanceName, const std::string &fmuResourceLocation) {
+    return std::make_unique<Model>(instanceName, fmuResourceLocation);
+}
@@ -6,14 +6,209 @@
  * Email:       onur.tuncer@itu.edu.tr
  * Institution: Istanbul Technical University
  *              Faculty of Aeronautics and Astronuatics
- * 
+ *
  * Date:        2024
  *
  * Description:
- * [Dynamic model of 6 DoF Fixed Mass FMU]
+ * [Dynamic model of 6 DoF Fixed Mass FMU (see resources/model.tex).
+ *  States: ECI position r (0-2), ECI velocity v (3-5), attitude quaternion q body to
+ *  ECI (6-9) and body rates w (10-12):
+ *      r' = v
+ *      v' = g_J2(r) + R(q) F / m
+ *      q' = 1/2 Omega(w) q
+ *      w' = I^-1 (M - w x I w)
+ *  with the body force F and moment M held over a communication step. The Jacobian
+ *  is analytic and the quaternion is brought back to unit length after every step;
+ *  after_step_jac is the Jacobian of that normalisation.
+ *  ode_param gives the derivatives with respect to the mass, force and moment for
+ *  the variational equations (Variational.h).]
  *
  * License:
  * [See License.txt in the top level directory for licence and copyright information]
  *
  * -----------------------------------------------------------------------------------
  */
+
+#ifndef DYNAMIC_MODEL_6DOF_H
+#define DYNAMIC_MODEL_6DOF_H
+
+#include "FixedSizeIntegrators.h"
+#include "GravitationalModels.h"
+#include "SmallMatrix.h"
+
+#include <cmath>
+#include <stdexcept>
+
+template<class Integrator>
+class DynamicModel : public Integration::Bind<Integrator, DynamicModel<Integrator>> {
+
+        using Solver = Integration::Bind<Integrator, DynamicModel>;
+
+    public:
+        static constexpr int StateCount = 13;
+        static constexpr int ParameterCount = 7;  // Mass, Force, Moment (ode_param)
+
+        //parameters
+        double Mass = 1.0;                              // [kg]
+        SmallMatrix::Vector3 Force = {0.0, 0.0, 0.0};   // body axes [N]
+        SmallMatrix::Vector3 Moment = {0.0, 0.0, 0.0};  // body axes [Nm]
+
+        //constructor; systems built on this one (Variational.h) pass their own size
+        DynamicModel (int neq = StateCount) : Solver (neq) {/*empty*/}
+
+        // Inertia tensor about the centre of mass in body axes [kg m^2]
+        void SetInertia(const SmallMatrix::Matrix3& inertia) {
+            if (!SmallMatrix::positiveDefinite(inertia)) {
+                throw std::invalid_argument("Inertia tensor must be symmetric positive definite");
+            }
+            m_Inertia = inertia;
+            m_InverseInertia = SmallMatrix::inverse(inertia);
+        }
+
+        //system of equations
+        void ode_fun (double* solin, double* fout) {
+            using namespace SmallMatrix;
+
+            //alias
+            const Quaternion q = {solin[6], solin[7], solin[8], solin[9]};
+            const Vector3 w = {solin[10], solin[11], solin[12]};
+
+            const auto g = J2::calculateGravitationalAcceleration(solin[0], solin[1], solin[2]);
+            const Vector3 a = multiply(rotationMatrix(q), scale(Force, 1.0 / Mass));
+            const Matrix4 Omega = omegaMatrix(w);
+            const Vector3 wdot = multiply(m_InverseInertia, subtract(Moment, cross(w, multiply(m_Inertia, w))));
+
+            //evaluate derivatives
+            for (int i = 0; i < 3; ++i) {
+                fout[i] = solin[3 + i];
+                fout[3 + i] = g[i] + a[i];
+                fout[10 + i] = wdot[i];
+            }
+            for (int i = 0; i < 4; ++i) {
+                fout[6 + i] = 0.5 * (Omega[i][0] * q[0] + Omega[i][1] * q[1] + Omega[i][2] * q[2] + Omega[i][3] * q[3]);
+            }
+        }
+
+        //jacobian
+        void ode_jac (double* solin, double** Jout) {
+            using namespace SmallMatrix;
+
+            const Quaternion q = {solin[6], solin[7], solin[8], solin[9]};
+            const Vector3 w = {solin[10], solin[11], solin[12]};
+
+            for (int i = 0; i < StateCount; ++i) {
+                for (int j = 0; j < StateCount; ++j) {
+                    Jout[i][j] = 0.0;
+                }
+            }
+
+            // r' = v
+            for (int i = 0; i < 3; ++i) {
+                Jout[i][3 + i] = 1.0;
+            }
+
+            // v': gravity gradient and the rotation of the body force
+            const auto G = J2::calculateGravityGradient(solin[0], solin[1], solin[2]).gradient;
+            const auto D = rotationDerivative(q, scale(Force, 1.0 / Mass));
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    Jout[3 + i][j] = G[i][j];
+                }
+                for (int k = 0; k < 4; ++k) {
+                    Jout[3 + i][6 + k] = D[k][i];
+                }
+            }
+
+            // q': 1/2 Omega(w) with respect to q, 1/2 Xi(q) with respect to w
+            const Matrix4 Omega = omegaMatrix(w);
+            const Matrix43 Xi = xiMatrix(q);
+            for (int i = 0; i < 4; ++i) {
+                for (int k = 0; k < 4; ++k) {
+                    Jout[6 + i][6 + k] = 0.5 * Omega[i][k];
+                }
+                for (int j = 0; j < 3; ++j) {
+                    Jout[6 + i][10 + j] = 0.5 * Xi[i][j];
+                }
+            }
+
+            // w': -I^-1 ([w x] I - [(I w) x])
+            const Matrix3 gyro = add(multiply(skew(w), m_Inertia), skew(scale(multiply(m_Inertia, w), -1.0)));
+            const Matrix3 W = multiply(m_InverseInertia, gyro);
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    Jout[10 + i][10 + j] = -W[i][j];
+                }
+            }
+        }
+
+        //derivatives with respect to Mass, the body force and the body moment
+        void ode_param (double* solin, double** Pout) {
+            using namespace SmallMatrix;
+
+            for (int i = 0; i < StateCount; ++i) {
+                for (int k = 0; k < ParameterCount; ++k) Pout[i][k] = 0.0;
+            }
+
+            const Matrix3 R = rotationMatrix({solin[6], solin[7], solin[8], solin[9]});
+            const Vector3 a = multiply(R, Force);
+            for (int i = 0; i < 3; ++i) {
+                Pout[3 + i][0] = -a[i] / (Mass * Mass);
+                for (int j = 0; j < 3; ++j) {
+                    Pout[3 + i][1 + j] = R[i][j] / Mass;
+                    Pout[10 + i][4 + j] = m_InverseInertia[i][j];
+                }
+            }
+        }
+
+        // Keep the attitude on the unit sphere; truncation error of the step otherwise
+        // scales the quaternion and, through R(q), the applied force
+        void after_step (double /*t*/) {
+            const auto q = SmallMatrix::normalise({this->get_sol(6), this->get_sol(7), this->get_sol(8), this->get_sol(9)});
+            for (int i = 0; i < 4; ++i) {
+                this->set_sol(6 + i, q[i]);
+            }
+        }
+
+        // Jacobian of after_step at the state before it, for Variational.h: the identity
+        // but for the quaternion rows, (I - q_hat q_hat^T) / |q| with q_hat = q / |q|
+        void after_step_jac (const double* solin, double** Jout) {
+            for (int i = 0; i < StateCount; ++i) {
+                for (int j = 0; j < StateCount; ++j) {
+                    Jout[i][j] = i == j ? 1.0 : 0.0;
+                }
+            }
+            const SmallMatrix::Quaternion q = {solin[6], solin[7], solin[8], solin[9]};
+            const auto unit = SmallMatrix::normalise(q);
+            const double length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+            for (int i = 0; i < 4; ++i) {
+                for (int k = 0; k < 4; ++k) {
+                    Jout[6 + i][6 + k] = ((i == k ? 1.0 : 0.0) - unit[i] * unit[k]) / length;
+                }
+            }
+        }
+
+        void SetState(const SmallMatrix::Vector3& r, const SmallMatrix::Vector3& v, const SmallMatrix::Quaternion& q,
+                      const SmallMatrix::Vector3& w) {
+            const auto unit = SmallMatrix::normalise(q);
+            for (int i = 0; i < 3; ++i) {
+                this->set_sol(i, r[i]);
+                this->set_sol(3 + i, v[i]);
+                this->set_sol(10 + i, w[i]);
+            }
+            for (int i = 0; i < 4; ++i) {
+                this->set_sol(6 + i, unit[i]);
+            }
+        }
+
+        SmallMatrix::Vector3 GetPosition() { return {this->get_sol(0), this->get_sol(1), this->get_sol(2)}; }
+        SmallMatrix::Vector3 GetVelocity() { return {this->get_sol(3), this->get_sol(4), this->get_sol(5)}; }
+        SmallMatrix::Quaternion GetAttitude() { return {this->get_sol(6), this->get_sol(7), this->get_sol(8), this->get_sol(9)}; }
+        SmallMatrix::Vector3 GetBodyRates() { return {this->get_sol(10), this->get_sol(11), this->get_sol(12)}; }
+
+    private:
+        SmallMatrix::Matrix3 m_Inertia = {{{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}}};
+        SmallMatrix::Matrix3 m_InverseInertia = {{{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}}};
+
+};
+
+#endif // DYNAMIC_MODEL_6DOF_H
@@ -6,11 +6,19 @@
  * Email:       onur.tuncer@itu.edu.tr
  * Institution: Istanbul Technical University
  *              Faculty of Aeronautics and Astronuatics
- * 
+ *
  * Date:        2024
  *
  * Description:
- * [Coordinate transformation from ECEF to ECI frame]
+ * [Coordinate transformation from ECEF to ECI frame.
+ *  Position, velocity and acceleration of up to MaxVehicles vehicles are transformed
+ *  with one rotation per step; vehicle 0 uses the plain variable names and vehicle k
+ *  the suffix _k. Only the first vehicle_count vehicles are evaluated.
+ *  frame_model selects the transformation: 0 rotates about Z by the Earth rotation
+ *  angle since time_since_epoch, 1 applies the IAU-76/FK5 reduction (precession,
+ *  nutation, sidereal time and polar motion) at UTC seconds utc_since_j2000 after
+ *  2000-01-01 12:00 UTC, with Earth orientation parameters read from eop_file in
+ *  the resources folder (none when empty).]
  *
  * License:
  * [See License.txt in the top level directory for licence and copyright information]
@@ -20,109 +28,258 @@
 
 #include <fmu4cpp/fmu_base.hpp>
 #include "EarthCenteredFrames.h"
+#include "EarthOrientation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 using namespace fmu4cpp;
 
+constexpr int MaxVehicles = 8;
+
+// Values of the frame_model parameter
+enum FrameModel { ZRotation = 0, IAU76FK5 = 1 };
+
 class Model : public fmu_base {
 
 public:
     Model(const std::string &instanceName, const std::string &resources)
-        : fmu_base(instanceName, resources) {
+        : fmu_base(instanceName, resources), m_Transform(0.0) {
 
+        // Time since the ECEF and ECI axes coincided, at simulation time zero
         register_variable(
                 real(
-                        "ec", [this] { return m_Tim; }, [this](double value) { m_ = value; })
-                        .setCausality(causality_t::INPUT)
-                        .setVariability(variability_t::CONTINUOUS));
-    
-        register_variable(
-                real(
-                        "ecef_rx", [this] { return m_EcefRx; }, [this](double value) { m_EcefRx = value; })
-                        .setCausality(causality_t::INPUT)
-                        .setVariability(variability_t::CONTINUOUS));
+                        "time_since_epoch", [this] { return m_TimeSinceEpoch; }, [this](double value) { m_TimeSinceEpoch = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
 
         register_variable(
-                real(
-                        "ecef_rx", [this] { return m_EcefRx; }, [this](double value) { m_EcefRx = value; })
-                        .setCausality(causality_t::INPUT)
-                        .setVariability(variability_t::CONTINUOUS));
+                integer(
+                        "frame_model", [this] { return m_FrameModel; }, [this](int value) { m_FrameModel = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
 
+        // UTC seconds since 2000-01-01 12:00 UTC at simulation time zero, IAU-76/FK5 only
         register_variable(
                 real(
-                        "ecef_rx", [this] { return m_EcefRx; }, [this](double value) { m_EcefRx = value; })
-                        .setCausality(causality_t::INPUT)
-                        .setVariability(variability_t::CONTINUOUS));
+                        "utc_since_j2000", [this] { return m_UtcSinceJ2000; }, [this](double value) { m_UtcSinceJ2000 = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
 
-        
         register_variable(
-                real(
-                        "ecef_rx", [this] { return m_EcefRx; }, [this](double value) { m_EcefRx = value; })
-                        .setCausality(causality_t::INPUT)
-                        .setVariability(variability_t::CONTINUOUS));
+                string(
+                        "eop_file", [this] { return m_EopFile; }, [this](std::string value) { m_EopFile = std::move(value); })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
 
         register_variable(
-                real(
-                        "ecef_rx", [this] { return m_EcefRx; }, [this](double value) { m_EcefRx = value; })
-                        .setCausality(causality_t::INPUT)
-                        .setVariability(variability_t::CONTINUOUS));
+                integer(
+                        "vehicle_count", [this] { return m_VehicleCount; }, [this](int value) { m_VehicleCount = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
 
-        register_variable(
-                real(
-                        "ecef_rx", [this] { return m_EcefRx; }, [this](double value) { m_EcefRx = value; })
-                        .setCausality(causality_t::INPUT)
-                        .setVariability(variability_t::CONTINUOUS));
+        const char *axes[3] = {"x", "y", "z"};
+        for (int k = 0; k < MaxVehicles; ++k) {
+            const std::string suffix = k == 0 ? "" : "_" + std::to_string(k);
+
+            for (int i = 0; i < 3; ++i) {
+                register_variable(
+                        real(
+                                "ecef_r" + std::string(axes[i]) + suffix, [this, k, i] { return m_EcefR[k][i]; },
+                                [this, k, i](double value) { m_EcefR[k][i] = value; })
+                                .setCausality(causality_t::INPUT)
+                                .setVariability(variability_t::CONTINUOUS));
+            }
+
+            for (int i = 0; i < 3; ++i) {
+                register_variable(
+                        real(
+                                "ecef_v" + std::string(axes[i]) + suffix, [this, k, i] { return m_EcefV[k][i]; },
+                                [this, k, i](double value) { m_EcefV[k][i] = value; })
+                                .setCausality(causality_t::INPUT)
+                                .setVariability(variability_t::CONTINUOUS));
+            }
+
+            for (int i = 0; i < 3; ++i) {
+                register_variable(
+                        real(
+                                "ecef_a" + std::string(axes[i]) + suffix, [this, k, i] { return m_EcefA[k][i]; },
+                                [this, k, i](double value) { m_EcefA[k][i] = value; })
+                                .setCausality(causality_t::INPUT)
+                                .setVariability(variability_t::CONTINUOUS));
+            }
+
+            const std::vector<size_t> r = {get_real_variable("ecef_rx" + suffix)->index(),
+                                           get_real_variable("ecef_ry" + suffix)->index(),
+                                           get_real_variable("ecef_rz" + suffix)->index()};
+
+            for (int i = 0; i < 3; ++i) {
+                register_variable(
+                        real(
+                                "eci_r" + std::string(axes[i]) + suffix, [this, k, i] { return m_EciR[k][i]; })
+                                .setCausality(causality_t::OUTPUT)
+                                .setVariability(variability_t::CONTINUOUS)
+                                .setDependencies(r));
+            }
+
+            // With polar motion (frame_model IAU-76/FK5) every ECI axis depends on every ECEF one
+            const std::vector<size_t> rv = {get_real_variable("ecef_rx" + suffix)->index(),
+                                            get_real_variable("ecef_ry" + suffix)->index(),
+                                            get_real_variable("ecef_rz" + suffix)->index(),
+                                            get_real_variable("ecef_vx" + suffix)->index(),
+                                            get_real_variable("ecef_vy" + suffix)->index(),
+                                            get_real_variable("ecef_vz" + suffix)->index()};
+
+            for (int i = 0; i < 3; ++i) {
+                register_variable(
+                        real(
+                                "eci_v" + std::string(axes[i]) + suffix, [this, k, i] { return m_EciV[k][i]; })
+                                .setCausality(causality_t::OUTPUT)
+                                .setVariability(variability_t::CONTINUOUS)
+                                .setDependencies(rv));
+            }
+
+            const std::vector<size_t> rva = {get_real_variable("ecef_rx" + suffix)->index(),
+                                             get_real_variable("ecef_ry" + suffix)->index(),
+                                             get_real_variable("ecef_rz" + suffix)->index(),
+                                             get_real_variable("ecef_vx" + suffix)->index(),
+                                             get_real_variable("ecef_vy" + suffix)->index(),
+                                             get_real_variable("ecef_vz" + suffix)->index(),
+                                             get_real_variable("ecef_ax" + suffix)->index(),
+                                             get_real_variable("ecef_ay" + suffix)->index(),
+                                             get_real_variable("ecef_az" + suffix)->index()};
+
+            for (int i = 0; i < 3; ++i) {
+                register_variable(
+                        real(
+                                "eci_a" + std::string(axes[i]) + suffix, [this, k, i] { return m_EciA[k][i]; })
+                                .setCausality(causality_t::OUTPUT)
+                                .setVariability(variability_t::CONTINUOUS)
+                                .setDependencies(rva));
+            }
+        }
 
-        
-      
-        register_variable(
-                real(
-                        "Output", [this] { return m_Output; })
-                        .setCausality(causality_t::OUTPUT)
-                        .setVariability(variability_t::CONTINUOUS)
-                        .setDependencies({get_real_variable("Input")->index(),
-                                          get_real_variable("Gain")->index()}));
-     
         Model::reset();
     }
 
+    void exit_initialisation_mode() override {
+        if (m_VehicleCount < 1 || m_VehicleCount > MaxVehicles) {
+            fail("vehicle_count must be between 1 and " + std::to_string(MaxVehicles));
+        }
+        if (m_FrameModel == IAU76FK5) {
+            Coordinate::EopTable eop;
+            if (!m_EopFile.empty()) {
+                try {
+                    eop = Coordinate::EopTable::load(resourceLocation() + "/" + m_EopFile);
+                } catch (const std::exception &ex) {
+                    fail(std::string(ex.what()) + "; eop_file must name a file in the FMU resources folder");
+                }
+            }
+            m_Orientation = std::make_unique<Coordinate::EarthOrientation>(std::move(eop));
+        } else if (m_FrameModel != ZRotation) {
+            fail("frame_model must be 0 (Z rotation) or 1 (IAU-76/FK5)");
+        }
+    }
+
     bool do_step(double currentTime, double dt) override {
-        
-         try{
-            
+
+        try{
+            const std::size_t n = static_cast<std::size_t>(m_VehicleCount);
+            std::span<const Vector> r(m_EcefR.data(), n);
+            std::span<const Vector> v(m_EcefV.data(), n);
+            std::span<const Vector> a(m_EcefA.data(), n);
+
+            if (m_Orientation) {
+                m_Orientation->ecefToEci(m_UtcSinceJ2000 + currentTime, r, v, a, std::span<Vector>(m_EciR.data(), n),
+                                         std::span<Vector>(m_EciV.data(), n), std::span<Vector>(m_EciA.data(), n));
+                return true;
+            }
+
+            // Advance the rotation by recurrence while the master keeps a fixed step, otherwise restart it
+            if (m_Stepping && dt == m_StepSize && std::abs(currentTime - m_NextTime) <= 1e-9 * std::max(1.0, std::abs(currentTime))) {
+                m_Transform.step();
+            } else {
+                m_Transform = Coordinate::EcefEciTransform(m_TimeSinceEpoch + currentTime, dt);
+                m_StepSize = dt;
+                m_Stepping = true;
+            }
+            m_NextTime = currentTime + dt;
+
+            m_Transform.toEci(r, std::span<Vector>(m_EciR.data(), n));
+            m_Transform.toEciVelocity(r, v, std::span<Vector>(m_EciV.data(), n));
+            m_Transform.toEciAcceleration(r, v, a, std::span<Vector>(m_EciA.data(), n));
             return true;
         }catch(...){
             return false;
-        } 
+        }
     }
 
     void reset() override {
-      m_EcefRx = 0;
+        m_TimeSinceEpoch = 0.0;
+        m_FrameModel = ZRotation;
+        m_UtcSinceJ2000 = 0.0;
+        m_EopFile.clear();
+        m_VehicleCount = 1;
+
+        for (int k = 0; k < MaxVehicles; ++k) {
+            m_EcefR[k] = {0.0, 0.0, 0.0};
+            m_EcefV[k] = {0.0, 0.0, 0.0};
+            m_EcefA[k] = {0.0, 0.0, 0.0};
+            m_EciR[k] = {0.0, 0.0, 0.0};
+            m_EciV[k] = {0.0, 0.0, 0.0};
+            m_EciA[k] = {0.0, 0.0, 0.0};
+        }
+
+        m_Transform = Coordinate::EcefEciTransform(0.0);
+        m_Orientation.reset();
+        m_Stepping = false;
+        m_StepSize = 0.0;
+        m_NextTime = 0.0;
     }
 
 private:
-    double m_EcefRx;
-    double m_EcefRy;
-    double m_EcefRz;
-    double m_EcefVx;
-    double m_EcefVy;
-    double m_EcefVz;
+    using Vector = std::array<double, 3>;
+
+    // The FMI wrapper drops exception messages, so log them before failing
+    [[noreturn]] void fail(const std::string &message) {
+        log(fmi2Error, message);
+        throw std::runtime_error(message);
+    }
+
     double m_TimeSinceEpoch;
-    double m_EciRx;
-    double m_EciRy;
-    double m_EciRz;
-    double m_EciVx;
-    double m_EciVy;
-    double m_EciVz;
+    int m_FrameModel;
+    double m_UtcSinceJ2000;
+    std::string m_EopFile; // relative to the resources folder, empty for zero Earth orientation parameters
+    int m_VehicleCount;
+
+    std::array<Vector, MaxVehicles> m_EcefR;
+    std::array<Vector, MaxVehicles> m_EcefV;
+    std::array<Vector, MaxVehicles> m_EcefA;
+    std::array<Vector, MaxVehicles> m_EciR;
+    std::array<Vector, MaxVehicles> m_EciV;
+    std::array<Vector, MaxVehicles> m_EciA;
+
+    Coordinate::EcefEciTransform m_Transform;
+    std::unique_ptr<Coordinate::EarthOrientation> m_Orientation; // set for frame_model IAU-76/FK5
+    bool m_Stepping;
+    double m_StepSize;
+    double m_NextTime;
 };
 
 model_info fmu4cpp::get_model_info() {
     model_info info;
     info.modelName = "ECEF2ECI";
-    info.description = "Convert position and velocity from ECEF to ECI frame";
+    info.description = "Convert position, velocity and acceleration from ECEF to ECI frame";
     info.modelIdentifier = FMU4CPP_MODEL_IDENTIFIER;
     return info;
 }
 
 std::unique_ptr<fmu_base> fmu4cpp::createInstance(const std::string &instanceName, const std::string &fmuResourceLocation) {
     return std::make_unique<Model>(instanceName, fmuResourceLocation);
-}
\ No newline at end of file
+}
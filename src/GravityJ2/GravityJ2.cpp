@@ -21,6 +21,10 @@
 #include <fmu4cpp/fmu_base.hpp>
 #include "GravitationalModels.h"
 
+#include <stdexcept>
+#include <string>
+#include <utility>
+
 using namespace fmu4cpp;
 
 class Model : public fmu_base {
@@ -29,6 +33,12 @@ public:
     Model(const std::string &instanceName, const std::string &resources)
         : fmu_base(instanceName, resources) {
 
+        register_variable(
+                integer(
+                        "zonal_degree", [this] { return m_ZonalDegree; }, [this](int value) { m_ZonalDegree = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
         register_variable(
                 real(
                         "eci_rx", [this] { return m_EciRx; }, [this](double value) { m_EciRx = value; })
@@ -73,17 +83,45 @@ public:
                         .setDependencies({get_real_variable("eci_rx")->index(),
                                           get_real_variable("eci_ry")->index(),
                                           get_real_variable("eci_rz")->index()}));
-     
+
+        // Gravity gradient d(g_i)/d(r_j), upper triangle of the symmetric tensor
+        const std::array<std::pair<int, int>, 6> gradientEntries = {{{0, 0}, {0, 1}, {0, 2}, {1, 1}, {1, 2}, {2, 2}}};
+        for (auto [i, j] : gradientEntries) {
+            const std::string name = std::string("eci_dg") + "xyz"[i] + "_d" + "xyz"[j];
+            register_variable(
+                    real(
+                            name, [this, i, j] { return m_Gradient[i][j]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS)
+                            .setDependencies({get_real_variable("eci_rx")->index(),
+                                              get_real_variable("eci_ry")->index(),
+                                              get_real_variable("eci_rz")->index()}));
+        }
+
         Model::reset();
     }
 
+    void exit_initialisation_mode() override {
+        // Pick the unrolled zonal model once; do_step calls it through a plain function pointer.
+        // The gradient shares its terms with the acceleration, so both come from one call.
+        switch (m_ZonalDegree) {
+            case 2: m_Gravity = &J2::Zonal<2>::calculateGravityGradient<double>; break;
+            case 3: m_Gravity = &J2::Zonal<3>::calculateGravityGradient<double>; break;
+            case 4: m_Gravity = &J2::Zonal<4>::calculateGravityGradient<double>; break;
+            case 5: m_Gravity = &J2::Zonal<5>::calculateGravityGradient<double>; break;
+            case 6: m_Gravity = &J2::Zonal<6>::calculateGravityGradient<double>; break;
+            default: fail("zonal_degree must be between 2 and 6, got " + std::to_string(m_ZonalDegree));
+        }
+    }
+
     bool do_step(double currentTime, double dt) override {
 
         try{
-            auto result = J2::calculateGravitationalAcceleration(m_EciRx, m_EciRy, m_EciRz);
-            m_EciGx = result[0];
-            m_EciGy = result[1];
-            m_EciGz = result[2];
+            auto result = m_Gravity(m_EciRx, m_EciRy, m_EciRz);
+            m_EciGx = result.acceleration[0];
+            m_EciGy = result.acceleration[1];
+            m_EciGz = result.acceleration[2];
+            m_Gradient = result.gradient;
             return true;
         }catch(...){
             return false;
@@ -91,24 +129,37 @@ public:
     }
 
     void reset() override {
+       m_ZonalDegree = 2;
+       m_Gravity = &J2::Zonal<2>::calculateGravityGradient<double>;
+
        m_EciRx = 0.0;
        m_EciRy = 1.0;
        m_EciRz = 0.0;
     }
 
 private:
+    // The FMI wrapper drops exception messages, so log them before failing
+    [[noreturn]] void fail(const std::string &message) {
+        log(fmi2Error, message);
+        throw std::runtime_error(message);
+    }
+
+    int m_ZonalDegree; // highest zonal harmonic J2..J6
+    J2::AccelerationAndGradient<double> (*m_Gravity)(double, double, double);
+
     double m_EciRx;
     double m_EciRy;
     double m_EciRz;
     double m_EciGx;
     double m_EciGy;
     double m_EciGz;
+    std::array<std::array<double, 3>, 3> m_Gradient{};
 };
 
 model_info fmu4cpp::get_model_info() {
     model_info info;
     info.modelName = "GravityJ2";
-    info.description = "J2 gravity model";
+    info.description = "Zonal (J2..J6) gravity model";
     info.modelIdentifier = FMU4CPP_MODEL_IDENTIFIER;
     return info;
 }
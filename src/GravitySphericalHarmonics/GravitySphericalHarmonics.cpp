@@ -0,0 +1,284 @@
+/*
+ * -----------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [GravitySphericalHarmonics.cpp]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Spherical harmonic gravity model FMU (EGM96/EGM2008 coefficients).
+ *  No coefficients are shipped: convert an ICGEM .gfc model with
+ *  convertGravityCoefficients (SphericalHarmonics::convertIcgemFile), place the
+ *  output in src/GravitySphericalHarmonics/resources before building and set the
+ *  coefficient_file parameter to its name.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#include <fmu4cpp/fmu_base.hpp>
+#include "GravityFieldCache.h"
+#include "SphericalHarmonicGravity.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace fmu4cpp;
+
+class Model : public fmu_base {
+
+public:
+    Model(const std::string &instanceName, const std::string &resources)
+        : fmu_base(instanceName, resources) {
+
+        register_variable(
+                string(
+                        "coefficient_file", [this] { return m_CoefficientFile; }, [this](std::string value) { m_CoefficientFile = std::move(value); })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                integer(
+                        "degree", [this] { return m_Degree; }, [this](int value) { m_Degree = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                integer(
+                        "order", [this] { return m_Order; }, [this](int value) { m_Order = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                boolean(
+                        "output_gradient", [this] { return m_OutputGradient; }, [this](bool value) { m_OutputGradient = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                real(
+                        "cache_tolerance", [this] { return m_CacheTolerance; }, [this](double value) { m_CacheTolerance = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                real(
+                        "cache_gradient_tolerance", [this] { return m_CacheGradientTolerance; }, [this](double value) { m_CacheGradientTolerance = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                real(
+                        "ecef_rx", [this] { return m_EcefRx; }, [this](double value) { m_EcefRx = value; })
+                        .setCausality(causality_t::INPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "ecef_ry", [this] { return m_EcefRy; }, [this](double value) { m_EcefRy = value; })
+                        .setCausality(causality_t::INPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "ecef_rz", [this] { return m_EcefRz; }, [this](double value) { m_EcefRz = value; })
+                        .setCausality(causality_t::INPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "ecef_gx", [this] { return m_EcefGx; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS)
+                        .setDependencies({get_real_variable("ecef_rx")->index(),
+                                          get_real_variable("ecef_ry")->index(),
+                                          get_real_variable("ecef_rz")->index()}));
+
+        register_variable(
+                real(
+                        "ecef_gy", [this] { return m_EcefGy; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS)
+                        .setDependencies({get_real_variable("ecef_rx")->index(),
+                                          get_real_variable("ecef_ry")->index(),
+                                          get_real_variable("ecef_rz")->index()}));
+
+        register_variable(
+                real(
+                        "ecef_gz", [this] { return m_EcefGz; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS)
+                        .setDependencies({get_real_variable("ecef_rx")->index(),
+                                          get_real_variable("ecef_ry")->index(),
+                                          get_real_variable("ecef_rz")->index()}));
+
+        // Gravity gradient d(g_i)/d(r_j), upper triangle of the symmetric tensor
+        const std::array<std::pair<int, int>, 6> gradientEntries = {{{0, 0}, {0, 1}, {0, 2}, {1, 1}, {1, 2}, {2, 2}}};
+        for (auto [i, j] : gradientEntries) {
+            const std::string name = std::string("ecef_dg") + "xyz"[i] + "_d" + "xyz"[j];
+            register_variable(
+                    real(
+                            name, [this, i, j] { return m_Gradient[i][j]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS)
+                            .setDependencies({get_real_variable("ecef_rx")->index(),
+                                              get_real_variable("ecef_ry")->index(),
+                                              get_real_variable("ecef_rz")->index()}));
+        }
+
+        register_variable(
+                integer(
+                        "cache_hits", [this] { return m_Cache ? saturated(m_Cache->statistics().hits) : 0; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::DISCRETE));
+
+        register_variable(
+                integer(
+                        "cache_misses", [this] { return m_Cache ? saturated(m_Cache->statistics().misses) : 0; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::DISCRETE));
+
+        Model::reset();
+    }
+
+    void exit_initialisation_mode() override {
+        if (m_CoefficientFile.empty()) {
+            fail("The coefficient_file parameter is not set; convert an ICGEM .gfc model with convertGravityCoefficients "
+                 "and name the output file placed in the FMU resources folder");
+        }
+        const std::string path = resourceLocation() + "/" + m_CoefficientFile;
+        try {
+            m_File = std::make_shared<SphericalHarmonics::CoefficientFile>(path);
+        } catch (const std::exception &ex) {
+            fail(std::string(ex.what()) + "; coefficient_file must name a convertGravityCoefficients output in the FMU resources folder");
+        }
+        m_Field = std::make_shared<SphericalHarmonics::GravityField>(*m_File);
+        try {
+            m_Field->setDegreeOrder(m_Degree, m_Order);
+        } catch (const std::exception &ex) {
+            fail(std::string(ex.what()) + "; " + m_CoefficientFile + " holds degree " + std::to_string(m_File->degree()) +
+                 ", degree must not exceed it and order must be between 0 and degree");
+        }
+
+        if (m_CacheTolerance > 0.0) {
+            // Instances with the same field and settings share one cache; it keeps its own field alive
+            SphericalHarmonics::CacheSettings settings;
+            settings.tolerance = m_CacheTolerance;
+            settings.gradientTolerance = m_CacheGradientTolerance;
+            const std::string key =
+                    SphericalHarmonics::GravityFieldCache::sharedKey(path + "|" + std::to_string(m_Degree) + "|" + std::to_string(m_Order), settings);
+            const int degree = m_Degree;
+            const int order = m_Order;
+            const auto file = m_File;
+            m_Cache = SphericalHarmonics::GravityFieldCache::shared(key, [file, degree, order, settings] {
+                auto field = std::make_shared<SphericalHarmonics::GravityField>(*file);
+                field->setDegreeOrder(degree, order);
+                return std::make_shared<SphericalHarmonics::GravityFieldCache>(
+                        [file, field](double x, double y, double z) { return field->accelerationAndGradient(x, y, z); },
+                        file->header().GM, settings);
+            });
+        }
+    }
+
+    bool do_step(double currentTime, double dt) override {
+
+        try{
+            if (m_Cache) {
+                auto result = m_Cache->accelerationAndGradient(m_EcefRx, m_EcefRy, m_EcefRz);
+                m_EcefGx = result.acceleration[0];
+                m_EcefGy = result.acceleration[1];
+                m_EcefGz = result.acceleration[2];
+                m_Gradient = result.gradient;
+                return true;
+            }
+            if (m_OutputGradient) {
+                // Roughly twice the cost of the acceleration alone, hence opt-in
+                auto result = m_Field->accelerationAndGradient(m_EcefRx, m_EcefRy, m_EcefRz);
+                m_EcefGx = result.acceleration[0];
+                m_EcefGy = result.acceleration[1];
+                m_EcefGz = result.acceleration[2];
+                m_Gradient = result.gradient;
+                return true;
+            }
+            auto result = m_Field->acceleration(m_EcefRx, m_EcefRy, m_EcefRz);
+            m_EcefGx = result[0];
+            m_EcefGy = result[1];
+            m_EcefGz = result[2];
+            return true;
+        }catch(...){
+            return false;
+        }
+    }
+
+    void reset() override {
+       m_CoefficientFile.clear();
+       m_Degree = 70;
+       m_Order = 70;
+       m_OutputGradient = false;
+       m_CacheTolerance = 0.0;
+       m_CacheGradientTolerance = 1e-11;
+
+       m_EcefRx = 0.0;
+       m_EcefRy = 1.0;
+       m_EcefRz = 0.0;
+
+       m_Cache.reset();
+       m_Field.reset();
+       m_File.reset();
+    }
+
+private:
+    // FMI integers are 32 bit; long runs pass INT_MAX lookups, so the counters stop there
+    static int saturated(std::uint64_t count) {
+        return static_cast<int>(std::min<std::uint64_t>(count, std::numeric_limits<int>::max()));
+    }
+
+    // The FMI wrapper drops exception messages, so log them before failing
+    [[noreturn]] void fail(const std::string &message) {
+        log(fmi2Error, message);
+        throw std::runtime_error(message);
+    }
+
+    std::string m_CoefficientFile; // relative to the resources folder, no default
+
+    int m_Degree;
+    int m_Order;
+    bool m_OutputGradient; // also evaluate the gravity gradient outputs
+    double m_CacheTolerance; // interpolation error target of the shared cache [m/s^2], 0 evaluates directly
+    double m_CacheGradientTolerance; // gravity gradient error target of the shared cache [1/s^2]
+
+    double m_EcefRx;
+    double m_EcefRy;
+    double m_EcefRz;
+    double m_EcefGx;
+    double m_EcefGy;
+    double m_EcefGz;
+    std::array<std::array<double, 3>, 3> m_Gradient{};
+
+    std::shared_ptr<SphericalHarmonics::CoefficientFile> m_File;
+    std::shared_ptr<SphericalHarmonics::GravityField> m_Field;
+    std::shared_ptr<SphericalHarmonics::GravityFieldCache> m_Cache;
+};
+
+model_info fmu4cpp::get_model_info() {
+    model_info info;
+    info.modelName = "GravitySphericalHarmonics";
+    info.description = "Spherical harmonic gravity model up to configurable degree and order";
+    info.modelIdentifier = FMU4CPP_MODEL_IDENTIFIER;
+    return info;
+}
+
+std::unique_ptr<fmu_base> fmu4cpp::createInstance(const std::string &instanceName, const std::string &fmuResourceLocation) {
+    return std::make_unique<Model>(instanceName, fmuResourceLocation);
+}
@@ -0,0 +1,42 @@
+/*
+ * -----------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [convertCoefficients.cpp]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Convert an ICGEM .gfc gravity model into the memory mappable resources file
+ *  read by the GravitySphericalHarmonics FMU.
+ *  Usage: convertGravityCoefficients <model.gfc> <output.bin> <max degree>]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#include "SphericalHarmonicGravity.h"
+
+#include <iostream>
+
+int main(int argc, char **argv) {
+
+    if (argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " <model.gfc> <output.bin> <max degree>" << std::endl;
+        return -1;
+    }
+
+    try {
+        SphericalHarmonics::convertIcgemFile(argv[1], argv[2], std::stoi(argv[3]));
+    } catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,197 @@
+/*
+ * -----------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [MonteCarlo.cpp]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Monte Carlo dispersion runner, linked against the model of one FMU (one
+ *  <FMU>MonteCarlo executable per entry of MONTE_CARLO_TARGETS).
+ *  Usage: <FMU>MonteCarlo <dispersions> <runs> <summary.csv> [options]
+ *      --stop <s>         simulation stop time                  (default 3600)
+ *      --step <s>         communication step                    (default 10)
+ *      --seed <n>         master seed                           (default 0)
+ *      --threads <n>      worker threads, 0 for all cores       (default 0)
+ *      --pin              pin worker i to core i
+ *      --record <name>    real variable written at the stop time, repeatable
+ *      --resources <dir>  resources folder of the FMU
+ *  Each worker creates one instance and reuses it through reset() for all of its
+ *  runs. Every run draws the dispersed variables from its own counter based
+ *  streams (see MonteCarlo::sampleRun), initialises, steps to the stop time and appends
+ *      run, status, end time, <dispersed variables>, <recorded variables>
+ *  to the summary as soon as it finishes, so lines are in completion order.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#include <fmu4cpp/fmu_base.hpp>
+#include "MonteCarlo.h"
+
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+struct Settings {
+    std::string dispersionFile;
+    std::size_t runs = 0;
+    std::string summaryFile;
+    double stop = 3600.0;
+    double step = 10.0;
+    std::uint64_t seed = 0;
+    unsigned threads = 0;
+    bool pin = false;
+    std::vector<std::string> recorded;
+    std::string resources = ".";
+};
+
+// One instance per worker, with its variables looked up once
+struct Worker {
+    std::unique_ptr<fmu4cpp::fmu_base> instance;
+    std::vector<fmu4cpp::RealVariable> dispersed;
+    std::vector<fmu4cpp::RealVariable> recorded;
+};
+
+fmu4cpp::RealVariable lookup(fmu4cpp::fmu_base& instance, const std::string& name) {
+    auto variable = instance.get_real_variable(name);
+    if (!variable) throw std::invalid_argument("No real variable named '" + name + "'");
+    return *variable;
+}
+
+void attach(Worker& worker, const Settings& settings, const std::vector<MonteCarlo::Dispersion>& dispersions,
+          unsigned thread) {
+    worker.instance = fmu4cpp::createInstance("run" + std::to_string(thread), settings.resources);
+    for (const auto& dispersion : dispersions) worker.dispersed.push_back(lookup(*worker.instance, dispersion.variable));
+    for (const auto& name : settings.recorded) worker.recorded.push_back(lookup(*worker.instance, name));
+}
+
+void append(std::string& line, double value) {
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    line += ',';
+    line.append(buffer, result.ptr);
+}
+
+// Runs one trajectory into its summary line; false if it did not reach the stop time
+bool simulate(Worker& worker, const Settings& settings, const std::vector<MonteCarlo::Dispersion>& dispersions,
+              std::size_t run, std::string& line) {
+    fmu4cpp::fmu_base& instance = *worker.instance;
+    line = std::to_string(run);
+
+    std::vector<double> values;
+    MonteCarlo::sampleRun(dispersions, settings.seed, run, values);
+
+    double time = 0.0;
+    bool ok = true;
+    try {
+        instance.reset();
+        for (std::size_t i = 0; i < values.size(); ++i) worker.dispersed[i].set(values[i]);
+        instance.setup_experiment(0.0, settings.stop, std::nullopt);
+        instance.enter_initialisation_mode();
+        instance.exit_initialisation_mode();
+
+        while (ok && time < settings.stop - 1e-9 * settings.step) {
+            const double dt = std::min(settings.step, settings.stop - time);
+            ok = instance.do_step(time, dt);
+            if (ok) time += dt;
+        }
+    } catch (const std::exception&) {
+        ok = false;
+    }
+
+    line += ok ? ",ok" : ",failed";
+    append(line, time);
+    for (double value : values) append(line, value);
+    for (const auto& variable : worker.recorded) append(line, variable.get());
+    return ok;
+}
+
+Settings parse(int argc, char** argv) {
+    if (argc < 4) throw std::invalid_argument("Too few arguments");
+
+    Settings settings;
+    settings.dispersionFile = argv[1];
+    settings.runs = std::stoull(argv[2]);
+    settings.summaryFile = argv[3];
+
+    for (int i = 4; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (option == "--pin") {
+            settings.pin = true;
+            continue;
+        }
+        if (i + 1 == argc) throw std::invalid_argument("Option " + option + " needs a value");
+        const std::string value = argv[++i];
+        if (option == "--stop") settings.stop = std::stod(value);
+        else if (option == "--step") settings.step = std::stod(value);
+        else if (option == "--seed") settings.seed = std::stoull(value);
+        else if (option == "--threads") settings.threads = static_cast<unsigned>(std::stoul(value));
+        else if (option == "--record") settings.recorded.push_back(value);
+        else if (option == "--resources") settings.resources = value;
+        else throw std::invalid_argument("Unknown option " + option);
+    }
+    if (!(settings.step > 0.0) || !(settings.stop > 0.0)) throw std::invalid_argument("Stop time and step must be positive");
+    return settings;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+
+    try {
+        const Settings settings = parse(argc, argv);
+
+        std::ifstream dispersionFile(settings.dispersionFile);
+        if (!dispersionFile) throw std::runtime_error("Cannot open dispersion file '" + settings.dispersionFile + "'");
+        const auto dispersions = MonteCarlo::parseDispersions(dispersionFile);
+
+        // Unknown variable names are reported before any thread starts
+        Worker probe;
+        attach(probe, settings, dispersions, 0);
+
+        std::ofstream summaryFile(settings.summaryFile);
+        if (!summaryFile) throw std::runtime_error("Cannot open summary file '" + settings.summaryFile + "'");
+        std::string header = "run,status,time";
+        for (const auto& dispersion : dispersions) header += "," + dispersion.variable;
+        for (const auto& name : settings.recorded) header += "," + name;
+        summaryFile << header << '\n';
+
+        MonteCarlo::WorkStealingPool pool(settings.threads, settings.pin);
+        std::vector<Worker> workers(pool.threadCount());
+        workers[0] = std::move(probe);
+
+        std::atomic<std::size_t> failures{0};
+        const auto start = std::chrono::steady_clock::now();
+        {
+            MonteCarlo::SummaryWriter writer(summaryFile);
+            pool.run(settings.runs, [&](unsigned thread, std::size_t run) {
+                Worker& worker = workers[thread];
+                if (!worker.instance) attach(worker, settings, dispersions, thread);
+                std::string line;
+                if (!simulate(worker, settings, dispersions, run, line)) failures.fetch_add(1, std::memory_order_relaxed);
+                writer.write(line);
+            });
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << settings.runs << " runs (" << failures.load() << " failed) on " << pool.threadCount()
+                  << " threads in " << seconds << " s, " << settings.runs / seconds << " runs/s" << std::endl;
+    } catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <dispersions> <runs> <summary.csv> [--stop s] [--step s] [--seed n]"
+                  << " [--threads n] [--pin] [--record name]... [--resources dir]" << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * -----------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [SecularJ2Orbit.cpp]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Analytic orbit under secular J2 (SecularJ2.h) for long horizon coverage studies.
+ *  The initial ECI state is converted to mean elements once; each step evaluates the
+ *  orbit at the end of the step directly, so its cost does not depend on the step
+ *  size. ECEF and geodetic outputs follow from the state.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#include <fmu4cpp/fmu_base.hpp>
+#include "EarthCenteredFrames.h"
+#include "SecularJ2.h"
+
+#include <stdexcept>
+#include <string>
+
+using namespace fmu4cpp;
+
+class Model : public fmu_base {
+
+public:
+    Model(const std::string &instanceName, const std::string &resources)
+        : fmu_base(instanceName, resources) {
+
+        // Time since the ECEF and ECI axes coincided, at simulation time zero
+        register_variable(
+                real(
+                        "time_since_epoch", [this] { return m_TimeSinceEpoch; }, [this](double value) { m_TimeSinceEpoch = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        const char *axes[3] = {"x", "y", "z"};
+
+        // Initial osculating ECI state
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("initial_eci_r") + axes[i], [this, i] { return m_InitialEciR[i]; },
+                            [this, i](double value) { m_InitialEciR[i] = value; })
+                            .setCausality(causality_t::PARAMETER)
+                            .setVariability(variability_t::FIXED));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("initial_eci_v") + axes[i], [this, i] { return m_InitialEciV[i]; },
+                            [this, i](double value) { m_InitialEciV[i] = value; })
+                            .setCausality(causality_t::PARAMETER)
+                            .setVariability(variability_t::FIXED));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("eci_r") + axes[i], [this, i] { return m_EciR[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("eci_v") + axes[i], [this, i] { return m_EciV[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("ecef_r") + axes[i], [this, i] { return m_EcefR[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        register_variable(
+                real(
+                        "latitude", [this] { return m_Latitude; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "longitude", [this] { return m_Longitude; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "altitude", [this] { return m_Altitude; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        // Mean elements, angles in [rad]
+        register_variable(
+                real(
+                        "semi_major_axis", [this] { return m_Elements.a; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "eccentricity", [this] { return m_Elements.e; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "inclination", [this] { return m_Elements.i; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "raan", [this] { return m_Elements.raan; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "argument_of_perigee", [this] { return m_Elements.argp; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "mean_anomaly", [this] { return m_Elements.M; })
+                        .setCausality(causality_t::OUTPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        Model::reset();
+    }
+
+    void exit_initialisation_mode() override {
+        try {
+            m_Propagator.set(m_InitialEciR, m_InitialEciV);
+        } catch (const std::exception &ex) {
+            fail(std::string(ex.what()) + "; the initial_eci_r/initial_eci_v state must be an elliptic orbit");
+        }
+        m_Start = startTime();
+        updateOutputs(m_Start);
+    }
+
+    bool do_step(double currentTime, double dt) override {
+
+        try{
+            updateOutputs(currentTime + dt);
+            return true;
+        }catch(...){
+            return false;
+        }
+    }
+
+    void reset() override {
+       m_TimeSinceEpoch = 0.0;
+
+       // Circular orbit at 400 km altitude inclined at 51.6 deg
+       m_InitialEciR = {6778137.0, 0.0, 0.0};
+       m_InitialEciV = {0.0, 4763.31, 6009.80};
+
+       m_Propagator.set(m_InitialEciR, m_InitialEciV);
+       m_Start = 0.0;
+       updateOutputs(0.0);
+    }
+
+private:
+    // The FMI wrapper drops exception messages, so log them before failing
+    [[noreturn]] void fail(const std::string &message) {
+        log(fmi2Error, message);
+        throw std::runtime_error(message);
+    }
+
+    void updateOutputs(double time) {
+        m_Elements = m_Propagator.elements(time - m_Start);
+        TwoBody::toCartesian(m_Elements, J2::GM, m_EciR, m_EciV);
+
+        Coordinate::EcefEciTransform transform(m_TimeSinceEpoch + time);
+        m_EcefR = transform.toEcef(m_EciR);
+        Coordinate::ecefToLatLonAlt(m_EcefR[0], m_EcefR[1], m_EcefR[2], m_Latitude, m_Longitude, m_Altitude);
+    }
+
+    J2::SecularPropagator m_Propagator;
+    double m_Start; // simulation time of the initial state
+
+    double m_TimeSinceEpoch;
+
+    std::array<double, 3> m_InitialEciR;
+    std::array<double, 3> m_InitialEciV;
+
+    TwoBody::Elements m_Elements;
+    std::array<double, 3> m_EciR;
+    std::array<double, 3> m_EciV;
+
+    /********Helper coordinate frames****************************/
+    std::array<double, 3> m_EcefR;
+    double m_Latitude;
+    double m_Longitude;
+    double m_Altitude;
+    /**************************************************************/
+};
+
+model_info fmu4cpp::get_model_info() {
+    model_info info;
+    info.modelName = "SecularJ2Orbit";
+    info.description = "Analytic orbit propagation under the secular effect of J2";
+    info.modelIdentifier = FMU4CPP_MODEL_IDENTIFIER;
+    return info;
+}
+
+std::unique_ptr<fmu_base> fmu4cpp::createInstance(const std::string &instanceName, const std::string &fmuResourceLocation) {
+    return std::make_unique<Model>(instanceName, fmuResourceLocation);
+}
@@ -0,0 +1,188 @@
+/*
+ * -----------------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [ThirdBody.cpp]
+ * Author:      Prof.Dr. Onur Tuncer
+ * Email:       onur.tuncer@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Sun and Moon third body perturbation FMU]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * -----------------------------------------------------------------------------------
+ */
+
+#include <fmu4cpp/fmu_base.hpp>
+#include "Epoch.h"
+#include "ThirdBody.h"
+
+using namespace fmu4cpp;
+
+class Model : public fmu_base {
+
+public:
+    Model(const std::string &instanceName, const std::string &resources)
+        : fmu_base(instanceName, resources) {
+
+        // UTC calendar date of simulation time zero
+        register_variable(
+                integer(
+                        "epoch_year", [this] { return m_EpochYear; }, [this](int value) { m_EpochYear = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                integer(
+                        "epoch_month", [this] { return m_EpochMonth; }, [this](int value) { m_EpochMonth = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                integer(
+                        "epoch_day", [this] { return m_EpochDay; }, [this](int value) { m_EpochDay = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                integer(
+                        "epoch_hour", [this] { return m_EpochHour; }, [this](int value) { m_EpochHour = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                integer(
+                        "epoch_minute", [this] { return m_EpochMinute; }, [this](int value) { m_EpochMinute = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                integer(
+                        "epoch_second", [this] { return m_EpochSecond; }, [this](int value) { m_EpochSecond = value; })
+                        .setCausality(causality_t::PARAMETER)
+                        .setVariability(variability_t::FIXED));
+
+        register_variable(
+                real(
+                        "eci_rx", [this] { return m_EciR[0]; }, [this](double value) { m_EciR[0] = value; })
+                        .setCausality(causality_t::INPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "eci_ry", [this] { return m_EciR[1]; }, [this](double value) { m_EciR[1] = value; })
+                        .setCausality(causality_t::INPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        register_variable(
+                real(
+                        "eci_rz", [this] { return m_EciR[2]; }, [this](double value) { m_EciR[2] = value; })
+                        .setCausality(causality_t::INPUT)
+                        .setVariability(variability_t::CONTINUOUS));
+
+        const char *axes[3] = {"x", "y", "z"};
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("eci_a") + axes[i], [this, i] { return m_EciA[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS)
+                            .setDependencies({get_real_variable("eci_rx")->index(),
+                                              get_real_variable("eci_ry")->index(),
+                                              get_real_variable("eci_rz")->index()}));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("eci_sun_") + axes[i], [this, i] { return m_Sun[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            register_variable(
+                    real(
+                            std::string("eci_moon_") + axes[i], [this, i] { return m_Moon[i]; })
+                            .setCausality(causality_t::OUTPUT)
+                            .setVariability(variability_t::CONTINUOUS));
+        }
+
+        Model::reset();
+    }
+
+    void exit_initialisation_mode() override {
+        m_Epoch = TimeScale::Epoch::fromUtc(m_EpochYear, m_EpochMonth, m_EpochDay, m_EpochHour, m_EpochMinute, m_EpochSecond);
+        // Fit the whole run up front when its length is known; segments are shared with other instances
+        if (stopTime()) {
+            ThirdBody::Ephemeris::shared().prepare(m_Epoch.plusSeconds(startTime()).ttSinceJ2000(),
+                                                   m_Epoch.plusSeconds(*stopTime()).ttSinceJ2000());
+        }
+    }
+
+    bool do_step(double currentTime, double dt) override {
+
+        try{
+            // Bodies are evaluated once per communication step, at the time the position input refers to
+            const double time = m_Epoch.plusSeconds(currentTime).ttSinceJ2000();
+            ThirdBody::Ephemeris &ephemeris = ThirdBody::Ephemeris::shared();
+            m_Sun = ephemeris.sun(time);
+            m_Moon = ephemeris.moon(time);
+
+            auto sun = ThirdBody::acceleration(m_EciR, m_Sun, ThirdBody::GM_Sun);
+            auto moon = ThirdBody::acceleration(m_EciR, m_Moon, ThirdBody::GM_Moon);
+            for (int i = 0; i < 3; ++i) {
+                m_EciA[i] = sun[i] + moon[i];
+            }
+            return true;
+        }catch(...){
+            return false;
+        }
+    }
+
+    void reset() override {
+       m_EpochYear = 2000;
+       m_EpochMonth = 1;
+       m_EpochDay = 1;
+       m_EpochHour = 12;
+       m_EpochMinute = 0;
+       m_EpochSecond = 0;
+       m_Epoch = TimeScale::Epoch();
+
+       m_EciR = {0.0, 1.0, 0.0};
+       m_EciA = {0.0, 0.0, 0.0};
+       m_Sun = {0.0, 0.0, 0.0};
+       m_Moon = {0.0, 0.0, 0.0};
+    }
+
+private:
+    int m_EpochYear;
+    int m_EpochMonth;
+    int m_EpochDay;
+    int m_EpochHour;
+    int m_EpochMinute;
+    int m_EpochSecond;
+    TimeScale::Epoch m_Epoch; // simulation time zero
+
+    std::array<double, 3> m_EciR;
+    std::array<double, 3> m_EciA;
+    std::array<double, 3> m_Sun;
+    std::array<double, 3> m_Moon;
+};
+
+model_info fmu4cpp::get_model_info() {
+    model_info info;
+    info.modelName = "ThirdBody";
+    info.description = "Sun and Moon third body perturbations from a low precision ephemeris";
+    info.modelIdentifier = FMU4CPP_MODEL_IDENTIFIER;
+    return info;
+}
+
+std::unique_ptr<fmu_base> fmu4cpp::createInstance(const std::string &instanceName, const std::string &fmuResourceLocation) {
+    return std::make_unique<Model>(instanceName, fmuResourceLocation);
+}
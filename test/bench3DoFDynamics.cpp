@@ -0,0 +1,355 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [bench3DoFDynamics.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Cost of one communication step of the 3DoF dynamics (OdeROW6A, adaptive
+ *  substeps over 10 s) with the analytic Jacobian against libode's finite
+ *  difference fallback, plus the Jacobian itself against central differences, and
+ *  the same step with each integrator offered by IntegratorSelection, and 100 s of
+ *  0.01 s communication steps restarted per step against the dense output mode,
+ *  and the libode integrators against the fixed size ones (N = 6), with the
+ *  Jacobian evaluation and factorisation counts of the W mode. The Encke form is
+ *  checked the same way and compared with the Cowell form over one day of LEO
+ *  in right-hand side evaluations at equal accuracy. The state transition matrix
+ *  and mass and force sensitivities over one orbit from the variational equations
+ *  are timed against the 11 runs of a forward difference ensemble.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/DynamicModel.h"
+#include "IntegratorSelection.h"
+#include "FixedSizeIntegrators.h"
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/EnckeModel.h"
+#include "Variational.h"
+
+#include <array>
+
+constexpr double CommunicationStep = 10.0;
+
+// Same dynamics with the Jacobian left to the integrator's finite differences
+class FiniteDifferenceModel : public DynamicModel<OdeROW6A> {
+
+    public:
+        void ode_jac (double* solin, double** Jout) { OdeROW6A::ode_jac(solin, Jout); }
+};
+
+static const std::array<double, 3> R0 = {6778137.0, 0.0, 0.0};
+static const std::array<double, 3> V0 = {0.0, 5422.5, 5422.5};
+
+TEST_CASE("Analytic Jacobian matches central differences") {
+    DynamicModel<OdeROW6A> model;
+    double state[6] = {R0[0], R0[1], R0[2], V0[0], V0[1], V0[2]};
+    state[1] = 1.2e6;
+    state[2] = -2.1e6;
+
+    std::array<std::array<double, 6>, 6> J;
+    double* rows[6];
+    for (int i = 0; i < 6; ++i) rows[i] = J[i].data();
+    model.ode_jac(state, rows);
+
+    for (int j = 0; j < 6; ++j) {
+        const double h = j < 3 ? 1.0 : 1e-3;
+        double plus[6], minus[6], fp[6], fm[6];
+        for (int k = 0; k < 6; ++k) plus[k] = minus[k] = state[k];
+        plus[j] += h;
+        minus[j] -= h;
+        model.ode_fun(plus, fp);
+        model.ode_fun(minus, fm);
+        for (int i = 0; i < 6; ++i) {
+            REQUIRE(J[i][j] == Approx((fp[i] - fm[i]) / (2.0 * h)).margin(1e-12));
+        }
+    }
+}
+
+TEST_CASE("Communication step cost") {
+    BENCHMARK_ADVANCED("analytic Jacobian")(Catch::Benchmark::Chronometer meter) {
+        DynamicModel<OdeROW6A> model;
+        model.SetState(R0, V0);
+        meter.measure([&] {
+            model.solve_adaptive(CommunicationStep, CommunicationStep);
+            return model.get_sol(0);
+        });
+    };
+
+    BENCHMARK_ADVANCED("finite difference Jacobian")(Catch::Benchmark::Chronometer meter) {
+        FiniteDifferenceModel model;
+        model.SetState(R0, V0);
+        meter.measure([&] {
+            model.solve_adaptive(CommunicationStep, CommunicationStep);
+            return model.get_sol(0);
+        });
+    };
+}
+
+TEST_CASE("Communication step cost per integrator") {
+    const std::pair<Integration::Method, const char*> methods[] = {
+        {Integration::Method::RK4, "RK4"},         {Integration::Method::DoPri54, "DoPri54"},
+        {Integration::Method::DoPri87, "DoPri87"}, {Integration::Method::GRK4A, "GRK4A"},
+        {Integration::Method::ROW6A, "ROW6A"},     {Integration::Method::RadauIIA, "RadauIIA"},
+    };
+
+    for (const auto& [method, name] : methods) {
+        Integration::IntegratorSelection<DynamicModel> system;
+        system.select(method);
+        REQUIRE(system.method() == method);
+        system.visit([](auto& model) { model.SetState(R0, V0); });
+
+        BENCHMARK(name) {
+            return system.visit([](auto& model) {
+                Integration::IntegratorSelection<DynamicModel>::advance(model, CommunicationStep, CommunicationStep, 1.0);
+                return model.get_sol(0);
+            });
+        };
+    }
+}
+
+TEST_CASE("Small communication steps") {
+    constexpr double Step = 0.01;
+    constexpr int Steps = 10000;
+
+    BENCHMARK_ADVANCED("integrator restarted every step")(Catch::Benchmark::Chronometer meter) {
+        DynamicModel<OdeDoPri54> model;
+        model.set_reltol(1e-10);
+        model.set_abstol(1e-6);
+        meter.measure([&] {
+            model.SetState(R0, V0);
+            for (int k = 0; k < Steps; ++k) model.solve_adaptive(Step, Step);
+            return model.get_sol(0);
+        });
+    };
+
+    BENCHMARK_ADVANCED("dense output")(Catch::Benchmark::Chronometer meter) {
+        Integration::IntegratorSelection<DynamicModel> system;
+        system.select(Integration::Method::DoPri54);
+        meter.measure([&] {
+            system.visit([](auto& model) { model.SetState(R0, V0); });
+            system.start(0.0, Integration::StepSettings{});
+            double x = 0.0;
+            for (int k = 1; k <= Steps; ++k) x = system.advanceTo(k * Step)[0];
+            return x;
+        });
+    };
+}
+
+template<class Model>
+static void configure(Model& model) {
+    model.set_reltol(1e-10);
+    model.set_abstol(1e-6);
+    model.SetState(R0, V0);
+}
+
+template<class Model>
+static void benchmarkStep(const char* name) {
+    BENCHMARK_ADVANCED(name)(Catch::Benchmark::Chronometer meter) {
+        Model model;
+        configure(model);
+        meter.measure([&] {
+            model.solve_adaptive(10.0, 10.0);
+            return model.get_sol(0);
+        });
+    };
+}
+
+TEST_CASE("Fixed size integrators against libode") {
+    DynamicModel<OdeDoPri54> heap;
+    DynamicModel<Integration::FixedDoPri54<6>> fixed;
+    configure(heap);
+    configure(fixed);
+    heap.solve_adaptive(600.0, 10.0);
+    fixed.solve_adaptive(600.0, 10.0);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(fixed.get_sol(i) == Approx(heap.get_sol(i)).margin(1e-2));
+    }
+
+    WARN("model size: libode DoPri54 " << sizeof(DynamicModel<OdeDoPri54>) << " B plus heap arrays, fixed DoPri54 "
+                                       << sizeof(DynamicModel<Integration::FixedDoPri54<6>>) << " B");
+    benchmarkStep<DynamicModel<OdeDoPri54>>("libode DoPri54");
+    benchmarkStep<DynamicModel<Integration::FixedDoPri54<6>>>("fixed DoPri54");
+    benchmarkStep<DynamicModel<OdeROW6A>>("libode ROW6A");
+    benchmarkStep<DynamicModel<Integration::FixedROS34PW2<6>>>("fixed ROS34PW2");
+    benchmarkStep<DynamicModel<Integration::FixedROS34PW2<6, true>>>("fixed ROS34PW2, Jacobian reuse");
+}
+
+TEST_CASE("Jacobian evaluations and factorisations over 600 s") {
+    DynamicModel<Integration::FixedROS34PW2<6>> fresh;
+    DynamicModel<Integration::FixedROS34PW2<6, true>> reuse;
+    configure(fresh);
+    configure(reuse);
+    fresh.solve_adaptive(600.0, 10.0);
+    reuse.solve_adaptive(600.0, 10.0);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(reuse.get_sol(i) == Approx(fresh.get_sol(i)).margin(1e-1));
+    }
+    WARN("every step: " << fresh.get_nstep() << " steps, " << fresh.get_nrej() << " rejected, " << fresh.get_njac()
+                        << " Jacobians, " << fresh.get_nlu() << " LU");
+    WARN("reuse:      " << reuse.get_nstep() << " steps, " << reuse.get_nrej() << " rejected, " << reuse.get_njac()
+                        << " Jacobians, " << reuse.get_nlu() << " LU");
+}
+
+TEST_CASE("Encke Jacobian matches central differences") {
+    EnckeModel<OdeROW6A> model;
+    model.Force = {0.0, 3.0, -1.0};
+    model.SetState(R0, V0);
+    double state[7] = {850.0, -420.0, 130.0, 0.6, -0.25, 0.1, 1234.0};
+
+    std::array<std::array<double, 7>, 7> J;
+    double* rows[7];
+    for (int i = 0; i < 7; ++i) rows[i] = J[i].data();
+    model.ode_jac(state, rows);
+
+    for (int j = 0; j < 7; ++j) {
+        const double h = j < 3 ? 1.0 : (j < 6 ? 1e-3 : 1e-2);
+        double plus[7], minus[7], fp[7], fm[7];
+        for (int k = 0; k < 7; ++k) plus[k] = minus[k] = state[k];
+        plus[j] += h;
+        minus[j] -= h;
+        model.ode_fun(plus, fp);
+        model.ode_fun(minus, fm);
+        for (int i = 0; i < 7; ++i) {
+            REQUIRE(J[i][j] == Approx((fp[i] - fm[i]) / (2.0 * h)).margin(1e-11));
+        }
+    }
+}
+
+// One day in 60 s communication steps, rectifying the Encke reference between them
+template<class Model>
+static std::array<double, 3> propagateDay(Model& model) {
+    model.SetState(R0, V0);
+    for (int k = 0; k < 1440; ++k) {
+        if constexpr (requires { model.Rectify(); }) {
+            model.Rectify();
+        }
+        model.solve_adaptive(60.0, 60.0);
+    }
+    return model.GetPosition();
+}
+
+TEST_CASE("Encke against Cowell over one day") {
+    DynamicModel<Integration::FixedDoPri54<6>> reference;
+    reference.set_reltol(1e-13);
+    reference.set_abstol(1e-9);
+    const auto r = propagateDay(reference);
+    auto error = [&r](const std::array<double, 3>& x) {
+        return std::sqrt((x[0] - r[0]) * (x[0] - r[0]) + (x[1] - r[1]) * (x[1] - r[1]) + (x[2] - r[2]) * (x[2] - r[2]));
+    };
+
+    DynamicModel<Integration::FixedDoPri54<6>> cowell;
+    cowell.set_reltol(1e-11);
+    cowell.set_abstol(1e-6);
+    const double cowellError = error(propagateDay(cowell));
+
+    // The deviation is small, so the absolute tolerance carries the position scale
+    EnckeModel<Integration::FixedDoPri54<7>> encke;
+    encke.set_reltol(1e-10);
+    encke.set_abstol(1e-3);
+    const double enckeError = error(propagateDay(encke));
+
+    WARN("Cowell: " << cowell.get_nfev() << " evaluations, " << cowellError << " m; Encke: " << encke.get_nfev()
+                    << " evaluations, " << enckeError << " m");
+    REQUIRE(enckeError < cowellError);
+    REQUIRE(encke.get_nfev() < cowell.get_nfev());
+
+    BENCHMARK("Cowell, one orbit") {
+        DynamicModel<Integration::FixedDoPri54<6>> model;
+        model.set_reltol(1e-11);
+        model.set_abstol(1e-6);
+        model.SetState(R0, V0);
+        for (int k = 0; k < 92; ++k) model.solve_adaptive(60.0, 60.0);
+        return model.get_sol(0);
+    };
+
+    BENCHMARK("Encke, one orbit") {
+        EnckeModel<Integration::FixedDoPri54<7>> model;
+        model.set_reltol(1e-10);
+        model.set_abstol(1e-3);
+        model.SetState(R0, V0);
+        for (int k = 0; k < 92; ++k) {
+            model.Rectify();
+            model.solve_adaptive(60.0, 60.0);
+        }
+        return model.get_sol(0);
+    };
+}
+
+// Nominal run plus one per state and parameter, each displaced by delta
+static std::array<std::array<double, 6>, 11> forwardDifferenceEnsemble(double duration, long& evaluations) {
+    constexpr std::array<double, 10> delta = {1.0, 1.0, 1.0, 1e-3, 1e-3, 1e-3, 1e-2, 1e-3, 1e-3, 1e-3};
+    std::array<std::array<double, 6>, 11> columns{};
+    std::array<double, 6> nominal{};
+    evaluations = 0;
+    for (int run = 0; run < 11; ++run) {
+        DynamicModel<Integration::FixedDoPri54<6>> model;
+        configure(model);
+        model.Mass = 500.0;
+        model.Force = {2.0, -1.0, 0.5};
+        const int j = run - 1;
+        if (j >= 0 && j < 6) model.set_sol(j, model.get_sol(j) + delta[j]);
+        if (j == 6) model.Mass += delta[j];
+        if (j > 6) model.Force[j - 7] += delta[j];
+        model.solve_adaptive(duration, 10.0);
+        evaluations += model.get_nfev();
+        for (int i = 0; i < 6; ++i) {
+            if (run == 0) {
+                nominal[i] = model.get_sol(i);
+            } else {
+                columns[run][i] = (model.get_sol(i) - nominal[i]) / delta[j];
+            }
+        }
+    }
+    columns[0] = nominal;
+    return columns;
+}
+
+TEST_CASE("Variational equations against a finite difference ensemble") {
+    constexpr double Orbit = 5400.0;
+    using Augmented = Integration::Variational<DynamicModel>::System<Integration::FixedDoPri54<66>>;
+
+    Augmented variational;
+    configure(variational);
+    variational.Mass = 500.0;
+    variational.Force = {2.0, -1.0, 0.5};
+    variational.solve_adaptive(Orbit, 10.0);
+
+    long ensembleEvaluations = 0;
+    const auto columns = forwardDifferenceEnsemble(Orbit, ensembleEvaluations);
+    double worst = 0.0;
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j < 6; ++j) {
+            const double difference = variational.GetTransition(i, j) - columns[1 + j][i];
+            worst = std::max(worst, std::abs(difference) / std::max(1.0, std::abs(columns[1 + j][i])));
+        }
+    }
+    REQUIRE(worst < 1e-2);
+    WARN("variational: " << variational.get_nfev() << " evaluations of the 66 state system; ensemble: "
+                         << ensembleEvaluations << " evaluations of the 6 state model; largest relative difference "
+                         << worst);
+
+    BENCHMARK("variational equations, one orbit") {
+        Augmented model;
+        configure(model);
+        model.Mass = 500.0;
+        model.Force = {2.0, -1.0, 0.5};
+        model.solve_adaptive(Orbit, 10.0);
+        return model.GetTransition(0, 0);
+    };
+
+    BENCHMARK("forward difference ensemble, one orbit") {
+        long evaluations = 0;
+        return forwardDifferenceEnsemble(Orbit, evaluations)[1][0];
+    };
+}
@@ -0,0 +1,253 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [bench6DoFDynamics.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [6DoF right-hand side: analytic Jacobian against central differences,
+ *  throughput in RHS evaluations per second, quaternion norm under stepping, and
+ *  a 10 s communication step on the libode integrators against the fixed size
+ *  ones (N = 13), with the Jacobian evaluation and factorisation counts of the
+ *  W mode, and 600 s of variational equations (state transition matrix and mass,
+ *  force and moment sensitivities) against a forward difference ensemble of 17
+ *  runs, one per state outside the quaternion and one per parameter.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+#include "../src/6DoF/DynamicModel.h"
+#include "FixedSizeIntegrators.h"
+#include "Variational.h"
+#include "ode_dopri_54.h"
+#include "ode_row6a.h"
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+using State = std::array<double, 13>;
+
+// libode integrators own raw buffers, so models are configured in place rather than returned
+template<class Model>
+static void configure(Model& model) {
+    model.Mass = 850.0;
+    model.Force = {120.0, -35.0, 60.0};
+    model.Moment = {0.4, -1.1, 0.25};
+    model.SetInertia({{{410.0, -12.0, 6.0}, {-12.0, 380.0, -3.0}, {6.0, -3.0, 520.0}}});
+}
+
+static const State X = {6.5e6, 1.2e6, -2.1e6, 1200.0, 6900.0, 2500.0, 0.8, -0.2, 0.5, 0.3, 0.05, -0.12, 0.3};
+
+TEST_CASE("Analytic Jacobian matches central differences") {
+    DynamicModel<OdeROW6A> model;
+    configure(model);
+    State state = X;
+
+    std::array<State, 13> J;
+    double* rows[13];
+    for (int i = 0; i < 13; ++i) rows[i] = J[i].data();
+    model.ode_jac(state.data(), rows);
+
+    for (int j = 0; j < 13; ++j) {
+        const double h = j < 3 ? 1.0 : 1e-4;
+        State plus = state;
+        State minus = state;
+        State fp;
+        State fm;
+        plus[j] += h;
+        minus[j] -= h;
+        model.ode_fun(plus.data(), fp.data());
+        model.ode_fun(minus.data(), fm.data());
+        for (int i = 0; i < 13; ++i) {
+            REQUIRE(J[i][j] == Approx((fp[i] - fm[i]) / (2.0 * h)).margin(1e-9));
+        }
+    }
+}
+
+TEST_CASE("Quaternion stays normalised across steps") {
+    DynamicModel<OdeROW6A> model;
+    configure(model);
+    model.SetState({X[0], X[1], X[2]}, {X[3], X[4], X[5]}, {X[6], X[7], X[8], X[9]}, {X[10], X[11], X[12]});
+    model.solve_adaptive(100.0, 1.0);
+    const auto q = model.GetAttitude();
+    REQUIRE(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3] == Approx(1.0).margin(1e-14));
+}
+
+TEST_CASE("Right-hand side throughput") {
+    DynamicModel<OdeROW6A> model;
+    configure(model);
+    State state = X;
+    State derivative;
+
+    // Plain timed loop to report evaluations per second
+    constexpr int Evaluations = 2000000;
+    const auto start = std::chrono::steady_clock::now();
+    double sink = 0.0;
+    for (int n = 0; n < Evaluations; ++n) {
+        state[12] = 0.3 + 1e-12 * n;
+        model.ode_fun(state.data(), derivative.data());
+        sink += derivative[12];
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    WARN("ode_fun: " << Evaluations / seconds / 1e6 << " million evaluations per second (checksum " << sink << ")");
+
+    BENCHMARK("ode_fun") {
+        model.ode_fun(state.data(), derivative.data());
+        return derivative[3];
+    };
+
+    std::array<State, 13> J;
+    double* rows[13];
+    for (int i = 0; i < 13; ++i) rows[i] = J[i].data();
+    BENCHMARK("ode_jac") {
+        model.ode_jac(state.data(), rows);
+        return J[3][0];
+    };
+}
+
+template<class Model>
+static void configureStep(Model& model) {
+    configure(model);
+    model.set_reltol(1e-10);
+    model.set_abstol(1e-6);
+    model.SetState({X[0], X[1], X[2]}, {X[3], X[4], X[5]}, {X[6], X[7], X[8], X[9]}, {X[10], X[11], X[12]});
+}
+
+template<class Model>
+static void benchmarkStep(const char* name) {
+    BENCHMARK_ADVANCED(name)(Catch::Benchmark::Chronometer meter) {
+        Model model;
+        configureStep(model);
+        meter.measure([&] {
+            model.solve_adaptive(10.0, 10.0);
+            return model.get_sol(0);
+        });
+    };
+}
+
+TEST_CASE("Fixed size integrators against libode") {
+    DynamicModel<OdeDoPri54> heap;
+    DynamicModel<Integration::FixedDoPri54<13>> fixed;
+    configureStep(heap);
+    configureStep(fixed);
+    heap.solve_adaptive(600.0, 10.0);
+    fixed.solve_adaptive(600.0, 10.0);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(fixed.get_sol(i) == Approx(heap.get_sol(i)).margin(1e-2));
+    }
+
+    WARN("model size: libode DoPri54 " << sizeof(DynamicModel<OdeDoPri54>) << " B plus heap arrays, fixed DoPri54 "
+                                       << sizeof(DynamicModel<Integration::FixedDoPri54<13>>) << " B");
+    benchmarkStep<DynamicModel<OdeDoPri54>>("libode DoPri54");
+    benchmarkStep<DynamicModel<Integration::FixedDoPri54<13>>>("fixed DoPri54");
+    benchmarkStep<DynamicModel<OdeROW6A>>("libode ROW6A");
+    benchmarkStep<DynamicModel<Integration::FixedROS34PW2<13>>>("fixed ROS34PW2");
+    benchmarkStep<DynamicModel<Integration::FixedROS34PW2<13, true>>>("fixed ROS34PW2, Jacobian reuse");
+}
+
+TEST_CASE("Jacobian evaluations and factorisations over 600 s") {
+    DynamicModel<Integration::FixedROS34PW2<13>> fresh;
+    DynamicModel<Integration::FixedROS34PW2<13, true>> reuse;
+    configureStep(fresh);
+    configureStep(reuse);
+    fresh.solve_adaptive(600.0, 10.0);
+    reuse.solve_adaptive(600.0, 10.0);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(reuse.get_sol(i) == Approx(fresh.get_sol(i)).margin(1e-1));
+    }
+    WARN("every step: " << fresh.get_nstep() << " steps, " << fresh.get_nrej() << " rejected, " << fresh.get_njac()
+                        << " Jacobians, " << fresh.get_nlu() << " LU");
+    WARN("reuse:      " << reuse.get_nstep() << " steps, " << reuse.get_nrej() << " rejected, " << reuse.get_njac()
+                        << " Jacobians, " << reuse.get_nlu() << " LU");
+}
+
+// Nominal run plus one per state and parameter, each displaced by delta; columns
+// of the quaternion are left out, as the displaced quaternion is renormalised
+static std::array<State, 21> forwardDifferenceEnsemble(double duration, long& evaluations) {
+    std::array<double, 20> delta{};
+    for (int j = 0; j < 3; ++j) {
+        delta[j] = 1.0;
+        delta[3 + j] = 1e-3;
+        delta[10 + j] = 1e-6;
+        delta[14 + j] = 1e-3;
+        delta[17 + j] = 1e-5;
+    }
+    delta[13] = 1e-2;
+
+    std::array<State, 21> columns{};
+    evaluations = 0;
+    for (int run = 0; run < 21; ++run) {
+        const int j = run - 1;
+        if (j >= 6 && j < 10) continue;
+        DynamicModel<Integration::FixedDoPri54<13>> model;
+        configureStep(model);
+        if (j >= 0 && j < 13) model.set_sol(j, model.get_sol(j) + delta[j]);
+        if (j == 13) model.Mass += delta[j];
+        if (j > 13 && j < 17) model.Force[j - 14] += delta[j];
+        if (j >= 17) model.Moment[j - 17] += delta[j];
+        model.solve_adaptive(duration, 10.0);
+        evaluations += model.get_nfev();
+        for (int i = 0; i < 13; ++i) {
+            columns[run][i] = run == 0 ? model.get_sol(i) : (model.get_sol(i) - columns[0][i]) / delta[j];
+        }
+    }
+    return columns;
+}
+
+TEST_CASE("Variational equations against a finite difference ensemble") {
+    constexpr double Duration = 600.0;
+    using Augmented = Integration::Variational<DynamicModel>::System<Integration::FixedDoPri54<273>>;
+
+    const SmallMatrix::Vector3 r = {X[0], X[1], X[2]};
+    const SmallMatrix::Vector3 v = {X[3], X[4], X[5]};
+    const SmallMatrix::Quaternion q = {X[6], X[7], X[8], X[9]};
+    const SmallMatrix::Vector3 w = {X[10], X[11], X[12]};
+    auto variational = std::make_unique<Augmented>();
+    configure(*variational);
+    variational->set_reltol(1e-10);
+    variational->set_abstol(1e-6);
+    variational->SetState(r, v, q, w);
+    variational->solve_adaptive(Duration, 10.0);
+
+    long ensembleEvaluations = 0;
+    const auto columns = forwardDifferenceEnsemble(Duration, ensembleEvaluations);
+    double worst = 0.0;
+    for (int j = 0; j < 20; ++j) {
+        if (j >= 6 && j < 10) continue;
+        for (int i = 0; i < 13; ++i) {
+            const double exact = j < 13 ? variational->GetTransition(i, j) : variational->GetSensitivity(i, j - 13);
+            worst = std::max(worst, std::abs(exact - columns[1 + j][i]) / std::max(1.0, std::abs(columns[1 + j][i])));
+        }
+    }
+    REQUIRE(worst < 1e-2);
+    WARN("variational: " << variational->get_nfev() << " evaluations of the 273 state system; ensemble: "
+                         << ensembleEvaluations << " evaluations of the 13 state model; largest relative difference "
+                         << worst);
+
+    BENCHMARK("variational equations, 600 s") {
+        auto model = std::make_unique<Augmented>();
+        configure(*model);
+        model->set_reltol(1e-10);
+        model->set_abstol(1e-6);
+        model->SetState(r, v, q, w);
+        model->solve_adaptive(Duration, 10.0);
+        return model->GetTransition(0, 0);
+    };
+
+    BENCHMARK("forward difference ensemble, 600 s") {
+        long evaluations = 0;
+        return forwardDifferenceEnsemble(Duration, evaluations)[1][0];
+    };
+}
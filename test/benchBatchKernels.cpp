@@ -0,0 +1,130 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [benchBatchKernels.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Throughput of the scalar routines against the batch kernels per instruction set.
+ *  Each benchmark processes PointCount points; points per second = PointCount / mean.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+#include "BatchKernels.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+constexpr std::size_t PointCount = 1 << 16;
+
+static const char* isaName(Simd::Isa isa) {
+    switch (isa) {
+        case Simd::Isa::AVX512: return "AVX-512";
+        case Simd::Isa::AVX2:   return "AVX2";
+        case Simd::Isa::SSE2:   return "SSE2";
+        default:                return "scalar";
+    }
+}
+
+TEST_CASE("J2 gravity throughput") {
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> coordinate(-4.2e7, 4.2e7);
+    std::vector<double> x(PointCount), y(PointCount), z(PointCount), ax(PointCount), ay(PointCount), az(PointCount);
+    for (std::size_t i = 0; i < PointCount; ++i) {
+        x[i] = coordinate(rng);
+        y[i] = coordinate(rng);
+        z[i] = coordinate(rng);
+    }
+
+    BENCHMARK("scalar loop") {
+        for (std::size_t i = 0; i < PointCount; ++i) {
+            auto a = J2::calculateGravitationalAcceleration(x[i], y[i], z[i]);
+            ax[i] = a[0];
+            ay[i] = a[1];
+            az[i] = a[2];
+        }
+        return ax[PointCount - 1];
+    };
+
+    for (auto isa : {Simd::Isa::SSE2, Simd::Isa::AVX2, Simd::Isa::AVX512}) {
+        Simd::limitIsa(isa);
+        BENCHMARK(std::string("batch ") + isaName(Simd::activeIsa())) {
+            J2::calculateGravitationalAcceleration(x, y, z, ax, ay, az);
+            return ax[PointCount - 1];
+        };
+    }
+    Simd::limitIsa(Simd::Isa::AVX512);
+}
+
+TEST_CASE("ECEF to ECI throughput") {
+    std::mt19937_64 rng(2);
+    std::uniform_real_distribution<double> coordinate(-7.0e6, 7.0e6);
+    std::vector<double> x(PointCount), y(PointCount), z(PointCount), xe(PointCount), ye(PointCount), ze(PointCount);
+    for (std::size_t i = 0; i < PointCount; ++i) {
+        x[i] = coordinate(rng);
+        y[i] = coordinate(rng);
+        z[i] = coordinate(rng);
+    }
+
+    BENCHMARK("scalar loop") {
+        for (std::size_t i = 0; i < PointCount; ++i) {
+            auto r = Coordinate::ecefToEci(x[i], y[i], z[i], 600.0);
+            xe[i] = r[0];
+            ye[i] = r[1];
+            ze[i] = r[2];
+        }
+        return xe[PointCount - 1];
+    };
+
+    for (auto isa : {Simd::Isa::SSE2, Simd::Isa::AVX2, Simd::Isa::AVX512}) {
+        Simd::limitIsa(isa);
+        BENCHMARK(std::string("batch ") + isaName(Simd::activeIsa())) {
+            Coordinate::ecefToEci(x, y, z, 600.0, xe, ye, ze);
+            return xe[PointCount - 1];
+        };
+    }
+    Simd::limitIsa(Simd::Isa::AVX512);
+}
+
+TEST_CASE("US1976 atmosphere throughput") {
+    std::vector<double> h(PointCount), out(PointCount);
+    for (std::size_t i = 0; i < PointCount; ++i) {
+        h[i] = 71000.0 * static_cast<double>(i) / PointCount;
+    }
+
+    BENCHMARK("scalar temperature loop") {
+        for (std::size_t i = 0; i < PointCount; ++i) out[i] = US1976::Temperature(h[i]);
+        return out[PointCount - 1];
+    };
+
+    BENCHMARK("scalar density loop") {
+        for (std::size_t i = 0; i < PointCount; ++i) out[i] = US1976::Density(h[i]);
+        return out[PointCount - 1];
+    };
+
+    for (auto isa : {Simd::Isa::SSE2, Simd::Isa::AVX2, Simd::Isa::AVX512}) {
+        Simd::limitIsa(isa);
+        BENCHMARK(std::string("batch temperature ") + isaName(Simd::activeIsa())) {
+            US1976::Temperature(h, out);
+            return out[PointCount - 1];
+        };
+        BENCHMARK(std::string("batch density ") + isaName(Simd::activeIsa())) {
+            US1976::Density(h, out);
+            return out[PointCount - 1];
+        };
+    }
+    Simd::limitIsa(Simd::Isa::AVX512);
+}
@@ -0,0 +1,147 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [benchEnsembleDynamics.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Throughput of TrajectoryCount LEO trajectories over one orbit: the scalar
+ *  DynamicModel, one trajectory after the other, against the ensemble model with
+ *  the same integration, per instruction set of the batch gravity kernel; fixed
+ *  RK4 steps and adaptive DoPri54 steps. Trajectories per second =
+ *  TrajectoryCount / mean. The ensemble is also timed with drag for a tile that
+ *  re-enters.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/DynamicModel.h"
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/EnsembleModel.h"
+#include "FixedSizeIntegrators.h"
+
+#include <array>
+#include <cmath>
+#include <string>
+
+constexpr std::size_t TrajectoryCount = 256;
+constexpr double Duration = 5550.0; // about one orbit at 400 km
+
+using Vector = std::array<double, 3>;
+
+static const char* isaName(Simd::Isa isa) {
+    switch (isa) {
+        case Simd::Isa::AVX512: return "AVX-512";
+        case Simd::Isa::AVX2:   return "AVX2";
+        case Simd::Isa::SSE2:   return "SSE2";
+        default:                return "scalar";
+    }
+}
+
+static void initial(std::size_t k, Vector& r, Vector& v) {
+    const double speed = 7668.6 * (1.0 + 1e-4 * (k % 32));
+    const double inclination = 0.9 + 1e-3 * k;
+    r = {6778137.0, 0.0, 0.0};
+    v = {0.0, speed * std::cos(inclination), speed * std::sin(inclination)};
+}
+
+// Adaptive where the integrator is, otherwise fixed 10 s steps
+template<class Integrator>
+static void solve(Integrator& integrator) {
+    if constexpr (requires { integrator.solve_adaptive(Duration, 10.0); }) {
+        integrator.solve_adaptive(Duration, 10.0);
+    } else {
+        integrator.solve_fixed(Duration, 10.0);
+    }
+}
+
+template<class Ensemble>
+static double runEnsemble(Ensemble& ensemble) {
+    for (std::size_t k = 0; k < TrajectoryCount; ++k) {
+        Vector r, v;
+        initial(k, r, v);
+        ensemble.SetState(k, r, v);
+    }
+    ensemble.set_t(0.0);
+    solve(ensemble);
+    return ensemble.get_sol(TrajectoryCount - 1, 0);
+}
+
+template<class Model>
+static double runScalar() {
+    double sum = 0.0;
+    for (std::size_t k = 0; k < TrajectoryCount; ++k) {
+        Model model;
+        model.set_reltol(1e-10);
+        model.set_abstol(1e-6);
+        Vector r, v;
+        initial(k, r, v);
+        model.SetState(r, v);
+        solve(model);
+        sum += model.get_sol(0);
+    }
+    return sum;
+}
+
+TEST_CASE("Fixed step RK4 throughput") {
+    BENCHMARK("scalar DynamicModel") {
+        return runScalar<DynamicModel<Integration::FixedRK4<6>>>();
+    };
+
+    EnsembleModel<Integration::EnsembleRK4<6>> ensemble(TrajectoryCount);
+    for (auto isa : {Simd::Isa::Scalar, Simd::Isa::SSE2, Simd::Isa::AVX2, Simd::Isa::AVX512}) {
+        Simd::limitIsa(isa);
+        BENCHMARK(std::string("ensemble, gravity ") + isaName(Simd::activeIsa())) {
+            return runEnsemble(ensemble);
+        };
+    }
+    Simd::limitIsa(Simd::Isa::AVX512);
+}
+
+TEST_CASE("Adaptive DoPri54 throughput") {
+    BENCHMARK("scalar DynamicModel") {
+        return runScalar<DynamicModel<Integration::FixedDoPri54<6>>>();
+    };
+
+    EnsembleModel<Integration::EnsembleDoPri54<6>> ensemble(TrajectoryCount);
+    ensemble.set_reltol(1e-10);
+    ensemble.set_abstol(1e-6);
+    for (auto isa : {Simd::Isa::Scalar, Simd::Isa::AVX2, Simd::Isa::AVX512}) {
+        Simd::limitIsa(isa);
+        BENCHMARK(std::string("ensemble, gravity ") + isaName(Simd::activeIsa())) {
+            return runEnsemble(ensemble);
+        };
+    }
+    Simd::limitIsa(Simd::Isa::AVX512);
+
+    // Steps per trajectory: lanes of a tile wait for the slowest one, so the work
+    // done is the tile maximum, while the steps counted are each lane's own
+    WARN("ensemble steps " << ensemble.get_nstep() << ", right-hand sides " << ensemble.get_nfev());
+}
+
+TEST_CASE("Ensemble throughput with drag") {
+    EnsembleModel<Integration::EnsembleDoPri54<6>> ensemble(TrajectoryCount);
+    ensemble.set_reltol(1e-10);
+    ensemble.set_abstol(1e-6);
+
+    BENCHMARK("ensemble, 60 s of re-entry from 70 km") {
+        for (std::size_t k = 0; k < TrajectoryCount; ++k) {
+            ensemble.SetState(k, {6378137.0 + 70000.0, 0.0, 0.0}, {-300.0, 7000.0 - k, 0.0});
+            ensemble.SetMass(k, 100.0);
+            ensemble.SetDragArea(k, 0.5 + 0.01 * k);
+        }
+        ensemble.set_t(0.0);
+        ensemble.solve_adaptive(60.0, 1.0);
+        return ensemble.get_sol(0, 0);
+    };
+}
@@ -0,0 +1,113 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [benchGeodetic.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Closed form ECEF to geodetic conversion against an iterative reference, for
+ *  accuracy and throughput. Each benchmark converts PointCount points.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+#include "BatchKernels.h"
+#include "EarthCenteredFrames.h"
+
+#include <random>
+#include <vector>
+
+constexpr std::size_t PointCount = 1 << 14;
+
+// Fixed point iteration on the latitude, run until it stops changing
+static void iterativeLatLonAlt(double x, double y, double z, double& lat, double& lon, double& alt, int& iterations) {
+    const double a = Coordinate::EARTH_SEMI_MAJOR_AXIS;
+    const double e2 = Coordinate::EARTH_ECCENTRICITY * Coordinate::EARTH_ECCENTRICITY;
+    const double p = std::sqrt(x * x + y * y);
+    double phi = std::atan2(z, p * (1 - e2));
+    double h = 0.0;
+    for (iterations = 1; iterations < 100; ++iterations) {
+        const double s = std::sin(phi);
+        const double N = a / std::sqrt(1 - e2 * s * s);
+        h = p / std::cos(phi) - N;
+        const double next = std::atan2(z, p * (1 - e2 * N / (N + h)));
+        if (std::abs(next - phi) < 1e-15) {
+            phi = next;
+            break;
+        }
+        phi = next;
+    }
+    // Altitude along the normal, stable at all latitudes
+    const double s = std::sin(phi);
+    alt = p * std::cos(phi) + z * s - a * std::sqrt(1 - e2 * s * s);
+    lat = phi / Coordinate::DEG_TO_RAD;
+    lon = std::atan2(y, x) / Coordinate::DEG_TO_RAD;
+}
+
+TEST_CASE("ECEF to geodetic, closed form against iteration") {
+    std::mt19937_64 rng(9);
+    std::uniform_real_distribution<double> latitude(-89.9, 89.9);
+    std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+    std::uniform_real_distribution<double> altitude(-1.0e4, 1.0e6);
+
+    std::vector<double> x(PointCount), y(PointCount), z(PointCount);
+    for (std::size_t i = 0; i < PointCount; ++i) {
+        Coordinate::latLonAltToEcef(latitude(rng), longitude(rng), altitude(rng), x[i], y[i], z[i]);
+    }
+    std::vector<double> lat(PointCount), lon(PointCount), alt(PointCount);
+
+    // Accuracy: closed form and converged iteration agree to round off
+    double worstLat = 0.0;
+    double worstAlt = 0.0;
+    int worstIterations = 0;
+    for (std::size_t i = 0; i < PointCount; ++i) {
+        double la, lo, al, lr, lor, ar;
+        int iterations;
+        Coordinate::ecefToLatLonAlt(x[i], y[i], z[i], la, lo, al);
+        iterativeLatLonAlt(x[i], y[i], z[i], lr, lor, ar, iterations);
+        worstLat = std::max(worstLat, std::abs(la - lr));
+        worstAlt = std::max(worstAlt, std::abs(al - ar));
+        worstIterations = std::max(worstIterations, iterations);
+    }
+    WARN("max |lat - lat_iterative| = " << worstLat << " deg, max |alt - alt_iterative| = " << worstAlt
+                                        << " m, iterations up to " << worstIterations);
+    REQUIRE(worstLat < 1e-11);
+    REQUIRE(worstAlt < 1e-6);
+
+    BENCHMARK("iterative reference") {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < PointCount; ++i) {
+            double la, lo, al;
+            int iterations;
+            iterativeLatLonAlt(x[i], y[i], z[i], la, lo, al, iterations);
+            sum += al;
+        }
+        return sum;
+    };
+
+    BENCHMARK("closed form, scalar calls") {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < PointCount; ++i) {
+            double la, lo, al;
+            Coordinate::ecefToLatLonAlt(x[i], y[i], z[i], la, lo, al);
+            sum += al;
+        }
+        return sum;
+    };
+
+    BENCHMARK("closed form, batch") {
+        Coordinate::ecefToLatLonAlt(x, y, z, lat, lon, alt);
+        return alt[0];
+    };
+}
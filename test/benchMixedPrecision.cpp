@@ -0,0 +1,98 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [benchMixedPrecision.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Throughput of the mixed precision mode against the double path: the batch
+ *  density in double and in single precision per instruction set, PointCount
+ *  altitudes per benchmark, and TrajectoryCount re-entries of the ensemble model
+ *  with double and float environments; trajectories per second =
+ *  TrajectoryCount / mean.]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/EnsembleModel.h"
+
+#include <string>
+#include <vector>
+
+constexpr std::size_t PointCount = 1 << 16;
+constexpr std::size_t TrajectoryCount = 256;
+
+static const char* isaName(Simd::Isa isa) {
+    switch (isa) {
+        case Simd::Isa::AVX512: return "AVX-512";
+        case Simd::Isa::AVX2:   return "AVX2";
+        case Simd::Isa::SSE2:   return "SSE2";
+        default:                return "scalar";
+    }
+}
+
+TEST_CASE("Density throughput, double against float") {
+    std::vector<double> h(PointCount), density(PointCount);
+    std::vector<float> hf(PointCount), densityf(PointCount);
+    for (std::size_t i = 0; i < PointCount; ++i) {
+        h[i] = 71000.0 * static_cast<double>(i) / PointCount;
+        hf[i] = static_cast<float>(h[i]);
+    }
+
+    for (auto isa : {Simd::Isa::Scalar, Simd::Isa::AVX2, Simd::Isa::AVX512}) {
+        Simd::limitIsa(isa);
+        BENCHMARK(std::string("double ") + isaName(Simd::activeIsa())) {
+            US1976::Density(h, density);
+            return density[PointCount - 1];
+        };
+        BENCHMARK(std::string("float ") + isaName(Simd::activeIsa())) {
+            US1976::Density(hf, densityf);
+            return densityf[PointCount - 1];
+        };
+    }
+    Simd::limitIsa(Simd::Isa::AVX512);
+}
+
+template<class Ensemble>
+static double reentry(Ensemble& ensemble) {
+    for (std::size_t k = 0; k < TrajectoryCount; ++k) {
+        ensemble.SetState(k, {6378137.0 + 70000.0, 0.0, 0.0}, {-300.0, 7000.0 - k, 0.0});
+        ensemble.SetMass(k, 100.0);
+        ensemble.SetDragArea(k, 0.5 + 0.01 * k);
+    }
+    ensemble.set_t(0.0);
+    if constexpr (requires { ensemble.solve_adaptive(60.0, 1.0); }) {
+        ensemble.solve_adaptive(60.0, 1.0);
+    } else {
+        ensemble.solve_fixed(60.0, 0.1);
+    }
+    return ensemble.get_sol(TrajectoryCount - 1, 0);
+}
+
+TEST_CASE("Re-entry throughput, double against mixed precision") {
+    EnsembleModel<Integration::EnsembleRK4<6>, double> rk4(TrajectoryCount);
+    EnsembleModel<Integration::EnsembleRK4<6>, float> rk4Mixed(TrajectoryCount);
+    BENCHMARK("RK4 0.1 s steps, double") { return reentry(rk4); };
+    BENCHMARK("RK4 0.1 s steps, mixed") { return reentry(rk4Mixed); };
+
+    // Tolerances of a low fidelity sweep, well above the float noise of the drag
+    EnsembleModel<Integration::EnsembleDoPri54<6>, double> dopri(TrajectoryCount);
+    EnsembleModel<Integration::EnsembleDoPri54<6>, float> dopriMixed(TrajectoryCount);
+    dopri.set_reltol(1e-8);
+    dopri.set_abstol(1e-3);
+    dopriMixed.set_reltol(1e-8);
+    dopriMixed.set_abstol(1e-3);
+    BENCHMARK("DoPri54, double") { return reentry(dopri); };
+    BENCHMARK("DoPri54, mixed") { return reentry(dopriMixed); };
+}
@@ -0,0 +1,107 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [benchSphericalHarmonicGravity.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Cost of one spherical harmonic acceleration evaluation for several degrees]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+#include "GravitationalModels.h"
+#include "GravityFieldCache.h"
+#include "SphericalHarmonicGravity.h"
+
+#include <string>
+
+TEST_CASE("Spherical harmonic acceleration cost per evaluation") {
+    const int maxDegree = 360;
+    std::vector<double> C(SphericalHarmonics::triangularSize(maxDegree), 1e-9);
+    std::vector<double> S(SphericalHarmonics::triangularSize(maxDegree), 1e-9);
+    C[0] = 1.0;
+    SphericalHarmonics::GravityField field(C.data(), S.data(), maxDegree, J2::GM, J2::Re);
+
+    BENCHMARK("J2 closed form") {
+        return J2::calculateGravitationalAcceleration(6.9e6, 1.0e5, 1.2e6);
+    };
+
+    BENCHMARK("Zonal<4> unrolled") {
+        return J2::Zonal<4>::calculateGravitationalAcceleration(6.9e6, 1.0e5, 1.2e6);
+    };
+
+    BENCHMARK("Zonal<6> unrolled") {
+        return J2::Zonal<6>::calculateGravitationalAcceleration(6.9e6, 1.0e5, 1.2e6);
+    };
+
+    for (int degree : {2, 8, 20, 70, 120, 360}) {
+        field.setDegreeOrder(degree, degree);
+        BENCHMARK("degree/order " + std::to_string(degree)) {
+            return field.acceleration(6.9e6, 1.0e5, 1.2e6);
+        };
+    }
+}
+
+TEST_CASE("Gravity gradient cost per evaluation") {
+    const int maxDegree = 70;
+    std::vector<double> C(SphericalHarmonics::triangularSize(maxDegree), 1e-9);
+    std::vector<double> S(SphericalHarmonics::triangularSize(maxDegree), 1e-9);
+    C[0] = 1.0;
+    SphericalHarmonics::GravityField field(C.data(), S.data(), maxDegree, J2::GM, J2::Re);
+
+    BENCHMARK("J2 acceleration and gradient") {
+        return J2::calculateGravityGradient(6.9e6, 1.0e5, 1.2e6);
+    };
+
+    BENCHMARK("Zonal<6> acceleration and gradient") {
+        return J2::Zonal<6>::calculateGravityGradient(6.9e6, 1.0e5, 1.2e6);
+    };
+
+    for (int degree : {8, 20, 70}) {
+        field.setDegreeOrder(degree, degree);
+        BENCHMARK("degree/order " + std::to_string(degree) + " acceleration and gradient") {
+            return field.accelerationAndGradient(6.9e6, 1.0e5, 1.2e6);
+        };
+    }
+}
+
+TEST_CASE("Gravity field cache lookup against direct evaluation") {
+    const int maxDegree = 70;
+    std::vector<double> C(SphericalHarmonics::triangularSize(maxDegree), 1e-9);
+    std::vector<double> S(SphericalHarmonics::triangularSize(maxDegree), 1e-9);
+    C[0] = 1.0;
+    SphericalHarmonics::GravityField field(C.data(), S.data(), maxDegree, J2::GM, J2::Re);
+    SphericalHarmonics::GravityFieldCache cache([&field](double x, double y, double z) { return field.accelerationAndGradient(x, y, z); }, J2::GM);
+
+    // Points along a short arc, so the cells are built once and then reused
+    std::vector<std::array<double, 3>> arc;
+    for (int n = 0; n < 64; ++n) {
+        const double angle = 1e-3 * n;
+        arc.push_back({6.9e6 * std::cos(angle), 6.9e6 * std::sin(angle), 1.2e6});
+    }
+    for (const auto& p : arc) cache.acceleration(p[0], p[1], p[2]);
+
+    BENCHMARK("direct degree/order 70, 64 points") {
+        double sum = 0.0;
+        for (const auto& p : arc) sum += field.accelerationAndGradient(p[0], p[1], p[2]).acceleration[0];
+        return sum;
+    };
+
+    BENCHMARK("cached degree/order 70, 64 points") {
+        double sum = 0.0;
+        for (const auto& p : arc) sum += cache.accelerationAndGradient(p[0], p[1], p[2]).acceleration[0];
+        return sum;
+    };
+}
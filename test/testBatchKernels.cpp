@@ -0,0 +1,119 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testBatchKernels.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Batch kernels must agree with the scalar routines on every instruction set]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "BatchKernels.h"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Distance between a and b in units in the last place of `scale`
+static double ulpDistance(double a, double b, double scale) {
+    if (std::isnan(a) && std::isnan(b)) return 0.0;
+    return std::abs(a - b) / std::max(std::nextafter(std::abs(scale), INFINITY) - std::abs(scale),
+                                      std::numeric_limits<double>::denorm_min());
+}
+
+static const Simd::Isa allIsas[] = {Simd::Isa::Scalar, Simd::Isa::SSE2, Simd::Isa::AVX2, Simd::Isa::AVX512};
+
+TEST_CASE("Batch J2 gravity matches the scalar routine") {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> coordinate(-4.2e7, 4.2e7);
+
+    const std::size_t n = 1003; // odd size exercises the scalar tail
+    std::vector<double> x(n), y(n), z(n), ax(n), ay(n), az(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = coordinate(rng);
+        y[i] = coordinate(rng);
+        z[i] = coordinate(rng);
+    }
+
+    for (auto isa : allIsas) {
+        Simd::limitIsa(isa);
+        J2::calculateGravitationalAcceleration(x, y, z, ax, ay, az);
+        for (std::size_t i = 0; i < n; ++i) {
+            auto expected = J2::calculateGravitationalAcceleration(x[i], y[i], z[i]);
+            double scale = std::sqrt(expected[0] * expected[0] + expected[1] * expected[1] + expected[2] * expected[2]);
+            REQUIRE(ulpDistance(ax[i], expected[0], scale) <= Simd::MaxUlpError);
+            REQUIRE(ulpDistance(ay[i], expected[1], scale) <= Simd::MaxUlpError);
+            REQUIRE(ulpDistance(az[i], expected[2], scale) <= Simd::MaxUlpError);
+        }
+    }
+    Simd::limitIsa(Simd::Isa::AVX512);
+}
+
+TEST_CASE("Batch ECEF to ECI rotation matches the scalar routine") {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> coordinate(-7.0e6, 7.0e6);
+
+    const std::size_t n = 517;
+    const double t = 12345.678;
+    std::vector<double> x(n), y(n), z(n), xe(n), ye(n), ze(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = coordinate(rng);
+        y[i] = coordinate(rng);
+        z[i] = coordinate(rng);
+    }
+
+    for (auto isa : allIsas) {
+        Simd::limitIsa(isa);
+        Coordinate::ecefToEci(x, y, z, t, xe, ye, ze);
+        for (std::size_t i = 0; i < n; ++i) {
+            auto expected = Coordinate::ecefToEci(x[i], y[i], z[i], t);
+            double scale = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+            REQUIRE(ulpDistance(xe[i], expected[0], scale) <= Simd::MaxUlpError);
+            REQUIRE(ulpDistance(ye[i], expected[1], scale) <= Simd::MaxUlpError);
+            REQUIRE(ze[i] == expected[2]);
+        }
+    }
+    Simd::limitIsa(Simd::Isa::AVX512);
+}
+
+TEST_CASE("Batch US1976 atmosphere matches the scalar routines") {
+    const std::size_t n = 801;
+    std::vector<double> h(n), temperature(n), pressure(n), density(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        h[i] = -1000.0 + 100.0 * static_cast<double>(i); // spans below, inside and above the table
+    }
+
+    for (auto isa : allIsas) {
+        Simd::limitIsa(isa);
+        US1976::Temperature(h, temperature);
+        US1976::Pressure(h, pressure);
+        US1976::Density(h, density);
+        for (std::size_t i = 0; i < n; ++i) {
+            double T = US1976::Temperature(h[i]);
+            double P = US1976::Pressure(h[i]);
+            double rho = US1976::Density(h[i]);
+            REQUIRE(ulpDistance(temperature[i], T, T) <= Simd::MaxUlpError);
+            REQUIRE(ulpDistance(pressure[i], P, P) <= Simd::MaxUlpError);
+            REQUIRE(ulpDistance(density[i], rho, rho) <= Simd::MaxUlpError);
+        }
+    }
+    Simd::limitIsa(Simd::Isa::AVX512);
+}
+
+TEST_CASE("Batch kernels reject mismatched spans") {
+    std::vector<double> a(4), b(3);
+    REQUIRE_THROWS_AS(US1976::Temperature(a, b), std::invalid_argument);
+}
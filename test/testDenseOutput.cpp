@@ -0,0 +1,151 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testDenseOutput.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Hermite dense output: exact on cubics, fourth order on smooth solutions, and
+ *  the communication step independence of IntegratorSelection::advanceTo]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "DenseOutput.h"
+#include "IntegratorSelection.h"
+
+#include <cmath>
+
+using Integration::HermiteStep;
+
+TEST_CASE("Hermite step reproduces a cubic") {
+    auto p = [](double t) { return 1.0 - 2.0 * t + 0.5 * t * t + 0.25 * t * t * t; };
+    auto dp = [](double t) { return -2.0 + t + 0.75 * t * t; };
+
+    HermiteStep step(1);
+    const double t0 = 0.3, t1 = 2.1;
+    const double y0 = p(t0), f0 = dp(t0), y1 = p(t1), f1 = dp(t1);
+    step.set(t0, &y0, &f0, t1, &y1, &f1);
+
+    for (double t = t0; t <= t1; t += 0.05) {
+        double y;
+        step.evaluate(t, &y);
+        REQUIRE(y == Approx(p(t)).margin(1e-13));
+    }
+}
+
+TEST_CASE("Hermite step error is fourth order") {
+    auto maxError = [](double h) {
+        HermiteStep step(2);
+        const double y0[2] = {std::sin(0.0), std::cos(0.0)};
+        const double f0[2] = {std::cos(0.0), -std::sin(0.0)};
+        const double y1[2] = {std::sin(h), std::cos(h)};
+        const double f1[2] = {std::cos(h), -std::sin(h)};
+        step.set(0.0, y0, f0, h, y1, f1);
+        double error = 0.0;
+        for (int k = 0; k <= 20; ++k) {
+            const double t = h * k / 20.0;
+            double y[2];
+            step.evaluate(t, y);
+            error = std::max({error, std::abs(y[0] - std::sin(t)), std::abs(y[1] - std::cos(t))});
+        }
+        return error;
+    };
+
+    // Halving the step divides the error by about 2^4
+    const double ratio = maxError(0.2) / maxError(0.1);
+    REQUIRE(ratio == Approx(16.0).epsilon(0.1));
+}
+
+TEST_CASE("Zero length step holds its state") {
+    HermiteStep step(3);
+    const double y[3] = {1.0, -2.0, 3.0};
+    step.reset(5.0, y);
+    double out[3];
+    step.evaluate(5.0, out);
+    REQUIRE(out[0] == 1.0);
+    REQUIRE(out[1] == -2.0);
+    REQUIRE(out[2] == 3.0);
+}
+
+// Harmonic oscillator y'' = -y as a model of the shape IntegratorSelection expects
+template<class Integrator>
+class Oscillator : public Integration::Bind<Integrator, Oscillator<Integrator>> {
+
+    public:
+        static constexpr int StateCount = 2;
+
+        Oscillator() : Integration::Bind<Integrator, Oscillator>(StateCount) {}
+
+        void ode_fun(double* solin, double* fout) {
+            fout[0] = solin[1];
+            fout[1] = -solin[0];
+        }
+};
+
+TEST_CASE("Outputs do not depend on the communication step") {
+    Integration::StepSettings settings;
+    settings.relativeTolerance = 1e-10;
+    settings.absoluteTolerance = 1e-12;
+    settings.maxStep = 0.1;
+
+    for (const auto method : {Integration::Method::DoPri54, Integration::Method::ROW6A}) {
+        Integration::IntegratorSelection<Oscillator> coarse;
+        Integration::IntegratorSelection<Oscillator> fine;
+        for (auto* system : {&coarse, &fine}) {
+            system->select(method);
+            system->visit([](auto& model) {
+                model.set_sol(0, 0.0);
+                model.set_sol(1, 1.0);
+            });
+            system->start(0.0, settings);
+        }
+
+        for (int k = 1; k <= 1000; ++k) {
+            const double t = 0.01 * k;
+            const auto& y = fine.advanceTo(t);
+            REQUIRE(y[0] == Approx(std::sin(t)).margin(1e-5));
+        }
+        const auto& yFine = fine.advanceTo(10.0);
+        const auto& yCoarse = coarse.advanceTo(10.0);
+        REQUIRE(yFine[0] == Approx(yCoarse[0]).margin(1e-12));
+        REQUIRE(yFine[1] == Approx(yCoarse[1]).margin(1e-12));
+    }
+}
+
+TEST_CASE("Outputs between long integrator steps keep the tolerance") {
+    Integration::StepSettings settings;
+    settings.relativeTolerance = 1e-8;
+    settings.absoluteTolerance = 1e-10;
+    settings.maxStep = 5.0;
+
+    // Continuous extension (FixedDoPri54), Hermite bounded by its error estimate on natural
+    // steps (FixedROS34PW2) and on segments the integrator is forced onto (DoPri87)
+    for (const auto method : {Integration::Method::FixedDoPri54, Integration::Method::FixedROS34PW2, Integration::Method::DoPri87}) {
+        Integration::IntegratorSelection<Oscillator> system;
+        system.select(method);
+        system.visit([](auto& model) {
+            model.set_sol(0, 0.0);
+            model.set_sol(1, 1.0);
+        });
+        system.start(0.0, settings);
+
+        double worst = 0.0;
+        for (int k = 1; k <= 1000; ++k) {
+            const double t = 0.01 * k;
+            const auto& y = system.advanceTo(t);
+            worst = std::max({worst, std::abs(y[0] - std::sin(t)), std::abs(y[1] - std::cos(t))});
+        }
+        REQUIRE(worst < 1e-6);
+    }
+}
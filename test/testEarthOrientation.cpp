@@ -0,0 +1,196 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testEarthOrientation.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [ITRF to GCRF transformation against Vallado, Example 3-15 (IAU-76/FK5)]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "EarthOrientation.h"
+#include "J2000.h"
+
+#include <cstdio>
+
+// 2004 April 6, 07:51:28.386009 UTC
+static const double utc = timeSinceJ2000(2004, 4, 6, 7, 51, 28) + 0.386009;
+
+static Coordinate::EopTable valladoEop() {
+    Coordinate::EopRecord r;
+    r.mjd = 53101.0;
+    r.xp = -0.140682;
+    r.yp = 0.333309;
+    r.dut1 = -0.4399619;
+    r.lod = 0.0015563;
+    r.dPsi = -0.052195;
+    r.dEps = -0.003875;
+    Coordinate::EopRecord next = r;
+    next.mjd += 1.0;
+    return Coordinate::EopTable({r, next});
+}
+
+TEST_CASE("ITRF to GCRF reproduces the reference example") {
+    Coordinate::EarthOrientation orientation(valladoEop());
+
+    const std::array<double, 3> r = {-1033.4793830e3, 7901.2952754e3, 6380.3565958e3};
+    const std::array<double, 3> v = {-3.225636520e3, -2.872451450e3, 5.531924446e3};
+    auto eci = orientation.ecefToEci(r, utc);
+    auto veci = orientation.ecefToEciVelocity(r, v, utc);
+
+    // Truncated nutation series: agreement to a few centimetres and a millimetre per second
+    REQUIRE(eci[0] == Approx(5102.508958e3).margin(0.25));
+    REQUIRE(eci[1] == Approx(6123.011401e3).margin(0.25));
+    REQUIRE(eci[2] == Approx(6378.136928e3).margin(0.25));
+    REQUIRE(veci[0] == Approx(-4.743220157e3).margin(1e-3));
+    REQUIRE(veci[1] == Approx(0.790536497e3).margin(1e-3));
+    REQUIRE(veci[2] == Approx(5.533755727e3).margin(1e-3));
+
+    auto back = orientation.eciToEcef(eci, utc);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(back[i] == Approx(r[i]).margin(1e-6));
+    }
+}
+
+TEST_CASE("Interpolated precession-nutation matches direct evaluation") {
+    Coordinate::EarthOrientation orientation(valladoEop());
+    Coordinate::EarthOrientation reference(valladoEop(), Coordinate::defaultNutationTerms(), 1e-3);
+
+    const std::array<double, 3> r = {7.0e6, -1.0e6, 2.0e6};
+    for (double dt = 0.0; dt < 7200.0; dt += 137.0) {
+        auto a = orientation.ecefToEci(r, utc + dt);
+        // 1 ms cadence: the grid points straddle utc + dt, effectively no interpolation
+        auto b = reference.ecefToEci(r, utc + dt);
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(a[i] == Approx(b[i]).margin(1e-4));
+        }
+    }
+}
+
+TEST_CASE("Acceleration of an Earth fixed point matches the velocity derivative") {
+    Coordinate::EarthOrientation orientation(valladoEop());
+    const std::array<double, 3> r = {-1033.4793830e3, 7901.2952754e3, 6380.3565958e3};
+    const std::array<double, 3> zero = {0.0, 0.0, 0.0};
+
+    const auto a = orientation.ecefToEciAcceleration(r, zero, zero, utc);
+    const auto before = orientation.ecefToEciVelocity(r, zero, utc - 1.0);
+    const auto after = orientation.ecefToEciVelocity(r, zero, utc + 1.0);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(a[i] == Approx(0.5 * (after[i] - before[i])).margin(1e-6));
+    }
+
+    // The array form builds the rotation once and agrees with the single vector calls
+    const std::array<double, 3> v = {-3.225636520e3, -2.872451450e3, 5.531924446e3};
+    const std::array<double, 3> acc = {1.0, -2.0, 3.0};
+    std::vector<std::array<double, 3>> rs = {r, v}, vs = {v, r}, as = {acc, zero};
+    std::vector<std::array<double, 3>> ro(2), vo(2), ao(2);
+    orientation.ecefToEci(utc, rs, vs, as, ro, vo, ao);
+    for (std::size_t k = 0; k < rs.size(); ++k) {
+        const auto rk = orientation.ecefToEci(rs[k], utc);
+        const auto vk = orientation.ecefToEciVelocity(rs[k], vs[k], utc);
+        const auto ak = orientation.ecefToEciAcceleration(rs[k], vs[k], as[k], utc);
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(ro[k][i] == Approx(rk[i]).margin(1e-6));
+            REQUIRE(vo[k][i] == Approx(vk[i]).margin(1e-9));
+            REQUIRE(ao[k][i] == Approx(ak[i]).margin(1e-12));
+        }
+    }
+}
+
+TEST_CASE("Nutation table file round trip") {
+    const std::string path = "testEarthOrientation.txt";
+    {
+        std::ofstream out(path);
+        out << "# D M M' F Omega psi psiRate eps epsRate\n";
+        for (const auto& t : Coordinate::defaultNutationTerms()) {
+            out << t.D << ' ' << t.M << ' ' << t.Mp << ' ' << t.F << ' ' << t.Omega << ' ' << t.psi << ' ' << t.psiRate << ' ' << t.eps
+                << ' ' << t.epsRate << '\n';
+        }
+    }
+    auto terms = Coordinate::loadNutationTerms(path);
+    std::remove(path.c_str());
+    REQUIRE(terms.size() == Coordinate::defaultNutationTerms().size());
+
+    auto a = Coordinate::nutationAngles(0.04, terms);
+    auto b = Coordinate::nutationAngles(0.04, Coordinate::defaultNutationTerms());
+    REQUIRE(a.dPsi == b.dPsi);
+    REQUIRE(a.dEps == b.dEps);
+}
+
+TEST_CASE("Simple Z rotation uses the sidereal rate and the right sense") {
+    // A point fixed on the equator moves eastward in inertial space
+    auto r = Coordinate::ecefToEci(7.0e6, 0.0, 0.0, 100.0);
+    REQUIRE(r[1] > 0.0);
+    REQUIRE(std::atan2(r[1], r[0]) == Approx(100.0 * Coordinate::EARTH_ROTATION_RATE).epsilon(1e-12));
+
+    auto v = Coordinate::ecefToEciVel(7.0e6, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+    REQUIRE(v[1] == Approx(7.0e6 * Coordinate::EARTH_ROTATION_RATE).epsilon(1e-12));
+}
+
+TEST_CASE("UT1-UTC is interpolated across the 2016 leap second") {
+    // IERS values around 2017-01-01 (MJD 57754), where UT1-UTC steps up by the leap second
+    auto day = [](double mjd, double dut1) {
+        Coordinate::EopRecord r;
+        r.mjd = mjd;
+        r.dut1 = dut1;
+        return r;
+    };
+    const Coordinate::EopTable eop({day(57753.0, -0.4077), day(57754.0, 0.5923), day(57755.0, 0.5920)});
+
+    // Half a day before the leap UT1-UTC is still close to its 2016-12-31 value, not halfway through the step
+    REQUIRE(eop.at(57753.5).dut1 == Approx(-0.4077).margin(1e-9));
+    REQUIRE(eop.at(57754.0).dut1 == Approx(0.5923).margin(1e-9));
+    REQUIRE(eop.at(57754.5).dut1 == Approx(0.59215).margin(1e-9));
+
+    // The transformation agrees with a table holding that day's UT1-UTC constant
+    const Coordinate::EopTable before({day(57752.0, -0.4077), day(57753.0, -0.4077)});
+    const Coordinate::EopTable after({day(57754.0, 0.5923), day(57755.0, 0.5923)});
+    Coordinate::EarthOrientation orientation(eop);
+    Coordinate::EarthOrientation reference(before);
+    Coordinate::EarthOrientation referenceAfter(after);
+    const std::array<double, 3> r = {6.378e6, 0.0, 0.0};
+    for (double hour = 1.5; hour < 24.0; hour += 3.0) {
+        const double t = timeSinceJ2000(2016, 12, 31, 0, 0, 0) + hour * 3600.0;
+        const auto a = orientation.ecefToEci(r, t);
+        const auto b = reference.ecefToEci(r, t);
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(a[i] == Approx(b[i]).margin(1e-3));
+        }
+    }
+    const double t = timeSinceJ2000(2017, 1, 1, 0, 0, 0) + 60.0;
+    const auto a = orientation.ecefToEci(r, t);
+    const auto b = referenceAfter.ecefToEci(r, t);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(a[i] == Approx(b[i]).margin(1e-2));
+    }
+}
+
+TEST_CASE("The frame of the last epoch is reused") {
+    Coordinate::EarthOrientation orientation(valladoEop());
+    const std::array<double, 3> r = {-1033.4793830e3, 7901.2952754e3, 6380.3565958e3};
+    const auto m = orientation.ecefToEciMatrix(utc);
+    const auto eci = orientation.ecefToEci(r, utc);
+    const auto direct = Coordinate::multiply(m, r);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(eci[i] == direct[i]);
+    }
+    // A different epoch rebuilds the frame
+    const auto later = orientation.ecefToEci(r, utc + 10.0);
+    REQUIRE(later[0] != eci[0]);
+    const auto back = orientation.eciToEcef(eci, utc);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(back[i] == Approx(r[i]).margin(1e-6));
+    }
+}
@@ -0,0 +1,201 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testEnsembleIntegrators.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Ensemble 3DoF dynamics against the scalar DynamicModel lane by lane, with a
+ *  shared fixed step and with per lane adaptive steps, and the drag of the rotating
+ *  atmosphere against a scalar model of the same forces]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/DynamicModel.h"
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/EnsembleModel.h"
+#include "FixedSizeIntegrators.h"
+
+#include <array>
+#include <cmath>
+
+using Vector = std::array<double, 3>;
+
+// Trajectory k of a spread of LEO orbits with different eccentricities and forces
+static void initial(std::size_t k, Vector& r, Vector& v, double& mass, Vector& force) {
+    const double a = 6778137.0 + 2000.0 * k;
+    const double speed = std::sqrt(3.986004418e14 / a) * (1.0 + 0.002 * (k % 17));
+    const double inclination = 0.1 + 0.03 * k;
+    r = {a, 0.0, 0.0};
+    v = {0.0, speed * std::cos(inclination), speed * std::sin(inclination)};
+    mass = 400.0 + k;
+    force = {0.01 * (k % 5), -0.02, 0.005 * (k % 3)};
+}
+
+static double distance(const Vector& a, const Vector& b) {
+    return std::sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+template<class Ensemble>
+static void configure(Ensemble& ensemble) {
+    for (std::size_t k = 0; k < ensemble.size(); ++k) {
+        Vector r, v, force;
+        double mass;
+        initial(k, r, v, mass, force);
+        ensemble.SetState(k, r, v);
+        ensemble.SetMass(k, mass);
+        ensemble.SetForce(k, force);
+    }
+}
+
+template<class Scalar>
+static void configure(Scalar& model, std::size_t k) {
+    Vector r, v;
+    initial(k, r, v, model.Mass, model.Force);
+    model.SetState(r, v);
+}
+
+TEST_CASE("Fixed steps follow the scalar model in every lane") {
+    // Not a multiple of the tile width, so the last tile is padded
+    const std::size_t count = 100;
+    EnsembleModel<Integration::EnsembleRK4<6>> ensemble(count);
+    configure(ensemble);
+    ensemble.solve_fixed(3000.0, 7.0);
+
+    for (std::size_t k = 0; k < count; ++k) {
+        DynamicModel<Integration::FixedRK4<6>> model;
+        configure(model, k);
+        model.solve_fixed(3000.0, 7.0);
+        REQUIRE(ensemble.get_t(k) == Approx(3000.0));
+        REQUIRE(distance(ensemble.GetPosition(k), model.GetPosition()) < 1e-6);
+        REQUIRE(distance(ensemble.GetVelocity(k), model.GetVelocity()) < 1e-9);
+    }
+    REQUIRE(ensemble.get_nstep() == long(count) * 429);
+}
+
+TEST_CASE("Adaptive lanes take their own steps") {
+    const std::size_t count = 70;
+    EnsembleModel<Integration::EnsembleDoPri54<6>> ensemble(count);
+    ensemble.set_reltol(1e-10);
+    ensemble.set_abstol(1e-6);
+    configure(ensemble);
+    ensemble.solve_adaptive(6000.0, 10.0);
+
+    long steps = 0;
+    long rejected = 0;
+    for (std::size_t k = 0; k < count; ++k) {
+        DynamicModel<Integration::FixedDoPri54<6>> model;
+        model.set_reltol(1e-10);
+        model.set_abstol(1e-6);
+        configure(model, k);
+        model.solve_adaptive(6000.0, 10.0);
+        steps += model.get_nstep();
+        rejected += model.get_nrej();
+        REQUIRE(ensemble.get_t(k) == 6000.0);
+        REQUIRE(distance(ensemble.GetPosition(k), model.GetPosition()) < 1e-4);
+        REQUIRE(distance(ensemble.GetVelocity(k), model.GetVelocity()) < 1e-7);
+    }
+    // Lane by lane the same step sequence as the scalar integrator
+    REQUIRE(ensemble.get_nstep() == steps);
+    REQUIRE(ensemble.get_nrej() == rejected);
+
+    // A second call continues from each lane's own time
+    ensemble.solve_adaptive(100.0, 10.0);
+    REQUIRE(ensemble.get_t(count - 1) == 6100.0);
+}
+
+// Scalar model of the same forces as EnsembleModel; bound to the integrator itself so
+// that the integrator calls this ode_fun rather than DynamicModel's
+class DragModel : public DynamicModel<Integration::Bind<Integration::FixedDoPri54<6>, DragModel>> {
+
+    public:
+        double DragArea = 0.0;
+
+        void ode_fun(double* solin, double* fout) {
+            DynamicModel::ode_fun(solin, fout);
+            const double r2 = solin[0] * solin[0] + solin[1] * solin[1] + solin[2] * solin[2];
+            const double h = std::sqrt(r2) - Coordinate::EARTH_SEMI_MAJOR_AXIS * (1.0 - solin[2] * solin[2] / r2 / 298.257223563);
+            if (h < 0.0 || h > 71000.0) return;
+            const double rho = US1976::Density(h);
+            const double w = Coordinate::EARTH_ROTATION_RATE;
+            const double v[3] = {solin[3] + w * solin[1], solin[4] - w * solin[0], solin[5]};
+            const double k = -0.5 * rho * DragArea / Mass * std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+            for (int i = 0; i < 3; ++i) fout[3 + i] += k * v[i];
+        }
+};
+
+TEST_CASE("Drag of the rotating atmosphere") {
+    // Re-entry from 70 km at 7 km/s for a spread of ballistic coefficients, and one
+    // lane left in orbit, which shares the tile but feels no drag
+    const std::size_t count = 9;
+    EnsembleModel<Integration::EnsembleDoPri54<6>> ensemble(count);
+    ensemble.set_reltol(1e-10);
+    ensemble.set_abstol(1e-6);
+    const Vector r = {6378137.0 + 70000.0, 0.0, 0.0};
+    const Vector v = {-300.0, 7000.0, 0.0};
+    for (std::size_t k = 0; k + 1 < count; ++k) {
+        ensemble.SetState(k, r, v);
+        ensemble.SetMass(k, 100.0);
+        ensemble.SetDragArea(k, 0.1 * (k + 1));
+    }
+    ensemble.SetState(count - 1, {6778137.0, 0.0, 0.0}, {0.0, 7668.6, 0.0});
+    ensemble.SetDragArea(count - 1, 1.0);
+    ensemble.solve_adaptive(60.0, 1.0);
+
+    for (std::size_t k = 0; k + 1 < count; ++k) {
+        DragModel model;
+        model.set_reltol(1e-10);
+        model.set_abstol(1e-6);
+        model.Mass = 100.0;
+        model.DragArea = 0.1 * (k + 1);
+        model.SetState(r, v);
+        model.solve_adaptive(60.0, 1.0);
+        // The two DoPri54 agree to their global error, not bit for bit: with FMA their steps
+        // differ, and through the drag each lands up to ~5e-8 |v| from a reltol 1e-13 solution
+        const double bound = 1e4 * 1e-10;
+        const Vector p = model.GetPosition();
+        const Vector u = model.GetVelocity();
+        REQUIRE(distance(ensemble.GetPosition(k), p) < bound * std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]));
+        REQUIRE(distance(ensemble.GetVelocity(k), u) < bound * std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]));
+    }
+
+    // More drag, less speed
+    auto speed = [&](std::size_t k) {
+        const Vector u = ensemble.GetVelocity(k);
+        return std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+    };
+    for (std::size_t k = 1; k + 1 < count; ++k) REQUIRE(speed(k) < speed(k - 1));
+
+    DynamicModel<Integration::FixedDoPri54<6>> orbit;
+    orbit.set_reltol(1e-10);
+    orbit.set_abstol(1e-6);
+    orbit.SetState({6778137.0, 0.0, 0.0}, {0.0, 7668.6, 0.0});
+    orbit.solve_adaptive(60.0, 1.0);
+    REQUIRE(distance(ensemble.GetPosition(count - 1), orbit.GetPosition()) < 1e-6);
+
+    // Air at rest in the rotating frame exerts no force; with FMA the relative velocity
+    // x[4] - w x[0] is the rounding residual of x[4] rather than zero
+    using Ensemble = EnsembleModel<Integration::EnsembleRK4<6>>;
+    Ensemble still(1);
+    Ensemble::Block x{};
+    Ensemble::Block f{};
+    Ensemble::Block vacuum{};
+    for (int l = 0; l < Ensemble::Lanes; ++l) {
+        x[0][l] = r[0];
+        x[4][l] = Coordinate::EARTH_ROTATION_RATE * r[0];
+    }
+    still.ode_fun(0, x, vacuum);
+    still.SetDragArea(0, 10.0);
+    still.ode_fun(0, x, f);
+    for (int i = 0; i < 6; ++i) REQUIRE(f[i][0] == Approx(vacuum[i][0]).margin(1e-15));
+}
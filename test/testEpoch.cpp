@@ -0,0 +1,114 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testEpoch.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Epoch: calendar conversion, leap seconds, time scales and stepping]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "Epoch.h"
+#include "J2000.h"
+
+using namespace TimeScale;
+
+// Calendar conversion is usable at compile time
+static_assert(daysFromCivil(1970, 1, 1) == 0);
+static_assert(daysFromCivil(2000, 3, 1) - daysFromCivil(2000, 2, 28) == 2);
+static_assert(daysFromCivil(1900, 3, 1) - daysFromCivil(1900, 2, 28) == 1);
+static_assert(civilFromDays(daysFromCivil(2024, 2, 29)).day == 29);
+static_assert(Epoch::fromTt(2000, 1, 1, 12, 0, 0).ttNanoseconds() == 0);
+static_assert(taiMinusUtc(daysFromCivil(2016, 12, 31)) == 36);
+static_assert(taiMinusUtc(daysFromCivil(2017, 1, 1)) == 37);
+
+TEST_CASE("Calendar round trip") {
+    for (std::int64_t day = daysFromCivil(1600, 1, 1); day < daysFromCivil(2400, 1, 1); day += 7) {
+        const CivilDate date = civilFromDays(day);
+        REQUIRE(daysFromCivil(date.year, date.month, date.day) == day);
+    }
+}
+
+TEST_CASE("J2000 in the time scales") {
+    // J2000.0 is 2000-01-01 11:59:27.816 TAI and 11:58:55.816 UTC
+    const Epoch j2000;
+    REQUIRE(Epoch::fromTai(2000, 1, 1, 11, 59, 27, 816000000) == j2000);
+    REQUIRE(Epoch::fromUtc(2000, 1, 1, 11, 58, 55, 816000000) == j2000);
+    REQUIRE(j2000.taiMinusUtc() == 32);
+    REQUIRE(j2000.utcSinceJ2000() == Approx(-64.184).epsilon(1e-15));
+
+    const CalendarTime utc = j2000.utc();
+    REQUIRE(utc.hour == 11);
+    REQUIRE(utc.minute == 58);
+    REQUIRE(utc.second == 55);
+    REQUIRE(utc.nanosecond == 816000000);
+
+    auto [day, fraction] = j2000.julianDateTT();
+    REQUIRE(day == J2000JulianDate);
+    REQUIRE(fraction == 0.0);
+}
+
+TEST_CASE("UTC reading matches the J2000 helpers") {
+    const Epoch epoch = Epoch::fromUtc(2004, 4, 6, 7, 51, 28, 386009000);
+    REQUIRE(epoch.taiMinusUtc() == 32);
+    REQUIRE(epoch.utcSinceJ2000() == Approx(timeSinceJ2000(2004, 4, 6, 7, 51, 28) + 0.386009).margin(1e-4));
+    REQUIRE(epoch.ut1SinceJ2000(-0.4399619) == Approx(epoch.utcSinceJ2000() - 0.4399619).margin(1e-9));
+    // TT = UTC + 32 s + 32.184 s
+    REQUIRE(epoch.ttSinceJ2000() - epoch.utcSinceJ2000() == Approx(64.184).margin(1e-6));
+}
+
+TEST_CASE("UTC seconds since J2000 map back with the leap second of their day") {
+    for (const Epoch epoch : {Epoch::fromUtc(1995, 3, 1, 6, 0, 0), Epoch::fromUtc(2004, 4, 6, 7, 51, 28), Epoch::fromUtc(2020, 1, 1, 0, 0, 0)}) {
+        REQUIRE(Epoch::fromUtcSinceJ2000(epoch.utcSinceJ2000()) == epoch);
+    }
+    // 29 s in 1995, not today's 37 s
+    const Epoch epoch = Epoch::fromUtcSinceJ2000(timeSinceJ2000(1995, 3, 1, 6, 0, 0));
+    REQUIRE(epoch.taiMinusUtc() == 29);
+    REQUIRE(epoch.ttSinceJ2000() - epoch.utcSinceJ2000() == Approx(61.184).margin(1e-6));
+}
+
+TEST_CASE("Leap second at the end of 2016") {
+    const Epoch before = Epoch::fromUtc(2016, 12, 31, 23, 59, 59);
+    const Epoch leap = Epoch::fromUtc(2016, 12, 31, 23, 59, 60);
+    const Epoch after = Epoch::fromUtc(2017, 1, 1, 0, 0, 0);
+    REQUIRE(leap - before == NanosecondsPerSecond);
+    REQUIRE(after - before == 2 * NanosecondsPerSecond);
+    REQUIRE(before.taiMinusUtc() == 36);
+    REQUIRE(after.taiMinusUtc() == 37);
+
+    const CalendarTime utc = after.utc();
+    REQUIRE(utc.year == 2017);
+    REQUIRE(utc.month == 1);
+    REQUIRE(utc.day == 1);
+    REQUIRE(utc.hour == 0);
+    REQUIRE(utc.second == 0);
+}
+
+TEST_CASE("Stepping is exact") {
+    const Epoch start = Epoch::fromUtc(2024, 3, 20, 3, 6, 0);
+    Epoch epoch = start;
+    const std::int64_t dt = Epoch::nanoseconds(0.001);
+    for (int i = 0; i < 86400000; ++i) {
+        epoch += dt;
+    }
+    REQUIRE(epoch == Epoch::fromUtc(2024, 3, 21, 3, 6, 0));
+    REQUIRE(epoch.ttSinceJ2000() - start.ttSinceJ2000() == 86400.0);
+
+    // Nanosecond resolution survives at a large offset from J2000
+    const Epoch late = Epoch::fromTt(2150, 1, 1, 0, 0, 0, 1);
+    auto [day, fraction] = late.julianDateTT();
+    REQUIRE(fraction * 86400.0e9 == Approx(43200.0e9 + 1.0).margin(1e-3));
+    REQUIRE(day == J2000JulianDate + static_cast<double>(daysFromCivil(2149, 12, 31) - J2000Day));
+}
@@ -0,0 +1,240 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testFixedSizeIntegrators.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Fixed size integrators: LU solve, convergence order of each method (ROS34PW2
+ *  also with a wrong Jacobian, which a W-method tolerates), tolerance control,
+ *  Jacobian reuse in the W mode, stiffness switching and the 3DoF model built
+ *  on them]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "FixedSizeIntegrators.h"
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/DynamicModel.h"
+
+#include <cmath>
+
+using namespace Integration;
+
+TEST_CASE("LU solve with pivoting") {
+    std::array<double, 9> A = {0.0, 2.0, 1.0, 1.0, 1.0, 1.0, 4.0, -1.0, 3.0};
+    const std::array<double, 9> original = A;
+    const double x[3] = {1.0, -2.0, 0.5};
+    double b[3];
+    for (int i = 0; i < 3; ++i) b[i] = original[3 * i] * x[0] + original[3 * i + 1] * x[1] + original[3 * i + 2] * x[2];
+
+    LuFactor<3> lu;
+    REQUIRE(lu.factor(A));
+    lu.solve(A, b);
+    for (int i = 0; i < 3; ++i) REQUIRE(b[i] == Approx(x[i]).margin(1e-14));
+
+    std::array<double, 4> singular = {1.0, 2.0, 2.0, 4.0};
+    REQUIRE_FALSE(LuFactor<2>().factor(singular));
+}
+
+// Nonlinear test problem y1' = y2, y2' = -sin(y1) (pendulum) with an optional
+// scaling of the Jacobian to mimic a stale one
+template<class Integrator>
+class Pendulum : public Bind<Integrator, Pendulum<Integrator>> {
+
+    public:
+        static constexpr int StateCount = 2;
+        double JacobianScale = 1.0;
+
+        Pendulum() : Bind<Integrator, Pendulum>(StateCount) {}
+
+        void ode_fun(double* solin, double* fout) {
+            fout[0] = solin[1];
+            fout[1] = -std::sin(solin[0]);
+        }
+
+        void ode_jac(double* solin, double** Jout) {
+            Jout[0][0] = 0.0;
+            Jout[0][1] = JacobianScale;
+            Jout[1][0] = -std::cos(solin[0]) * JacobianScale;
+            Jout[1][1] = 0.0;
+        }
+};
+
+template<class Integrator>
+double solveFixed(double dt, double scale = 1.0) {
+    Pendulum<Integrator> model;
+    model.JacobianScale = scale;
+    model.set_sol(0, 1.0);
+    model.set_sol(1, 0.0);
+    model.solve_fixed(2.0, dt);
+    return model.get_sol(0);
+}
+
+// Observed order from three step sizes halving each time
+template<class Integrator>
+double observedOrder(double dt, double scale = 1.0) {
+    const double a = solveFixed<Integrator>(dt, scale);
+    const double b = solveFixed<Integrator>(dt / 2.0, scale);
+    const double c = solveFixed<Integrator>(dt / 4.0, scale);
+    return std::log2(std::abs(a - b) / std::abs(b - c));
+}
+
+TEST_CASE("Convergence order") {
+    REQUIRE(observedOrder<FixedRK4<2>>(0.1) == Approx(4.0).margin(0.15));
+    REQUIRE(observedOrder<FixedDoPri54<2>>(0.2) == Approx(5.0).margin(0.3));
+    // With the exact Jacobian the leading error term is small on this problem and
+    // the observed order runs above 3 before roundoff takes over
+    REQUIRE(observedOrder<FixedROS34PW2<2>>(0.2) > 2.9);
+    REQUIRE(observedOrder<FixedROS34PW2<2>>(0.05, 0.5) == Approx(3.0).margin(0.1));
+    REQUIRE(observedOrder<FixedROS34PW2<2>>(0.05, 0.0) == Approx(3.0).margin(0.1));
+}
+
+TEST_CASE("Adaptive methods meet the tolerance") {
+    // Reference from a tightly controlled run
+    Pendulum<FixedDoPri54<2>> reference;
+    reference.set_reltol(1e-13);
+    reference.set_abstol(1e-13);
+    reference.set_sol(0, 1.0);
+    reference.set_sol(1, 0.0);
+    reference.solve_adaptive(10.0, 0.01);
+
+    Pendulum<FixedDoPri54<2>> dopri;
+    Pendulum<FixedROS34PW2<2>> rosenbrock;
+    dopri.set_reltol(1e-8);
+    dopri.set_abstol(1e-8);
+    rosenbrock.set_reltol(1e-8);
+    rosenbrock.set_abstol(1e-8);
+    dopri.set_sol(0, 1.0);
+    rosenbrock.set_sol(0, 1.0);
+    dopri.solve_adaptive(10.0, 0.01);
+    rosenbrock.solve_adaptive(10.0, 0.01);
+
+    REQUIRE(dopri.get_t() == 10.0);
+    REQUIRE(rosenbrock.get_t() == 10.0);
+    REQUIRE(dopri.get_sol(0) == Approx(reference.get_sol(0)).margin(1e-6));
+    REQUIRE(rosenbrock.get_sol(0) == Approx(reference.get_sol(0)).margin(1e-6));
+    REQUIRE(rosenbrock.get_njac() == rosenbrock.get_nlu());
+    REQUIRE(rosenbrock.get_nlu() == rosenbrock.get_nstep() + rosenbrock.get_nrej());
+}
+
+TEST_CASE("W mode reuses the Jacobian and its factorisation") {
+    Pendulum<FixedROS34PW2<2>> fresh;
+    Pendulum<FixedROS34PW2<2, true>> reuse;
+    fresh.set_reltol(1e-8);
+    fresh.set_abstol(1e-8);
+    reuse.set_reltol(1e-8);
+    reuse.set_abstol(1e-8);
+    fresh.set_sol(0, 1.0);
+    reuse.set_sol(0, 1.0);
+    fresh.solve_adaptive(10.0, 0.01);
+    reuse.solve_adaptive(10.0, 0.01);
+
+    REQUIRE(reuse.get_sol(0) == Approx(fresh.get_sol(0)).margin(1e-6));
+    REQUIRE(reuse.get_njac() < reuse.get_nstep() / 5);
+    REQUIRE(reuse.get_nlu() < reuse.get_nstep());
+    REQUIRE(reuse.get_nlu() >= reuse.get_njac());
+
+    // A forced refresh costs one evaluation on the next step
+    const long jacobians = reuse.get_njac();
+    reuse.refresh_jacobian();
+    reuse.solve_adaptive(1e-3, 1e-3);
+    REQUIRE(reuse.get_njac() == jacobians + 1);
+}
+
+// y' = -lambda (y - cos tau) - sin tau, tau' = 1, solved by y = cos tau, and stiff
+// (lambda = 1e4) for 5 <= tau < 10 only
+template<class Integrator>
+class PhasedRelaxation : public Bind<Integrator, PhasedRelaxation<Integrator>> {
+
+    public:
+        static constexpr int StateCount = 2;
+
+        PhasedRelaxation() : Bind<Integrator, PhasedRelaxation>(StateCount) {}
+
+        void ode_fun(double* solin, double* fout) {
+            const double tau = solin[1];
+            const double lambda = tau >= 5.0 && tau < 10.0 ? 1e4 : 1.0;
+            fout[0] = -lambda * (solin[0] - std::cos(tau)) - std::sin(tau);
+            fout[1] = 1.0;
+        }
+
+        void ode_jac(double* solin, double** Jout) {
+            const double tau = solin[1];
+            const double lambda = tau >= 5.0 && tau < 10.0 ? 1e4 : 1.0;
+            Jout[0][0] = -lambda;
+            Jout[0][1] = -lambda * std::sin(tau) - std::cos(tau);
+            Jout[1][0] = 0.0;
+            Jout[1][1] = 0.0;
+        }
+};
+
+template<class Model>
+void solvePhased(Model& model) {
+    model.set_reltol(1e-8);
+    model.set_abstol(1e-8);
+    model.set_sol(0, 1.0);
+    model.set_sol(1, 0.0);
+    model.solve_adaptive(15.0, 0.01);
+}
+
+TEST_CASE("Switching follows the stiff phase") {
+    PhasedRelaxation<FixedAutoSwitch<2>> switching;
+    PhasedRelaxation<FixedDoPri54<2>> explicitOnly;
+    PhasedRelaxation<FixedROS34PW2<2, true>> implicitOnly;
+    solvePhased(switching);
+    solvePhased(explicitOnly);
+    solvePhased(implicitOnly);
+
+    REQUIRE(switching.get_sol(0) == Approx(std::cos(15.0)).margin(1e-6));
+    REQUIRE(switching.get_nswitch() == 2);
+    REQUIRE_FALSE(switching.is_stiff());
+    REQUIRE(switching.get_event(0).toStiff);
+    REQUIRE(switching.get_event(0).time == Approx(5.0).margin(0.5));
+    REQUIRE_FALSE(switching.get_event(1).toStiff);
+    REQUIRE(switching.get_event(1).time == Approx(10.0).margin(0.5));
+    REQUIRE(switching.get_explicit_time() + switching.get_implicit_time() == Approx(15.0));
+
+    // Fewer evaluations than either method alone
+    WARN("right-hand side evaluations: switching " << switching.get_nfev() << ", DoPri54 " << explicitOnly.get_nfev()
+                                                   << ", ROS34PW2 " << implicitOnly.get_nfev());
+    REQUIRE(switching.get_nfev() < explicitOnly.get_nfev());
+    REQUIRE(switching.get_nstep() < implicitOnly.get_nstep());
+}
+
+TEST_CASE("Dimension mismatch is rejected") {
+    REQUIRE_THROWS_AS(Pendulum<FixedDoPri54<3>>(), std::invalid_argument);
+}
+
+TEST_CASE("3DoF model on the fixed size integrators") {
+    const std::array<double, 3> r = {6778137.0, 0.0, 0.0};
+    const std::array<double, 3> v = {0.0, 5422.5, 5422.5};
+
+    DynamicModel<FixedDoPri54<6>> dopri;
+    DynamicModel<FixedROS34PW2<6>> rosenbrock;
+    DynamicModel<FixedDoPri54<6>> reference;
+    dopri.set_reltol(1e-10);
+    rosenbrock.set_reltol(1e-10);
+    reference.set_reltol(1e-13);
+    reference.set_abstol(1e-9);
+    dopri.SetState(r, v);
+    rosenbrock.SetState(r, v);
+    reference.SetState(r, v);
+    dopri.solve_adaptive(600.0, 10.0);
+    rosenbrock.solve_adaptive(600.0, 10.0);
+    reference.solve_adaptive(600.0, 10.0);
+
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(dopri.GetPosition()[i] == Approx(reference.GetPosition()[i]).margin(1e-2));
+        REQUIRE(rosenbrock.GetPosition()[i] == Approx(reference.GetPosition()[i]).margin(1e-1));
+    }
+}
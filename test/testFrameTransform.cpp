@@ -0,0 +1,116 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testFrameTransform.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [ECEF/ECI transform context: consistency, kinematics and the rotation recurrence]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "EarthCenteredFrames.h"
+
+#include <vector>
+
+using Vector = std::array<double, 3>;
+
+TEST_CASE("Context agrees with the single call routines") {
+    Coordinate::EcefEciTransform transform(1234.5);
+    const Vector r = {6.1e6, -2.3e6, 1.7e6};
+    const Vector v = {120.0, 7300.0, -40.0};
+
+    auto expected = Coordinate::ecefToEci(r[0], r[1], r[2], 1234.5);
+    auto expectedVelocity = Coordinate::ecefToEciVel(r[0], r[1], r[2], v[0], v[1], v[2], 1234.5);
+    auto eci = transform.toEci(r);
+    auto veci = transform.toEciVelocity(r, v);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(eci[i] == expected[i]);
+        REQUIRE(veci[i] == Approx(expectedVelocity[i]).epsilon(1e-15));
+    }
+
+    auto back = transform.toEcef(eci);
+    auto vback = transform.toEcefVelocity(eci, veci);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(back[i] == Approx(r[i]).margin(1e-8));
+        REQUIRE(vback[i] == Approx(v[i]).margin(1e-10));
+    }
+}
+
+TEST_CASE("Velocity and acceleration follow from differentiating the ECI position") {
+    // ECEF trajectory r(t) = r0 + v0 t + a0 t^2 / 2
+    const Vector r0 = {6.5e6, 1.0e6, -0.5e6};
+    const Vector v0 = {-300.0, 7000.0, 900.0};
+    const Vector a0 = {-8.0, -1.2, 0.6};
+    const double t = 500.0;
+    const double h = 0.5;
+
+    auto eciAt = [&](double tau) {
+        const double d = tau - t;
+        Vector r = {r0[0] + v0[0] * d + 0.5 * a0[0] * d * d, r0[1] + v0[1] * d + 0.5 * a0[1] * d * d,
+                    r0[2] + v0[2] * d + 0.5 * a0[2] * d * d};
+        return Coordinate::EcefEciTransform(tau).toEci(r);
+    };
+
+    Coordinate::EcefEciTransform transform(t);
+    auto v = transform.toEciVelocity(r0, v0);
+    auto a = transform.toEciAcceleration(r0, v0, a0);
+    auto rp = eciAt(t + h);
+    auto rm = eciAt(t - h);
+    auto rc = eciAt(t);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(v[i] == Approx((rp[i] - rm[i]) / (2 * h)).margin(1e-4));
+        REQUIRE(a[i] == Approx((rp[i] - 2 * rc[i] + rm[i]) / (h * h)).margin(1e-3));
+    }
+
+    auto reci = transform.toEci(r0);
+    auto aback = transform.toEcefAcceleration(reci, v, a);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(aback[i] == Approx(a0[i]).margin(1e-10));
+    }
+}
+
+TEST_CASE("Incremental stepping tracks fresh trig calls") {
+    const double dt = 0.01;
+    Coordinate::EcefEciTransform stepped(100.0, dt);
+    for (int n = 1; n <= 200000; ++n) {
+        stepped.step();
+    }
+    Coordinate::EcefEciTransform fresh(100.0 + 200000 * dt);
+    REQUIRE(stepped.time() == Approx(fresh.time()).epsilon(1e-14));
+    REQUIRE(stepped.cosAngle() == Approx(fresh.cosAngle()).margin(1e-11));
+    REQUIRE(stepped.sinAngle() == Approx(fresh.sinAngle()).margin(1e-11));
+    REQUIRE(stepped.cosAngle() * stepped.cosAngle() + stepped.sinAngle() * stepped.sinAngle() == Approx(1.0).epsilon(1e-15));
+}
+
+TEST_CASE("Array forms match the single vector forms, also in place") {
+    Coordinate::EcefEciTransform transform(-777.0);
+    std::vector<Vector> r = {{7.0e6, 0.0, 0.0}, {1.0e6, -6.9e6, 3.0e5}, {-2.0e6, 2.0e6, 6.0e6}};
+    std::vector<Vector> v = {{0.0, 7500.0, 0.0}, {10.0, 20.0, 30.0}, {-7000.0, 0.0, 100.0}};
+    std::vector<Vector> out(3);
+
+    transform.toEciVelocity(r, v, out);
+    for (std::size_t i = 0; i < r.size(); ++i) {
+        REQUIRE(out[i] == transform.toEciVelocity(r[i], v[i]));
+    }
+
+    auto copy = r;
+    transform.toEci(copy, copy);
+    for (std::size_t i = 0; i < r.size(); ++i) {
+        REQUIRE(copy[i] == transform.toEci(r[i]));
+    }
+
+    std::vector<Vector> shorter(2);
+    REQUIRE_THROWS_AS(transform.toEci(r, shorter), std::invalid_argument);
+}
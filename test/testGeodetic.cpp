@@ -0,0 +1,114 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testGeodetic.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Closed form ECEF to geodetic conversion and local level frames]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "BatchKernels.h"
+#include "EarthCenteredFrames.h"
+
+#include <random>
+#include <vector>
+
+using namespace Coordinate;
+
+TEST_CASE("ECEF to geodetic inverts latLonAltToEcef") {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> latitude(-90.0, 90.0);
+    std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+    std::uniform_real_distribution<double> altitude(-1.0e4, 4.0e7);
+
+    for (int n = 0; n < 20000; ++n) {
+        const double lat0 = latitude(rng);
+        const double lon0 = longitude(rng);
+        const double alt0 = altitude(rng);
+        double x, y, z;
+        latLonAltToEcef(lat0, lon0, alt0, x, y, z);
+
+        double lat, lon, alt;
+        ecefToLatLonAlt(x, y, z, lat, lon, alt);
+        REQUIRE(lat == Approx(lat0).margin(1e-11));
+        REQUIRE(lon == Approx(lon0).margin(1e-11));
+        REQUIRE(alt == Approx(alt0).margin(1e-6 + 1e-15 * std::abs(alt0)));
+    }
+}
+
+TEST_CASE("Poles and the equator") {
+    double lat, lon, alt;
+    ecefToLatLonAlt(0.0, 0.0, 6356752.314245 + 1000.0, lat, lon, alt);
+    REQUIRE(lat == Approx(90.0));
+    REQUIRE(alt == Approx(1000.0).margin(1e-6));
+
+    ecefToLatLonAlt(0.0, 0.0, -6356752.314245, lat, lon, alt);
+    REQUIRE(lat == Approx(-90.0));
+    REQUIRE(alt == Approx(0.0).margin(1e-6));
+
+    ecefToLatLonAlt(EARTH_SEMI_MAJOR_AXIS + 500.0, 0.0, 0.0, lat, lon, alt);
+    REQUIRE(lat == Approx(0.0).margin(1e-14));
+    REQUIRE(lon == Approx(0.0).margin(1e-14));
+    REQUIRE(alt == Approx(500.0).margin(1e-6));
+}
+
+TEST_CASE("Local level frames") {
+    const double lat = 41.1;
+    const double lon = 29.0;
+    Matrix3 ned = ecefToNed(lat, lon);
+    Matrix3 enu = ecefToEnu(lat, lon);
+    Matrix3 neu = ecefToNeu(lat, lon);
+
+    // Orthonormal and right handed (NED, ENU) / left handed (NEU)
+    for (const Matrix3* R : {&ned, &enu, &neu}) {
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                double dot = (*R)[i][0] * (*R)[j][0] + (*R)[i][1] * (*R)[j][1] + (*R)[i][2] * (*R)[j][2];
+                REQUIRE(dot == Approx(i == j ? 1.0 : 0.0).margin(1e-15));
+            }
+        }
+    }
+
+    // A point straight above the origin is "up"
+    double x0, y0, z0, x1, y1, z1;
+    latLonAltToEcef(lat, lon, 100.0, x0, y0, z0);
+    latLonAltToEcef(lat, lon, 1100.0, x1, y1, z1);
+    auto p = ecefToNeuPosition(x1, y1, z1, lat, lon, 100.0);
+    REQUIRE(p[0] == Approx(0.0).margin(1e-8));
+    REQUIRE(p[1] == Approx(0.0).margin(1e-8));
+    REQUIRE(p[2] == Approx(1000.0).epsilon(1e-12));
+
+    // A point slightly east has a positive east component in every frame
+    latLonAltToEcef(lat, lon + 0.01, 100.0, x1, y1, z1);
+    double d[3] = {x1 - x0, y1 - y0, z1 - z0};
+    REQUIRE(ned[1][0] * d[0] + ned[1][1] * d[1] + ned[1][2] * d[2] > 0.0);
+    REQUIRE(enu[0][0] * d[0] + enu[0][1] * d[1] + enu[0][2] * d[2] > 0.0);
+}
+
+TEST_CASE("Batch geodetic conversion matches the scalar routine") {
+    std::vector<double> x = {7.0e6, -1.2e6, 3.3e6, 0.0};
+    std::vector<double> y = {1.0e5, 6.4e6, -4.1e6, 0.0};
+    std::vector<double> z = {-2.0e5, 1.0e6, 3.9e6, 6.5e6};
+    std::vector<double> lat(4), lon(4), alt(4);
+    ecefToLatLonAlt(x, y, z, lat, lon, alt);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        double la, lo, al;
+        ecefToLatLonAlt(x[i], y[i], z[i], la, lo, al);
+        REQUIRE(lat[i] == la);
+        REQUIRE(lon[i] == lo);
+        REQUIRE(alt[i] == al);
+    }
+}
@@ -0,0 +1,230 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testGravityFieldCache.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Interpolating gravity cache against the underlying spherical harmonic field]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "GravitationalModels.h"
+#include "GravityFieldCache.h"
+
+#include <random>
+#include <thread>
+
+using SphericalHarmonics::triangularIndex;
+using SphericalHarmonics::triangularSize;
+
+struct Field {
+    static constexpr int degree = 12;
+    std::vector<double> C;
+    std::vector<double> S;
+    SphericalHarmonics::GravityField field;
+
+    Field() : C(makeCoefficients(false)), S(makeCoefficients(true)), field(C.data(), S.data(), degree, J2::GM, J2::Re) {}
+
+    static std::vector<double> makeCoefficients(bool sine) {
+        std::mt19937_64 rng(sine ? 11 : 7);
+        std::normal_distribution<double> normal(0.0, 1.0);
+        std::vector<double> values(triangularSize(degree), 0.0);
+        if (!sine) values[triangularIndex(0, 0, degree)] = 1.0;
+        for (int n = 2; n <= degree; ++n) {
+            for (int m = sine ? 1 : 0; m <= n; ++m) {
+                values[triangularIndex(n, m, degree)] = 1e-6 / (n * n) * normal(rng);
+            }
+        }
+        values[triangularIndex(2, 0, degree)] = sine ? 0.0 : -J2::J2 / std::sqrt(5.0);
+        return values;
+    }
+
+    SphericalHarmonics::GravityFieldCache::Model model() {
+        return [this](double x, double y, double z) { return field.accelerationAndGradient(x, y, z); };
+    }
+};
+
+// Random positions in a low Earth orbit shell
+static std::vector<std::array<double, 3>> shell(std::size_t count, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::uniform_real_distribution<double> radius(6.6e6, 7.2e6);
+    std::vector<std::array<double, 3>> points;
+    for (std::size_t n = 0; n < count; ++n) {
+        std::array<double, 3> u = {normal(rng), normal(rng), normal(rng)};
+        const double scale = radius(rng) / std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+        points.push_back({u[0] * scale, u[1] * scale, u[2] * scale});
+    }
+    return points;
+}
+
+TEST_CASE("Cached gravity stays within the error target") {
+    Field f;
+    SphericalHarmonics::CacheSettings settings;
+    settings.tolerance = 1e-7;
+    SphericalHarmonics::GravityFieldCache cache(f.model(), J2::GM, settings);
+
+    double worst = 0.0;
+    for (const auto& p : shell(300, 1)) {
+        const auto cached = cache.accelerationAndGradient(p[0], p[1], p[2]);
+        const auto exact = f.field.accelerationAndGradient(p[0], p[1], p[2]);
+        double error = 0.0;
+        for (int i = 0; i < 3; ++i) {
+            error += (cached.acceleration[i] - exact.acceleration[i]) * (cached.acceleration[i] - exact.acceleration[i]);
+            for (int j = 0; j < 3; ++j) {
+                REQUIRE(cached.gradient[i][j] == Approx(exact.gradient[i][j]).margin(1e-11));
+                REQUIRE(cached.gradient[i][j] == cached.gradient[j][i]);
+            }
+        }
+        worst = std::max(worst, std::sqrt(error));
+    }
+    // The error check samples each cell at nine points, so allow some headroom
+    REQUIRE(worst < 5 * settings.tolerance);
+
+    const auto stats = cache.statistics();
+    REQUIRE(stats.misses > 0);
+    REQUIRE(stats.refinements > 0);
+    REQUIRE(stats.hits + stats.misses >= 300);
+}
+
+TEST_CASE("Repeated lookups are hits") {
+    Field f;
+    SphericalHarmonics::GravityFieldCache cache(f.model(), J2::GM);
+    const auto points = shell(50, 2);
+    for (const auto& p : points) cache.acceleration(p[0], p[1], p[2]);
+    const auto first = cache.statistics();
+    for (const auto& p : points) cache.acceleration(p[0], p[1], p[2]);
+    const auto second = cache.statistics();
+    REQUIRE(second.misses == first.misses);
+    REQUIRE(second.hits == first.hits + points.size());
+}
+
+TEST_CASE("Least recently used cells are evicted at capacity") {
+    Field f;
+    SphericalHarmonics::CacheSettings settings;
+    settings.tolerance = 1e-3;
+    settings.rootCellSize = 2.0e5;
+    settings.capacity = 16;
+    SphericalHarmonics::GravityFieldCache cache(f.model(), J2::GM, settings);
+
+    const std::array<double, 3> hot = {7.0e6, 1.0e5, 1.0e5};
+    for (const auto& p : shell(200, 3)) {
+        cache.acceleration(p[0], p[1], p[2]);
+        cache.acceleration(hot[0], hot[1], hot[2]);
+    }
+    const auto stats = cache.statistics();
+    REQUIRE(stats.evictions > 0);
+    REQUIRE(stats.cells <= settings.capacity);
+
+    // The cell used after every other lookup is never the oldest
+    const auto before = cache.statistics().misses;
+    cache.acceleration(hot[0], hot[1], hot[2]);
+    REQUIRE(cache.statistics().misses == before);
+}
+
+TEST_CASE("Eviction keeps refined markers") {
+    Field f;
+    SphericalHarmonics::CacheSettings settings;
+    settings.tolerance = 1e-6;
+    settings.capacity = 8;
+    SphericalHarmonics::GravityFieldCache cache(f.model(), J2::GM, settings);
+
+    const auto points = shell(100, 5);
+    for (const auto& p : points) cache.acceleration(p[0], p[1], p[2]);
+    const auto first = cache.statistics();
+    REQUIRE(first.evictions > 0);
+    REQUIRE(first.refinements > 0);
+    REQUIRE(first.cells <= settings.capacity);
+
+    // Revisiting evicted regions rebuilds their leaves but never refines again
+    for (const auto& p : points) cache.acceleration(p[0], p[1], p[2]);
+    const auto second = cache.statistics();
+    REQUIRE(second.misses > first.misses);
+    REQUIRE(second.refinements == first.refinements);
+    REQUIRE(second.refinedCells == first.refinedCells);
+}
+
+TEST_CASE("The gradient tolerance refines cells on its own") {
+    Field f;
+    SphericalHarmonics::CacheSettings loose;
+    loose.tolerance = 1e-3;
+    loose.gradientTolerance = 1.0;
+    SphericalHarmonics::CacheSettings tight = loose;
+    tight.gradientTolerance = 1e-12;
+    SphericalHarmonics::GravityFieldCache coarse(f.model(), J2::GM, loose);
+    SphericalHarmonics::GravityFieldCache fine(f.model(), J2::GM, tight);
+
+    double coarseWorst = 0.0;
+    double fineWorst = 0.0;
+    for (const auto& p : shell(100, 6)) {
+        const auto exact = f.field.accelerationAndGradient(p[0], p[1], p[2]);
+        const auto a = coarse.accelerationAndGradient(p[0], p[1], p[2]);
+        const auto b = fine.accelerationAndGradient(p[0], p[1], p[2]);
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                coarseWorst = std::max(coarseWorst, std::abs(a.gradient[i][j] - exact.gradient[i][j]));
+                fineWorst = std::max(fineWorst, std::abs(b.gradient[i][j] - exact.gradient[i][j]));
+            }
+        }
+    }
+    REQUIRE(fine.statistics().refinements > coarse.statistics().refinements);
+    REQUIRE(fineWorst < 1e-11);
+    REQUIRE(fineWorst < coarseWorst);
+}
+
+TEST_CASE("One cache is shared across instances and threads") {
+    Field f;
+    auto factory = [&f] { return std::make_shared<SphericalHarmonics::GravityFieldCache>(f.model(), J2::GM); };
+    auto a = SphericalHarmonics::GravityFieldCache::shared("test", factory);
+    auto b = SphericalHarmonics::GravityFieldCache::shared("test", factory);
+    REQUIRE(a == b);
+
+    const auto points = shell(100, 4);
+    std::vector<std::thread> threads;
+    std::vector<double> sums(4, 0.0);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (const auto& p : points) sums[t] += a->acceleration(p[0], p[1], p[2])[0];
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (int t = 1; t < 4; ++t) {
+        REQUIRE(sums[t] == sums[0]);
+    }
+
+    a.reset();
+    b.reset();
+    auto c = SphericalHarmonics::GravityFieldCache::shared("test", factory);
+    REQUIRE(c->statistics().misses == 0);
+}
+
+TEST_CASE("Caches with different error targets are not shared") {
+    Field f;
+    SphericalHarmonics::CacheSettings coarse;
+    coarse.tolerance = 1e-6;
+    SphericalHarmonics::CacheSettings fine;
+    fine.tolerance = 1e-9;
+    const std::string coarseKey = SphericalHarmonics::GravityFieldCache::sharedKey("field", coarse);
+    const std::string fineKey = SphericalHarmonics::GravityFieldCache::sharedKey("field", fine);
+    REQUIRE(coarseKey != fineKey);
+
+    auto a = SphericalHarmonics::GravityFieldCache::shared(
+            coarseKey, [&] { return std::make_shared<SphericalHarmonics::GravityFieldCache>(f.model(), J2::GM, coarse); });
+    auto b = SphericalHarmonics::GravityFieldCache::shared(
+            fineKey, [&] { return std::make_shared<SphericalHarmonics::GravityFieldCache>(f.model(), J2::GM, fine); });
+    REQUIRE(a != b);
+    REQUIRE(a->settings().tolerance == 1e-6);
+    REQUIRE(b->settings().tolerance == 1e-9);
+}
@@ -0,0 +1,125 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testGravityGradient.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Analytic gravity-gradient tensors against central differences of the acceleration]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "GravitationalModels.h"
+#include "SphericalHarmonicGravity.h"
+
+#include <random>
+
+using SphericalHarmonics::triangularIndex;
+using SphericalHarmonics::triangularSize;
+
+static const std::array<std::array<double, 3>, 4> positions = {{
+    {7.0e6, 3.0e6, 2.0e6},
+    {-4.0e6, 5.5e6, -3.3e6},
+    {1.0e3, -2.0e3, 6.9e6},
+    {6.6e6, 0.0, 0.0},
+}};
+
+// Central difference Jacobian of an acceleration function
+template<typename F>
+static std::array<std::array<double, 3>, 3> finiteDifference(F acceleration, const std::array<double, 3>& p) {
+    const double h = 10.0;
+    std::array<std::array<double, 3>, 3> G{};
+    for (int j = 0; j < 3; ++j) {
+        auto plus = p;
+        auto minus = p;
+        plus[j] += h;
+        minus[j] -= h;
+        auto ap = acceleration(plus[0], plus[1], plus[2]);
+        auto am = acceleration(minus[0], minus[1], minus[2]);
+        for (int i = 0; i < 3; ++i) {
+            G[i][j] = (ap[i] - am[i]) / (2 * h);
+        }
+    }
+    return G;
+}
+
+template<int N>
+static void checkZonal() {
+    for (const auto& p : positions) {
+        auto result = J2::Zonal<N>::calculateGravityGradient(p[0], p[1], p[2]);
+        auto a = J2::Zonal<N>::calculateGravitationalAcceleration(p[0], p[1], p[2]);
+        auto G = finiteDifference([](double x, double y, double z) { return J2::Zonal<N>::calculateGravitationalAcceleration(x, y, z); }, p);
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(result.acceleration[i] == Approx(a[i]).epsilon(1e-14));
+            for (int j = 0; j < 3; ++j) {
+                REQUIRE(result.gradient[i][j] == Approx(G[i][j]).margin(1e-15));
+                REQUIRE(result.gradient[i][j] == result.gradient[j][i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Zonal gravity gradients match central differences") {
+    checkZonal<2>();
+    checkZonal<3>();
+    checkZonal<4>();
+    checkZonal<5>();
+    checkZonal<6>();
+}
+
+TEST_CASE("J2 gravity gradient is the degree 2 zonal gradient and traceless") {
+    auto result = J2::calculateGravityGradient(7.0e6, 3.0e6, 2.0e6);
+    auto zonal = J2::Zonal<2>::calculateGravityGradient(7.0e6, 3.0e6, 2.0e6);
+    double trace = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        trace += result.gradient[i][i];
+        for (int j = 0; j < 3; ++j) {
+            REQUIRE(result.gradient[i][j] == zonal.gradient[i][j]);
+        }
+    }
+    REQUIRE(trace == Approx(0.0).margin(1e-18));
+}
+
+TEST_CASE("Spherical harmonic gravity gradient matches central differences") {
+    const int degree = 20;
+    std::mt19937_64 rng(5);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<double> C(triangularSize(degree), 0.0), S(triangularSize(degree), 0.0);
+    C[triangularIndex(0, 0, degree)] = 1.0;
+    for (int n = 2; n <= degree; ++n) {
+        for (int m = 0; m <= n; ++m) {
+            C[triangularIndex(n, m, degree)] = 1e-5 / (n * n) * normal(rng);
+            S[triangularIndex(n, m, degree)] = (m == 0) ? 0.0 : 1e-5 / (n * n) * normal(rng);
+        }
+    }
+    SphericalHarmonics::GravityField field(C.data(), S.data(), degree, J2::GM, J2::Re);
+
+    for (auto [n, m] : {std::pair{20, 20}, std::pair{20, 7}, std::pair{3, 0}}) {
+        field.setDegreeOrder(n, m);
+        for (const auto& p : positions) {
+            auto result = field.accelerationAndGradient(p[0], p[1], p[2]);
+            auto a = field.acceleration(p[0], p[1], p[2]);
+            auto G = finiteDifference([&field](double x, double y, double z) { return field.acceleration(x, y, z); }, p);
+            double trace = 0.0;
+            for (int i = 0; i < 3; ++i) {
+                trace += result.gradient[i][i];
+                REQUIRE(result.acceleration[i] == Approx(a[i]).epsilon(1e-12));
+                for (int j = 0; j < 3; ++j) {
+                    REQUIRE(result.gradient[i][j] == Approx(G[i][j]).margin(1e-15));
+                }
+            }
+            REQUIRE(trace == Approx(0.0).margin(1e-17));
+        }
+    }
+}
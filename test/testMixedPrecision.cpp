@@ -0,0 +1,122 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testMixedPrecision.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Error study of the mixed precision mode against the double path: the single
+ *  precision density on every kernel against the double model, and re-entries of
+ *  the mixed precision ensemble against the double ensemble, next to the error of
+ *  the integration itself]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/EnsembleModel.h"
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+using Vector = std::array<double, 3>;
+
+static const Simd::Isa allIsas[] = {Simd::Isa::Scalar, Simd::Isa::SSE2, Simd::Isa::AVX2, Simd::Isa::AVX512};
+
+static double distance(const Vector& a, const Vector& b) {
+    return std::sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+TEST_CASE("Single precision density against the double model") {
+    const std::size_t n = 7301; // spans below, inside and above the table, and a scalar tail
+    std::vector<float> h(n), density(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        h[i] = -1000.0f + 10.0f * static_cast<float>(i);
+    }
+
+    for (auto isa : allIsas) {
+        Simd::limitIsa(isa);
+        US1976::Density(h, density);
+        for (std::size_t i = 0; i < n; ++i) {
+            const float expected = Simd::detail::densityFloat(h[i]);
+            if (h[i] < 0.0f || h[i] > 71000.0f) {
+                REQUIRE(std::isnan(density[i]));
+                REQUIRE(std::isnan(expected));
+                continue;
+            }
+            const float ulp = std::nextafter(expected, INFINITY) - expected;
+            REQUIRE(std::abs(density[i] - expected) <= Simd::MaxUlpError * ulp);
+
+            const double rho = US1976::Density(static_cast<double>(h[i]));
+            REQUIRE(std::abs(density[i] - rho) <= Simd::MaxFloatRelativeError * rho);
+        }
+    }
+    Simd::limitIsa(Simd::Isa::AVX512);
+}
+
+template<class Ensemble>
+static void reentry(Ensemble& ensemble) {
+    for (std::size_t k = 0; k < ensemble.size(); ++k) {
+        ensemble.SetState(k, {6378137.0 + 70000.0, 0.0, 0.0}, {-300.0, 7000.0 - 10.0 * k, 50.0});
+        ensemble.SetMass(k, 100.0);
+        ensemble.SetDragArea(k, 0.1 + 0.02 * k);
+    }
+}
+
+TEST_CASE("Mixed precision re-entry follows the double path") {
+    // 60 s from 70 km to below 50 km, losing up to half of the speed to drag
+    const std::size_t count = 64;
+    EnsembleModel<Integration::EnsembleRK4<6>, double> reference(count);
+    EnsembleModel<Integration::EnsembleRK4<6>, double> halved(count);
+    EnsembleModel<Integration::EnsembleRK4<6>, float> mixed(count);
+    reentry(reference);
+    reentry(halved);
+    reentry(mixed);
+    reference.solve_fixed(60.0, 0.1);
+    halved.solve_fixed(60.0, 0.05);
+    mixed.solve_fixed(60.0, 0.1);
+
+    double position = 0.0;
+    double velocity = 0.0;
+    double truncation = 0.0;
+    for (std::size_t k = 0; k < count; ++k) {
+        position = std::max(position, distance(mixed.GetPosition(k), reference.GetPosition(k)));
+        velocity = std::max(velocity, distance(mixed.GetVelocity(k), reference.GetVelocity(k)));
+        truncation = std::max(truncation, distance(halved.GetPosition(k), reference.GetPosition(k)));
+    }
+    WARN("mixed against double: " << position << " m, " << velocity << " m/s; halving the step: " << truncation << " m");
+    // Far below what the step size costs already
+    REQUIRE(position < 0.05);
+    REQUIRE(velocity < 0.005);
+    REQUIRE(position < 0.01 * truncation);
+}
+
+TEST_CASE("Mixed precision leaves orbits above the atmosphere unchanged") {
+    const std::size_t count = 10;
+    EnsembleModel<Integration::EnsembleDoPri54<6>, double> reference(count);
+    EnsembleModel<Integration::EnsembleDoPri54<6>, float> mixed(count);
+    for (std::size_t k = 0; k < count; ++k) {
+        const Vector r = {6778137.0 + 1000.0 * k, 0.0, 0.0};
+        const Vector v = {0.0, 7668.6 * std::cos(0.1 * k), 7668.6 * std::sin(0.1 * k)};
+        reference.SetState(k, r, v);
+        mixed.SetState(k, r, v);
+        reference.SetDragArea(k, 1.0);
+        mixed.SetDragArea(k, 1.0);
+    }
+    reference.solve_adaptive(5550.0, 10.0);
+    mixed.solve_adaptive(5550.0, 10.0);
+    for (std::size_t k = 0; k < count; ++k) {
+        REQUIRE(mixed.GetPosition(k) == reference.GetPosition(k));
+        REQUIRE(mixed.GetVelocity(k) == reference.GetVelocity(k));
+    }
+}
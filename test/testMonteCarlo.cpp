@@ -0,0 +1,151 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testMonteCarlo.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Dispersion file parsing, per run generators, the work stealing pool and the
+ *  summary writer of the Monte Carlo runner]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "MonteCarlo.h"
+
+#include <atomic>
+#include <chrono>
+#include <set>
+
+TEST_CASE("Dispersion files are parsed line by line") {
+    std::istringstream input("# variable distribution parameters\n"
+                             "mass normal 500 5\n"
+                             "\n"
+                             "initial_eci_vy   uniform 7600 7700   # along track\n"
+                             "time_since_epoch constant 120\n");
+    const auto dispersions = MonteCarlo::parseDispersions(input);
+    REQUIRE(dispersions.size() == 3);
+    REQUIRE(dispersions[0].variable == "mass");
+    REQUIRE(dispersions[0].distribution.kind == MonteCarlo::Distribution::Kind::Normal);
+    REQUIRE(dispersions[0].distribution.b == 5.0);
+    REQUIRE(dispersions[1].distribution.kind == MonteCarlo::Distribution::Kind::Uniform);
+    REQUIRE(dispersions[1].distribution.a == 7600.0);
+    REQUIRE(dispersions[2].distribution.kind == MonteCarlo::Distribution::Kind::Constant);
+
+    Random::Philox random(1, 2);
+    REQUIRE(dispersions[2].distribution.sample(random) == 120.0);
+    for (int i = 0; i < 1000; ++i) {
+        const double value = dispersions[1].distribution.sample(random);
+        REQUIRE(value >= 7600.0);
+        REQUIRE(value < 7700.0);
+    }
+
+    for (const char* bad : {"mass gamma 1 2", "mass uniform 2 1", "mass normal 500 0", "mass normal 500", "mass constant 1 2"}) {
+        std::istringstream line(bad);
+        REQUIRE_THROWS_AS(MonteCarlo::parseDispersions(line), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Draws depend on the seed and the run index only") {
+    std::istringstream input("mass normal 500 5\n"
+                             "drag uniform 0.9 1.1\n");
+    auto dispersions = MonteCarlo::parseDispersions(input);
+
+    std::vector<double> a, b, c, d;
+    MonteCarlo::sampleRun(dispersions, 7, 41, a);
+    MonteCarlo::sampleRun(dispersions, 7, 41, b);
+    MonteCarlo::sampleRun(dispersions, 7, 42, c);
+    MonteCarlo::sampleRun(dispersions, 8, 41, d);
+    REQUIRE(a == b);
+    REQUIRE(a[0] != c[0]);
+    REQUIRE(a[0] != d[0]);
+
+    // Another dispersion leaves the draws of the others alone
+    dispersions.insert(dispersions.begin() + 1, MonteCarlo::Dispersion{"thrust", {MonteCarlo::Distribution::Kind::Normal, 0.0, 1.0}});
+    MonteCarlo::sampleRun(dispersions, 7, 41, b);
+    REQUIRE(b[0] == a[0]);
+
+    // Same values on any number of threads, in any order
+    const std::size_t runs = 2000;
+    std::vector<std::vector<double>> serial(runs);
+    for (std::size_t run = 0; run < runs; ++run) MonteCarlo::sampleRun(dispersions, 3, run, serial[run]);
+    for (unsigned threads : {1u, 3u, 8u}) {
+        std::vector<std::vector<double>> parallel(runs);
+        MonteCarlo::WorkStealingPool(threads).run(runs, [&](unsigned, std::size_t index) {
+            const std::size_t run = runs - 1 - index;
+            MonteCarlo::sampleRun(dispersions, 3, run, parallel[run]);
+        });
+        REQUIRE(parallel == serial);
+    }
+}
+
+TEST_CASE("Every run executes exactly once whatever the thread count") {
+    for (unsigned threads : {1u, 2u, 3u, 8u}) {
+        for (std::size_t count : {std::size_t(0), std::size_t(1), std::size_t(5), std::size_t(1000)}) {
+            MonteCarlo::WorkStealingPool pool(threads);
+            std::vector<std::atomic<int>> calls(count);
+            std::atomic<bool> badThread{false};
+            pool.run(count, [&](unsigned thread, std::size_t index) {
+                if (thread >= threads) badThread = true;
+                calls[index].fetch_add(1);
+            });
+            REQUIRE_FALSE(badThread);
+            for (const auto& call : calls) REQUIRE(call.load() == 1);
+        }
+    }
+}
+
+TEST_CASE("Idle threads take over the runs of a busy one") {
+    // The first block holds all of the slow runs; without stealing thread 0 would
+    // run all of them
+    MonteCarlo::WorkStealingPool pool(4);
+    const std::size_t count = 64;
+    std::vector<unsigned> owner(count);
+    pool.run(count, [&](unsigned thread, std::size_t index) {
+        owner[index] = thread;
+        if (index < count / 4) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    });
+    const std::set<unsigned> slowOwners(owner.begin(), owner.begin() + count / 4);
+    REQUIRE(slowOwners.size() > 1);
+}
+
+TEST_CASE("A failing task stops the pool and is rethrown") {
+    MonteCarlo::WorkStealingPool pool(3, true);
+    std::atomic<std::size_t> done{0};
+    REQUIRE_THROWS_AS(pool.run(1000, [&](unsigned, std::size_t index) {
+        if (index == 10) throw std::runtime_error("diverged");
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        done.fetch_add(1);
+    }), std::runtime_error);
+    REQUIRE(done.load() < 500);
+}
+
+TEST_CASE("Summary lines from many threads stay whole") {
+    std::ostringstream output;
+    {
+        MonteCarlo::SummaryWriter writer(output, 7);
+        MonteCarlo::WorkStealingPool pool(4);
+        pool.run(500, [&](unsigned, std::size_t index) { writer.write(std::to_string(index) + ",ok"); });
+        REQUIRE(writer.lines() == 500);
+    }
+
+    std::istringstream lines(output.str());
+    std::set<std::size_t> runs;
+    std::string line;
+    while (std::getline(lines, line)) {
+        REQUIRE(line.size() > 3);
+        REQUIRE(line.substr(line.size() - 3) == ",ok");
+        runs.insert(std::stoul(line));
+    }
+    REQUIRE(runs.size() == 500);
+}
@@ -0,0 +1,113 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testPhilox.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Philox4x32-10 against the Random123 known answers, bulk against scalar draws on
+ *  every kernel, and the moments of the uniform and normal draws]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "Philox.h"
+
+#include <vector>
+
+static const Simd::Isa allIsas[] = {Simd::Isa::Scalar, Simd::Isa::SSE2, Simd::Isa::AVX2, Simd::Isa::AVX512};
+
+TEST_CASE("Philox4x32-10 reproduces the known answers") {
+    STATIC_REQUIRE(Random::philox({0, 0, 0, 0}, {0, 0}) == Random::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+    REQUIRE(Random::philox({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}) ==
+            Random::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+    REQUIRE(Random::philox({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}) ==
+            Random::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+}
+
+TEST_CASE("Streams are addressed by seed, run and stream id") {
+    const std::uint64_t seed = 0x0123456789abcdefULL;
+    const std::uint64_t run = 0x0000000500000007ULL;
+    Random::Philox random(seed, run, 3);
+    const Random::Counter block = Random::philox({0, 3, 7, 5}, {0x89abcdef, 0x01234567});
+    for (int w = 0; w < 4; ++w) REQUIRE(random.bits() == block[w]);
+    REQUIRE(random.bits() == Random::philox({1, 3, 7, 5}, {0x89abcdef, 0x01234567})[0]);
+}
+
+TEST_CASE("Bulk draws equal scalar draws on every kernel") {
+    const std::size_t n = 1003; // odd, and not a whole number of eight block batches
+
+    std::vector<std::uint32_t> bits(n);
+    std::vector<double> uniform(n), normal(n);
+    Random::Philox reference(42, 9, 1);
+    for (auto& b : bits) b = reference.bits();
+    for (auto& u : uniform) u = reference.uniform(-2.0, 3.0);
+    for (auto& z : normal) z = reference.normal(1.0, 0.5);
+    const double next = reference.normal();
+
+    for (auto isa : allIsas) {
+        Simd::limitIsa(isa);
+        Random::Philox random(42, 9, 1);
+        std::vector<std::uint32_t> bulkBits(n);
+        std::vector<double> bulkUniform(n), bulkNormal(n);
+
+        // Split so that the bulk calls start in the middle of a block
+        random.fillBits(std::span<std::uint32_t>(bulkBits).first(3));
+        random.fillBits(std::span<std::uint32_t>(bulkBits).subspan(3));
+        random.fillUniform(bulkUniform, -2.0, 3.0);
+        random.fillNormal(bulkNormal, 1.0, 0.5);
+
+        REQUIRE(bulkBits == bits);
+        REQUIRE(bulkUniform == uniform);
+        REQUIRE(bulkNormal == normal);
+        REQUIRE(random.normal() == next);
+    }
+    Simd::limitIsa(Simd::Isa::AVX512);
+}
+
+TEST_CASE("Uniform doubles stay inside the open interval at the extreme words") {
+    REQUIRE(Random::toUniform(0x00000000, 0x00000000) > 0.0);
+    REQUIRE(Random::toUniform(0xFFFFFFFF, 0xFFFFFFFF) < 1.0);
+}
+
+TEST_CASE("Uniform and normal draws have the expected moments") {
+    const std::size_t n = 1 << 20;
+    std::vector<double> values(n);
+    Random::Philox random(2024, 0);
+
+    random.fillUniform(values);
+    REQUIRE(*std::min_element(values.begin(), values.end()) > 0.0);
+    REQUIRE(*std::max_element(values.begin(), values.end()) < 1.0);
+    double sum = 0.0;
+    double sum2 = 0.0;
+    for (double u : values) {
+        sum += u;
+        sum2 += u * u;
+    }
+    REQUIRE(sum / n == Approx(0.5).margin(2e-3));
+    REQUIRE(sum2 / n - (sum / n) * (sum / n) == Approx(1.0 / 12.0).margin(1e-3));
+
+    random.fillNormal(values, 3.0, 2.0);
+    sum = 0.0;
+    sum2 = 0.0;
+    double sum4 = 0.0;
+    for (double z : values) {
+        const double x = (z - 3.0) / 2.0;
+        sum += x;
+        sum2 += x * x;
+        sum4 += x * x * x * x;
+    }
+    REQUIRE(sum / n == Approx(0.0).margin(5e-3));
+    REQUIRE(sum2 / n == Approx(1.0).margin(5e-3));
+    REQUIRE(sum4 / n == Approx(3.0).margin(3e-2));
+}
@@ -0,0 +1,149 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testSecularJ2.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Cartesian and Keplerian conversions, secular J2 rates and the secular J2
+ *  propagator against a numerically integrated J2 orbit]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "SecularJ2.h"
+#include "FixedSizeIntegrators.h"
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/DynamicModel.h"
+
+#include <cmath>
+
+using TwoBody::Vector;
+
+static double distance(const Vector& a, const Vector& b) {
+    return std::sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+TEST_CASE("Elements survive the round trip through Cartesian state") {
+    const TwoBody::Elements elements{7000e3, 0.1, 0.9, 2.0, 4.0, 5.5};
+    Vector r;
+    Vector v;
+    TwoBody::toCartesian(elements, J2::GM, r, v);
+    const TwoBody::Elements back = TwoBody::toElements(r, v, J2::GM);
+    REQUIRE(back.a == Approx(elements.a).epsilon(1e-12));
+    REQUIRE(back.e == Approx(elements.e).epsilon(1e-12));
+    REQUIRE(back.i == Approx(elements.i).epsilon(1e-12));
+    REQUIRE(back.raan == Approx(elements.raan).epsilon(1e-12));
+    REQUIRE(back.argp == Approx(elements.argp).epsilon(1e-12));
+    REQUIRE(back.M == Approx(elements.M).epsilon(1e-12));
+}
+
+TEST_CASE("Circular and equatorial orbits fall back to the node and the x axis") {
+    // Circular equatorial: everything is measured from the x axis
+    const double vc = std::sqrt(J2::GM / 7000e3);
+    const Vector r = {0.0, 7000e3, 0.0};
+    const Vector v = {-vc, 0.0, 0.0};
+    const TwoBody::Elements elements = TwoBody::toElements(r, v, J2::GM);
+    REQUIRE(elements.e == Approx(0.0).margin(1e-12));
+    REQUIRE(elements.i == Approx(0.0).margin(1e-12));
+    REQUIRE(elements.raan == 0.0);
+    REQUIRE(elements.argp == 0.0);
+    REQUIRE(elements.M == Approx(0.5 * M_PI).epsilon(1e-12));
+
+    Vector r2;
+    Vector v2;
+    TwoBody::toCartesian(elements, J2::GM, r2, v2);
+    REQUIRE(distance(r, r2) < 1e-6);
+    REQUIRE(distance(v, v2) < 1e-9);
+
+    // Hyperbolic states have no Keplerian elements
+    REQUIRE_THROWS_AS(TwoBody::toElements(r, {0.0, 0.0, 2.0 * vc}, J2::GM), std::domain_error);
+}
+
+TEST_CASE("Sun-synchronous inclination precesses the node once a year") {
+    // 700 km circular orbit at the sun-synchronous inclination of 98.19 deg
+    TwoBody::Elements elements;
+    elements.a = J2::Re + 700e3;
+    elements.i = 98.19 * M_PI / 180.0;
+    const J2::SecularPropagator propagator(elements);
+    REQUIRE(propagator.raanRate() * 86400.0 * 365.2422 == Approx(2.0 * M_PI).epsilon(2e-3));
+
+    // Critical inclination freezes perigee
+    elements.i = std::acos(std::sqrt(0.2));
+    REQUIRE(J2::SecularPropagator(elements).argpRate() == Approx(0.0).margin(1e-15));
+}
+
+TEST_CASE("Propagation jumps to any epoch") {
+    const TwoBody::Elements elements{7200e3, 0.02, 1.1, 0.4, 2.2, 3.0};
+    const J2::SecularPropagator propagator(elements);
+
+    // Out and back lands on the epoch state
+    Vector r0;
+    Vector v0;
+    Vector r;
+    Vector v;
+    TwoBody::toCartesian(elements, J2::GM, r0, v0);
+    propagator.propagate(0.0, r, v);
+    REQUIRE(distance(r, r0) < 1e-6);
+
+    // Ten years ahead costs the same as one step and the mean elements drift linearly
+    const double tenYears = 10.0 * 365.25 * 86400.0;
+    const TwoBody::Elements later = propagator.elements(tenYears);
+    REQUIRE(later.a == elements.a);
+    REQUIRE(later.e == elements.e);
+    REQUIRE(later.i == elements.i);
+    REQUIRE(std::remainder(later.raan - elements.raan - propagator.raanRate() * tenYears, 2.0 * M_PI) ==
+            Approx(0.0).margin(1e-6));
+    propagator.propagate(-tenYears, r, v);
+    REQUIRE(std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]) > elements.a * (1.0 - elements.e) - 1.0);
+}
+
+TEST_CASE("Secular propagation follows the integrated J2 orbit") {
+    for (double inclination : {51.6, 98.0}) {
+        TwoBody::Elements elements;
+        elements.a = 6778137.0;
+        elements.e = 0.01;
+        elements.i = inclination * M_PI / 180.0;
+        elements.raan = 0.3;
+        elements.argp = 1.0;
+        elements.M = 0.5;
+        Vector r0;
+        Vector v0;
+        TwoBody::toCartesian(elements, J2::GM, r0, v0);
+
+        DynamicModel<Integration::FixedDoPri54<6>> model;
+        model.set_reltol(1e-12);
+        model.set_abstol(1e-6);
+        model.SetState(r0, v0);
+
+        J2::SecularPropagator secular;
+        secular.set(r0, v0);
+        const J2::SecularPropagator uncorrected(TwoBody::toElements(r0, v0, J2::GM));
+
+        // One day: the error stays at the level of the short periodic terms, while
+        // the osculating semi-major axis taken as mean drifts hundreds of kilometres
+        double worst = 0.0;
+        double worstUncorrected = 0.0;
+        for (int k = 1; k <= 1440; ++k) {
+            model.solve_adaptive(60.0, 60.0);
+            const auto reference = model.GetPosition();
+            Vector r;
+            Vector v;
+            secular.propagate(60.0 * k, r, v);
+            worst = std::max(worst, distance(r, reference));
+            uncorrected.propagate(60.0 * k, r, v);
+            worstUncorrected = std::max(worstUncorrected, distance(r, reference));
+        }
+        REQUIRE(worst < 40e3);
+        REQUIRE(worstUncorrected > 10.0 * worst);
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testSmallMatrix.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Fixed size vector, matrix and quaternion kernels]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "SmallMatrix.h"
+
+using namespace SmallMatrix;
+
+static_assert(dot(cross(Vector3{1.0, 0.0, 0.0}, Vector3{0.0, 1.0, 0.0}), Vector3{0.0, 0.0, 1.0}) == 1.0);
+
+TEST_CASE("Inverse of an inertia tensor") {
+    const Matrix3 I = {{{12.0, -0.5, 0.3}, {-0.5, 9.0, 0.2}, {0.3, 0.2, 15.0}}};
+    const Matrix3 P = multiply(I, inverse(I));
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            REQUIRE(P[i][j] == Approx(i == j ? 1.0 : 0.0).margin(1e-15));
+        }
+    }
+}
+
+TEST_CASE("Positive definiteness by leading principal minors") {
+    REQUIRE(positiveDefinite({{{12.0, -0.5, 0.3}, {-0.5, 9.0, 0.2}, {0.3, 0.2, 15.0}}}));
+    // Positive determinant, but two negative eigenvalues
+    REQUIRE_FALSE(positiveDefinite({{{-1.0, 0.0, 0.0}, {0.0, -1.0, 0.0}, {0.0, 0.0, 1.0}}}));
+    REQUIRE_FALSE(positiveDefinite({{{1.0, 0.0, 0.0}, {0.0, -1.0, 0.0}, {0.0, 0.0, -1.0}}}));
+    REQUIRE_FALSE(positiveDefinite({{{1.0, 2.0, 0.0}, {2.0, 1.0, 0.0}, {0.0, 0.0, -1.0}}}));
+    REQUIRE_FALSE(positiveDefinite({{{12.0, -0.5, 0.3}, {0.5, 9.0, 0.2}, {0.3, 0.2, 15.0}}}));
+}
+
+TEST_CASE("Skew matrix is the cross product") {
+    const Vector3 a = {0.3, -1.2, 2.5};
+    const Vector3 b = {-4.0, 0.7, 1.1};
+    const Vector3 c = cross(a, b);
+    const Vector3 d = multiply(skew(a), b);
+    for (int i = 0; i < 3; ++i) REQUIRE(d[i] == Approx(c[i]).epsilon(1e-15));
+}
+
+TEST_CASE("Rotation matrix agrees with the quaternion sandwich") {
+    const Quaternion q = normalise({0.8, -0.2, 0.5, 0.3});
+    const Vector3 v = {1.5, -2.0, 0.25};
+    const Quaternion rotated = multiply(multiply(q, Quaternion{0.0, v[0], v[1], v[2]}), conjugate(q));
+    const Vector3 r = multiply(rotationMatrix(q), v);
+    for (int i = 0; i < 3; ++i) REQUIRE(r[i] == Approx(rotated[i + 1]).epsilon(1e-14));
+
+    // Orthonormal
+    const Matrix3 RRt = multiply(rotationMatrix(q), transpose(rotationMatrix(q)));
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            REQUIRE(RRt[i][j] == Approx(i == j ? 1.0 : 0.0).margin(1e-15));
+        }
+    }
+}
+
+TEST_CASE("Rotation derivative matches central differences") {
+    const Quaternion q = {0.7, 0.1, -0.4, 0.35};
+    const Vector3 v = {2.0, -1.0, 3.0};
+    const auto D = rotationDerivative(q, v);
+    for (int k = 0; k < 4; ++k) {
+        Quaternion plus = q;
+        Quaternion minus = q;
+        plus[k] += 1e-6;
+        minus[k] -= 1e-6;
+        const Vector3 difference = subtract(multiply(rotationMatrix(plus), v), multiply(rotationMatrix(minus), v));
+        for (int i = 0; i < 3; ++i) REQUIRE(D[k][i] == Approx(difference[i] / 2e-6).margin(1e-8));
+    }
+}
+
+TEST_CASE("Kinematic matrices agree with the quaternion product") {
+    const Quaternion q = normalise({0.1, 0.9, -0.3, 0.2});
+    const Vector3 w = {0.05, -0.2, 0.4};
+    const Quaternion product = multiply(q, Quaternion{0.0, w[0], w[1], w[2]});
+    const Matrix4 Omega = omegaMatrix(w);
+    const Matrix43 Xi = xiMatrix(q);
+    for (int i = 0; i < 4; ++i) {
+        const double byOmega = Omega[i][0] * q[0] + Omega[i][1] * q[1] + Omega[i][2] * q[2] + Omega[i][3] * q[3];
+        const double byXi = Xi[i][0] * w[0] + Xi[i][1] * w[1] + Xi[i][2] * w[2];
+        REQUIRE(byOmega == Approx(product[i]).margin(1e-15));
+        REQUIRE(byXi == Approx(product[i]).margin(1e-15));
+    }
+}
@@ -0,0 +1,141 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testSphericalHarmonicGravity.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Spherical harmonic gravity field against closed forms and the potential]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "GravitationalModels.h"
+#include "SphericalHarmonicGravity.h"
+
+#include <cstdio>
+#include <random>
+
+using SphericalHarmonics::triangularIndex;
+using SphericalHarmonics::triangularSize;
+
+// Decaying pseudo random coefficients (Kaula-like), enough to exercise every term
+static void randomCoefficients(int degree, std::vector<double>& C, std::vector<double>& S) {
+    std::mt19937_64 rng(3);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    C.assign(triangularSize(degree), 0.0);
+    S.assign(triangularSize(degree), 0.0);
+    C[triangularIndex(0, 0, degree)] = 1.0;
+    for (int n = 2; n <= degree; ++n) {
+        for (int m = 0; m <= n; ++m) {
+            C[triangularIndex(n, m, degree)] = 1e-5 / (n * n) * normal(rng);
+            S[triangularIndex(n, m, degree)] = (m == 0) ? 0.0 : 1e-5 / (n * n) * normal(rng);
+        }
+    }
+}
+
+TEST_CASE("Degree 2 zonal field reproduces the J2 model") {
+    const int degree = 4;
+    std::vector<double> C(triangularSize(degree), 0.0), S(triangularSize(degree), 0.0);
+    C[triangularIndex(0, 0, degree)] = 1.0;
+    C[triangularIndex(2, 0, degree)] = -J2::J2 / std::sqrt(5.0);
+
+    SphericalHarmonics::GravityField field(C.data(), S.data(), degree, J2::GM, J2::Re);
+    for (auto p : {std::array<double, 3>{7.0e6, 3.0e6, 2.0e6},
+                   std::array<double, 3>{0.0, 0.0, 7.1e6},
+                   std::array<double, 3>{-4.0e6, 5.5e6, -3.3e6}}) {
+        auto expected = J2::calculateGravitationalAcceleration(p[0], p[1], p[2]);
+        auto a = field.acceleration(p[0], p[1], p[2]);
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(a[i] == Approx(expected[i]).margin(1e-12));
+        }
+    }
+}
+
+TEST_CASE("Acceleration is the gradient of the potential") {
+    const int degree = 30;
+    std::vector<double> C, S;
+    randomCoefficients(degree, C, S);
+    SphericalHarmonics::GravityField field(C.data(), S.data(), degree, J2::GM, J2::Re);
+
+    const std::array<double, 3> p = {4.1e6, -3.7e6, 4.4e6};
+    const double h = 1.0;
+    auto a = field.acceleration(p[0], p[1], p[2]);
+    for (int i = 0; i < 3; ++i) {
+        auto plus = p;
+        auto minus = p;
+        plus[i] += h;
+        minus[i] -= h;
+        double derivative = (field.potential(plus[0], plus[1], plus[2]) - field.potential(minus[0], minus[1], minus[2])) / (2 * h);
+        REQUIRE(a[i] == Approx(derivative).margin(1e-7));
+    }
+}
+
+TEST_CASE("Truncated degree and order match a file of that degree") {
+    const int degree = 12;
+    std::vector<double> C, S;
+    randomCoefficients(degree, C, S);
+    SphericalHarmonics::GravityField full(C.data(), S.data(), degree, J2::GM, J2::Re);
+    full.setDegreeOrder(8, 5);
+
+    std::vector<double> Ct(triangularSize(8), 0.0), St(triangularSize(8), 0.0);
+    for (int n = 0; n <= 8; ++n) {
+        for (int m = 0; m <= std::min(n, 5); ++m) {
+            Ct[triangularIndex(n, m, 8)] = C[triangularIndex(n, m, degree)];
+            St[triangularIndex(n, m, 8)] = S[triangularIndex(n, m, degree)];
+        }
+    }
+    SphericalHarmonics::GravityField truncated(Ct.data(), St.data(), 8, J2::GM, J2::Re);
+
+    auto a = full.acceleration(5.0e6, 4.0e6, -2.0e6);
+    auto b = truncated.acceleration(5.0e6, 4.0e6, -2.0e6);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(a[i] == Approx(b[i]).epsilon(1e-13));
+    }
+}
+
+TEST_CASE("Degree 360 stays finite at the pole and on the equator") {
+    const int degree = 360;
+    std::vector<double> C, S;
+    randomCoefficients(degree, C, S);
+    SphericalHarmonics::GravityField field(C.data(), S.data(), degree, J2::GM, J2::Re);
+
+    for (auto p : {std::array<double, 3>{0.0, 0.0, 6.4e6},
+                   std::array<double, 3>{6.4e6, 0.0, 0.0},
+                   std::array<double, 3>{1.0, 0.0, -6.4e6}}) {
+        auto a = field.acceleration(p[0], p[1], p[2]);
+        double norm = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+        REQUIRE(std::isfinite(norm));
+        REQUIRE(norm == Approx(J2::GM / (6.4e6 * 6.4e6)).epsilon(1e-2));
+    }
+}
+
+TEST_CASE("Coefficient file round trip through the memory mapping") {
+    const int degree = 6;
+    std::vector<double> C, S;
+    randomCoefficients(degree, C, S);
+    const std::string path = "testSphericalHarmonicGravity.bin";
+    SphericalHarmonics::writeCoefficientFile(path, degree, J2::GM, J2::Re, C, S);
+
+    {
+        SphericalHarmonics::CoefficientFile file(path);
+        REQUIRE(file.degree() == degree);
+        REQUIRE(file.header().GM == J2::GM);
+        for (std::size_t k = 0; k < C.size(); ++k) {
+            REQUIRE(file.C()[k] == C[k]);
+            REQUIRE(file.S()[k] == S[k]);
+        }
+    }
+    std::remove(path.c_str());
+    REQUIRE_THROWS(SphericalHarmonics::CoefficientFile(path));
+}
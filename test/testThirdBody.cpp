@@ -0,0 +1,86 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testThirdBody.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Sun/Moon ephemeris and third body accelerations]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "J2000.h"
+#include "ThirdBody.h"
+
+static double norm(const std::array<double, 3>& v) {
+    return std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
+
+TEST_CASE("Sun direction at the J2000 epoch") {
+    auto sun = ThirdBody::sunPosition(0.0);
+    const double ra = std::atan2(sun[1], sun[0]) * 180.0 / ThirdBody::detail::PI + 360.0;
+    const double dec = std::asin(sun[2] / norm(sun)) * 180.0 / ThirdBody::detail::PI;
+    REQUIRE(ra == Approx(281.29).margin(0.05));
+    REQUIRE(dec == Approx(-23.03).margin(0.05));
+    REQUIRE(norm(sun) == Approx(1.4710e11).epsilon(1e-3));
+}
+
+TEST_CASE("Moon stays within its distance and declination range") {
+    for (double day = 0.0; day < 365.0; day += 0.37) {
+        auto moon = ThirdBody::moonPosition(timeSinceJ2000(2024, 1, 1, 0, 0, 0) + day * 86400.0);
+        REQUIRE(norm(moon) > 3.55e8);
+        REQUIRE(norm(moon) < 4.07e8);
+        REQUIRE(std::abs(std::asin(moon[2] / norm(moon))) < 29.0 * ThirdBody::detail::Degree);
+    }
+}
+
+TEST_CASE("Chebyshev segments reproduce the series") {
+    ThirdBody::Ephemeris ephemeris;
+    const double start = timeSinceJ2000(2024, 3, 1, 0, 0, 0);
+    ephemeris.prepare(start, start + 30.0 * 86400.0);
+    const std::size_t prepared = ephemeris.segmentCount();
+    REQUIRE(prepared > 0);
+
+    for (double t = start; t < start + 30.0 * 86400.0; t += 3917.0) {
+        auto sun = ephemeris.sun(t);
+        auto moon = ephemeris.moon(t);
+        auto sunSeries = ThirdBody::sunPosition(t);
+        auto moonSeries = ThirdBody::moonPosition(t);
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(sun[i] == Approx(sunSeries[i]).margin(1.0));
+            REQUIRE(moon[i] == Approx(moonSeries[i]).margin(0.01));
+        }
+    }
+    REQUIRE(ephemeris.segmentCount() == prepared);
+}
+
+TEST_CASE("Third body acceleration matches the direct difference") {
+    const std::array<double, 3> r = {4.2164e7, 0.0, 0.0};
+    const std::array<double, 3> s = ThirdBody::moonPosition(0.0);
+    auto a = ThirdBody::acceleration(r, s, ThirdBody::GM_Moon);
+
+    const std::array<double, 3> d = {s[0] - r[0], s[1] - r[1], s[2] - r[2]};
+    const double dn = norm(d);
+    const double sn = norm(s);
+    for (int i = 0; i < 3; ++i) {
+        const double direct = ThirdBody::GM_Moon * (d[i] / (dn * dn * dn) - s[i] / (sn * sn * sn));
+        REQUIRE(a[i] == Approx(direct).epsilon(1e-9));
+    }
+    // Lunar tide at GEO is of order 1e-5 m/s^2
+    REQUIRE(norm(a) > 1e-6);
+    REQUIRE(norm(a) < 3e-5);
+
+    // Small q: f(q) ~ 3q/2 without cancellation
+    REQUIRE(ThirdBody::battinF(1e-12) == Approx(1.5e-12).epsilon(1e-9));
+}
@@ -0,0 +1,142 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testTwoBody.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [Universal-variable Kepler propagation on elliptic and hyperbolic orbits, the
+ *  Encke deviation acceleration and the Encke form of the 3DoF dynamics against
+ *  the Cowell form]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "TwoBody.h"
+#include "GravitationalModels.h"
+#include "FixedSizeIntegrators.h"
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/DynamicModel.h"
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/EnckeModel.h"
+
+#include <cmath>
+
+using TwoBody::Vector;
+
+static double norm(const Vector& a) { return std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]); }
+
+static double energy(const Vector& r, const Vector& v) {
+    return 0.5 * (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]) - J2::GM / norm(r);
+}
+
+TEST_CASE("Stumpff series meet the closed forms") {
+    for (double z : {-2e-2, -1.01e-2, 1.01e-2, 2e-2}) {
+        const double s = std::sqrt(std::abs(z));
+        const double C = z > 0.0 ? (1.0 - std::cos(s)) / z : (std::cosh(s) - 1.0) / -z;
+        REQUIRE(TwoBody::stumpffC(z) == Approx(C).epsilon(1e-12));
+    }
+    REQUIRE(TwoBody::stumpffC(0.0) == 0.5);
+    REQUIRE(TwoBody::stumpffS(0.0) == Approx(1.0 / 6.0));
+    REQUIRE(TwoBody::stumpffS(0.99e-2) == Approx(TwoBody::stumpffS(1.01e-2)).epsilon(1e-4));
+}
+
+TEST_CASE("Elliptic orbit returns after one period") {
+    const Vector r0 = {7000e3, -1200e3, 300e3};
+    const Vector v0 = {1100.0, 7200.0, 1500.0};
+    const double a = 1.0 / (2.0 / norm(r0) - (v0[0] * v0[0] + v0[1] * v0[1] + v0[2] * v0[2]) / J2::GM);
+    const double period = 2.0 * M_PI * std::sqrt(a * a * a / J2::GM);
+
+    TwoBody::KeplerOrbit orbit(r0, v0, J2::GM);
+    Vector r;
+    Vector v;
+    for (double t = 0.0; t < period; t += 137.0) {
+        orbit.propagate(t, r, v);
+        REQUIRE(energy(r, v) == Approx(energy(r0, v0)).epsilon(1e-11));
+    }
+    orbit.propagate(period, r, v);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(r[i] == Approx(r0[i]).margin(1e-3));
+        REQUIRE(v[i] == Approx(v0[i]).margin(1e-6));
+    }
+
+    // Backwards as well
+    orbit.propagate(-period, r, v);
+    REQUIRE(r[0] == Approx(r0[0]).margin(1e-3));
+}
+
+TEST_CASE("Hyperbolic orbit conserves energy and angular momentum") {
+    const Vector r0 = {7000e3, 0.0, 0.0};
+    const Vector v0 = {0.0, 12000.0, 500.0};
+    TwoBody::KeplerOrbit orbit(r0, v0, J2::GM);
+    const double h0 = r0[0] * v0[1];
+
+    Vector r;
+    Vector v;
+    orbit.propagate(20000.0, r, v);
+    REQUIRE(energy(r, v) == Approx(energy(r0, v0)).epsilon(1e-11));
+    REQUIRE(r[0] * v[1] - r[1] * v[0] == Approx(h0).epsilon(1e-11));
+    REQUIRE(norm(r) > 1e8);
+}
+
+TEST_CASE("Encke acceleration is the difference of the central accelerations") {
+    const Vector rho = {6778137.0, 150e3, -320e3};
+    const Vector d = {120.0, -45.0, 80.0};
+    const Vector r = {rho[0] + d[0], rho[1] + d[1], rho[2] + d[2]};
+    const auto a = TwoBody::enckeAcceleration(rho, d, J2::GM);
+    for (int i = 0; i < 3; ++i) {
+        const double direct = -J2::GM * r[i] / std::pow(norm(r), 3) + J2::GM * rho[i] / std::pow(norm(rho), 3);
+        REQUIRE(a[i] == Approx(direct).epsilon(1e-6));
+    }
+}
+
+TEST_CASE("J2 perturbation is the non-central part of the J2 field") {
+    const double x = 5.1e6, y = -2.3e6, z = 3.9e6;
+    const auto full = J2::calculateGravitationalAcceleration(x, y, z);
+    const auto perturbation = J2::calculateJ2Perturbation(x, y, z);
+    const double r = std::sqrt(x * x + y * y + z * z);
+    const double factor = -J2::GM / (r * r * r);
+    REQUIRE(perturbation[0] == Approx(full[0] - factor * x).epsilon(1e-9));
+    REQUIRE(perturbation[1] == Approx(full[1] - factor * y).epsilon(1e-9));
+    REQUIRE(perturbation[2] == Approx(full[2] - factor * z).epsilon(1e-9));
+}
+
+TEST_CASE("Encke and Cowell forms follow the same trajectory") {
+    const std::array<double, 3> r0 = {6778137.0, 0.0, 0.0};
+    const std::array<double, 3> v0 = {0.0, 5422.5, 5422.5};
+
+    DynamicModel<Integration::FixedDoPri54<6>> cowell;
+    EnckeModel<Integration::FixedDoPri54<7>> encke;
+    cowell.set_reltol(1e-13);
+    cowell.set_abstol(1e-9);
+    encke.set_reltol(1e-12);
+    encke.set_abstol(1e-6);
+    cowell.Force = encke.Force = {0.0, 2.0, -1.0};
+    cowell.Mass = encke.Mass = 500.0;
+    cowell.SetState(r0, v0);
+    encke.SetState(r0, v0);
+
+    int rectifications = 0;
+    for (int k = 0; k < 180; ++k) {
+        cowell.solve_adaptive(60.0, 60.0);
+        rectifications += encke.Rectify();
+        encke.solve_adaptive(60.0, 60.0);
+    }
+    REQUIRE(rectifications > 0);
+    const auto rc = cowell.GetPosition();
+    const auto re = encke.GetPosition();
+    const auto vc = cowell.GetVelocity();
+    const auto ve = encke.GetVelocity();
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(re[i] == Approx(rc[i]).margin(1e-2));
+        REQUIRE(ve[i] == Approx(vc[i]).margin(1e-5));
+    }
+}
@@ -0,0 +1,146 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testVariational.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [State transition matrix and parameter sensitivities of the 3DoF dynamics from
+ *  the variational equations against central differences of perturbed runs, and
+ *  the same through explicit and implicit integrators]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "../src/3DoFFixedMassRotatingEllipsoidEarth/DynamicModel.h"
+#include "IntegratorSelection.h"
+#include "Variational.h"
+
+#include <array>
+#include <cmath>
+
+using Nominal = DynamicModel<Integration::FixedDoPri54<6>>;
+using VariationalSystem = Integration::Variational<DynamicModel>;
+using Augmented = VariationalSystem::System<Integration::FixedDoPri54<66>>;
+using State = std::array<double, 6>;
+
+static const State X0 = {6778137.0, 0.0, 0.0, 0.0, 5422.5, 5422.5};
+static const std::array<double, 3> F0 = {2.0, -1.0, 0.5};
+constexpr double M0 = 500.0;
+constexpr double Duration = 3000.0;
+
+template<class Model>
+static void configure(Model& model, const State& x, double mass, const std::array<double, 3>& force) {
+    // libode's fixed step integrators have no tolerances
+    if constexpr (requires { model.set_reltol(1.0); }) {
+        model.set_reltol(1e-12);
+        model.set_abstol(1e-9);
+    }
+    model.Mass = mass;
+    model.Force = force;
+    const std::array<double, 3> r = {x[0], x[1], x[2]};
+    const std::array<double, 3> v = {x[3], x[4], x[5]};
+    model.SetState(r, v);
+}
+
+static State run(const State& x, double mass, const std::array<double, 3>& force) {
+    Nominal model;
+    configure(model, x, mass, force);
+    model.solve_adaptive(Duration, 10.0);
+    State y;
+    for (int i = 0; i < 6; ++i) y[i] = model.get_sol(i);
+    return y;
+}
+
+TEST_CASE("Variational system has the augmented size") {
+    STATIC_REQUIRE(Augmented::StateCount == 66);
+    Augmented model;
+    configure(model, X0, M0, F0);
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j < 6; ++j) REQUIRE(model.GetTransition(i, j) == (i == j ? 1.0 : 0.0));
+        for (int k = 0; k < 4; ++k) REQUIRE(model.GetSensitivity(i, k) == 0.0);
+    }
+}
+
+TEST_CASE("State transition matrix matches perturbed runs") {
+    Augmented model;
+    configure(model, X0, M0, F0);
+    model.solve_adaptive(Duration, 10.0);
+
+    // The nominal part is the plain model
+    const State nominal = run(X0, M0, F0);
+    for (int i = 0; i < 6; ++i) REQUIRE(model.get_sol(i) == Approx(nominal[i]).epsilon(1e-10));
+
+    const std::array<double, 6> delta = {1.0, 1.0, 1.0, 1e-3, 1e-3, 1e-3};
+    for (int j = 0; j < 6; ++j) {
+        State plus = X0;
+        State minus = X0;
+        plus[j] += delta[j];
+        minus[j] -= delta[j];
+        const State yPlus = run(plus, M0, F0);
+        const State yMinus = run(minus, M0, F0);
+        for (int i = 0; i < 6; ++i) {
+            const double difference = (yPlus[i] - yMinus[i]) / (2.0 * delta[j]);
+            const double scale = i < 3 ? (j < 3 ? 1.0 : Duration) : (j < 3 ? 1.0 / Duration : 1.0);
+            REQUIRE(model.GetTransition(i, j) == Approx(difference).margin(1e-5 * scale));
+        }
+    }
+}
+
+TEST_CASE("Mass and force sensitivities match perturbed runs") {
+    Augmented model;
+    configure(model, X0, M0, F0);
+    model.solve_adaptive(Duration, 10.0);
+
+    // Mass
+    const State massPlus = run(X0, M0 + 0.5, F0);
+    const State massMinus = run(X0, M0 - 0.5, F0);
+    for (int i = 0; i < 6; ++i) {
+        REQUIRE(model.GetSensitivity(i, 0) == Approx((massPlus[i] - massMinus[i]) / 1.0).epsilon(1e-4).margin(1e-9));
+    }
+
+    // Force, one component at a time
+    for (int k = 0; k < 3; ++k) {
+        std::array<double, 3> plus = F0;
+        std::array<double, 3> minus = F0;
+        plus[k] += 0.1;
+        minus[k] -= 0.1;
+        const State yPlus = run(X0, M0, plus);
+        const State yMinus = run(X0, M0, minus);
+        for (int i = 0; i < 6; ++i) {
+            REQUIRE(model.GetSensitivity(i, 1 + k) == Approx((yPlus[i] - yMinus[i]) / 0.2).epsilon(1e-4).margin(1e-9));
+        }
+    }
+}
+
+TEST_CASE("Variations agree between explicit and implicit integrators") {
+    using Selection = Integration::IntegratorSelection<VariationalSystem::System>;
+
+    Integration::StepSettings settings;
+    settings.relativeTolerance = 1e-10;
+    settings.absoluteTolerance = 1e-8;
+
+    std::array<double, 66> reference{};
+    for (auto method : {Integration::Method::FixedDoPri54, Integration::Method::FixedROS34PW2}) {
+        Selection selection;
+        selection.select(static_cast<int>(method));
+        selection.visit([](auto& model) { configure(model, X0, M0, F0); });
+        selection.start(0.0, settings);
+        const std::vector<double>& y = selection.advanceTo(600.0);
+        if (method == Integration::Method::FixedDoPri54) {
+            std::copy(y.begin(), y.end(), reference.begin());
+            continue;
+        }
+        for (int i = 6; i < 66; ++i) REQUIRE(y[i] == Approx(reference[i]).epsilon(1e-4).margin(1e-5));
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testVariational6DoF.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ *
+ * Date:        2024
+ *
+ * Description:
+ * [State transition matrix of the 6DoF dynamics, whose quaternion is normalised
+ *  after every step, against central differences of perturbed runs]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "../src/6DoF/DynamicModel.h"
+#include "FixedSizeIntegrators.h"
+#include "Variational.h"
+
+#include <array>
+#include <cmath>
+
+using Nominal = DynamicModel<Integration::FixedDoPri54<13>>;
+using Augmented = Integration::Variational<DynamicModel>::System<Integration::FixedDoPri54<273>>;
+using Rates = SmallMatrix::Vector3;
+
+static const SmallMatrix::Vector3 R0 = {6778137.0, 0.0, 0.0};
+static const SmallMatrix::Vector3 V0 = {0.0, 5422.5, 5422.5};
+static const SmallMatrix::Quaternion Q0 = {0.9, 0.1, -0.3, 0.2};
+static const Rates W0 = {0.05, -0.02, 0.08};
+constexpr double Duration = 200.0;
+
+template<class Model>
+static void configure(Model& model, const Rates& w) {
+    // Loose enough that the truncation error moves |q| off one between normalisations
+    model.set_reltol(1e-8);
+    model.set_abstol(1e-8);
+    model.Mass = 500.0;
+    model.Force = {2.0, -1.0, 0.5};
+    model.Moment = {0.1, 0.0, -0.05};
+    model.SetInertia({{{410.0, -12.0, 6.0}, {-12.0, 380.0, -3.0}, {6.0, -3.0, 520.0}}});
+    model.SetState(R0, V0, Q0, w);
+}
+
+static SmallMatrix::Quaternion attitude(const Rates& w) {
+    Nominal model;
+    configure(model, w);
+    model.solve_adaptive(Duration, 1.0);
+    return model.GetAttitude();
+}
+
+TEST_CASE("Quaternion rows of the transition matrix follow the normalisation") {
+    Augmented model;
+    configure(model, W0);
+    model.solve_adaptive(Duration, 1.0);
+    const auto q = model.GetAttitude();
+
+    for (int j = 0; j < 13; ++j) {
+        // Variations of a unit quaternion are tangent to the sphere
+        double radial = 0.0;
+        for (int i = 0; i < 4; ++i) radial += q[i] * model.GetTransition(6 + i, j);
+        REQUIRE(radial == Approx(0.0).margin(1e-12));
+    }
+
+    for (int j = 0; j < 3; ++j) {
+        const double delta = 1e-5;
+        Rates plus = W0;
+        Rates minus = W0;
+        plus[j] += delta;
+        minus[j] -= delta;
+        const auto qPlus = attitude(plus);
+        const auto qMinus = attitude(minus);
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(model.GetTransition(6 + i, 10 + j) == Approx((qPlus[i] - qMinus[i]) / (2.0 * delta)).margin(1e-4));
+        }
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * ----------------------------------------------------------------------------
+ * Project:     [EBEK]
+ * File:        [testZonalGravity.cpp]
+ * Author:      Onur Tuncer, PhD
+ * Email:       tuncero@itu.edu.tr
+ * Institution: Istanbul Technical University
+ *              Faculty of Aeronautics and Astronuatics
+ * 
+ * Date:        2024
+ *
+ * Description:
+ * [Compile time unrolled zonal gravity models J2..J6]
+ *
+ * License:
+ * [See License.txt in the top level directory for licence and copyright information]
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "GravitationalModels.h"
+#include "SphericalHarmonicGravity.h"
+
+using SphericalHarmonics::triangularIndex;
+using SphericalHarmonics::triangularSize;
+
+static const std::array<double, 3> positions[] = {{7.0e6, 3.0e6, 2.0e6},
+                                                  {1.0e3, -2.0e3, 6.9e6},
+                                                  {-4.0e6, 5.5e6, -3.3e6}};
+
+TEST_CASE("Zonal<2> equals the J2 model") {
+    for (const auto& p : positions) {
+        auto expected = J2::calculateGravitationalAcceleration(p[0], p[1], p[2]);
+        auto a = J2::Zonal<2>::calculateGravitationalAcceleration(p[0], p[1], p[2]);
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(a[i] == Approx(expected[i]).margin(1e-13));
+        }
+    }
+}
+
+template<int N>
+static void compareWithSphericalHarmonics() {
+    std::vector<double> C(triangularSize(N), 0.0), S(triangularSize(N), 0.0);
+    C[triangularIndex(0, 0, N)] = 1.0;
+    for (int n = 2; n <= N; ++n) {
+        C[triangularIndex(n, 0, N)] = -J2::Jn[n] / std::sqrt(2.0 * n + 1.0);
+    }
+    SphericalHarmonics::GravityField field(C.data(), S.data(), N, J2::GM, J2::Re);
+
+    for (const auto& p : positions) {
+        auto expected = field.acceleration(p[0], p[1], p[2]);
+        auto a = J2::Zonal<N>::calculateGravitationalAcceleration(p[0], p[1], p[2]);
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(a[i] == Approx(expected[i]).margin(1e-12));
+        }
+    }
+}
+
+TEST_CASE("Zonal<N> matches the spherical harmonic field with zonal terms only") {
+    compareWithSphericalHarmonics<3>();
+    compareWithSphericalHarmonics<4>();
+    compareWithSphericalHarmonics<5>();
+    compareWithSphericalHarmonics<6>();
+}
+
+TEST_CASE("Zonal models work in single precision") {
+    auto a = J2::Zonal<4>::calculateGravitationalAcceleration(7.0e6f, 3.0e6f, 2.0e6f);
+    auto b = J2::Zonal<4>::calculateGravitationalAcceleration(7.0e6, 3.0e6, 2.0e6);
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(a[i] == Approx(b[i]).epsilon(1e-5));
+    }
+}